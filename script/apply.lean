@@ -43,9 +43,17 @@ def mkAsArgs (n : Nat) : String :=
 def mkFsArgs (n : Nat) : String :=
   genSeq n (s!"fx({·})")
 
--- make string: "lean_inc(fx(0)); ...; lean_inc(fx(n-1))"
-def mkIncFs (n : Nat) : String :=
-  genSeq n (s!"lean_inc(fx({·})); ") (sep := "")
+-- make string: "x0, ..., x{n-1}"
+def mkXsArgs (n : Nat) : String :=
+  genSeq n (s!"x{·}")
+
+-- make string: "obj* x0 = fx(0); ...; obj* x{n-1} = fx(n-1); "
+def mkLoadFs (n : Nat) : String :=
+  genSeq n (fun i => s!"obj* x{i} = fx({i}); ") (sep := "")
+
+-- make string: "obj* x0 = fx(0); lean_inc(x0); ...; obj* x{n-1} = fx(n-1); lean_inc(x{n-1}); "
+def mkLoadIncFs (n : Nat) : String :=
+  genSeq n (fun i => s!"obj* x{i} = fx({i}); lean_inc(x{i}); ") (sep := "")
 
 def mkApplyI (n : Nat) (max : Nat) : M Unit := do
   let argDecls := mkArgDecls n
@@ -55,38 +63,38 @@ if (lean_is_scalar(f)) \{ {genSeq n (s!"lean_dec(a{·+1}); ") (sep := "")}return
 unsigned arity = lean_closure_arity(f);
 unsigned fixed = lean_closure_num_fixed(f);
 if (arity == fixed + {n}) \{
+  void * fn = lean_closure_fun(f);
   if (lean_is_exclusive(f)) \{
     switch (arity) \{\n"
+  -- We release `f` before calling `fn`, so that the call is a tail call.
   for j in [n:max + 1] do
-    let fs := mkFsArgs (j - n)
+    let loadfs := mkLoadFs (j - n)
+    let xs := mkXsArgs (j - n)
     let sep := if j = n then "" else ", "
-    emit s!"    case {j}: \{ obj* r = FN{j}(f)({fs}{sep}{args}); lean_free_object(f); return r; }\n"
+    emit s!"    case {j}: \{ {loadfs}lean_free_object(f); return reinterpret_cast<fn{j}>(fn)({xs}{sep}{args}); }\n"
   emit "    }
   }
   switch (arity) {\n"
   for j in [n:max + 1] do
-    let lean_incfs := mkIncFs (j - n)
-    let fs := mkFsArgs (j - n)
+    let loadincfs := mkLoadIncFs (j - n)
+    let xs := mkXsArgs (j - n)
     let sep := if j = n then "" else ", "
-    emit  s!"  case {j}: \{ {lean_incfs}obj* r = FN{j}(f)({fs}{sep}{args}); lean_dec_ref(f); return r; }\n"
+    emit  s!"  case {j}: \{ {loadincfs}lean_dec_ref(f); return reinterpret_cast<fn{j}>(fn)({xs}{sep}{args}); }\n"
   emit s!"  default:
     lean_assert(arity > {max});
     obj * as[{n}] = \{ {args} };
     obj ** args = static_cast<obj**>(LEAN_ALLOCA(arity*sizeof(obj*))); // NOLINT
-    for (unsigned i = 0; i < fixed; i++) \{ lean_inc(fx(i)); args[i] = fx(i); }
+    move_fixed_args(f, args);
     for (unsigned i = 0; i < {n}; i++) args[fixed+i] = as[i];
-    obj * r = FNN(f)(args);
-    lean_dec_ref(f);
-    return r;
+    return reinterpret_cast<fnn>(fn)(args);
   }
 } else if (arity < fixed + {n}) \{\n"
   if n ≥ 2 then do
     emit  s!"  obj * as[{n}] = \{ {args} };
   obj ** args = static_cast<obj**>(LEAN_ALLOCA(arity*sizeof(obj*))); // NOLINT
-  for (unsigned i = 0; i < fixed; i++) \{ lean_inc(fx(i)); args[i] = fx(i); }
+  void * fn = move_fixed_args(f, args);
   for (unsigned i = 0; i < arity-fixed; i++) args[fixed+i] = as[i];
-  obj * new_f = curry(f, arity, args);
-  lean_dec_ref(f);
+  obj * new_f = curry(fn, arity, args);
   return lean_apply_n(new_f, {n}+fixed-arity, &as[arity-fixed]);\n"
   else emit s!"  lean_assert(fixed < arity);
   lean_unreachable();\n"
@@ -104,8 +112,7 @@ case 0: lean_unreachable();\n"
     emit  s!"case {i+1}: return reinterpret_cast<fn{i+1}>(f)({as});\n"
   emit "default: return reinterpret_cast<fnn>(f)(as);
 }
-}
-static obj* curry(obj* f, unsigned n, obj** as) { return curry(lean_closure_fun(f), n, as); }\n"
+}\n"
 
 def mkApplyN (max : Nat) : M Unit := do
   emit "extern \"C\" LEAN_EXPORT obj* lean_apply_n(obj* f, unsigned n, obj** as) {
@@ -126,17 +133,14 @@ unsigned arity = lean_closure_arity(f);
 unsigned fixed = lean_closure_num_fixed(f);
 if (arity == fixed + n) \{
   obj ** args = static_cast<obj**>(LEAN_ALLOCA(arity*sizeof(obj*))); // NOLINT
-  for (unsigned i = 0; i < fixed; i++) \{ lean_inc(fx(i)); args[i] = fx(i); }
+  void * fn = move_fixed_args(f, args);
   for (unsigned i = 0; i < n; i++) args[fixed+i] = as[i];
-  obj * r = FNN(f)(args);
-  lean_dec_ref(f);
-  return r;
+  return reinterpret_cast<fnn>(fn)(args);
 } else if (arity < fixed + n) \{
   obj ** args = static_cast<obj**>(LEAN_ALLOCA(arity*sizeof(obj*))); // NOLINT
-  for (unsigned i = 0; i < fixed; i++) \{ lean_inc(fx(i)); args[i] = fx(i); }
+  void * fn = move_fixed_args(f, args);
   for (unsigned i = 0; i < arity-fixed; i++) args[fixed+i] = as[i];
-  obj * new_f = FNN(f)(args);
-  lean_dec_ref(f);
+  obj * new_f = curry(fn, arity, args);
   return lean_apply_n(new_f, n+fixed-arity, &as[arity-fixed]);
 } else \{
   return fix_args(f, n, as);
@@ -173,6 +177,23 @@ static obj* fix_args(obj* f, unsigned n, obj*const* as) {
 static inline obj* fix_args(obj* f, std::initializer_list<obj*> const & l) {
     return fix_args(f, l.size(), l.begin());
 }
+
+/*
+Copy the fixed arguments of `f` to `args` and release `f`. The arguments are moved when `f` is
+not shared. Returns the function pointer of `f`.
+*/
+static void * move_fixed_args(obj* f, obj** args) {
+    void * fn = lean_closure_fun(f);
+    unsigned fixed = lean_closure_num_fixed(f);
+    if (lean_is_exclusive(f)) {
+        for (unsigned i = 0; i < fixed; i++) args[i] = fx(i);
+        lean_free_object(f);
+    } else {
+        for (unsigned i = 0; i < fixed; i++) { lean_inc(fx(i)); args[i] = fx(i); }
+        lean_dec_ref(f);
+    }
+    return fn;
+}
 "
 
 def mkCopyright : M Unit := emit "/*
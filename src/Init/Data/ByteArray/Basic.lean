@@ -9,6 +9,7 @@ prelude
 public import Init.Data.UInt.Basic
 import all Init.Data.UInt.BasicAux
 public import Init.Data.Array.Extract
+public import Init.Data.Ord.Basic
 
 set_option doc.verso true
 
@@ -110,6 +111,14 @@ protected opaque hash (a : @& ByteArray) : UInt64
 instance : Hashable ByteArray where
   hash := ByteArray.hash
 
+/--
+Computes a hash for a {name}`ByteArray` using version 2 of the runtime's hash function (wyhash),
+starting from {name}`seed`. It is faster than {name}`ByteArray.hash` on all but the shortest arrays, but
+unlike the latter it is not used by the {name}`Hashable` instance, and its results should not be persisted.
+-/
+@[extern "lean_byte_array_hash_v2"]
+opaque hashV2 (a : @& ByteArray) (seed : UInt64 := 0) : UInt64
+
 /--
 Returns {name}`true` when {name}`s` contains zero bytes.
 -/
@@ -209,6 +218,68 @@ The variant {name}`findFinIdx?` additionally returns a proof that the found inde
     decreasing_by decreasing_trivial_pre_omega
   loop start
 
+/--
+Finds the index of the first occurrence of {name}`v` in {name}`a` at or after {name}`start`.
+
+This is a native primitive that scans the array in bulk, and it is much faster than
+{name}`findIdx?` with an equality test.
+-/
+@[extern "lean_byte_array_idx_of"]
+def idxOf? (a : @& ByteArray) (v : UInt8) (start : @& Nat := 0) : Option Nat :=
+  a.findIdx? (· == v) start
+
+/--
+Sets the bytes with indices {name}`start` (inclusive) to {name}`stop` (exclusive) to {name}`v`.
+-/
+@[extern "lean_byte_array_fill"]
+def fill (a : ByteArray) (v : UInt8) (start : @& Nat := 0) (stop : @& Nat := a.size) : ByteArray :=
+  ⟨a.data.mapIdx fun i b => if start ≤ i ∧ i < stop then v else b⟩
+
+/--
+Compares two byte arrays lexicographically.
+-/
+@[extern "lean_byte_array_compare"]
+protected def compare (a b : @& ByteArray) : Ordering :=
+  let rec loop (i : Nat) : Ordering :=
+    if h : i < a.size then
+      if h' : i < b.size then
+        if a[i] < b[i] then .lt
+        else if b[i] < a[i] then .gt
+        else loop (i+1)
+      else
+        .gt
+    else if i < b.size then
+      .lt
+    else
+      .eq
+    termination_by a.size - i
+    decreasing_by decreasing_trivial_pre_omega
+  loop 0
+
+instance : Ord ByteArray where
+  compare := ByteArray.compare
+
+/--
+Computes the bitwise exclusive or of two byte arrays. The result has the size of the shorter array.
+-/
+@[extern "lean_byte_array_xor"]
+protected def xor (a : ByteArray) (b : @& ByteArray) : ByteArray :=
+  ⟨a.data.zipWith (· ^^^ ·) b.data⟩
+
+/--
+Computes the bitwise and of two byte arrays. The result has the size of the shorter array.
+-/
+@[extern "lean_byte_array_and"]
+protected def and (a : ByteArray) (b : @& ByteArray) : ByteArray :=
+  ⟨a.data.zipWith (· &&& ·) b.data⟩
+
+/--
+Computes the bitwise or of two byte arrays. The result has the size of the shorter array.
+-/
+@[extern "lean_byte_array_or"]
+protected def or (a : ByteArray) (b : @& ByteArray) : ByteArray :=
+  ⟨a.data.zipWith (· ||| ·) b.data⟩
+
 /--
 An efficient implementation of {name}`ForIn.forIn` for {name}`ByteArray` that uses {name}`USize`
 rather than {name}`Nat` for indices.
@@ -171,6 +171,41 @@ def foldlM {β : Type v} {m : Type v → Type w} [Monad m] (f : β → Float →
 def foldl {β : Type v} (f : β → Float → β) (init : β) (as : FloatArray) (start := 0) (stop := as.size) : β :=
   Id.run <| as.foldlM (pure <| f · ·) init start stop
 
+/-- Sets the elements with indices `start` (inclusive) to `stop` (exclusive) to `v`. -/
+@[extern "lean_float_array_fill"]
+def fill (a : FloatArray) (v : Float) (start : @& Nat := 0) (stop : @& Nat := a.size) : FloatArray :=
+  ⟨a.data.mapIdx fun i d => if start ≤ i ∧ i < stop then v else d⟩
+
+/--
+Sums the elements of `a`.
+
+The native implementation adds the elements in several interleaved partial sums to make use of SIMD
+instructions, so the result may differ from a sequential sum by rounding.
+-/
+@[extern "lean_float_array_sum"]
+def sum (a : @& FloatArray) : Float :=
+  a.foldl (· + ·) 0
+
+/--
+The dot product of `a` and `b`, ignoring the elements of the longer array that have no counterpart.
+As with `sum`, the result may differ from a sequential computation by rounding.
+-/
+@[extern "lean_float_array_dot"]
+def dot (a b : @& FloatArray) : Float :=
+  (a.data.zipWith (· * ·) b.data).foldl (· + ·) 0
+
+/--
+Replaces each element `y[i]` with `alpha * x[i] + y[i]`. Elements of `y` past the end of `x` are kept.
+-/
+@[extern "lean_float_array_axpy"]
+def axpy (alpha : Float) (x : @& FloatArray) (y : FloatArray) : FloatArray :=
+  ⟨y.data.mapIdx fun i d => if h : i < x.size then alpha * x[i] + d else d⟩
+
+/-- Multiplies each element of `a` by `c`. -/
+@[extern "lean_float_array_scale"]
+def scale (a : FloatArray) (c : Float) : FloatArray :=
+  ⟨a.data.map (· * c)⟩
+
 end FloatArray
 
 /--
@@ -2806,6 +2806,18 @@ where
 def substrEq (s1 : String) (pos1 : String.Pos.Raw) (s2 : String) (pos2 : String.Pos.Raw) (sz : Nat) : Bool :=
   Pos.Raw.substrEq s1 pos1 s2 pos2 sz
 
+/--
+Computes a hash for strings using version 2 of the runtime's string hash function (wyhash), starting
+from `seed`.
+
+It is considerably faster than `String.hash` on all but the shortest strings. `String.hash` remains
+the hash function of the `Hashable String` instance, because its results are stored in `.olean` files,
+e.g. as part of `Name`s. Code that does not persist hashes can use this function instead, e.g. through
+a local `Hashable` instance.
+-/
+@[extern "lean_string_hash_v2"]
+opaque hashV2 (s : @& String) (seed : UInt64 := 0) : UInt64
+
 end String
 
 namespace String
@@ -81,6 +81,13 @@ opaque hash (s : @& Slice) : UInt64
 instance : Hashable Slice where
   hash := hash
 
+/--
+Computes a hash for a slice using version 2 of the runtime's string hash function (wyhash), starting
+from {name}`seed`. The result is the same as hashing a copy of the slice with {name}`String.hashV2`.
+-/
+@[extern "lean_slice_hash_v2"]
+opaque hashV2 (s : @& Slice) (seed : UInt64 := 0) : UInt64
+
 instance : LT Slice where
   lt x y := x.copy < y.copy
 
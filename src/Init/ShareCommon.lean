@@ -85,6 +85,28 @@ instance : Inhabited (State σ) := ⟨.mk σ⟩
 @[extern "lean_state_sharecommon"]
 def State.shareCommon {σ : @& StateFactory} (s : State σ) (a : α) : α × State σ := (a, s)
 
+/--
+State of the native max sharing engine. Unlike `State`, it does not call back into Lean maps
+and sets: the set of maximally shared objects is an open addressing table implemented in C++.
+The table is kept across calls to `NativeState.shareCommon`, and it is updated in place when
+the state is not shared.
+-/
+opaque NativeStatePointed : NonemptyType
+abbrev NativeState : Type := NativeStatePointed.type
+instance : Nonempty NativeState := NativeStatePointed.property
+
+/-- Creates an empty native state with room for `capacity` objects before the table is resized. -/
+@[extern "lean_sharecommon_native_mk"]
+opaque NativeState.mk (capacity : USize := 1024) : NativeState
+instance : Inhabited NativeState := ⟨.mk⟩
+
+/-- Returns the number of maximally shared objects stored in `s`. -/
+@[extern "lean_sharecommon_native_size"]
+opaque NativeState.size (s : @& NativeState) : Nat
+
+@[extern "lean_sharecommon_native"]
+def NativeState.shareCommon (s : NativeState) (a : α) : α × NativeState := (a, s)
+
 end ShareCommon
 
 class MonadShareCommon (m : Type u → Type v) where
@@ -107,6 +129,18 @@ instance ShareCommonT.monadShareCommon [Monad m] : MonadShareCommon (ShareCommon
 @[inline] def ShareCommonT.run [Monad m] (x : ShareCommonT σ m α) : m α := x.run' default
 @[inline] def ShareCommonM.run (x : ShareCommonM σ α) : α := ShareCommonT.run x
 
+abbrev NativeShareCommonT (m : Type → Type v) := StateT ShareCommon.NativeState m
+abbrev NativeShareCommonM := NativeShareCommonT Id
+
+@[specialize] def NativeShareCommonT.withShareCommon [Monad m] (a : α) : NativeShareCommonT m α :=
+  modifyGet fun s => s.shareCommon a
+
+instance NativeShareCommonT.monadShareCommon [Monad m] : MonadShareCommon (NativeShareCommonT m) where
+  withShareCommon := NativeShareCommonT.withShareCommon
+
+@[inline] def NativeShareCommonT.run [Monad m] (x : NativeShareCommonT m α) : m α := x.run' default
+@[inline] def NativeShareCommonM.run (x : NativeShareCommonM α) : α := NativeShareCommonT.run x
+
 /--
 A more restrictive but efficient max sharing primitive.
 
@@ -114,3 +148,11 @@ Remark: it optimizes the number of RC operations, and the strategy for caching r
 -/
 @[extern "lean_sharecommon_quick"]
 def ShareCommon.shareCommon' (a : @& α) : α := a
+
+/--
+Parallel version of `ShareCommon.shareCommon'` for large objects. It produces the same result,
+but the objects of each height in the object graph are maximally shared by `numThreads` task
+manager workers. If `numThreads` is `0`, the number of hardware threads is used.
+-/
+@[extern "lean_sharecommon_par"]
+def ShareCommon.shareCommonPar' (a : @& α) (numThreads : @& Nat := 0) : α := a
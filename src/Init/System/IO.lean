@@ -852,6 +852,13 @@ Encountering an EOF does not close a handle. Subsequent reads may block and retu
 -/
 @[extern "lean_io_prim_handle_get_line"] opaque getLine (h : @& Handle) : IO String
 /--
+Reads bytes up to and including the next occurrence of `delim` from the handle. If the returned
+array is empty, an end-of-file marker (EOF) has been reached.
+
+Encountering an EOF does not close a handle. Subsequent reads may block and return more data.
+-/
+@[extern "lean_io_prim_handle_read_until"] opaque readUntil (h : @& Handle) (delim : UInt8) : IO ByteArray
+/--
 Writes the provided string to the file handle using the UTF-8 encoding.
 
 Writing to a handle is typically buffered, and may not immediately modify the file on disk. Use
@@ -1859,6 +1866,17 @@ not used concurrently or which are already persistent.
 @[extern "lean_runtime_mark_persistent"]
 unsafe def Runtime.markPersistent (a : α) : BaseIO α := return a
 
+/--
+Enables or disables deferring reference count decrements of multi-threaded objects. While enabled,
+each thread collects such decrements and applies repeated decrements of the same object with a
+single atomic operation, which reduces contention on objects that are shared by many threads.
+Deferred decrements are applied when the thread's buffer fills up, after each task, when the mode is
+disabled, and when the thread exits, so objects may be freed (and dropped tasks may be cancelled)
+later than otherwise. Increments are not affected.
+-/
+@[extern "lean_runtime_set_deferred_mt_decrements"]
+opaque Runtime.setDeferredMTDecrements (enabled : Bool) : BaseIO Unit
+
 set_option linter.unusedVariables false in
 /--
 Discards the passed owned reference. This leads to `a` any any object reachable from it never being
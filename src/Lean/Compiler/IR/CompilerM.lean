@@ -139,6 +139,21 @@ def findEnvDecl (env : Environment) (declName : Name) (includeServer := false):
 private def findInterpDecl (env : Environment) (declName : Name) : Option Decl :=
   findEnvDecl (includeServer := true) env declName
 
+/--
+Like `findInterpDecl` but only returns imported declarations. Their IR is determined by
+`env.header.moduleData` alone, which lets the interpreter share it between all environments with the same
+imports.
+-/
+@[export lean_ir_find_imported_env_decl]
+private def findImportedInterpDecl (env : Environment) (declName : Name) : Option Decl := do
+  let modIdx ← env.getModuleIdxFor? declName
+  findAtSorted? (declMapExt.getModuleIREntries env modIdx) declName <|>
+  findAtSorted? (declMapExt.getModuleEntries env modIdx) declName
+
+@[export lean_ir_get_imported_module_data]
+private def getImportedModuleData (env : Environment) : Array ModuleData :=
+  env.header.moduleData
+
 namespace ExplicitBoxing
 
 def mkBoxedName (n : Name) : Name :=
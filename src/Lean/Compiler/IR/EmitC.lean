@@ -26,6 +26,8 @@ structure Context where
   jpMap      : JPParamsMap := {}
   mainFn     : FunId := default
   mainParams : Array Param := #[]
+  /-- Whether to emit the C `main` function for a module defining `main`. -/
+  emitMain   : Bool := true
 
 abbrev M := ReaderT Context (EStateM String String)
 
@@ -221,7 +223,7 @@ def hasMainFn : M Bool := do
   return decls.any (fun d => d.name == `main)
 
 def emitMainFnIfNeeded : M Unit := do
-  if (← hasMainFn) then emitMainFn
+  if (← read).emitMain && (← hasMainFn) then emitMainFn
 
 def emitFileHeader : M Unit := do
   let env ← getEnv
@@ -760,9 +762,23 @@ def emitInitFn : M Unit := do
     let fn := mkModuleInitializationFunctionName imp.module pkg?
     emitLn s!"lean_object* {fn}(uint8_t builtin);"
     return fn
+  let decls := (getDecls env).reverse
+  -- Globals initialized by `emitDeclInit`, which may be restored from a startup snapshot instead
+  -- (see `runtime/startup_snapshot.cpp`).
+  let globals := decls.filter fun d => !isIOUnitInitFn env d.name && d.params.size == 0
+  let snapshotArgs ← if globals.isEmpty then
+    pure "NULL, NULL"
+  else do
+    let names ← globals.mapM (toCName ·.name)
+    let sizes := globals.zipWith (fun d n => if d.resultType.isScalar then s!"sizeof({n})" else "0") names
+    emitLns [
+      s!"static void* _G_snapshot_globals[] = \{{", ".intercalate (names.map ("&" ++ ·))}};",
+      s!"static size_t const _G_snapshot_sizes[] = \{{", ".intercalate sizes}};"]
+    pure "_G_snapshot_globals, _G_snapshot_sizes"
+  let modInitFn ← getModInitFn
   emitLns [
     "static bool _G_initialized = false;",
-    s!"LEAN_EXPORT lean_object* {← getModInitFn}(uint8_t builtin) \{",
+    s!"LEAN_EXPORT lean_object* {modInitFn}(uint8_t builtin) \{",
     "lean_object * res;",
     "if (_G_initialized) return lean_io_result_mk_ok(lean_box(0));",
     "_G_initialized = true;"
@@ -771,9 +787,19 @@ def emitInitFn : M Unit := do
     s!"res = {fn}(builtin);",
     "if (lean_io_result_is_error(res)) return res;",
     "lean_dec_ref(res);"]
-  let decls := getDecls env
-  decls.reverse.forM emitDeclInit
-  emitLns ["return lean_io_result_mk_ok(lean_box(0));", "}"]
+  let restore := s!"builtin && lean_startup_snapshot_restore_module(\"{modInitFn}\", {snapshotArgs}, {globals.length})"
+  let inits := decls.filter fun d => isIOUnitInitFn env d.name || d.params.size == 0
+  if inits.isEmpty then
+    emitLn s!"{restore};"
+  else
+    emitLn s!"bool _G_snapshot = {restore};"
+  -- the effects of a restored module's initializers, including on the globals of other modules, are part of the
+  -- snapshot
+  for d in inits do
+    emit "if (!_G_snapshot) {"; emitDeclInit d; emitLn "}"
+  emitLns [
+    s!"if (builtin) lean_startup_snapshot_record_module(\"{modInitFn}\", {snapshotArgs}, {globals.length});",
+    "return lean_io_result_mk_ok(lean_box(0));", "}"]
 
 def main : M Unit := do
   emitFileHeader
@@ -785,8 +811,8 @@ def main : M Unit := do
 
 end EmitC
 
-def emitC (env : Environment) (modName : Name) : Except String String :=
-  match EmitC.main { env, modName } |>.run "" with
+def emitC (env : Environment) (modName : Name) (emitMain := true) : Except String String :=
+  match EmitC.main { env, modName, emitMain } |>.run "" with
   | EStateM.Result.ok    _   s => Except.ok s
   | EStateM.Result.error err _ => Except.error err
 
@@ -533,9 +533,12 @@ def emitExternDeclAux (decl : Decl) (cNameStr : String) : M llvmctx Unit := do
   let extC := isExternC env decl.name
   let _ ← emitFnDeclAux (← getLLVMModule) decl cNameStr extC
 
-def emitFnDecls : M llvmctx Unit := do
+/--
+Declares all functions used by `decls`, which are defined in the current module. Unless `defineGlobals` is false,
+this also defines the globals holding the values of the constants among `decls`.
+-/
+def emitFnDeclsFor (decls : List Decl) (defineGlobals := true) : M llvmctx Unit := do
   let env ← getEnv
-  let decls := getDecls env
   let modDecls  : NameSet := decls.foldl (fun s d => s.insert d.name) {}
   let usedDecls : NameSet := decls.foldl (fun s d => collectUsedDecls env d (s.insert d.name)) {}
   let usedDecls := usedDecls.toList
@@ -543,9 +546,12 @@ def emitFnDecls : M llvmctx Unit := do
     let decl ← getDecl n
     match getExternNameFor env `c decl.name with
     | some cName => emitExternDeclAux decl cName
-    | none       => emitFnDecl decl (!modDecls.contains n)
+    | none       => emitFnDecl decl (!defineGlobals || !modDecls.contains n)
   return ()
 
+def emitFnDecls : M llvmctx Unit := do
+  emitFnDeclsFor (getDecls (← getEnv))
+
 def emitLhsSlot_ (x : VarId) : M llvmctx (LLVM.LLVMType llvmctx × LLVM.Value llvmctx) := do
   let state ← get
   match state.var2val[x]? with
@@ -1633,46 +1639,158 @@ partial def getModuleFunctions (mod : LLVM.Module llvmctx) : IO (Array (LLVM.Val
     else go (← LLVM.getNextFunction v) (acc.push v)
   go (← LLVM.getFirstFunction mod) #[]
 
+/--
+Links the bitcode of the inline functions of `lean.h` into `mod` and gives them internal linkage, then verifies
+the result.
+-/
+def linkLeanH (llvmctx : LLVM.Context) (mod : LLVM.Module llvmctx) : IO Unit := do
+  let membuf ← LLVM.createMemoryBufferWithContentsOfFile (← getLeanHBcPath).toString
+  let modruntime ← LLVM.parseBitcode llvmctx membuf
+  LLVM.disposeMemoryBuffer membuf
+  /- It is important that we extract the names here because
+     pointers into modruntime get invalidated by linkModules -/
+  let runtimeGlobals ← (← getModuleGlobals modruntime).mapM (·.getName)
+  let filter func := do
+    -- | Do not insert internal linkage for
+    -- intrinsics such as `@llvm.umul.with.overflow.i64` which clang generates, and also
+    -- for declarations such as `lean_inc_ref_cold` which are externally defined.
+    if (← LLVM.isDeclaration func) then
+      return none
+    else
+      return some (← func.getName)
+  let runtimeFunctions ← (← getModuleFunctions modruntime).filterMapM filter
+  LLVM.linkModules (dest := mod) (src := modruntime)
+  -- Mark every global and function as having internal linkage.
+  for name in runtimeGlobals do
+    let some global ← LLVM.getNamedGlobal mod name
+       | throw <| IO.Error.userError s!"ERROR: linked module must have global from runtime module: '{name}'"
+    LLVM.setLinkage global LLVM.Linkage.internal
+  for name in runtimeFunctions do
+    let some fn ← LLVM.getNamedFunction mod name
+       | throw <| IO.Error.userError s!"ERROR: linked module must have function from runtime module: '{name}'"
+    LLVM.setLinkage fn LLVM.Linkage.internal
+  if let some err ← LLVM.verifyModule mod then
+    throw <| .userError err
+
+/-- Minimum number of declarations per LLVM module when splitting a module for parallel code generation. -/
+def minDeclsPerPartition := 64
+
+/--
+Emits the definitions of `decls`, a part of the declarations of the current module, into a fresh LLVM context and
+module and writes its bitcode to `filepath`. The first part (`isFirst`) also defines the globals of all constants of
+the module, the module initializer and `main`; the other parts only declare them.
+-/
+def emitLLVMPartition (env : Environment) (modName : Name) (decls : Array Decl) (isFirst : Bool)
+    (filepath : String) : IO Unit := do
+  let llvmctx ← LLVM.createContext
+  try
+    let module ← LLVM.createModule llvmctx modName.toString
+    let emitLLVMCtx : EmitLLVM.Context llvmctx := {env := env, modName := modName, llvmmodule := module}
+    let initState := { var2val := default, jp2bb := default : EmitLLVM.State llvmctx}
+    let emit : EmitLLVM.M llvmctx Unit := do
+      if isFirst then
+        EmitLLVM.emitFnDecls
+      else
+        EmitLLVM.emitFnDeclsFor decls.toList (defineGlobals := false)
+      let builder ← LLVM.createBuilderInContext llvmctx
+      decls.forM (EmitLLVM.emitDecl module builder)
+      if isFirst then
+        EmitLLVM.emitInitFn module builder
+        EmitLLVM.emitMainFnIfNeeded module builder
+    let out? ← (emit.run initState).run emitLLVMCtx
+    match out? with
+    | .ok _ =>
+      LLVM.writeBitcodeToFile module filepath
+      LLVM.disposeModule module
+    | .error err =>
+      LLVM.disposeModule module
+      throw (IO.Error.userError err)
+  finally
+    LLVM.disposeContext llvmctx
+
 /--
 `emitLLVM` is the entrypoint for the lean shell to code generate LLVM.
+
+If `numThreads > 1` and the module is large enough, its declarations are split into up to `numThreads` parts that
+are emitted concurrently, each into its own LLVM context, and then linked into a single module.
 -/
 @[export lean_ir_emit_llvm]
-def emitLLVM (env : Environment) (modName : Name) (filepath : String) : IO Unit := do
+def emitLLVM (env : Environment) (modName : Name) (filepath : String) (numThreads : Nat := 1) : IO Unit := do
+  LLVM.llvmInitializeTargetInfo
+  let decls := (getDecls env).reverse.toArray
+  let numParts := min numThreads (decls.size / minDeclsPerPartition)
+  if numParts ≤ 1 then
+    let llvmctx ← LLVM.createContext
+    let module ← LLVM.createModule llvmctx modName.toString
+    let emitLLVMCtx : EmitLLVM.Context llvmctx := {env := env, modName := modName, llvmmodule := module}
+    let initState := { var2val := default, jp2bb := default : EmitLLVM.State llvmctx}
+    let out? ← ((EmitLLVM.main (llvmctx := llvmctx)).run initState).run emitLLVMCtx
+    match out? with
+    | .ok _ => do
+           linkLeanH llvmctx emitLLVMCtx.llvmmodule
+           LLVM.writeBitcodeToFile emitLLVMCtx.llvmmodule filepath
+           LLVM.disposeModule emitLLVMCtx.llvmmodule
+    | .error err => throw (IO.Error.userError err)
+    return
+  let partSize := (decls.size + numParts - 1) / numParts
+  -- Modules cannot be linked across contexts, so the parts are passed on as bitcode.
+  let partPaths := (List.range numParts).toArray.map fun i => s!"{filepath}.{i}.tmp"
+  let tasks ← partPaths.mapIdxM fun i path =>
+    IO.asTask <| emitLLVMPartition env modName (decls.extract (i * partSize) ((i + 1) * partSize)) (i == 0) path
+  let results ← tasks.mapM IO.wait
+  try
+    for r in results do
+      IO.ofExcept r
+    let llvmctx ← LLVM.createContext
+    try
+      let module ← LLVM.createModule llvmctx modName.toString
+      for path in partPaths do
+        let membuf ← LLVM.createMemoryBufferWithContentsOfFile path
+        let part ← LLVM.parseBitcode llvmctx membuf
+        LLVM.disposeMemoryBuffer membuf
+        -- consumes `part`
+        LLVM.linkModules (dest := module) (src := part)
+      linkLeanH llvmctx module
+      LLVM.writeBitcodeToFile module filepath
+      LLVM.disposeModule module
+    finally
+      LLVM.disposeContext llvmctx
+  finally
+    for path in partPaths do
+      try IO.FS.removeFile path catch _ => pure ()
+
+/-- Whether the interpreter can compile hot functions to native code, i.e. Lean was built with LLVM support. -/
+@[extern "lean_ir_jit_available"]
+opaque jitAvailable : Unit → Bool
+
+/-- The number of functions compiled to native code by the interpreter in this process so far. -/
+@[extern "lean_ir_get_num_jit_compiled"]
+opaque getNumJitCompiled : BaseIO Nat
+
+/--
+Entrypoint for the JIT tier of the interpreter: emits the function declarations `decls` into a fresh LLVM module
+linked with `lean.h`. The functions used by `decls` must either be in `decls` or be available as native code.
+Returns the addresses of the new LLVM context and module, which are owned by the caller.
+-/
+@[export lean_ir_emit_llvm_jit]
+def emitLLVMJit (env : Environment) (decls : Array Decl) : IO (USize × USize) := do
   LLVM.llvmInitializeTargetInfo
   let llvmctx ← LLVM.createContext
-  let module ← LLVM.createModule llvmctx modName.toString
-  let emitLLVMCtx : EmitLLVM.Context llvmctx := {env := env, modName := modName, llvmmodule := module}
-  let initState := { var2val := default, jp2bb := default : EmitLLVM.State llvmctx}
-  let out? ← ((EmitLLVM.main (llvmctx := llvmctx)).run initState).run emitLLVMCtx
-  match out? with
-  | .ok _ => do
-         let membuf ← LLVM.createMemoryBufferWithContentsOfFile (← getLeanHBcPath).toString
-         let modruntime ← LLVM.parseBitcode llvmctx membuf
-         /- It is important that we extract the names here because
-            pointers into modruntime get invalidated by linkModules -/
-         let runtimeGlobals ← (← getModuleGlobals modruntime).mapM (·.getName)
-         let filter func := do
-           -- | Do not insert internal linkage for
-           -- intrinsics such as `@llvm.umul.with.overflow.i64` which clang generates, and also
-           -- for declarations such as `lean_inc_ref_cold` which are externally defined.
-           if (← LLVM.isDeclaration func) then
-             return none
-           else
-             return some (← func.getName)
-         let runtimeFunctions ← (← getModuleFunctions modruntime).filterMapM filter
-         LLVM.linkModules (dest := emitLLVMCtx.llvmmodule) (src := modruntime)
-         -- Mark every global and function as having internal linkage.
-         for name in runtimeGlobals do
-           let some global ← LLVM.getNamedGlobal emitLLVMCtx.llvmmodule name
-              | throw <| IO.Error.userError s!"ERROR: linked module must have global from runtime module: '{name}'"
-           LLVM.setLinkage global LLVM.Linkage.internal
-         for name in runtimeFunctions do
-           let some fn ← LLVM.getNamedFunction emitLLVMCtx.llvmmodule name
-              | throw <| IO.Error.userError s!"ERROR: linked module must have function from runtime module: '{name}'"
-           LLVM.setLinkage fn LLVM.Linkage.internal
-         if let some err ← LLVM.verifyModule emitLLVMCtx.llvmmodule then
-           throw <| .userError err
-         LLVM.writeBitcodeToFile emitLLVMCtx.llvmmodule filepath
-         LLVM.disposeModule emitLLVMCtx.llvmmodule
-  | .error err => throw (IO.Error.userError err)
+  let module ← LLVM.createModule llvmctx "jit"
+  try
+    let emitLLVMCtx : EmitLLVM.Context llvmctx := {env := env, modName := `jit, llvmmodule := module}
+    let initState := { var2val := default, jp2bb := default : EmitLLVM.State llvmctx}
+    let emit : EmitLLVM.M llvmctx Unit := do
+      EmitLLVM.emitFnDeclsFor decls.toList
+      let builder ← LLVM.createBuilderInContext llvmctx
+      decls.forM (EmitLLVM.emitDecl module builder)
+    if let .error err ← (emit.run initState).run emitLLVMCtx then
+      throw (IO.Error.userError err)
+    linkLeanH llvmctx module
+    return (llvmctx.ptr, module.ptr)
+  catch e =>
+    -- the caller only takes ownership on success
+    LLVM.disposeModule module
+    LLVM.disposeContext llvmctx
+    throw e
 end Lean.IR
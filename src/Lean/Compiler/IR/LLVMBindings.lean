@@ -105,6 +105,9 @@ opaque llvmInitializeTargetInfo : BaseIO (Unit)
 @[extern "lean_llvm_create_context"]
 opaque createContext : BaseIO (Context)
 
+@[extern "lean_llvm_dispose_context"]
+opaque disposeContext (ctx : Context) : BaseIO Unit
+
 @[extern "lean_llvm_create_module"]
 opaque createModule (ctx : Context) (name : @&String) : BaseIO (Module ctx)
 
@@ -304,6 +307,10 @@ opaque createMemoryBufferWithContentsOfFile (path : @&String) : BaseIO (MemoryBu
 @[extern "lean_llvm_parse_bitcode"]
 opaque parseBitcode (ctx : Context) (membuf : MemoryBuffer ctx) : BaseIO (Module ctx)
 
+/-- Frees a memory buffer. `parseBitcode` does not take ownership of its buffer, which may be freed afterwards. -/
+@[extern "lean_llvm_dispose_memory_buffer"]
+opaque disposeMemoryBuffer (membuf : MemoryBuffer ctx) : BaseIO Unit
+
 @[extern "lean_llvm_link_modules"]
 opaque linkModules (dest : Module ctx) (src : Module ctx) : BaseIO Unit
 
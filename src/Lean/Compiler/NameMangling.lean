@@ -222,6 +222,15 @@ public def Name.demangle? (s : String) : Option Name :=
   let n := demangle s
   if mangleAux n = s then some n else none
 
+/--
+Returns the name of the declaration compiled to the native symbol `s`, if `s` has been produced by
+`Name.mangle _ "l_"`. Used to symbolize native stack frames in profiles.
+-/
+@[export lean_demangle_symbol]
+public def Name.demangleSymbol? (s : String) : Option Name := do
+  let s ← s.dropPrefix? "l_"
+  Name.demangle? s.toString
+
 -- For correctness of mangle/demangle, see https://gist.github.com/Rob23oba/5ddef42a1743858e9334461ca57c4be8
 
 end Lean
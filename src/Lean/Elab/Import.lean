@@ -9,6 +9,7 @@ prelude
 public import Lean.Parser.Module
 meta import Lean.Parser.Module
 import Lean.Compiler.ModPkgExt
+import Lean.Util.Path
 
 public section
 
@@ -42,6 +43,40 @@ def HeaderSyntax.toModuleHeader (stx : HeaderSyntax) : ModuleHeader where
 
 abbrev headerToImports := @HeaderSyntax.imports
 
+/--
+Identity of the files the modules of `env` were imported from: the size and modification time of
+each .olean and .ir file that may have been read for them. Used by the compile server to notice
+modules rebuilt since it imported them.
+-/
+def importedArtifactsId (env : Environment) (arts : NameMap ImportArtifacts) : IO String := do
+  let mut id := ""
+  for mod in env.header.moduleNames do
+    let fnames ← if let some arts := arts.find? mod then
+      pure arts.toArray
+    else
+      let oleanFile ← findOLean mod
+      pure #[oleanFile, OLeanLevel.server.adjustFileName oleanFile,
+        OLeanLevel.private.adjustFileName oleanFile, oleanFile.withExtension "ir"]
+    for fname in fnames do
+      let md? ← try some <$> fname.metadata catch _ => pure none
+      id := id ++ match md? with
+        | some md => s!"{fname}:{md.byteSize}:{md.modified.sec}.{md.modified.nsec}\n"
+        | none    => s!"{fname}:-\n"
+  return id
+
+/--
+Runs `act`, which imports the environment determined by `key`, in a way that allows the compile server
+(`lean --compile-server`) to keep the environment loaded: in a process serving a request of the
+server, the first request with a given `key` runs `act` and keeps its result loaded in a process
+that later requests with the same `key` are forked from, which skip `act`. Before serving a request,
+that process compares `artifactsId` of the environment with its value right after `act`, and lets the
+request import the environment again if they differ. Outside of the compile server, this simply runs
+`act`.
+-/
+@[extern "lean_compile_server_import"]
+opaque withCompileServerImport (key : @& String) (act : IO Environment)
+    (artifactsId : Environment → IO String) : IO Environment
+
 def processHeaderCore
     (startPos : String.Pos.Raw) (imports : Array Import) (isModule : Bool)
     (opts : Options) (messages : MessageLog) (inputCtx : Parser.InputContext)
@@ -56,10 +91,14 @@ def processHeaderCore
       .exported
   else
     .private
+  -- everything the imported environment depends on, including where the modules are found
+  let key := s!"{repr imports}\n{repr level}\n{trustLevel}\n{repr plugins}\n{opts}\n{leakEnv}\n" ++
+    s!"{repr (← searchPathRef.get)}\n{repr arts}"
   let (env, messages) ← try
-    let env ←
-      importModules (leakEnv := leakEnv) (loadExts := true) (level := level)
-        imports opts trustLevel plugins arts
+    let env ← withCompileServerImport key
+      (importModules (leakEnv := leakEnv) (loadExts := true) (level := level)
+        imports opts trustLevel plugins arts)
+      (importedArtifactsId · arts)
     pure (env, messages)
   catch e =>
     let env ← mkEmptyEnvironment
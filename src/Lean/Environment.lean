@@ -1736,11 +1736,23 @@ def readModuleData (fname : @& System.FilePath) : IO (ModuleData × CompactedReg
   let some part := parts[0]? | unreachable!
   return part
 
+/--
+  Drop the interpreter's caches for imports with the given module data, which may reference objects in their compacted
+  regions. -/
+@[extern "lean_ir_free_imported_caches"]
+private opaque freeInterpreterCaches (moduleData : @& Array ModuleData) : IO Unit
+
+/--
+  Returns the number of the interpreter's caches for imports, which are shared by all environments with the same module
+  data until freed by `Environment.freeRegions`. Used for testing. -/
+@[extern "lean_ir_get_num_imported_caches"]
+opaque getNumInterpreterCaches : BaseIO Nat
+
 /--
   Free compacted regions of imports. No live references to imported objects may exist at the time of invocation; in
   particular, `env` should be the last reference to any `Environment` derived from these imports. -/
 @[noinline, export lean_environment_free_regions]
-unsafe def Environment.freeRegions (env : Environment) : IO Unit :=
+unsafe def Environment.freeRegions (env : Environment) : IO Unit := do
   /-
     NOTE: This assumes `env` is not inferred as a borrowed parameter, and is freed after extracting the `header` field.
     Otherwise, we would encounter undefined behavior when the constant map in `env`, which may reference objects in
@@ -1756,6 +1768,7 @@ unsafe def Environment.freeRegions (env : Environment) : IO Unit :=
     ```
 
     TODO: statically check for this. -/
+  freeInterpreterCaches env.header.moduleData
   env.header.regions.forM CompactedRegion.free
 
 def OLeanLevel.adjustFileName (base : System.FilePath) : OLeanLevel → System.FilePath
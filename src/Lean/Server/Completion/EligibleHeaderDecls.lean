@@ -24,9 +24,13 @@ structure EligibleDecl where
 
 abbrev EligibleHeaderDecls := Std.HashMap Name EligibleDecl
 
-/-- Cached header declarations for which `allowCompletion headerEnv decl` is true. -/
-builtin_initialize eligibleHeaderDeclsMutex : Std.Mutex (Option EligibleHeaderDecls) ←
-  Std.Mutex.new none
+/--
+Cached header declarations for which `allowCompletion headerEnv decl` is true.
+
+This is a plain `IO.Ref` rather than a `Std.Mutex` as mutexes cannot be part of a startup snapshot (see
+`runtime/startup_snapshot.cpp`).
+-/
+builtin_initialize eligibleHeaderDeclsRef : IO.Ref (Option EligibleHeaderDecls) ← IO.mkRef none
 
 def getCompletionKindForDecl (constInfo : ConstantInfo)
     : MetaM Lsp.CompletionItemKind := do
@@ -63,24 +67,23 @@ Returns the declarations in the header for which `allowCompletion env decl` is t
 if not already cached.
 -/
 def getEligibleHeaderDecls (env : Environment) : MetaM EligibleHeaderDecls := do
-  eligibleHeaderDeclsMutex.atomically do
-    match ← get with
-    | some eligibleHeaderDecls =>
-      return eligibleHeaderDecls
-    | none =>
-      let mut eligibleHeaderDecls : EligibleHeaderDecls := {}
-      -- map₁ are the header decls
-      for (declName, c) in env.constants.map₁ do
-        if allowCompletion env declName then
-          let kind ← getCompletionKindForDecl c
-          let tags ← getCompletionTagsForDecl declName
-          eligibleHeaderDecls := eligibleHeaderDecls.insert declName {
-            info := c
-            kind := pure kind
-            tags := pure tags
-          }
-      set <| some eligibleHeaderDecls
-      return eligibleHeaderDecls
+  if let some eligibleHeaderDecls ← eligibleHeaderDeclsRef.get then
+    return eligibleHeaderDecls
+  let mut eligibleHeaderDecls : EligibleHeaderDecls := {}
+  -- map₁ are the header decls
+  for (declName, c) in env.constants.map₁ do
+    if allowCompletion env declName then
+      let kind ← getCompletionKindForDecl c
+      let tags ← getCompletionTagsForDecl declName
+      eligibleHeaderDecls := eligibleHeaderDecls.insert declName {
+        info := c
+        kind := pure kind
+        tags := pure tags
+      }
+  -- concurrent requests may compute the declarations at the same time; all of them return the first result
+  eligibleHeaderDeclsRef.modifyGet fun
+    | some cached => (cached, some cached)
+    | none        => (eligibleHeaderDecls, some eligibleHeaderDecls)
 
 /-- Iterate over all declarations that are allowed in completion results. -/
 def forEligibleDeclsM [Monad m] [MonadEnv m] [MonadLiftT MetaM m]
@@ -11,6 +11,8 @@ import Lean.Elab.ParseImportsFast
 import Lean.Server.Watchdog
 import Lean.Server.FileWorker
 import Lean.Compiler.IR.EmitC
+import Lean.Compiler.FFI
+import Lean.LoadDynlib
 
 /-  Lean companion to  `shell.cpp` -/
 
@@ -33,6 +35,13 @@ opaque decodeLossyUTF8 (a : @& ByteArray) : String
 @[extern "lean_run_main"]
 opaque runMain (env : @& Environment) (opts : @& Options) (args : @& List String) : BaseIO UInt32
 
+/--
+Forgets which declarations the interpreter found no native code for, so that it picks up native code from libraries
+loaded afterwards.
+-/
+@[extern "lean_ir_clear_native_symbol_cache"]
+opaque clearNativeSymbolCache : BaseIO Unit
+
 /--
 Initializes the LLVM subsystem.
 If Lean lacks LLVM support, this function will fail with an assertion violation.
@@ -124,6 +133,7 @@ def displayHelp (useStderr : Bool) : IO Unit := do
   out.putStrLn    "  -V, --short-version    display short version number"
   out.putStrLn    "  -g, --githash          display the git commit hash number used to build this binary"
   out.putStrLn    "      --run <file>       call the 'main' definition in the given file with the remaining arguments"
+  out.putStrLn    "                         (set LEAN_RUN_CACHE_DIR to cache native code for the file there)"
   out.putStrLn    "  -o, --o=oname          create olean file"
   out.putStrLn    "  -i, --i=iname          create ilean file"
   out.putStrLn    "  -c, --c=fname          name of the C output file"
@@ -144,6 +154,8 @@ def displayHelp (useStderr : Bool) : IO Unit := do
     out.putStrLn  "  -s, --tstack=num       thread stack size in Kb"
     out.putStrLn  "      --server           start lean in server mode"
     out.putStrLn  "      --worker           start lean in server-worker mode"
+  out.putStrLn    "      --compile-server=socket  serve requests to run lean on the Unix domain socket, keeping"
+  out.putStrLn    "                         imported environments loaded (set LEAN_COMPILE_SERVER=socket to use it)"
   out.putStrLn    "      --plugin=file      load and initialize Lean shared library for registering linters etc."
   out.putStrLn    "      --load-dynlib=file load shared library to make its symbols available to the interpreter"
   out.putStrLn    "      --setup=file       JSON file with module setup data (supersedes the file's header)"
@@ -154,6 +166,12 @@ def displayHelp (useStderr : Bool) : IO Unit := do
   out.putStrLn    "      --print-prefix     print the installation prefix for Lean and exit"
   out.putStrLn    "      --print-libdir     print the installation directory for Lean's built-in libraries and exit"
   out.putStrLn    "      --profile          display elaboration/type checking time for each definition/theorem"
+  out.putStrLn    "      --sample-profile=file  periodically sample the call stacks of native and interpreted code"
+  out.putStrLn    "                         and write them to file in the collapsed stack format (for flame graphs)"
+  out.putStrLn    "      --chrome-trace=file  write a timeline of profiled steps, task executions and blocking"
+  out.putStrLn    "                         `Task.get`s of all threads to file in the Chrome trace event format"
+  out.putStrLn    "      --alloc-profile=file  sample allocations and write the bytes allocated and retained per"
+  out.putStrLn    "                         declaration and profiled step to file on exit"
   out.putStrLn    "      --stats            display environment statistics"
   if Internal.isDebug () then
     out.putStrLn  "      --debug=tag        enable assertions with the given tag"
@@ -170,6 +188,84 @@ private builtin_initialize maxMemory : Lean.Option Nat ←
 private builtin_initialize timeout : Lean.Option Nat ←
   Lean.Option.register `timeout {defValue := Internal.getDefaultMaxHeartbeat ()}
 
+private def sharedLibExt : String :=
+  if System.Platform.isWindows then "dll"
+  else if System.Platform.isOSX then "dylib"
+  else "so"
+
+/--
+Compiles the IR of module `modName` in `env` through the C backend into a shared library in `cacheDir`, unless a
+library for the same code and Lean version is already there. Returns the path of the library.
+-/
+private def buildRunCache (env : Environment) (modName : Name) (cacheDir : FilePath) : IO FilePath := do
+  -- The C `main` function would refer to runtime functions that need not be exported by `lean`.
+  let c ← IO.ofExcept <| IR.emitC env modName (emitMain := false)
+  let key := mixHash (hash c) (hash (versionString ++ githash))
+  let stem := toString key
+  let lib := cacheDir / s!"{stem}.{sharedLibExt}"
+  if (← lib.pathExists) then
+    return lib
+  IO.FS.createDirAll cacheDir
+  -- Concurrent runs of the same script write to separate files and atomically rename the result.
+  let pid ← IO.Process.getPID
+  let src := cacheDir / s!"{stem}.{pid}.c"
+  let tmp := cacheDir / s!"{stem}.{pid}.{sharedLibExt}.tmp"
+  IO.FS.writeFile src c
+  try
+    let sysroot ← getBuildDir
+    let bundledCc := sysroot / "bin" / "clang" |>.addExtension FilePath.exeExtension
+    let (cc, ccFlags) ← match (← IO.getEnv "LEAN_CC") with
+      | some cc => pure (cc, #[])
+      | none =>
+        if (← bundledCc.pathExists) then
+          pure (bundledCc.toString,
+            Compiler.FFI.getInternalCFlags sysroot ++ Compiler.FFI.getInternalLinkerFlags sysroot)
+        else
+          pure ("cc", #[])
+    -- Leave references to the runtime and imported modules to be resolved against the running `lean`, but resolve
+    -- them all when loading the library so that a script importing modules without native code fails to load instead
+    -- of failing when calling into them.
+    let linkFlags :=
+      if System.Platform.isOSX then #["-Wl,-undefined,dynamic_lookup", "-Wl,-bind_at_load"] else #["-Wl,-z,now"]
+    let out ← IO.Process.output {
+      cmd := cc
+      args := #[src.toString, "-o", tmp.toString, "-shared", "-fPIC", "-O3", "-DNDEBUG"] ++
+        Compiler.FFI.getCFlags sysroot ++ ccFlags ++ linkFlags
+    }
+    if out.exitCode != 0 then
+      throw <| IO.userError s!"'{cc}' failed with exit code {out.exitCode}:\n{out.stderr}"
+    IO.FS.rename tmp lib
+    return lib
+  finally
+    -- also when the compiler is missing or fails, which may leave a partial library behind
+    try IO.FS.removeFile src catch _ => pure ()
+    try IO.FS.removeFile tmp catch _ => pure ()
+
+/--
+Loads native code for the script `env` from the cache in `cacheDir`, building it first if necessary, so that the
+interpreter running the script's `main` calls into it. If the code cannot be built or loaded, the script is
+interpreted as usual; errors from running its module initializer are thrown as they leave the native code in an
+unusable state.
+-/
+private def loadRunCache (env : Environment) (modName : Name) (cacheDir : FilePath) : IO Unit := do
+  -- Would need import libraries for the Lean runtime.
+  if System.Platform.isWindows then
+    return
+  let dynlib ← match (← (do Dynlib.load (← buildRunCache env modName cacheDir)).toBaseIO) with
+    | .ok dynlib => pure dynlib
+    | .error e =>
+      IO.eprintln s!"warning: not using native code cache for '{modName}': {e}"
+      return
+  -- Lean never unloads libraries.
+  -- Safety: There are no concurrent accesses to `dynlib` at this point.
+  let _ ← unsafe Runtime.markPersistent dynlib
+  let initFn := mkModuleInitializationFunctionName modName env.getModulePackage?
+  let some sym := dynlib.get? initFn
+    | throw <| IO.userError s!"initializer '{initFn}' not found in native code cache for '{modName}'"
+  -- Safety: `sym` is the initializer of a module compiled by the C backend.
+  unsafe sym.runAsInit
+  clearNativeSymbolCache
+
 @[export lean_shell_main]
 def shellMain
     (args : List String)
@@ -280,6 +376,9 @@ def shellMain
       oleanFileName? ileanFileName? jsonOutput errorOnKinds #[] printStats setup?
   if let some env := env? then
     if run then
+      if let some cacheDir ← IO.getEnv "LEAN_RUN_CACHE_DIR" then
+        if !cacheDir.isEmpty then
+          loadRunCache env mainModuleName cacheDir
       return ← runMain env opts args
     if let some c := cFileName? then
       let .ok out ← IO.FS.Handle.mk c .write |>.toBaseIO
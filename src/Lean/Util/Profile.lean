@@ -49,4 +49,11 @@ def profileitIO {ε α : Type} (category : String) (opts : Options) (act : EIO 
 def profileitM {m : Type → Type} (ε : Type) [MonadFunctorT (EIO ε) m] {α : Type} (category : String) (opts : Options) (act : m α) (decl := Name.anonymous) : m α :=
   monadMap (fun {β} => profileitIO (ε := ε) (α := β) (decl := decl) category opts) act
 
+/--
+Writes the current report of the allocation profiler enabled by `lean --alloc-profile=file` to its file, including
+the bytes retained at this point. Does nothing if the profiler is not running.
+-/
+@[extern "lean_write_alloc_profile"]
+opaque writeAllocProfile : BaseIO Unit
+
 end Lean
@@ -47,6 +47,36 @@ def getAddrInfo (host : String) (service : String) (addrFamily : Option AddressF
     | some .ipv4 => 1
     | some .ipv6 => 2)
 
+/--
+Asynchronously resolves many hostnames for the same service at once. The results are in the same
+order as `hosts`, a failed lookup does not affect the others.
+-/
+@[inline]
+def getAddrInfoBatch (hosts : Array String) (service : String) (addrFamily : Option AddressFamily := none) :
+    Async (Array (Except IO.Error (Array IPAddr))) := do
+  Async.ofPurePromise <| UV.DNS.getAddrInfoBatch
+    hosts
+    service
+    (match addrFamily with
+    | none => 0
+    | some .ipv4 => 1
+    | some .ipv6 => 2)
+
+/--
+Sets how long successful lookups (`positive`) and lookups of names that do not exist (`negative`)
+are cached. A duration of 0 disables caching of the respective results.
+-/
+@[inline]
+def setCacheTTL (positive negative : Std.Time.Millisecond.Offset) : IO Unit :=
+  UV.DNS.setCacheTTL positive.toInt.toNat.toUInt64 negative.toInt.toNat.toUInt64
+
+/--
+Drops all cached lookup results.
+-/
+@[inline]
+def flushCache : IO Unit :=
+  UV.DNS.flushCache
+
 /--
 Performs a reverse DNS lookup on a `SocketAddress`.
 -/
@@ -8,12 +8,15 @@ module
 prelude
 public import Std.Time
 public import Std.Internal.UV.System
+public import Std.Internal.UV.Process
+public import Std.Internal.Async.Basic
 public import Std.Data.HashMap
 
 public section
 
 open Std Time
 open System
+open Std.Internal.IO.Async
 
 namespace Std
 namespace Internal
@@ -236,6 +239,78 @@ Returns the available memory for allocation in bytes.
 def availableMemory : IO UInt64 :=
   UV.System.availableMemory
 
+/--
+A child process running on the event loop. Unlike `IO.Process.Child`, waiting for it to exit and
+reading its output does not block a thread.
+-/
+structure Child where
+  private ofNative ::
+    native : Internal.UV.Process.Child
+
+/--
+Spawns a new child process. See `IO.Process.SpawnArgs` for the available options.
+-/
+@[inline]
+def spawn (args : IO.Process.SpawnArgs) : IO Child := do
+  let native ← Internal.UV.Process.spawn args
+  return Child.ofNative native
+
+namespace Child
+
+/--
+Returns the process id of the child.
+-/
+@[inline]
+def pid (c : Child) : PId :=
+  ⟨c.native.pid.toUInt64⟩
+
+/--
+Waits for the child to exit and returns its exit code. If the child was terminated by a signal, the
+exit code is `128` plus the signal number.
+-/
+@[inline]
+def wait (c : Child) : Async UInt32 :=
+  Async.ofPurePromise c.native.wait
+
+/--
+Sends the signal `signum` to the child, `SIGTERM` by default.
+-/
+@[inline]
+def kill (c : Child) (signum : Int32 := 15) : IO Unit :=
+  c.native.kill signum
+
+/--
+Writes data to the stdin of the child, which must be `.piped`.
+-/
+@[inline]
+def send (c : Child) (data : ByteArray) : Async Unit :=
+  Async.ofPromise <| c.native.send #[data]
+
+/--
+Closes the stdin of the child once all pending writes have completed.
+-/
+@[inline]
+def closeStdin (c : Child) : Async Unit :=
+  Async.ofPromise <| c.native.shutdownStdin
+
+/--
+Receives at most `size` bytes from the stdout of the child, which must be `.piped`. If EOF is
+reached, the result is `.none`.
+-/
+@[inline]
+def recvStdout? (c : Child) (size : UInt64) : Async (Option ByteArray) :=
+  Async.ofPromise <| c.native.recv? 1 size
+
+/--
+Receives at most `size` bytes from the stderr of the child, which must be `.piped`. If EOF is
+reached, the result is `.none`.
+-/
+@[inline]
+def recvStderr? (c : Child) (size : UInt64) : Async (Option ByteArray) :=
+  Async.ofPromise <| c.native.recv? 2 size
+
+end Child
+
 end Process
 end IO
 end Internal
@@ -14,3 +14,4 @@ public import Std.Internal.UV.UDP
 public import Std.Internal.UV.System
 public import Std.Internal.UV.DNS
 public import Std.Internal.UV.Signal
+public import Std.Internal.UV.Process
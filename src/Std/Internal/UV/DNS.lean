@@ -26,6 +26,28 @@ Asynchronously resolves a hostname and service to an array of socket addresses.
 opaque getAddrInfo (host : @& String) (service : @& String) (family : UInt8) :
     IO (IO.Promise (Except IO.Error (Array IPAddr)))
 
+/--
+Asynchronously resolves many hostnames for the same service at once. The results are in the same
+order as `hosts`, a failed lookup does not affect the others.
+-/
+@[extern "lean_uv_dns_get_info_batch"]
+opaque getAddrInfoBatch (hosts : @& Array String) (service : @& String) (family : UInt8) :
+    IO (IO.Promise (Array (Except IO.Error (Array IPAddr))))
+
+/--
+Sets for how many milliseconds successful lookups (`positive`) and lookups of names that do not
+exist (`negative`) are cached. A time to live of 0 disables caching of the respective results.
+The defaults are 30 seconds and 10 seconds.
+-/
+@[extern "lean_uv_dns_set_cache_ttl"]
+opaque setCacheTTL (positive : UInt64) (negative : UInt64) : IO Unit
+
+/--
+Drops all cached lookup results.
+-/
+@[extern "lean_uv_dns_flush_cache"]
+opaque flushCache : IO Unit
+
 /--
 Performs a reverse DNS lookup on a `SocketAddress`.
 -/
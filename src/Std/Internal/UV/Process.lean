@@ -0,0 +1,97 @@
+/-
+Copyright (c) 2025 Lean FRO, LLC. All rights reserved.
+Released under Apache 2.0 license as described in the file LICENSE.
+-/
+module
+
+prelude
+public import Init.System.Promise
+public import Init.System.IO
+public import Init.Data.SInt
+
+public section
+
+namespace Std
+namespace Internal
+namespace UV
+namespace Process
+
+private opaque ChildImpl : NonemptyType.{0}
+
+/--
+Represents a child process that was spawned on the event loop. Waiting for the child to exit and
+reading from or writing to its standard streams does not block any thread.
+-/
+def Child : Type := ChildImpl.type
+
+instance : Nonempty Child := by exact ChildImpl.property
+
+/--
+Spawns a new child process on the event loop. The standard streams of the child are set up according
+to `args`: `.piped` streams can be used through `Child.send`, `Child.recv?` and
+`Child.shutdownStdin`, `.inherit` streams are shared with the current process and `.null` streams
+are redirected to the null device.
+-/
+@[extern "lean_uv_process_spawn"]
+opaque spawn (args : @& IO.Process.SpawnArgs) : IO Child
+
+namespace Child
+
+/--
+Returns an `IO.Promise` that resolves with the exit code of the child once it exits. If the child was
+terminated by a signal, the exit code is `128` plus the signal number. Calling this function multiple
+times returns the same `IO.Promise`.
+-/
+@[extern "lean_uv_process_wait"]
+opaque wait (child : @& Child) : IO (IO.Promise UInt32)
+
+/--
+Returns the process id of the child.
+-/
+@[extern "lean_uv_process_pid"]
+opaque pid (child : @& Child) : UInt32
+
+/--
+Sends the signal `signum` to the child.
+-/
+@[extern "lean_uv_process_kill"]
+opaque kill (child : @& Child) (signum : Int32) : IO Unit
+
+/--
+Writes data to the stdin of the child. Fails if stdin is not `.piped`.
+-/
+@[extern "lean_uv_process_send"]
+opaque send (child : @& Child) (data : Array ByteArray) : IO (IO.Promise (Except IO.Error Unit))
+
+/--
+Closes the stdin of the child after all pending writes have completed, signalling an EOF to the
+child. Fails if stdin is not `.piped`.
+-/
+@[extern "lean_uv_process_shutdown_stdin"]
+opaque shutdownStdin (child : @& Child) : IO (IO.Promise (Except IO.Error Unit))
+
+/--
+Receives data from stdout (`stream = 1`) or stderr (`stream = 2`) of the child with a maximum size
+of `size` bytes. The promise resolves when data is available or an error occurs. If data is
+received, it's wrapped in `.some`. If EOF is reached, the result is `.none`, indicating no more data
+is available. Receiving data in parallel on the same stream is not supported. Fails if the stream
+is not `.piped`.
+-/
+@[extern "lean_uv_process_recv"]
+opaque recv? (child : @& Child) (stream : UInt8) (size : UInt64) :
+    IO (IO.Promise (Except IO.Error (Option ByteArray)))
+
+/--
+Cancels a receive from stdout (`stream = 1`) or stderr (`stream = 2`) of the child. The last promise
+returned by `recv?` on that stream is dropped and never resolved. If there is no receive in progress,
+this is a no-op.
+-/
+@[extern "lean_uv_process_cancel_recv"]
+opaque cancelRecv (child : @& Child) (stream : UInt8) : IO Unit
+
+end Child
+
+end Process
+end UV
+end Internal
+end Std
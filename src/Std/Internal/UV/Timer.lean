@@ -92,6 +92,15 @@ This function has different behavior depending on the state of the `Timer`:
 @[extern "lean_uv_timer_cancel"]
 opaque cancel (timer : @& Timer) : IO Unit
 
+/--
+Sets the tick resolution in milliseconds of the timer wheel that drives all `Timer`s of the event
+loop. Deadlines are rounded up to whole ticks, so a coarser resolution lets more timers expire
+together at the cost of precision. The default resolution is 1 millisecond. Running timers keep
+their deadlines. Throws an error if `resolution` is 0.
+-/
+@[extern "lean_uv_timer_set_resolution"]
+opaque setResolution (resolution : UInt64) : IO Unit
+
 end Timer
 
 end UV
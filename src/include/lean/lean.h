@@ -562,6 +562,10 @@ static inline bool lean_is_shared(lean_object * o) {
 
 LEAN_EXPORT void lean_mark_mt(lean_object * o);
 LEAN_EXPORT void lean_mark_persistent(lean_object * o);
+/* Enable or disable deferring the decrements of multi-threaded objects, see `lean_dec_ref_cold`. */
+LEAN_EXPORT void lean_set_deferred_mt_dec(bool enabled);
+/* Apply the decrements deferred by the current thread. */
+LEAN_EXPORT void lean_flush_deferred_decs(void);
 
 static inline void lean_set_st_header(lean_object * o, unsigned tag, unsigned other) {
     o->m_rc       = 1;
@@ -969,6 +973,13 @@ LEAN_EXPORT lean_obj_res lean_byte_array_mk(lean_obj_arg a);
 LEAN_EXPORT lean_obj_res lean_byte_array_data(lean_obj_arg a);
 LEAN_EXPORT lean_obj_res lean_copy_byte_array(lean_obj_arg a);
 LEAN_EXPORT uint64_t lean_byte_array_hash(b_lean_obj_arg a);
+LEAN_EXPORT uint64_t lean_byte_array_hash_v2(b_lean_obj_arg a, uint64_t seed);
+LEAN_EXPORT lean_obj_res lean_byte_array_fill(lean_obj_arg a, uint8_t v, b_lean_obj_arg start, b_lean_obj_arg stop);
+LEAN_EXPORT lean_obj_res lean_byte_array_idx_of(b_lean_obj_arg a, uint8_t v, b_lean_obj_arg start);
+LEAN_EXPORT uint8_t lean_byte_array_compare(b_lean_obj_arg a, b_lean_obj_arg b);
+LEAN_EXPORT lean_obj_res lean_byte_array_xor(lean_obj_arg a, b_lean_obj_arg b);
+LEAN_EXPORT lean_obj_res lean_byte_array_and(lean_obj_arg a, b_lean_obj_arg b);
+LEAN_EXPORT lean_obj_res lean_byte_array_or(lean_obj_arg a, b_lean_obj_arg b);
 
 static inline lean_obj_res lean_mk_empty_byte_array(b_lean_obj_arg capacity) {
     if (!lean_is_scalar(capacity)) lean_internal_panic_out_of_memory();
@@ -1028,6 +1039,11 @@ static inline lean_obj_res lean_byte_array_fset(lean_obj_arg a, b_lean_obj_arg i
 LEAN_EXPORT lean_obj_res lean_float_array_mk(lean_obj_arg a);
 LEAN_EXPORT lean_obj_res lean_float_array_data(lean_obj_arg a);
 LEAN_EXPORT lean_obj_res lean_copy_float_array(lean_obj_arg a);
+LEAN_EXPORT lean_obj_res lean_float_array_fill(lean_obj_arg a, double v, b_lean_obj_arg start, b_lean_obj_arg stop);
+LEAN_EXPORT double lean_float_array_sum(b_lean_obj_arg a);
+LEAN_EXPORT double lean_float_array_dot(b_lean_obj_arg a, b_lean_obj_arg b);
+LEAN_EXPORT lean_obj_res lean_float_array_axpy(double alpha, b_lean_obj_arg x, lean_obj_arg y);
+LEAN_EXPORT lean_obj_res lean_float_array_scale(lean_obj_arg a, double c);
 
 static inline lean_obj_res lean_mk_empty_float_array(b_lean_obj_arg capacity) {
     if (!lean_is_scalar(capacity)) lean_internal_panic_out_of_memory();
@@ -1162,9 +1178,11 @@ LEAN_EXPORT bool lean_string_lt(b_lean_obj_arg s1, b_lean_obj_arg s2);
 static inline uint8_t lean_string_dec_eq(b_lean_obj_arg s1, b_lean_obj_arg s2) { return lean_string_eq(s1, s2); }
 static inline uint8_t lean_string_dec_lt(b_lean_obj_arg s1, b_lean_obj_arg s2) { return lean_string_lt(s1, s2); }
 LEAN_EXPORT uint64_t lean_string_hash(b_lean_obj_arg);
+LEAN_EXPORT uint64_t lean_string_hash_v2(b_lean_obj_arg, uint64_t seed);
 LEAN_EXPORT lean_obj_res lean_string_of_usize(size_t);
 LEAN_EXPORT uint8_t lean_string_memcmp(b_lean_obj_arg s1, b_lean_obj_arg s2, b_lean_obj_arg lstart, b_lean_obj_arg rstart, b_lean_obj_arg len);
 LEAN_EXPORT uint64_t lean_slice_hash(b_lean_obj_arg);
+LEAN_EXPORT uint64_t lean_slice_hash_v2(b_lean_obj_arg, uint64_t seed);
 LEAN_EXPORT uint8_t lean_slice_dec_lt(b_lean_obj_arg s1, b_lean_obj_arg s2);
 
 /* Thunks */
@@ -2859,6 +2877,23 @@ static inline lean_obj_res lean_io_result_take_value(lean_obj_arg r) {
 
 LEAN_EXPORT void lean_io_result_show_error(b_lean_obj_arg r);
 LEAN_EXPORT void lean_io_mark_end_initialization(void);
+
+/* Startup snapshots (see `runtime/startup_snapshot.cpp`). `lean_startup_snapshot_start` restores the globals of the
+   modules initialized with `builtin` set until `lean_startup_snapshot_finish` from the snapshot file `fname` if it
+   exists and was taken by this binary; otherwise they are recorded and `lean_startup_snapshot_finish` writes them
+   to `fname`. Both do nothing on platforms without support for snapshots.
+
+   Used by module initializers emitted by the C backend: `globals[i]` is the address of the i-th global of the module,
+   holding an object if `sizes[i] == 0` and a scalar of `sizes[i]` bytes otherwise.
+   `lean_startup_snapshot_restore_module` restores all globals of the module `mod` from the snapshot being loaded, if
+   any, and returns whether it did so, in which case the module's initializers must not be run.
+   `lean_startup_snapshot_record_module` adds the globals to the snapshot being taken, if any. */
+LEAN_EXPORT void lean_startup_snapshot_start(char const * fname);
+LEAN_EXPORT void lean_startup_snapshot_finish(void);
+LEAN_EXPORT bool lean_startup_snapshot_restore_module(char const * mod, void ** globals, size_t const * sizes,
+                                                      size_t num_globals);
+LEAN_EXPORT void lean_startup_snapshot_record_module(char const * mod, void ** globals, size_t const * sizes,
+                                                     size_t num_globals);
 static inline lean_obj_res lean_io_result_mk_ok(lean_obj_arg a) {
     lean_object * r = lean_alloc_ctor(0, 1, 0);
     lean_ctor_set(r, 0, a);
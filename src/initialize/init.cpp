@@ -27,6 +27,11 @@ extern "C" LEAN_EXPORT void lean_initialize() {
     save_stack_info();
     initialize_util_module();
     uint8_t builtin = 1;
+    // Opt-in cache of the state of the core libs after initialization, see `runtime/startup_snapshot.cpp`
+    char const * snapshot = std::getenv("LEAN_STARTUP_SNAPSHOT");
+    if (snapshot && *snapshot) {
+        lean_startup_snapshot_start(snapshot);
+    }
     // Initializing the core libs explicitly is necessary because of references to them other than
     // via `import`, such as:
     // * calling exported Lean functions from C++
@@ -35,6 +40,9 @@ extern "C" LEAN_EXPORT void lean_initialize() {
     consume_io_result(initialize_Init(builtin));
     consume_io_result(initialize_Std(builtin));
     consume_io_result(initialize_Lean(builtin));
+    if (snapshot && *snapshot) {
+        lean_startup_snapshot_finish();
+    }
     initialize_kernel_module();
     init_default_print_fn();
     initialize_library_core_module();
@@ -0,0 +1,267 @@
+/*
+Copyright (c) 2025 Lean FRO, LLC. All rights reserved.
+Released under Apache 2.0 license as described in the file LICENSE.
+
+Sampling allocation profiler.
+
+The small allocator reports one in `rate` allocations on average (see `g_lean_alloc_sample_rate`), which we attribute
+to the site of the allocating thread: the category and declaration of its innermost `time_task`. Sampled objects are
+kept in a table until they are freed, at which point we read their tag and add their size to the bytes allocated at
+their site; objects still in the table when writing a report are counted as both allocated and retained. Each sample
+stands for `rate` allocations, so its size is scaled by `rate` in the report.
+
+The table is sharded by address as it is consulted by every free of an object in a page with a sampled object.
+*/
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include "runtime/sstream.h"
+#include "runtime/thread.h"
+#include "runtime/exception.h"
+#include "runtime/alloc.h"
+#include "library/alloc_profiler.h"
+
+namespace lean {
+std::atomic<bool> g_alloc_profiler_active(false);
+
+static constexpr unsigned g_num_shards = 64;
+
+struct alloc_site {
+    std::string m_category;
+    std::string m_decl;
+};
+
+struct alloc_sample {
+    unsigned m_site;
+    size_t   m_size;
+};
+
+struct sample_shard {
+    mutex m_mutex;
+    std::unordered_map<void *, alloc_sample> m_live;
+    // sampled bytes freed so far, by site and object tag
+    std::map<std::pair<unsigned, uint8>, uint64_t> m_freed;
+};
+
+struct alloc_profiler {
+    std::string m_fname;
+    unsigned    m_rate;
+    atomic<uint64_t> m_num_samples{0};
+    // sites, the first one being used outside of any `time_task`
+    std::vector<alloc_site> m_sites;
+    std::map<std::pair<std::string, std::string>, unsigned> m_site_ids;
+    mutex       m_sites_mutex;
+    sample_shard m_shards[g_num_shards];
+};
+// Never freed, as sampled objects may still be freed after the profiler has been stopped.
+static alloc_profiler * g_profiler = nullptr;
+static mutex * g_profiler_mutex = new mutex();
+LEAN_THREAD_VALUE(unsigned, g_current_site, 0);
+
+static sample_shard & get_shard(void * o) {
+    return g_profiler->m_shards[(reinterpret_cast<size_t>(o) >> 4) % g_num_shards];
+}
+
+static void report_alloc_sample(void * o, size_t sz) {
+    // the allocator may still report a sample it decided to take right before the profiler was stopped
+    if (!g_alloc_profiler_active.load(std::memory_order_relaxed))
+        return;
+    sample_shard & s = get_shard(o);
+    lock_guard<mutex> lock(s.m_mutex);
+    s.m_live[o] = { g_current_site, sz };
+    g_profiler->m_num_samples++;
+}
+
+static bool report_sampled_free(void * o) {
+    sample_shard & s = get_shard(o);
+    lock_guard<mutex> lock(s.m_mutex);
+    auto it = s.m_live.find(o);
+    if (it == s.m_live.end())
+        return false;
+    s.m_freed[{ it->second.m_site, lean_ptr_tag(static_cast<lean_object *>(o)) }] += it->second.m_size;
+    s.m_live.erase(it);
+    return true;
+}
+
+unsigned alloc_profiler_enter(std::string const & category, name const & decl) {
+    unsigned prev = g_current_site;
+    if (!g_profiler)
+        return prev;
+    lock_guard<mutex> lock(g_profiler->m_sites_mutex);
+    alloc_profiler & p = *g_profiler;
+    std::pair<std::string, std::string> key(category, decl ? decl.to_string() : p.m_sites[prev].m_decl);
+    auto it = p.m_site_ids.find(key);
+    if (it == p.m_site_ids.end()) {
+        it = p.m_site_ids.insert({ key, static_cast<unsigned>(p.m_sites.size()) }).first;
+        p.m_sites.push_back({ key.first, key.second });
+    }
+    g_current_site = it->second;
+    return prev;
+}
+
+void alloc_profiler_leave(unsigned prev_site) {
+    g_current_site = prev_site;
+}
+
+static std::string kind_of_tag(uint8 tag) {
+    switch (tag) {
+    case LeanClosure:     return "closure";
+    case LeanArray:       return "array";
+    case LeanStructArray: return "struct array";
+    case LeanScalarArray: return "scalar array";
+    case LeanString:      return "string";
+    case LeanMPZ:         return "big number";
+    case LeanThunk:       return "thunk";
+    case LeanTask:        return "task";
+    case LeanRef:         return "ref";
+    case LeanExternal:    return "external";
+    case LeanPromise:     return "promise";
+    default:
+        if (tag <= LeanMaxCtorTag) {
+            sstream ss;
+            ss << "constructor " << static_cast<unsigned>(tag);
+            return ss.str();
+        }
+        return "other";
+    }
+}
+
+struct alloc_totals {
+    uint64_t m_allocated{0};
+    uint64_t m_retained{0};
+};
+
+static std::string display_bytes(uint64_t n) {
+    sstream ss;
+    ss << std::fixed << std::setprecision(1);
+    if (n >= (1ull << 30))
+        ss << static_cast<double>(n) / (1ull << 30) << " GiB";
+    else if (n >= (1ull << 20))
+        ss << static_cast<double>(n) / (1ull << 20) << " MiB";
+    else if (n >= (1ull << 10))
+        ss << static_cast<double>(n) / (1ull << 10) << " KiB";
+    else
+        ss << n << " B";
+    return ss.str();
+}
+
+static void write_table(std::ostream & out, char const * header, std::map<std::string, alloc_totals> const & rows) {
+    std::vector<std::pair<std::string, alloc_totals>> sorted(rows.begin(), rows.end());
+    std::stable_sort(sorted.begin(), sorted.end(), [](auto const & a, auto const & b) {
+        return a.second.m_retained != b.second.m_retained ? a.second.m_retained > b.second.m_retained
+                                                          : a.second.m_allocated > b.second.m_allocated;
+    });
+    out << std::setw(12) << "allocated" << std::setw(12) << "retained" << "  " << header << "\n";
+    for (auto const & r : sorted) {
+        out << std::setw(12) << display_bytes(r.second.m_allocated)
+            << std::setw(12) << display_bytes(r.second.m_retained) << "  " << r.first << "\n";
+    }
+}
+
+/* Must hold `g_profiler_mutex`. */
+static void write_report(alloc_profiler & p) {
+    // site and tag -> sampled bytes
+    std::map<std::pair<unsigned, uint8>, alloc_totals> totals;
+    for (sample_shard & s : p.m_shards) {
+        lock_guard<mutex> lock(s.m_mutex);
+        for (auto const & e : s.m_freed)
+            totals[e.first].m_allocated += e.second;
+        // we hold the lock that would need to be taken before freeing the object, so it is safe to read its tag
+        for (auto const & e : s.m_live) {
+            alloc_totals & t = totals[{ e.second.m_site, lean_ptr_tag(static_cast<lean_object *>(e.first)) }];
+            t.m_allocated += e.second.m_size;
+            t.m_retained  += e.second.m_size;
+        }
+    }
+    std::map<std::string, alloc_totals> by_decl;
+    std::map<std::string, alloc_totals> by_site;
+    {
+        lock_guard<mutex> lock(p.m_sites_mutex);
+        for (auto const & e : totals) {
+            alloc_site const & site = p.m_sites[e.first.first];
+            alloc_totals t = e.second;
+            t.m_allocated *= p.m_rate;
+            t.m_retained  *= p.m_rate;
+            std::string decl = site.m_decl.empty() ? std::string("[no declaration]") : site.m_decl;
+            alloc_totals & d = by_decl[decl];
+            d.m_allocated += t.m_allocated;
+            d.m_retained  += t.m_retained;
+            std::string label = site.m_category.empty() ? std::string("[no profiled step]") : site.m_category;
+            if (!site.m_decl.empty())
+                label += " of " + site.m_decl;
+            alloc_totals & l = by_site[label + ": " + kind_of_tag(e.first.second)];
+            l.m_allocated += t.m_allocated;
+            l.m_retained  += t.m_retained;
+        }
+    }
+    std::ofstream out(p.m_fname);
+    if (!out) {
+        std::cerr << "failed to write allocation profile to '" << p.m_fname << "'\n";
+        return;
+    }
+    out << "allocation profile: " << p.m_num_samples.load() << " samples of 1 in " << p.m_rate
+        << " allocations, byte counts are estimates\n\n";
+    write_table(out, "declaration", by_decl);
+    out << "\n";
+    write_table(out, "profiled step: object kind", by_site);
+}
+
+void start_alloc_profiler(std::string const & fname, unsigned rate) {
+#ifdef LEAN_SMALL_ALLOCATOR
+    lock_guard<mutex> lock(*g_profiler_mutex);
+    if (g_profiler) {
+        throw exception("allocation profiler can only be started once");
+    }
+    alloc_profiler * p = new alloc_profiler();
+    p->m_fname = fname;
+    p->m_rate  = std::max(rate, 1u);
+    p->m_sites.push_back({ std::string(), std::string() });
+    p->m_site_ids.insert({ { std::string(), std::string() }, 0 });
+    g_profiler = p;
+    g_alloc_profiler_active = true;
+    g_lean_report_alloc_sample = report_alloc_sample;
+    g_lean_report_sampled_free = report_sampled_free;
+    g_lean_alloc_sample_rate = p->m_rate;
+    // write the report even if the process is terminated using `exit`
+    std::atexit(stop_alloc_profiler);
+#else
+    throw exception("allocation profiler requires Lean to be built with the small allocator");
+#endif
+}
+
+void stop_alloc_profiler() {
+    lock_guard<mutex> lock(*g_profiler_mutex);
+    if (!g_profiler || !g_alloc_profiler_active) {
+        return;
+    }
+    g_lean_alloc_sample_rate = 0;
+    g_alloc_profiler_active = false;
+    write_report(*g_profiler);
+    // Stop tracking sampled objects after the final report. Threads that have loaded a hook before we reset it may
+    // still call it, so the profiler itself is kept.
+    g_lean_report_alloc_sample = nullptr;
+    g_lean_report_sampled_free = nullptr;
+    for (sample_shard & s : g_profiler->m_shards) {
+        lock_guard<mutex> lock(s.m_mutex);
+        s.m_live.clear();
+        s.m_freed.clear();
+    }
+}
+
+void write_alloc_profile() {
+    lock_guard<mutex> lock(*g_profiler_mutex);
+    if (g_profiler && g_alloc_profiler_active) {
+        write_report(*g_profiler);
+    }
+}
+
+/* writeAllocProfile : BaseIO Unit */
+extern "C" LEAN_EXPORT obj_res lean_write_alloc_profile() {
+    write_alloc_profile();
+    return box(0);
+}
+}
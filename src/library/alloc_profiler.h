@@ -0,0 +1,44 @@
+/*
+Copyright (c) 2025 Lean FRO, LLC. All rights reserved.
+Released under Apache 2.0 license as described in the file LICENSE.
+*/
+#pragma once
+#include <string>
+#include <atomic>
+#include <iostream>
+#include "runtime/object.h"
+#include "util/name.h"
+
+#ifndef LEAN_DEFAULT_ALLOC_PROFILER_RATE
+#define LEAN_DEFAULT_ALLOC_PROFILER_RATE 4096
+#endif
+
+namespace lean {
+LEAN_EXPORT extern std::atomic<bool> g_alloc_profiler_active;
+
+/** \brief Start sampling on average one in `rate` allocations and attributing it to the innermost `time_task`
+    (category and declaration) of the allocating thread. A report of the estimated bytes allocated and still retained
+    per category, declaration and object kind is written to `fname` when the profiler is stopped, at the latest on
+    process exit, and on `write_alloc_profile`. Throws an exception if the runtime was built without the small
+    allocator or a profiler has been started before. */
+LEAN_EXPORT void start_alloc_profiler(std::string const & fname, unsigned rate);
+/** \brief Stop sampling, write the report and stop tracking sampled objects, if the profiler is running. */
+LEAN_EXPORT void stop_alloc_profiler();
+/** \brief Write the current report of a running profiler to its file. */
+LEAN_EXPORT void write_alloc_profile();
+
+/** \brief Run the allocation profiler until the end of the scope. */
+class scoped_alloc_profiler {
+public:
+    scoped_alloc_profiler(std::string const & fname, unsigned rate = LEAN_DEFAULT_ALLOC_PROFILER_RATE) {
+        start_alloc_profiler(fname, rate);
+    }
+    ~scoped_alloc_profiler() { stop_alloc_profiler(); }
+};
+
+/** \brief Attribute the allocations of the current thread to `category` of `decl` (or of the declaration of the
+    enclosing site if `decl` is anonymous) until the matching `alloc_profiler_leave`, which must be passed the
+    returned value. */
+LEAN_EXPORT unsigned alloc_profiler_enter(std::string const & category, name const & decl);
+LEAN_EXPORT void alloc_profiler_leave(unsigned prev_site);
+}
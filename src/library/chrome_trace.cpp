@@ -0,0 +1,293 @@
+/*
+Copyright (c) 2025 Lean FRO, LLC. All rights reserved.
+Released under Apache 2.0 license as described in the file LICENSE.
+
+Timeline profiler writing the Chrome trace event format.
+
+Each thread gets its own timeline of nested slices: `time_task`s (via `chrome_trace_begin/end`), executions of tasks
+and blocking `Task.get`s, which we learn about from the task manager through `g_lean_report_task_event`. Flow events
+connect the slice spawning a task to its execution, and the slice resolving a task to the `Task.get`s waiting for it,
+which makes critical paths through parallel elaboration visible in the viewer.
+
+Events are streamed to the file in the JSON array format, which viewers accept even without the closing bracket, so
+that a trace of a process that crashed or was killed is still usable.
+*/
+#include <string>
+#include <memory>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <fstream>
+#include <iomanip>
+#include <cstdio>
+#include "runtime/sstream.h"
+#include "runtime/thread.h"
+#include "runtime/exception.h"
+#include "runtime/alloc.h"
+#include "library/chrome_trace.h"
+
+namespace lean {
+extern atomic<void (*)(task_event, lean_task_object *)> g_lean_report_task_event;
+
+std::atomic<bool> g_chrome_trace_active(false);
+
+// number of tasks resolved while not waited for whose resolution is remembered, see `chrome_trace::m_resolved`
+static constexpr size_t g_max_unwaited_resolved = 1024;
+
+struct open_slice {
+    // label for flow events of tasks spawned inside this slice
+    std::string m_label;
+    uint64_t    m_heartbeats;
+};
+struct thread_state {
+    unsigned                m_tid;
+    std::vector<open_slice> m_slices;
+};
+// allocated on the first event of a thread and never freed, like thread ids in the trace
+LEAN_THREAD_PTR(thread_state, g_thread_state);
+
+struct resolved_task {
+    unsigned m_tid;
+    double   m_ts;
+    // distinguishes entries of different tasks at the same address
+    uint64_t m_seq;
+};
+
+struct chrome_trace {
+    std::ofstream m_out;
+    chrono::steady_clock::time_point m_start;
+    bool          m_closed{false};
+    std::string   m_buffer;
+    unsigned      m_next_tid{0};
+    uint64_t      m_next_flow_id{0};
+    // tasks spawned but not yet started, with the flow id of the spawn edge and the label of the spawning slice
+    std::unordered_map<lean_task_object *, std::pair<uint64_t, std::string>> m_spawned;
+    // number of `Task.get`s blocked on each task
+    std::unordered_map<lean_task_object *, unsigned> m_waiting;
+    // Thread and time at which tasks were resolved, kept until the flows to the `Task.get`s blocked on them have been
+    // written. A `Task.get` may also start blocking after a task has been reported as resolved but before its value
+    // is published, so we keep the entries of the last `g_max_unwaited_resolved` tasks resolved while not waited for
+    // as well. The addresses of freed tasks may be reused, which simply overwrites their entries.
+    std::unordered_map<lean_task_object *, resolved_task> m_resolved;
+    std::deque<std::pair<lean_task_object *, uint64_t>> m_unwaited;
+    uint64_t      m_next_resolved_seq{0};
+};
+// Never freed, as other threads may still report events after the trace has been stopped.
+static chrome_trace * g_trace = nullptr;
+static mutex * g_trace_mutex = new mutex();
+
+static std::string json_string(std::string const & s) {
+    std::string r = "\"";
+    for (unsigned char c : s) {
+        switch (c) {
+        case '"':  r += "\\\""; break;
+        case '\\': r += "\\\\"; break;
+        case '\n': r += "\\n"; break;
+        case '\t': r += "\\t"; break;
+        default:
+            if (c < 0x20) {
+                char buf[8];
+                snprintf(buf, sizeof(buf), "\\u%04x", c);
+                r += buf;
+            } else {
+                r += c;
+            }
+        }
+    }
+    r += '"';
+    return r;
+}
+
+/* microseconds since the start of the trace */
+static double now_us() {
+    return chrono::duration<double, std::micro>(chrono::steady_clock::now() - g_trace->m_start).count();
+}
+
+/* Append the event `{"ph":<ph>,"pid":1,"tid":<tid>,"ts":<ts><fields>}`. Must hold `g_trace_mutex`. */
+static void emit(char ph, unsigned tid, double ts, std::string const & fields) {
+    chrome_trace & t = *g_trace;
+    sstream ss;
+    ss << ",\n{\"ph\":\"" << ph << "\",\"pid\":1,\"tid\":" << tid << ",\"ts\":"
+       << std::fixed << std::setprecision(3) << ts << fields << "}";
+    t.m_buffer += ss.str();
+    if (t.m_buffer.size() >= 1 << 16) {
+        t.m_out << t.m_buffer;
+        t.m_buffer.clear();
+    }
+}
+
+/* Must hold `g_trace_mutex`. */
+static thread_state & get_thread_state() {
+    if (!g_thread_state) {
+        thread_state * s = new thread_state();
+        s->m_tid = g_trace->m_next_tid++;
+        sstream ss;
+        ss << ",\"name\":\"thread_name\",\"args\":{\"name\":\"";
+        if (s->m_tid == 0)
+            ss << "main";  // see `start_chrome_trace`
+        else
+            ss << "thread " << s->m_tid;
+        ss << "\"}";
+        emit('M', s->m_tid, 0, ss.str());
+        g_thread_state = s;
+    }
+    return *g_thread_state;
+}
+
+static void begin_slice(thread_state & s, std::string const & name, std::string const & label,
+                        std::string const & args) {
+    sstream ss;
+    ss << ",\"name\":" << json_string(name);
+    if (!args.empty())
+        ss << ",\"args\":{" << args << "}";
+    emit('B', s.m_tid, now_us(), ss.str());
+    s.m_slices.push_back({ label, get_num_heartbeats() });
+}
+
+static void end_slice(thread_state & s) {
+    if (s.m_slices.empty())
+        return;
+    sstream ss;
+    ss << ",\"args\":{\"heartbeats\":" << get_num_heartbeats() - s.m_slices.back().m_heartbeats << "}";
+    s.m_slices.pop_back();
+    emit('E', s.m_tid, now_us(), ss.str());
+}
+
+static std::string flow_fields(char const * name, uint64_t id) {
+    sstream ss;
+    ss << ",\"name\":\"" << name << "\",\"cat\":\"task\",\"id\":" << id;
+    return ss.str();
+}
+
+void chrome_trace_begin(std::string const & category, name const & decl) {
+    lock_guard<mutex> lock(*g_trace_mutex);
+    if (!g_trace || g_trace->m_closed)
+        return;
+    std::string label = category;
+    std::string args;
+    if (decl) {
+        label += " of " + decl.to_string();
+        args = "\"decl\":" + json_string(decl.to_string());
+    }
+    begin_slice(get_thread_state(), category, label, args);
+}
+
+void chrome_trace_end() {
+    lock_guard<mutex> lock(*g_trace_mutex);
+    if (!g_trace || g_trace->m_closed)
+        return;
+    end_slice(get_thread_state());
+}
+
+static void report_task_event(task_event e, lean_task_object * o) {
+    lock_guard<mutex> lock(*g_trace_mutex);
+    if (!g_trace || g_trace->m_closed)
+        return;
+    chrome_trace & t = *g_trace;
+    thread_state & s = get_thread_state();
+    switch (e) {
+    case task_event::spawned: {
+        uint64_t id = t.m_next_flow_id++;
+        emit('s', s.m_tid, now_us(), flow_fields("spawn", id));
+        t.m_spawned[o] = { id, s.m_slices.empty() ? std::string() : s.m_slices.back().m_label };
+        break;
+    }
+    case task_event::started: {
+        auto it = t.m_spawned.find(o);
+        if (it == t.m_spawned.end()) {
+            begin_slice(s, "task", "task", "");
+            break;
+        }
+        std::string args;
+        if (!it->second.second.empty()) {
+            args = "\"spawned by\":" + json_string(it->second.second);
+        }
+        begin_slice(s, "task", "task", args);
+        // bind the flow to the slice just begun rather than to the next one
+        emit('f', s.m_tid, now_us(), flow_fields("spawn", it->second.first) + ",\"bp\":\"e\"");
+        t.m_spawned.erase(it);
+        break;
+    }
+    case task_event::resolved: {
+        uint64_t seq = t.m_next_resolved_seq++;
+        t.m_resolved[o] = { s.m_tid, now_us(), seq };
+        if (t.m_waiting.find(o) == t.m_waiting.end()) {
+            t.m_unwaited.emplace_back(o, seq);
+            if (t.m_unwaited.size() > g_max_unwaited_resolved) {
+                auto old = t.m_unwaited.front();
+                t.m_unwaited.pop_front();
+                auto it = t.m_resolved.find(old.first);
+                if (it != t.m_resolved.end() && it->second.m_seq == old.second &&
+                    t.m_waiting.find(old.first) == t.m_waiting.end())
+                    t.m_resolved.erase(it);
+            }
+        }
+        break;
+    }
+    case task_event::stopped:
+    case task_event::wait_stopped: {
+        if (e == task_event::wait_stopped) {
+            auto it = t.m_resolved.find(o);
+            if (it != t.m_resolved.end()) {
+                uint64_t id = t.m_next_flow_id++;
+                emit('s', it->second.m_tid, it->second.m_ts, flow_fields("resolve", id));
+                emit('f', s.m_tid, now_us(), flow_fields("resolve", id) + ",\"bp\":\"e\"");
+            }
+            // the task has been resolved, so no further `Task.get` will block on it after the last one stopped
+            auto w = t.m_waiting.find(o);
+            if (w != t.m_waiting.end() && --w->second == 0) {
+                t.m_waiting.erase(w);
+                if (it != t.m_resolved.end())
+                    t.m_resolved.erase(it);
+            }
+        }
+        end_slice(s);
+        break;
+    }
+    case task_event::wait_started:
+        t.m_waiting[o]++;
+        begin_slice(s, "Task.get", "Task.get", "");
+        break;
+    }
+}
+
+void start_chrome_trace(std::string const & fname) {
+    lock_guard<mutex> lock(*g_trace_mutex);
+    if (g_trace) {
+        throw exception("timeline trace can only be started once");
+    }
+    std::unique_ptr<chrome_trace> t(new chrome_trace());
+    t->m_out.open(fname);
+    if (!t->m_out) {
+        throw exception(sstream() << "failed to open '" << fname << "' for writing the timeline trace");
+    }
+    t->m_start = chrono::steady_clock::now();
+    // the JSON array format does not allow a trailing comma, so every event but this one starts with a comma
+    t->m_out << "[{\"ph\":\"M\",\"pid\":1,\"name\":\"process_name\",\"args\":{\"name\":\"lean\"}}";
+    g_trace = t.release();
+    // the thread starting the trace is named "main"
+    get_thread_state();
+    g_chrome_trace_active = true;
+    g_lean_report_task_event = report_task_event;
+    // finish the file even if the process is terminated using `exit`
+    std::atexit(stop_chrome_trace);
+}
+
+void stop_chrome_trace() {
+    lock_guard<mutex> lock(*g_trace_mutex);
+    chrome_trace * t = g_trace;
+    if (!t || t->m_closed) {
+        return;
+    }
+    g_chrome_trace_active = false;
+    g_lean_report_task_event = nullptr;
+    t->m_closed = true;
+    t->m_out << t->m_buffer << "\n]\n";
+    t->m_buffer.clear();
+    t->m_out.close();
+    t->m_spawned.clear();
+    t->m_waiting.clear();
+    t->m_resolved.clear();
+    t->m_unwaited.clear();
+}
+}
@@ -0,0 +1,34 @@
+/*
+Copyright (c) 2025 Lean FRO, LLC. All rights reserved.
+Released under Apache 2.0 license as described in the file LICENSE.
+*/
+#pragma once
+#include <string>
+#include <atomic>
+#include "runtime/object.h"
+#include "util/name.h"
+
+namespace lean {
+LEAN_EXPORT extern std::atomic<bool> g_chrome_trace_active;
+
+/** \brief Start writing a timeline of all `time_task`s, task executions and blocking `Task.get`s of all threads to
+    `fname` in the Chrome trace event format (as loaded by e.g. Perfetto or `chrome://tracing`). Task spawns and the
+    tasks waited for by `Task.get` are connected to the corresponding slices by flow events. Should be started before
+    any tasks are spawned. Throws an exception if the file cannot be opened or a trace has been started before. */
+LEAN_EXPORT void start_chrome_trace(std::string const & fname);
+/** \brief Stop writing the timeline and close the file, if a trace is running. */
+LEAN_EXPORT void stop_chrome_trace();
+
+/** \brief Write a timeline until the end of the scope. */
+class scoped_chrome_trace {
+public:
+    scoped_chrome_trace(std::string const & fname) { start_chrome_trace(fname); }
+    ~scoped_chrome_trace() { stop_chrome_trace(); }
+};
+
+/** \brief Begin a slice named `category` on the timeline of the current thread, optionally attributed to the
+    declaration `decl`. Must be matched by `chrome_trace_end` on the same thread, which records the number of
+    heartbeats spent in between. */
+LEAN_EXPORT void chrome_trace_begin(std::string const & category, name const & decl);
+LEAN_EXPORT void chrome_trace_end();
+}
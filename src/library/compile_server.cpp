@@ -0,0 +1,937 @@
+/*
+Copyright (c) 2025 Lean FRO, LLC. All rights reserved.
+Released under Apache 2.0 license as described in the file LICENSE.
+
+Compile server: a long-lived `lean` process serving requests to run `lean` over a Unix domain socket, which keeps the
+environments imported by earlier requests loaded.
+
+Every request is run in a process forked from the server, in the working directory and environment of the client and
+with its standard streams, received over the socket, so requests are isolated from each other and from the server.
+A process running a request does so without a task manager until it reaches `import` (`lean_compile_server_import`),
+where it sends the key of its imports to the server:
+* if there is a *zygote* for the key, the server forwards the request to it and the process exits;
+* otherwise, the process imports the modules and becomes the zygote for the key: it forks a worker continuing the
+  request, and a worker for each request forwarded to it later, which starts over and finds the imported environment
+  at `import`.
+As the key does not determine the files the modules are imported from, a zygote checks before forking a worker that
+they have not changed since it imported them, and otherwise returns the request to the server to start it over.
+Zygotes do not create any threads, as `fork` only preserves the forking thread; their workers restart the event loop
+thread and create the task manager.
+
+Messages are a 32-bit length followed by the payload. A client sends a request as a message of null-terminated
+strings (build of `lean`, working directory, number of arguments, arguments, environment) together with the
+descriptors of its standard streams, and receives the 32-bit exit code of the request, which is reported by the
+process that forked the one running the request. As requests are run by the build of the server, a server refuses
+requests of other builds by replying `g_refused`, upon which the client runs the request itself.
+*/
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <functional>
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include "runtime/sstream.h"
+#include "runtime/exception.h"
+#include "runtime/libuv.h"
+#include "runtime/platform.h"
+#include "library/compile_server.h"
+#include "githash.h"
+
+#if !defined(LEAN_WINDOWS) && !defined(LEAN_EMSCRIPTEN)
+#include <cerrno>
+#include <csignal>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+extern "C" char ** environ;
+#endif
+
+namespace lean {
+#if !defined(LEAN_WINDOWS) && !defined(LEAN_EMSCRIPTEN)
+struct request {
+    std::string              m_cwd;
+    std::vector<std::string> m_args;
+    std::vector<std::string> m_env;
+    // connection to the client, to which the exit code is reported
+    int m_conn{-1};
+    // standard streams of the client
+    int m_stdio[3]{-1, -1, -1};
+};
+
+static void close_fd(int & fd) {
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+}
+
+static void close_request(request & r) {
+    close_fd(r.m_conn);
+    for (int & fd : r.m_stdio)
+        close_fd(fd);
+}
+
+/* Move `r` leaving no descriptors behind. */
+static request take_request(request & r) {
+    request t = std::move(r);
+    r.m_conn = -1;
+    for (int & fd : r.m_stdio)
+        fd = -1;
+    return t;
+}
+
+static bool write_all(int fd, char const * data, size_t n) {
+    while (n > 0) {
+        ssize_t k = send(fd, data, n, MSG_NOSIGNAL);
+        if (k < 0 && errno == EINTR)
+            continue;
+        if (k <= 0)
+            return false;
+        data += k;
+        n    -= k;
+    }
+    return true;
+}
+
+static bool read_all(int fd, char * data, size_t n) {
+    while (n > 0) {
+        ssize_t k = read(fd, data, n);
+        if (k < 0 && errno == EINTR)
+            continue;
+        if (k <= 0)
+            return false;
+        data += k;
+        n    -= k;
+    }
+    return true;
+}
+
+static constexpr unsigned g_max_msg_fds = 4;
+// exit code replied to requests of clients of a different build, which is not a valid exit code of a process
+static constexpr int32_t g_refused = -1;
+
+/* Identifies the build of `lean` sending or receiving a request: its githash, and the binary as the githash does not
+   tell apart builds of modified sources. */
+static std::string get_build_id() {
+    char binary_id[64];
+    get_binary_id(binary_id);
+    return std::string(LEAN_GITHASH) + " " + binary_id;
+}
+
+static bool send_msg(int sock, std::string const & payload, std::vector<int> const & fds = {}) {
+    uint32_t len = static_cast<uint32_t>(payload.size());
+    std::string data(reinterpret_cast<char const *>(&len), sizeof(len));
+    data += payload;
+    // the descriptors are attached to the first byte, which is sent by itself
+    iovec iov = { &data[0], 1 };
+    msghdr msg = {};
+    msg.msg_iov    = &iov;
+    msg.msg_iovlen = 1;
+    char cbuf[CMSG_SPACE(sizeof(int) * g_max_msg_fds)];
+    if (!fds.empty()) {
+        lean_assert(fds.size() <= g_max_msg_fds);
+        memset(cbuf, 0, sizeof(cbuf));
+        msg.msg_control    = cbuf;
+        msg.msg_controllen = CMSG_SPACE(sizeof(int) * fds.size());
+        cmsghdr * c  = CMSG_FIRSTHDR(&msg);
+        c->cmsg_level = SOL_SOCKET;
+        c->cmsg_type  = SCM_RIGHTS;
+        c->cmsg_len   = CMSG_LEN(sizeof(int) * fds.size());
+        memcpy(CMSG_DATA(c), fds.data(), sizeof(int) * fds.size());
+    }
+    ssize_t k;
+    do {
+        k = sendmsg(sock, &msg, MSG_NOSIGNAL);
+    } while (k < 0 && errno == EINTR);
+    return k == 1 && write_all(sock, data.data() + 1, data.size() - 1);
+}
+
+/* Append the descriptors received with `msg` to `fds`. */
+static void take_fds(msghdr & msg, std::vector<int> & fds) {
+    for (cmsghdr * c = CMSG_FIRSTHDR(&msg); c; c = CMSG_NXTHDR(&msg, c)) {
+        if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_RIGHTS) {
+            size_t n = (c->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            int const * p = reinterpret_cast<int const *>(CMSG_DATA(c));
+            fds.insert(fds.end(), p, p + n);
+        }
+    }
+}
+
+/* Receive a message and the descriptors sent with it. Returns false at the end of the stream or on errors. */
+static bool recv_msg(int sock, std::string & payload, std::vector<int> & fds) {
+    char header[sizeof(uint32_t)];
+    iovec iov = { header, 1 };
+    msghdr msg = {};
+    msg.msg_iov    = &iov;
+    msg.msg_iovlen = 1;
+    char cbuf[CMSG_SPACE(sizeof(int) * g_max_msg_fds)];
+    msg.msg_control    = cbuf;
+    msg.msg_controllen = sizeof(cbuf);
+    ssize_t k;
+    do {
+        k = recvmsg(sock, &msg, 0);
+    } while (k < 0 && errno == EINTR);
+    if (k != 1)
+        return false;
+    fds.clear();
+    take_fds(msg, fds);
+    uint32_t len;
+    if (read_all(sock, header + 1, sizeof(header) - 1)) {
+        memcpy(&len, header, sizeof(len));
+        payload.resize(len);
+        if (read_all(sock, &payload[0], len))
+            return true;
+    }
+    for (int & fd : fds)
+        close_fd(fd);
+    return false;
+}
+
+/* A message being received without blocking, see `recv_available`. */
+struct partial_msg {
+    std::string      m_data;
+    std::vector<int> m_fds;
+
+    bool is_complete() const {
+        uint32_t len;
+        if (m_data.size() < sizeof(len))
+            return false;
+        memcpy(&len, m_data.data(), sizeof(len));
+        return m_data.size() >= sizeof(len) + len;
+    }
+    std::string payload() const { return m_data.substr(sizeof(uint32_t)); }
+};
+
+/* Receive what is available of a message on `sock` without blocking. Returns false at the end of the stream, on
+   errors, or if more than a message has been received. */
+static bool recv_available(int sock, partial_msg & m) {
+    while (!m.is_complete()) {
+        char buf[4096];
+        iovec iov = { buf, sizeof(buf) };
+        msghdr msg = {};
+        msg.msg_iov    = &iov;
+        msg.msg_iovlen = 1;
+        char cbuf[CMSG_SPACE(sizeof(int) * g_max_msg_fds)];
+        msg.msg_control    = cbuf;
+        msg.msg_controllen = sizeof(cbuf);
+        ssize_t k = recvmsg(sock, &msg, MSG_DONTWAIT);
+        if (k < 0 && errno == EINTR)
+            continue;
+        if (k < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return true;
+        if (k <= 0)
+            return false;
+        take_fds(msg, m.m_fds);
+        m.m_data.append(buf, k);
+    }
+    uint32_t len;
+    memcpy(&len, m.m_data.data(), sizeof(len));
+    return m.m_data.size() == sizeof(len) + len;
+}
+
+static std::string encode_request(request const & r) {
+    std::string s;
+    auto add = [&](std::string const & str) { s += str; s += '\0'; };
+    add(r.m_cwd);
+    add(std::to_string(r.m_args.size()));
+    for (std::string const & arg : r.m_args)
+        add(arg);
+    for (std::string const & var : r.m_env)
+        add(var);
+    return s;
+}
+
+static bool decode_request(std::string const & s, request & r) {
+    std::vector<std::string> parts;
+    size_t i = 0;
+    while (i < s.size()) {
+        size_t j = s.find('\0', i);
+        if (j == std::string::npos)
+            return false;
+        parts.push_back(s.substr(i, j - i));
+        i = j + 1;
+    }
+    if (parts.size() < 2)
+        return false;
+    size_t argc = strtoul(parts[1].c_str(), nullptr, 10);
+    if (argc == 0 || parts.size() < 2 + argc)
+        return false;
+    r.m_cwd = parts[0];
+    r.m_args.assign(parts.begin() + 2, parts.begin() + 2 + argc);
+    r.m_env.assign(parts.begin() + 2 + argc, parts.end());
+    return true;
+}
+
+/* Make a request of a received message and the descriptors sent with it, those of its connection, if `with_conn`,
+   and of its standard streams. The descriptors are closed if the message is not a request. */
+static bool to_request(std::string const & payload, std::vector<int> & fds, bool with_conn, request & r) {
+    if (fds.size() != (with_conn ? 4u : 3u) || !decode_request(payload, r)) {
+        for (int & fd : fds)
+            close_fd(fd);
+        return false;
+    }
+    unsigned i = 0;
+    if (with_conn)
+        r.m_conn = fds[i++];
+    for (int & fd : r.m_stdio)
+        fd = fds[i++];
+    return true;
+}
+
+static bool send_request(int sock, request const & r, std::string const & prefix = "") {
+    return send_msg(sock, prefix + encode_request(r), { r.m_conn, r.m_stdio[0], r.m_stdio[1], r.m_stdio[2] });
+}
+
+/* Check that the peer of the connection `conn` runs as the same user as this process, as a request can do whatever
+   `lean` can do. */
+static bool is_same_user(int conn) {
+#if defined(__linux__)
+    ucred cred;
+    socklen_t len = sizeof(cred);
+    return getsockopt(conn, SOL_SOCKET, SO_PEERCRED, &cred, &len) == 0 && cred.uid == geteuid();
+#else
+    uid_t uid;
+    gid_t gid;
+    return getpeereid(conn, &uid, &gid) == 0 && uid == geteuid();
+#endif
+}
+
+/* Send the exit code of a request given its wait status to the client, and close the connection. */
+static void report_exit(int & conn, int status) {
+    int32_t code = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+    write_all(conn, reinterpret_cast<char const *>(&code), sizeof(code));
+    close_fd(conn);
+}
+
+/* Switch to the working directory, environment and standard streams of `r`. */
+static void enter_request(request & r) {
+    for (int i = 0; i < 3; i++) {
+        if (r.m_stdio[i] != i) {
+            dup2(r.m_stdio[i], i);
+            close_fd(r.m_stdio[i]);
+        }
+    }
+    // never freed, as `environ` points into them until the process exits
+    static std::vector<std::string> * env  = new std::vector<std::string>();
+    static std::vector<char *> *      envp = new std::vector<char *>();
+    *env = r.m_env;
+    envp->clear();
+    for (std::string & var : *env)
+        envp->push_back(&var[0]);
+    envp->push_back(nullptr);
+    environ = envp->data();
+    if (chdir(r.m_cwd.c_str()) != 0) {
+        std::cerr << "error: failed to enter directory '" << r.m_cwd << "': " << strerror(errno) << "\n";
+        _exit(1);
+    }
+}
+
+/* Self-pipe reporting `SIGCHLD` to the `poll` loops of the server and of zygotes. */
+static int g_sigchld_pipe[2] = { -1, -1 };
+
+static void on_sigchld(int) {
+    int saved_errno = errno;
+    char c = 0;
+    if (write(g_sigchld_pipe[1], &c, 1) < 0) {}
+    errno = saved_errno;
+}
+
+static void install_sigchld_handler() {
+    if (pipe(g_sigchld_pipe) != 0)
+        throw exception(sstream() << "failed to create pipe: " << strerror(errno));
+    for (int fd : g_sigchld_pipe)
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_sigchld;
+    sa.sa_flags   = SA_RESTART | SA_NOCLDSTOP;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGCHLD, &sa, nullptr);
+}
+
+/* In a forked child, restore the default handling of `SIGCHLD`. */
+static void reset_sigchld_handler() {
+    signal(SIGCHLD, SIG_DFL);
+    for (int & fd : g_sigchld_pipe)
+        close_fd(fd);
+}
+
+static void drain_sigchld_pipe() {
+    char buf[64];
+    while (read(g_sigchld_pipe[0], buf, sizeof(buf)) > 0) {}
+}
+
+enum class process_kind {
+    // not serving a request, or not a candidate for becoming a zygote anymore
+    other,
+    // running a request that has not reached `import` yet
+    probe,
+    // forked from a zygote for a request forwarded to it
+    zygote_worker
+};
+
+static process_kind g_kind = process_kind::other;
+static std::function<int(std::vector<std::string> const &)> * g_run_request = nullptr;
+// probe: control socket to the server, connection to the client, and task manager size of the request
+static int      g_ctl  = -1;
+static int      g_conn = -1;
+static unsigned g_num_workers = 0;
+// zygote and its workers: the imports loaded by the zygote, and the identity of the files they were loaded from
+// together with the function computing it (see `Lean.Elab.withCompileServerImport`)
+static std::string g_zygote_key;
+static object *    g_zygote_env = nullptr;
+static object *    g_zygote_artifacts_id_fn = nullptr;
+static optional<std::string> g_zygote_artifacts_id;
+
+/* Compute the identity of the files the imports of the zygote were loaded from, or return `none` on errors. */
+static optional<std::string> get_zygote_artifacts_id() {
+    inc(g_zygote_artifacts_id_fn);
+    inc(g_zygote_env);
+    object * r = apply_2(g_zygote_artifacts_id_fn, g_zygote_env, lean_io_mk_world());
+    optional<std::string> id;
+    if (!lean_io_result_is_error(r)) {
+        object * s = lean_io_result_get_value(r);
+        id = std::string(string_cstr(s), string_size(s) - 1);
+    }
+    dec(r);
+    return id;
+}
+
+/* Stop being a candidate for becoming a zygote and restart the event loop thread, as well as the task manager if
+   `start_task_manager`. */
+static void leave_probe(bool start_task_manager) {
+    g_kind = process_kind::other;
+    close_fd(g_ctl);
+    close_fd(g_conn);
+    lean_libuv_after_fork();
+    if (start_task_manager)
+        lean_init_task_manager_using(g_num_workers);
+}
+
+/* Loop of a zygote: fork a worker for each request forwarded by the server, and report the exit codes of the
+   workers, starting with `first_worker` serving the request of the probe that became the zygote. Exits when the
+   server closes the control socket and all workers have terminated.
+
+   Once the files the imports were loaded from have changed, requests are returned to the server (message `S`),
+   which starts them over and ends (message `E`) the requests forwarded to us. */
+[[noreturn]] static void run_zygote(pid_t first_worker) {
+    struct worker {
+        int  m_conn;
+        bool m_killed;
+    };
+    std::unordered_map<pid_t, worker> workers;
+    workers[first_worker] = { g_conn, false };
+    g_conn = -1;
+    // the client of the first request waits for the end of its standard streams, which we should not keep open
+    int null_fd = open("/dev/null", O_RDWR);
+    for (int i = 0; i < 3; i++)
+        dup2(null_fd, i);
+    close(null_fd);
+    send_msg(g_ctl, "R");
+    bool stale = false;
+    while (g_ctl >= 0 || !workers.empty()) {
+        std::vector<pollfd> fds = { { g_sigchld_pipe[0], POLLIN, 0 } };
+        std::vector<pid_t> pids;
+        for (auto const & w : workers) {
+            if (!w.second.m_killed) {
+                fds.push_back({ w.second.m_conn, POLLIN, 0 });
+                pids.push_back(w.first);
+            }
+        }
+        if (g_ctl >= 0)
+            fds.push_back({ g_ctl, POLLIN, 0 });
+        if (poll(fds.data(), fds.size(), -1) < 0)
+            continue;
+        if (fds[0].revents) {
+            drain_sigchld_pipe();
+            int status;
+            pid_t pid;
+            while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+                auto it = workers.find(pid);
+                if (it != workers.end()) {
+                    report_exit(it->second.m_conn, status);
+                    workers.erase(it);
+                }
+            }
+        }
+        // clients do not send anything after their request, so a readable connection means the client is gone
+        for (size_t i = 0; i < pids.size(); i++) {
+            auto it = workers.find(pids[i]);
+            if (fds[i + 1].revents && it != workers.end()) {
+                kill(pids[i], SIGTERM);
+                it->second.m_killed = true;
+            }
+        }
+        if (g_ctl >= 0 && fds.back().revents) {
+            std::string msg;
+            std::vector<int> msg_fds;
+            request r;
+            if (!recv_msg(g_ctl, msg, msg_fds) || msg == "E" || !to_request(msg, msg_fds, /* with_conn */ true, r)) {
+                close_fd(g_ctl);
+                continue;
+            }
+            if (!stale) {
+                optional<std::string> id = get_zygote_artifacts_id();
+                stale = !id || !g_zygote_artifacts_id || *id != *g_zygote_artifacts_id;
+            }
+            if (stale) {
+                send_request(g_ctl, r, "S");
+                close_request(r);
+                continue;
+            }
+            pid_t pid = fork();
+            if (pid == 0) {
+                for (auto & w : workers)
+                    close_fd(w.second.m_conn);
+                close_fd(g_ctl);
+                close_fd(r.m_conn);
+                reset_sigchld_handler();
+                g_kind = process_kind::zygote_worker;
+                enter_request(r);
+                lean_libuv_after_fork();
+                exit((*g_run_request)(r.m_args));
+            }
+            for (int & fd : r.m_stdio)
+                close_fd(fd);
+            if (pid < 0)
+                report_exit(r.m_conn, 1 << 8);
+            else
+                workers[pid] = { r.m_conn, false };
+        }
+    }
+    _exit(0);
+}
+
+/* `import` of a probe: ask the server for a zygote of `key`, and either exit after the server has forwarded the
+   request to it, or become the zygote. */
+static obj_res probe_import(std::string const & key, obj_arg act, obj_arg artifacts_id_fn) {
+    std::string reply;
+    std::vector<int> fds;
+    if (!send_msg(g_ctl, "K" + key) || !recv_msg(g_ctl, reply, fds)) {
+        dec(artifacts_id_fn);
+        leave_probe(true);
+        return apply_1(act, lean_io_mk_world());
+    }
+    if (reply == "F") {
+        _exit(0);
+    }
+    obj_res r = apply_1(act, lean_io_mk_world());
+    if (lean_io_result_is_error(r)) {
+        // the server reports our exit code after we are done with the request
+        dec(artifacts_id_fn);
+        leave_probe(true);
+        return r;
+    }
+    g_zygote_key = key;
+    g_zygote_env = lean_io_result_get_value(r);
+    inc(g_zygote_env);
+    g_zygote_artifacts_id_fn = artifacts_id_fn;
+    // if this fails, later requests consider the imports out of date and import them again
+    g_zygote_artifacts_id = get_zygote_artifacts_id();
+    install_sigchld_handler();
+    pid_t pid = fork();
+    if (pid < 0) {
+        reset_sigchld_handler();
+        leave_probe(true);
+        return r;
+    }
+    if (pid == 0) {
+        reset_sigchld_handler();
+        leave_probe(true);
+        return r;
+    }
+    dec(r);
+    g_kind = process_kind::other;
+    run_zygote(pid);
+}
+
+/* `Lean.Elab.withCompileServerImport`. As for other `IO` externs with explicit arguments, e.g. `lean_io_timeit`, the
+   world token is erased from the call, while `act` and `artifacts_id_fn` are closures still taking it. */
+extern "C" LEAN_EXPORT obj_res lean_compile_server_import(b_obj_arg key, obj_arg act, obj_arg artifacts_id_fn) {
+    switch (g_kind) {
+    case process_kind::probe:
+        return probe_import(std::string(string_cstr(key), string_size(key) - 1), act, artifacts_id_fn);
+    case process_kind::zygote_worker:
+        dec(artifacts_id_fn);
+        if (g_zygote_env && g_zygote_key == string_cstr(key)) {
+            dec(act);
+            inc(g_zygote_env);
+            return lean_io_result_mk_ok(g_zygote_env);
+        }
+        return apply_1(act, lean_io_mk_world());
+    case process_kind::other:
+        dec(artifacts_id_fn);
+        break;
+    }
+    return apply_1(act, lean_io_mk_world());
+}
+
+unsigned compile_server_task_workers(unsigned num_workers, bool imports) {
+    if (g_kind != process_kind::probe)
+        return num_workers;
+    if (!imports) {
+        leave_probe(false);
+        return num_workers;
+    }
+    g_num_workers = num_workers;
+    return 0;
+}
+
+class compile_server {
+    struct child {
+        // request run by the child until it is forwarded to a zygote or the child is a ready zygote
+        request     m_req;
+        int         m_ctl{-1};
+        // key of the imports if the child is or is becoming a zygote
+        std::string m_key;
+        bool        m_ready{false};
+        // requests waiting for the zygote to be ready
+        std::vector<request> m_queue;
+        uint64_t    m_last_use{0};
+    };
+    int      m_listen;
+    unsigned m_max_envs;
+    uint64_t m_clock{0};
+    std::string m_build_id = get_build_id();
+    // `std::map` as references to children must stay valid when forking new ones
+    std::map<pid_t, child> m_children;
+    std::map<std::string, pid_t> m_zygotes;
+    // accepted connections whose request has not been received completely
+    std::map<int, partial_msg> m_pending;
+
+    /* In a forked child, close the descriptors of the server. */
+    void close_server_fds() {
+        close_fd(m_listen);
+        for (auto & p : m_pending) {
+            close(p.first);
+            for (int & fd : p.second.m_fds)
+                close_fd(fd);
+        }
+        for (auto & c : m_children) {
+            close_request(c.second.m_req);
+            close_fd(c.second.m_ctl);
+            for (request & r : c.second.m_queue)
+                close_request(r);
+        }
+        reset_sigchld_handler();
+    }
+
+    /* Fork a probe running `r`. */
+    void spawn(request r) {
+        int ctl[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, ctl) != 0) {
+            report_exit(r.m_conn, 1 << 8);
+            close_request(r);
+            return;
+        }
+        pid_t pid = fork();
+        if (pid == 0) {
+            close_fd(ctl[0]);
+            close_server_fds();
+            g_kind = process_kind::probe;
+            g_ctl  = ctl[1];
+            g_conn = r.m_conn;
+            enter_request(r);
+            // a worker forked at `import` continues the request here as well
+            exit((*g_run_request)(r.m_args));
+        }
+        close_fd(ctl[1]);
+        if (pid < 0) {
+            close_fd(ctl[0]);
+            report_exit(r.m_conn, 1 << 8);
+            close_request(r);
+            return;
+        }
+        child & c = m_children[pid];
+        c.m_req = take_request(r);
+        c.m_ctl = ctl[0];
+    }
+
+    void forward(pid_t zygote, request r) {
+        child & z = m_children[zygote];
+        z.m_last_use = ++m_clock;
+        if (!z.m_ready) {
+            z.m_queue.push_back(take_request(r));
+            return;
+        }
+        if (!send_request(z.m_ctl, r)) {
+            // the zygote is terminating
+            auto it = m_zygotes.find(z.m_key);
+            if (it != m_zygotes.end() && it->second == zygote)
+                m_zygotes.erase(it);
+            spawn(take_request(r));
+            return;
+        }
+        close_request(r);
+    }
+
+    /* Make zygotes that were not used for the longest time exit until there are at most `m_max_envs`. */
+    void evict() {
+        while (m_zygotes.size() > m_max_envs) {
+            auto lru = m_zygotes.end();
+            for (auto it = m_zygotes.begin(); it != m_zygotes.end(); ++it) {
+                child const & z = m_children[it->second];
+                if (z.m_ready && (lru == m_zygotes.end() || z.m_last_use < m_children[lru->second].m_last_use))
+                    lru = it;
+            }
+            if (lru == m_zygotes.end())
+                return;
+            // the zygote exits once its workers are done
+            close_fd(m_children[lru->second].m_ctl);
+            m_zygotes.erase(lru);
+        }
+    }
+
+    void handle_ctl(pid_t pid) {
+        child & c = m_children[pid];
+        std::string msg;
+        std::vector<int> fds;
+        if (!recv_msg(c.m_ctl, msg, fds) || msg.empty()) {
+            close_fd(c.m_ctl);
+            return;
+        }
+        if (msg[0] == 'S') {
+            // the imports of the zygote are out of date: make it finish, and start over the request it returned
+            auto z = m_zygotes.find(c.m_key);
+            if (z != m_zygotes.end() && z->second == pid) {
+                m_zygotes.erase(z);
+                send_msg(c.m_ctl, "E");
+            }
+            request r;
+            if (to_request(msg.substr(1), fds, /* with_conn */ true, r))
+                spawn(take_request(r));
+            return;
+        }
+        for (int & fd : fds)
+            close_fd(fd);
+        if (msg[0] == 'K') {
+            std::string key = msg.substr(1);
+            auto it = m_zygotes.find(key);
+            if (it != m_zygotes.end()) {
+                send_msg(c.m_ctl, "F");
+                forward(it->second, take_request(c.m_req));
+            } else {
+                c.m_key = key;
+                c.m_last_use = ++m_clock;
+                m_zygotes[key] = pid;
+                send_msg(c.m_ctl, "Z");
+                evict();
+            }
+        } else if (msg == "R") {
+            // the zygote reports the exit code of its first request itself
+            c.m_ready = true;
+            close_request(c.m_req);
+            std::vector<request> queue = std::move(c.m_queue);
+            c.m_queue.clear();
+            for (request & r : queue)
+                forward(pid, take_request(r));
+        }
+    }
+
+    void reap() {
+        drain_sigchld_pipe();
+        int status;
+        pid_t pid;
+        while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+            auto it = m_children.find(pid);
+            if (it == m_children.end())
+                continue;
+            child & c = it->second;
+            if (c.m_req.m_conn >= 0)
+                report_exit(c.m_req.m_conn, status);
+            close_request(c.m_req);
+            close_fd(c.m_ctl);
+            auto z = m_zygotes.find(c.m_key);
+            if (z != m_zygotes.end() && z->second == pid)
+                m_zygotes.erase(z);
+            std::vector<request> queue = std::move(c.m_queue);
+            m_children.erase(it);
+            // requests waiting for a zygote that failed to import start over
+            for (request & r : queue)
+                spawn(take_request(r));
+        }
+    }
+
+    void accept_conn() {
+        int conn = accept(m_listen, nullptr, nullptr);
+        if (conn < 0)
+            return;
+        if (!is_same_user(conn)) {
+            close(conn);
+            return;
+        }
+        m_pending[conn];
+    }
+
+    /* Receive what is available of the request on the accepted connection `conn`, and run it once complete. The
+       request is received without blocking so that a client that is slow to send it does not stall the server. */
+    void recv_pending(int conn) {
+        auto it = m_pending.find(conn);
+        bool ok = recv_available(conn, it->second);
+        if (ok && !it->second.is_complete())
+            return;
+        // no longer to be closed by the processes we fork
+        partial_msg m = std::move(it->second);
+        m_pending.erase(it);
+        std::string payload = ok ? m.payload() : std::string();
+        size_t build_end = payload.find('\0');
+        if (ok && build_end != std::string::npos && payload.compare(0, build_end, m_build_id) != 0) {
+            for (int & fd : m.m_fds)
+                close_fd(fd);
+            write_all(conn, reinterpret_cast<char const *>(&g_refused), sizeof(g_refused));
+            close(conn);
+            return;
+        }
+        request r;
+        if (ok && build_end != std::string::npos
+            && to_request(payload.substr(build_end + 1), m.m_fds, /* with_conn */ false, r)) {
+            r.m_conn = conn;
+            spawn(take_request(r));
+            return;
+        }
+        for (int & fd : m.m_fds)
+            close_fd(fd);
+        close(conn);
+    }
+
+public:
+    compile_server(int listen_fd, unsigned max_envs):m_listen(listen_fd), m_max_envs(max_envs) {}
+
+    [[noreturn]] void run() {
+        install_sigchld_handler();
+        while (true) {
+            std::vector<pollfd> fds = { { m_listen, POLLIN, 0 }, { g_sigchld_pipe[0], POLLIN, 0 } };
+            std::vector<pid_t> pids;
+            for (auto const & c : m_children) {
+                if (c.second.m_ctl >= 0) {
+                    fds.push_back({ c.second.m_ctl, POLLIN, 0 });
+                    pids.push_back(c.first);
+                }
+            }
+            size_t pending_begin = fds.size();
+            for (auto const & p : m_pending)
+                fds.push_back({ p.first, POLLIN, 0 });
+            if (poll(fds.data(), fds.size(), -1) < 0)
+                continue;
+            for (size_t i = 0; i < pids.size(); i++) {
+                if (fds[i + 2].revents && m_children[pids[i]].m_ctl >= 0)
+                    handle_ctl(pids[i]);
+            }
+            for (size_t i = pending_begin; i < fds.size(); i++) {
+                if (fds[i].revents)
+                    recv_pending(fds[i].fd);
+            }
+            if (fds[1].revents)
+                reap();
+            if (fds[0].revents)
+                accept_conn();
+        }
+    }
+};
+
+static unsigned get_compile_server_max_envs() {
+    if (char const * max_envs = std::getenv("LEAN_COMPILE_SERVER_MAX_ENVS")) {
+        return atoi(max_envs);
+    }
+    return LEAN_DEFAULT_COMPILE_SERVER_MAX_ENVS;
+}
+
+int run_compile_server(std::string const & path,
+                       std::function<int(std::vector<std::string> const &)> const & run_request) {
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path))
+        throw exception(sstream() << "compile server socket path '" << path << "' is too long");
+    strcpy(addr.sun_path, path.c_str());
+    // replace the socket of a previous server, but nothing else
+    struct stat st;
+    if (lstat(path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode))
+        unlink(path.c_str());
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    // only our user may connect to the socket, which is additionally checked for each connection
+    mode_t old_umask = umask(0177);
+    bool ok = fd >= 0 && bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == 0;
+    umask(old_umask);
+    if (!ok || chmod(path.c_str(), S_IRUSR | S_IWUSR) != 0 || listen(fd, SOMAXCONN) != 0) {
+        int err = errno;
+        if (fd >= 0)
+            close(fd);
+        throw exception(sstream() << "failed to listen on '" << path << "': " << strerror(err));
+    }
+    g_run_request = new std::function<int(std::vector<std::string> const &)>(run_request);
+    compile_server(fd, get_compile_server_max_envs()).run();
+}
+
+optional<int> run_compile_server_client(char const * path, int argc, char ** argv) {
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--compile-server", strlen("--compile-server")) == 0)
+            return optional<int>();
+    }
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) == 0 || strlen(path) >= sizeof(addr.sun_path))
+        return optional<int>();
+    strcpy(addr.sun_path, path);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        return optional<int>();
+    if (connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+        close(fd);
+        return optional<int>();
+    }
+    request r;
+    if (char * cwd = getcwd(nullptr, 0)) {
+        r.m_cwd = cwd;
+        free(cwd);
+    }
+    r.m_args.assign(argv, argv + argc);
+    for (char ** var = environ; *var; var++)
+        r.m_env.push_back(*var);
+    if (!send_msg(fd, get_build_id() + '\0' + encode_request(r), { 0, 1, 2 })) {
+        close(fd);
+        return optional<int>();
+    }
+    int32_t code;
+    bool ok = read_all(fd, reinterpret_cast<char *>(&code), sizeof(code));
+    close(fd);
+    if (!ok) {
+        std::cerr << "error: compile server '" << path << "' did not report the exit code of the request\n";
+        return optional<int>(1);
+    }
+    // the server runs a different build of `lean`
+    if (code == g_refused)
+        return optional<int>();
+    return optional<int>(code);
+}
+#else
+int run_compile_server(std::string const &, std::function<int(std::vector<std::string> const &)> const &) {
+    throw exception("compile server is not supported on this platform");
+}
+
+optional<int> run_compile_server_client(char const *, int, char **) {
+    return optional<int>();
+}
+
+unsigned compile_server_task_workers(unsigned num_workers, bool) {
+    return num_workers;
+}
+
+extern "C" LEAN_EXPORT obj_res lean_compile_server_import(b_obj_arg, obj_arg act, obj_arg artifacts_id_fn) {
+    dec(artifacts_id_fn);
+    return apply_1(act, lean_io_mk_world());
+}
+#endif
+}
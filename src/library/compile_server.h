@@ -0,0 +1,35 @@
+/*
+Copyright (c) 2025 Lean FRO, LLC. All rights reserved.
+Released under Apache 2.0 license as described in the file LICENSE.
+*/
+#pragma once
+#include <string>
+#include <vector>
+#include <functional>
+#include "runtime/object.h"
+#include "runtime/optional.h"
+
+#ifndef LEAN_DEFAULT_COMPILE_SERVER_MAX_ENVS
+#define LEAN_DEFAULT_COMPILE_SERVER_MAX_ENVS 8
+#endif
+
+namespace lean {
+/** \brief Serve requests to run `lean` on the Unix domain socket `path` until the process is terminated. Each request
+    is run by `run_request`, given its command line arguments, in a process forked from the server in the working
+    directory, environment and with the standard streams of the client. Environments imported by requests are kept
+    loaded for later requests with the same imports, up to `LEAN_COMPILE_SERVER_MAX_ENVS` (default
+    `LEAN_DEFAULT_COMPILE_SERVER_MAX_ENVS`) of them. Throws an exception if the socket cannot be created or this
+    platform is not supported. */
+LEAN_EXPORT int run_compile_server(std::string const & path,
+                                   std::function<int(std::vector<std::string> const &)> const & run_request);
+
+/** \brief Run `lean` with the given command line through the compile server listening on `path`, returning the exit
+    code of the request, or `none` if there is no server to send the request to. */
+LEAN_EXPORT optional<int> run_compile_server_client(char const * path, int argc, char ** argv);
+
+/** \brief To be called when running a request, before creating the task manager with `num_workers` workers, where
+    `imports` tells whether the request elaborates a file. Returns the number of workers to create right away, which
+    is zero if the process may become the one keeping the imports of the request loaded: such a process is forked for
+    each later request, so it may not have created any threads, and the task manager is created after `import`. */
+LEAN_EXPORT unsigned compile_server_task_workers(unsigned num_workers, bool imports);
+}
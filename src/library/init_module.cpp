@@ -16,6 +16,7 @@ Author: Leonardo de Moura
 #include "library/formatter.h"
 #include "library/dynlib.h"
 #include "library/ir_interpreter.h"
+#include "library/ir_jit.h"
 
 namespace lean {
 void initialize_library_core_module() {
@@ -39,9 +40,11 @@ void initialize_library_module() {
     initialize_time_task();
     initialize_dynlib();
     initialize_ir_interpreter();
+    initialize_ir_jit();
 }
 
 void finalize_library_module() {
+    finalize_ir_jit();
     finalize_ir_interpreter();
     finalize_time_task();
     finalize_library_util();
@@ -10,8 +10,11 @@ Motivation
 ==========
 
 Even with a JIT compiler, we still have a need for a simpler interpreter on platforms LLVM JIT does not support (i.e.
-WebAssembly). Because this is mostly an edge case, we strive for simplicity instead of performance and thus reuse the
-existing compiler IR instead of inventing something like a new bytecode format.
+WebAssembly). Because this is mostly an edge case, we originally strove for simplicity instead of performance and walked
+the existing compiler IR directly. As more and more code is run by the interpreter during elaboration (e.g. tactics and
+`#eval` in the same file they are declared in), each IR declaration is now lowered once to a compact register bytecode
+(see `bytecode_compiler`), which avoids re-reading the IR objects and re-resolving callees on every execution. The IR
+walker is kept as a reference implementation and can be selected using `set_option interpreter.bytecode false`.
 
 Implementation
 ==============
@@ -25,9 +28,15 @@ code by checking for the mangled symbol via dlsym/GetProcAddress, which is also
 functions, which have a (relatively) homogeneous ABI that we can use without runtime code generation; see also
 `call/lookup_symbol` below.
 
+In bytecode mode, a frame has a fixed size known after lowering and the registers of a frame are the stack slots
+starting at its base pointer; join points become jumps inside the instruction array instead of entries on the join point
+stack. Callees are resolved on their first execution and cached in the call site of the instruction.
+
 */
 #include <string>
 #include <vector>
+#include <memory>
+#include <mutex>
 #include <shared_mutex>
 #ifdef LEAN_WINDOWS
 #include <windows.h>
@@ -47,14 +56,30 @@ functions, which have a (relatively) homogeneous ABI that we can use without run
 #include "library/time_task.h"
 #include "library/ir_types.h"
 #include "library/init_attribute.h"
+#include "library/ir_jit.h"
+#include "library/sampling_profiler.h"
 #include "util/nat.h"
 #include "util/option_declarations.h"
 #include "util/name_hash_map.h"
+#include "util/name_hash_set.h"
 
 #ifndef LEAN_DEFAULT_INTERPRETER_PREFER_NATIVE
 #define LEAN_DEFAULT_INTERPRETER_PREFER_NATIVE true
 #endif
 
+#ifndef LEAN_DEFAULT_INTERPRETER_BYTECODE
+#define LEAN_DEFAULT_INTERPRETER_BYTECODE true
+#endif
+
+#ifndef LEAN_DEFAULT_INTERPRETER_JIT_THRESHOLD
+#define LEAN_DEFAULT_INTERPRETER_JIT_THRESHOLD 0
+#endif
+
+// dispatch bytecode instructions through computed gotos where supported
+#if defined(__GNUC__)
+#define LEAN_BYTECODE_THREADED
+#endif
+
 namespace lean {
 namespace ir {
 // C++ wrappers of Lean data types
@@ -202,6 +227,8 @@ extern "C" float lean_float32_of_nat(lean_obj_arg a);
 
 static string_ref * g_boxed_mangled_suffix = nullptr;
 static name * g_interpreter_prefer_native = nullptr;
+static name * g_interpreter_bytecode = nullptr;
+static name * g_interpreter_jit_threshold = nullptr;
 
 // constants (lacking native declarations) initialized by `lean_run_init`
 // We can assume this variable is never written to and read from in parallel; see `enableInitializersExecution`.
@@ -371,6 +398,674 @@ name_hash_map<native_symbol_cache_entry> * g_native_symbol_cache;
 // could be `shared_mutex` with C++17
 std::shared_timed_mutex * g_native_symbol_cache_mutex;
 
+struct constant_cache_entry {
+    bool m_is_scalar;
+    value m_val;
+};
+
+struct symbol_cache_entry {
+    // looking up IR from .oleans is slow enough to warrant its own cache; but as local IR can
+    // be backtracked, this cache needs to be local as well. Imported IR is additionally cached in
+    // `imported_cache` below.
+    decl m_decl;
+    native_symbol_cache_entry m_native;
+    // number of interpreted calls, for the JIT threshold
+    unsigned m_num_calls = 0;
+};
+
+// Caches JIT compilation successes _and_ failures by (the address of) the IR declaration. Entries keep their
+// declaration alive so that the address cannot be reused by a different declaration.
+struct jit_cache_entry {
+    decl m_decl;
+    native_symbol_cache_entry m_native;
+};
+lean::unordered_map<object *, jit_cache_entry> * g_jit_cache;
+std::mutex * g_jit_cache_mutex;
+
+// Unlike local IR, the IR of imported declarations (and thus the values of imported constants) only depends on the
+// imports, so we share it between all interpreters whose environments have the same `Environment.header.moduleData`.
+struct imported_cache {
+    // the imports' module data; kept alive so that its address cannot be reused by different imports
+    object_ref m_module_data;
+    name_hash_map<decl> m_decls;
+    // cached values are marked as multi-threaded
+    name_hash_map<constant_cache_entry> m_constants;
+    std::shared_timed_mutex m_mutex;
+
+    explicit imported_cache(object_ref const & module_data) : m_module_data(module_data) {}
+    ~imported_cache() {
+        for (auto & it : m_constants) {
+            if (!it.second.m_is_scalar) {
+                dec(it.second.m_val.m_obj);
+            }
+        }
+    }
+};
+// keyed by (the address of) the module data; entries are removed by `Environment.freeRegions` as they may reference
+// objects in compacted regions
+lean::unordered_map<object *, std::shared_ptr<imported_cache>> * g_imported_caches;
+std::mutex * g_imported_caches_mutex;
+
+extern "C" object * lean_ir_get_imported_module_data(object * env);
+static std::shared_ptr<imported_cache> get_imported_cache(elab_environment const & env) {
+    object_ref module_data(lean_ir_get_imported_module_data(env.to_obj_arg()));
+    if (array_size(module_data.raw()) == 0) {
+        // nothing to share
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(*g_imported_caches_mutex);
+    auto it = g_imported_caches->find(module_data.raw());
+    if (it != g_imported_caches->end()) {
+        return it->second;
+    }
+    auto c = std::make_shared<imported_cache>(module_data);
+    g_imported_caches->insert({ module_data.raw(), c });
+    return c;
+}
+
+extern "C" LEAN_EXPORT object * lean_ir_free_imported_caches(b_obj_arg module_data) {
+    std::shared_ptr<imported_cache> c;
+    {
+        std::lock_guard<std::mutex> lock(*g_imported_caches_mutex);
+        auto it = g_imported_caches->find(module_data);
+        if (it != g_imported_caches->end()) {
+            c = std::move(it->second);
+            g_imported_caches->erase(it);
+        }
+    }
+    // `c` is freed here unless still used by an interpreter, which would violate the precondition of `freeRegions`
+    return io_result_mk_ok(box(0));
+}
+
+/* getNumInterpreterCaches : BaseIO Nat */
+extern "C" LEAN_EXPORT obj_res lean_ir_get_num_imported_caches() {
+    std::lock_guard<std::mutex> lock(*g_imported_caches_mutex);
+    return usize_to_nat(g_imported_caches->size());
+}
+
+extern "C" object * lean_ir_find_imported_env_decl(object * env, object * n);
+option_ref<decl> find_imported_ir_decl(elab_environment const & env, name const & n) {
+    return option_ref<decl>(lean_ir_find_imported_env_decl(env.to_obj_arg(), n.to_obj_arg()));
+}
+
+// =======================================
+// Register bytecode
+
+/*
+Function bodies are lowered to a register bytecode on first execution. The bytecode of a declaration is a flat
+`uint32` array of instructions, each of which consists of an opcode followed by its operands; see `bytecode_op`
+for their layout. Registers are slots of the interpreter's argument stack relative to the frame's base pointer:
+IR variable `x_i` is register `i - 1`, which puts the parameters `x_1 ... x_n` exactly where the caller pushed the
+arguments. It is followed by a register holding `box(0)`, which is used for irrelevant arguments, and by scratch
+registers for parallel moves. As the number of registers is known after lowering, a frame is allocated at once
+on entry. Join points become jump targets, and callees are resolved at the first execution of each call site.
+*/
+enum class bytecode_op : uint32 {
+    Ctor,        // dst ctor n args[n]
+    Reset,       // dst obj n
+    Reuse,       // dst obj ctor update_header n args[n]
+    Proj,        // dst obj idx
+    UProj,       // dst obj idx
+    SProj,       // dst obj offset type
+    FAp,         // dst site n args[n]
+    Load,        // dst site type
+    PAp,         // dst site n args[n]
+    Ap,          // dst fn n args[n]
+    Box,         // dst src type
+    Unbox,       // dst src type
+    Const,       // dst const
+    LitObj,      // dst obj_const
+    IsShared,    // dst obj
+    IsTaggedPtr, // dst obj
+    Move,        // dst src
+    Set,         // obj idx src
+    SetTag,      // obj tag
+    USet,        // obj idx src
+    SSet,        // obj offset src type
+    Inc,         // obj n
+    Dec,         // obj n
+    Del,         // obj
+    Case,        // src is_scalar n default targets[n]
+    Jmp,         // target
+    Loop,        // (tail call of the current function, after its arguments have been moved into place)
+    Ret,         // src
+    Throw,       // error
+};
+
+// jump target of `case` tags without a matching alternative
+static constexpr uint32 g_bytecode_no_target = std::numeric_limits<uint32>::max();
+
+struct bytecode_ctor {
+    unsigned m_tag;
+    unsigned m_num_objs;
+    unsigned m_scalar_sz;
+};
+
+struct bytecode_fn;
+
+struct bytecode_call_site {
+    name m_fn;
+    // resolved on first execution, pointing into the caches of the interpreter owning the bytecode
+    symbol_cache_entry * m_entry = nullptr;
+    bytecode_fn * m_code = nullptr;
+    constant_cache_entry const * m_const = nullptr;
+
+    explicit bytecode_call_site(name const & fn) : m_fn(fn) {}
+};
+
+struct bytecode_fn {
+    decl m_decl;
+    std::vector<uint32> m_code;
+    unsigned m_num_regs = 0;
+    // register holding `box(0)`
+    unsigned m_irrelevant_reg = 0;
+    std::vector<unsigned> m_param_regs;
+    // whether parameter `i` is in register `i`
+    bool m_canonical_params = true;
+    // maximal number of arguments of a call, i.e. the size of the argument buffer of an activation
+    unsigned m_max_args = 0;
+    std::vector<value> m_consts;
+    std::vector<object_ref> m_obj_consts;
+    std::vector<bytecode_ctor> m_ctors;
+    std::vector<bytecode_call_site> m_sites;
+    std::vector<std::string> m_errors;
+
+    explicit bytecode_fn(decl const & d) : m_decl(d) {}
+};
+
+/** \brief Lower the body of an IR declaration to bytecode. */
+class bytecode_compiler {
+    bytecode_fn & m_fn;
+    std::vector<uint32> & m_code;
+    // number of registers used by IR variables
+    unsigned m_num_vars = 0;
+    unsigned m_num_scratch = 0;
+    // positions of operands to be patched when the number of IR variables is known
+    std::vector<size_t> m_irrelevant_fixups;
+    std::vector<size_t> m_scratch_fixups;
+    struct jp_info {
+        size_t m_target = g_bytecode_no_target;
+        std::vector<uint32> m_params;
+        // positions of jumps to the join point before its body has been emitted
+        std::vector<size_t> m_fixups;
+    };
+    // join points in scope
+    lean::unordered_map<size_t, jp_info> m_jps;
+    name_hash_map<uint32> m_site_idx;
+
+    void emit(uint32 w) { m_code.push_back(w); }
+    void emit(bytecode_op op) { emit(static_cast<uint32>(op)); }
+    void emit(type t) { emit(static_cast<uint32>(t)); }
+
+    uint32 reg(var_id const & x) {
+        // variables are 1-indexed
+        size_t i = x.get_small_value();
+        lean_assert(i > 0);
+        m_num_vars = std::max(m_num_vars, static_cast<unsigned>(i));
+        return i - 1;
+    }
+
+    void emit_reg(var_id const & x) { emit(reg(x)); }
+
+    void emit_arg(arg const & a) {
+        if (arg_is_irrelevant(a)) {
+            m_irrelevant_fixups.push_back(m_code.size());
+            emit(0);
+        } else {
+            emit_reg(arg_var_id(a));
+        }
+    }
+
+    void emit_args(array_ref<arg> const & args) {
+        m_fn.m_max_args = std::max(m_fn.m_max_args, static_cast<unsigned>(args.size()));
+        emit(args.size());
+        for (arg const & a : args) {
+            emit_arg(a);
+        }
+    }
+
+    uint32 site(name const & fn) {
+        auto it = m_site_idx.find(fn);
+        if (it != m_site_idx.end())
+            return it->second;
+        uint32 i = m_fn.m_sites.size();
+        m_fn.m_sites.emplace_back(fn);
+        m_site_idx.insert({ fn, i });
+        return i;
+    }
+
+    uint32 ctor(ctor_info const & c) {
+        size_t usize = ctor_info_usize(c).get_small_value();
+        size_t ssize = ctor_info_ssize(c).get_small_value();
+        m_fn.m_ctors.push_back(bytecode_ctor { static_cast<unsigned>(ctor_info_tag(c).get_small_value()),
+                                               static_cast<unsigned>(ctor_info_size(c).get_small_value()),
+                                               static_cast<unsigned>(usize * sizeof(void *) + ssize) });
+        return m_fn.m_ctors.size() - 1;
+    }
+
+    void emit_const(uint32 dst, value v) {
+        emit(bytecode_op::Const); emit(dst); emit(m_fn.m_consts.size());
+        m_fn.m_consts.push_back(v);
+    }
+
+    void emit_obj_const(uint32 dst, object_ref const & o) {
+        if (is_scalar(o.raw())) {
+            emit_const(dst, o.raw());
+        } else {
+            emit(bytecode_op::LitObj); emit(dst); emit(m_fn.m_obj_consts.size());
+            m_fn.m_obj_consts.push_back(o);
+        }
+    }
+
+    /** \brief Throw `msg` when reaching this instruction. Used for invalid IR, which is only reported when executed. */
+    void emit_throw(std::string const & msg) {
+        emit(bytecode_op::Throw); emit(m_fn.m_errors.size());
+        m_fn.m_errors.push_back(msg);
+    }
+
+    void emit_jump_to(jp_info & jp) {
+        emit(bytecode_op::Jmp);
+        if (jp.m_target == g_bytecode_no_target) {
+            jp.m_fixups.push_back(m_code.size());
+        }
+        emit(jp.m_target);
+    }
+
+    /** \brief Assign each `src` to its `dst` simultaneously, going through scratch registers if a source is
+        overwritten by a previous move. */
+    void emit_parallel_move(buffer<std::pair<uint32, uint32>> const & moves) {
+        bool conflict = false;
+        for (size_t i = 0; i < moves.size() && !conflict; i++) {
+            for (size_t j = 0; j < i; j++) {
+                if (moves[j].first == moves[i].second && moves[j].first != moves[j].second) {
+                    conflict = true;
+                    break;
+                }
+            }
+        }
+        if (!conflict) {
+            for (auto const & m : moves) {
+                if (m.first != m.second) {
+                    emit(bytecode_op::Move); emit(m.first); emit(m.second);
+                }
+            }
+            return;
+        }
+        m_num_scratch = std::max(m_num_scratch, static_cast<unsigned>(moves.size()));
+        for (size_t i = 0; i < moves.size(); i++) {
+            emit(bytecode_op::Move);
+            m_scratch_fixups.push_back(m_code.size());
+            emit(i);
+            emit(moves[i].second);
+        }
+        for (size_t i = 0; i < moves.size(); i++) {
+            emit(bytecode_op::Move);
+            emit(moves[i].first);
+            m_scratch_fixups.push_back(m_code.size());
+            emit(i);
+        }
+    }
+
+    /** \brief Moves of the relevant `args` into the registers `dsts`. */
+    buffer<std::pair<uint32, uint32>> arg_moves(buffer<uint32> const & dsts, array_ref<arg> const & args) {
+        lean_assert(dsts.size() == args.size());
+        buffer<std::pair<uint32, uint32>> moves;
+        for (size_t i = 0; i < args.size(); i++) {
+            // irrelevant arguments are assigned after the parallel move, see `emit_irrelevant_moves`
+            if (!arg_is_irrelevant(args[i]))
+                moves.push_back({ dsts[i], reg(arg_var_id(args[i])) });
+        }
+        return moves;
+    }
+
+    void emit_irrelevant_moves(buffer<uint32> const & dsts, array_ref<arg> const & args) {
+        for (size_t i = 0; i < args.size(); i++) {
+            if (arg_is_irrelevant(args[i])) {
+                emit(bytecode_op::Move); emit(dsts[i]);
+                m_irrelevant_fixups.push_back(m_code.size());
+                emit(0);
+            }
+        }
+    }
+
+    void lower_expr(uint32 dst, expr const & e, type t) {
+        switch (expr_tag(e)) {
+            case expr_kind::Ctor: {
+                ctor_info const & c = expr_ctor_info(e);
+                if (ctor_info_size(c).get_small_value() == 0 && ctor_info_usize(c).get_small_value() == 0 &&
+                    ctor_info_ssize(c).get_small_value() == 0) {
+                    // a constructor without data is optimized to a tagged pointer
+                    emit_const(dst, box(ctor_info_tag(c).get_small_value()));
+                } else {
+                    emit(bytecode_op::Ctor); emit(dst); emit(ctor(c)); emit_args(expr_ctor_args(e));
+                }
+                return;
+            }
+            case expr_kind::Reset:
+                emit(bytecode_op::Reset); emit(dst); emit_reg(expr_reset_obj(e));
+                emit(expr_reset_num_objs(e).get_small_value());
+                return;
+            case expr_kind::Reuse:
+                emit(bytecode_op::Reuse); emit(dst); emit_reg(expr_reuse_obj(e)); emit(ctor(expr_reuse_ctor(e)));
+                emit(expr_reuse_update_header(e)); emit_args(expr_reuse_args(e));
+                return;
+            case expr_kind::Proj:
+                emit(bytecode_op::Proj); emit(dst); emit_reg(expr_proj_obj(e)); emit(expr_proj_idx(e).get_small_value());
+                return;
+            case expr_kind::UProj:
+                emit(bytecode_op::UProj); emit(dst); emit_reg(expr_uproj_obj(e));
+                emit(expr_uproj_idx(e).get_small_value());
+                return;
+            case expr_kind::SProj:
+                switch (t) {
+                    case type::Float: case type::Float32: case type::UInt8: case type::UInt16: case type::UInt32:
+                    case type::UInt64:
+                        emit(bytecode_op::SProj); emit(dst); emit_reg(expr_sproj_obj(e));
+                        emit(expr_sproj_idx(e).get_small_value() * sizeof(void *) + expr_sproj_offset(e).get_small_value());
+                        emit(t);
+                        return;
+                    default:
+                        emit_throw("invalid instruction");
+                        return;
+                }
+            case expr_kind::FAp:
+                if (expr_fap_args(e).size()) {
+                    emit(bytecode_op::FAp); emit(dst); emit(site(expr_fap_fun(e))); emit_args(expr_fap_args(e));
+                } else {
+                    // nullary function ("constant")
+                    emit(bytecode_op::Load); emit(dst); emit(site(expr_fap_fun(e))); emit(t);
+                }
+                return;
+            case expr_kind::PAp:
+                emit(bytecode_op::PAp); emit(dst); emit(site(expr_pap_fun(e))); emit_args(expr_pap_args(e));
+                return;
+            case expr_kind::Ap:
+                emit(bytecode_op::Ap); emit(dst); emit_reg(expr_ap_fun(e)); emit_args(expr_ap_args(e));
+                return;
+            case expr_kind::Box:
+                emit(bytecode_op::Box); emit(dst); emit_reg(expr_box_obj(e)); emit(expr_box_type(e));
+                return;
+            case expr_kind::Unbox:
+                emit(bytecode_op::Unbox); emit(dst); emit_reg(expr_unbox_obj(e)); emit(t);
+                return;
+            case expr_kind::Lit:
+                switch (lit_val_tag(expr_lit_val(e))) {
+                    case lit_val_kind::Num: {
+                        nat const & n = lit_val_num(expr_lit_val(e));
+                        switch (t) {
+                            case type::Float:
+                                lean_inc(n.raw());
+                                emit_const(dst, value::from_float(lean_float_of_nat(n.raw())));
+                                return;
+                            case type::Float32:
+                                lean_inc(n.raw());
+                                emit_const(dst, value::from_float32(lean_float32_of_nat(n.raw())));
+                                return;
+                            case type::UInt8:
+                            case type::UInt16:
+                            case type::UInt32:
+                            case type::USize:
+                                emit_const(dst, lean_usize_of_nat(n.raw()));
+                                return;
+                            case type::UInt64:
+                                emit_const(dst, lean_uint64_of_nat(n.raw()));
+                                return;
+                            // `nat` literal
+                            case type::Object:
+                            case type::Tagged:
+                            case type::TObject:
+                                emit_obj_const(dst, n);
+                                return;
+                            case type::Irrelevant:
+                            case type::Void:
+                            case type::Union:
+                            case type::Struct:
+                                break;
+                        }
+                        emit_throw("invalid instruction");
+                        return;
+                    }
+                    case lit_val_kind::Str:
+                        emit_obj_const(dst, lit_val_str(expr_lit_val(e)));
+                        return;
+                }
+                break;
+            case expr_kind::IsShared:
+                emit(bytecode_op::IsShared); emit(dst); emit_reg(expr_is_shared_obj(e));
+                return;
+            case expr_kind::IsTaggedPtr:
+                emit(bytecode_op::IsTaggedPtr); emit(dst); emit_reg(expr_is_tagged_ptr_obj(e));
+                return;
+        }
+        emit_throw("unexpected instruction kind " + std::to_string(static_cast<unsigned>(expr_tag(e))));
+    }
+
+    /** \brief Is `b` a tail call of the function being lowered, i.e. `let x := f ys; ret x`? */
+    bool is_self_tail_call(fn_body const & b) {
+        expr const & e = fn_body_vdecl_expr(b);
+        fn_body const & cont = fn_body_vdecl_cont(b);
+        return expr_tag(e) == expr_kind::FAp && expr_fap_fun(e) == decl_fun_id(m_fn.m_decl) &&
+            expr_fap_args(e).size() == m_fn.m_param_regs.size() &&
+            fn_body_tag(cont) == fn_body_kind::Ret && !arg_is_irrelevant(fn_body_ret_arg(cont)) &&
+            arg_var_id(fn_body_ret_arg(cont)) == fn_body_vdecl_var(b);
+    }
+
+    void lower_case(fn_body const & b) {
+        array_ref<alt_core> const & alts = fn_body_case_alts(b);
+        // find the first matching alternative for each tag as well as the default alternative, if any
+        size_t num_tags = 0;
+        for (alt_core const & a : alts) {
+            if (alt_core_tag(a) == alt_core_kind::Ctor)
+                num_tags = std::max(num_tags, ctor_info_tag(alt_core_ctor_info(a)).get_small_value() + 1);
+        }
+        buffer<size_t> tag_alt;
+        tag_alt.resize(num_tags, alts.size());
+        size_t default_alt = alts.size();
+        for (size_t i = 0; i < alts.size() && default_alt == alts.size(); i++) {
+            switch (alt_core_tag(alts[i])) {
+                case alt_core_kind::Ctor: {
+                    size_t tag = ctor_info_tag(alt_core_ctor_info(alts[i])).get_small_value();
+                    if (tag_alt[tag] == alts.size())
+                        tag_alt[tag] = i;
+                    break;
+                }
+                case alt_core_kind::Default:
+                    default_alt = i;
+                    break;
+            }
+        }
+        emit(bytecode_op::Case); emit_reg(fn_body_case_var(b)); emit(type_is_scalar(fn_body_case_var_type(b)));
+        emit(num_tags);
+        size_t targets = m_code.size();
+        for (size_t i = 0; i < num_tags + 1; i++) {
+            emit(g_bytecode_no_target);
+        }
+        // emit each alternative that can be reached, and patch the table
+        buffer<size_t> alt_target;
+        alt_target.resize(alts.size(), g_bytecode_no_target);
+        auto target_of = [&](size_t i) {
+            if (i == alts.size())
+                return static_cast<size_t>(g_bytecode_no_target);
+            if (alt_target[i] == g_bytecode_no_target) {
+                alt_target[i] = m_code.size();
+                lower_body(alt_core_tag(alts[i]) == alt_core_kind::Ctor ? alt_core_ctor_cont(alts[i]) :
+                           alt_core_default_cont(alts[i]));
+            }
+            return alt_target[i];
+        };
+        m_code[targets] = target_of(default_alt);
+        for (size_t tag = 0; tag < num_tags; tag++) {
+            m_code[targets + 1 + tag] = target_of(tag_alt[tag] == alts.size() ? default_alt : tag_alt[tag]);
+        }
+    }
+
+    void lower_body(fn_body const & b0) {
+        std::reference_wrapper<fn_body const> b(b0);
+        while (true) {
+            switch (fn_body_tag(b)) {
+                case fn_body_kind::VDecl:
+                    if (is_self_tail_call(b)) {
+                        array_ref<arg> const & args = expr_fap_args(fn_body_vdecl_expr(b));
+                        buffer<uint32> dsts;
+                        for (unsigned r : m_fn.m_param_regs)
+                            dsts.push_back(r);
+                        emit_parallel_move(arg_moves(dsts, args));
+                        emit_irrelevant_moves(dsts, args);
+                        emit(bytecode_op::Loop);
+                        return;
+                    }
+                    lower_expr(reg(fn_body_vdecl_var(b)), fn_body_vdecl_expr(b), fn_body_vdecl_type(b));
+                    b = fn_body_vdecl_cont(b);
+                    break;
+                case fn_body_kind::JDecl: {
+                    // emit the continuation first, which always ends in a terminal instruction, then the join point
+                    size_t j = fn_body_jdecl_id(b).get_small_value();
+                    bool shadows = m_jps.find(j) != m_jps.end();
+                    jp_info & jp = m_jps[j];
+                    jp_info outer = std::move(jp);
+                    jp = jp_info();
+                    for (param const & p : fn_body_jdecl_params(b))
+                        jp.m_params.push_back(reg(param_var(p)));
+                    lower_body(fn_body_jdecl_cont(b));
+                    jp.m_target = m_code.size();
+                    for (size_t pos : jp.m_fixups)
+                        m_code[pos] = jp.m_target;
+                    jp.m_fixups.clear();
+                    lower_body(fn_body_jdecl_body(b));
+                    if (shadows)
+                        jp = std::move(outer);
+                    else
+                        m_jps.erase(j);
+                    return;
+                }
+                case fn_body_kind::Set:
+                    emit(bytecode_op::Set); emit_reg(fn_body_set_var(b)); emit(fn_body_set_idx(b).get_small_value());
+                    emit_arg(fn_body_set_arg(b));
+                    b = fn_body_set_cont(b);
+                    break;
+                case fn_body_kind::SetTag:
+                    emit(bytecode_op::SetTag); emit_reg(fn_body_set_tag_var(b));
+                    emit(fn_body_set_tag_cidx(b).get_small_value());
+                    b = fn_body_set_tag_cont(b);
+                    break;
+                case fn_body_kind::USet:
+                    emit(bytecode_op::USet); emit_reg(fn_body_uset_target(b)); emit(fn_body_uset_idx(b).get_small_value());
+                    emit_reg(fn_body_uset_source(b));
+                    b = fn_body_uset_cont(b);
+                    break;
+                case fn_body_kind::SSet:
+                    switch (fn_body_sset_type(b)) {
+                        case type::Float: case type::Float32: case type::UInt8: case type::UInt16: case type::UInt32:
+                        case type::UInt64:
+                            emit(bytecode_op::SSet); emit_reg(fn_body_sset_target(b));
+                            emit(fn_body_sset_idx(b).get_small_value() * sizeof(void *) +
+                                 fn_body_sset_offset(b).get_small_value());
+                            emit_reg(fn_body_sset_source(b)); emit(fn_body_sset_type(b));
+                            b = fn_body_sset_cont(b);
+                            break;
+                        default:
+                            emit_throw("invalid instruction");
+                            return;
+                    }
+                    break;
+                case fn_body_kind::Inc:
+                    emit(bytecode_op::Inc); emit_reg(fn_body_inc_var(b)); emit(fn_body_inc_val(b).get_small_value());
+                    b = fn_body_inc_cont(b);
+                    break;
+                case fn_body_kind::Dec:
+                    emit(bytecode_op::Dec); emit_reg(fn_body_dec_var(b)); emit(fn_body_dec_val(b).get_small_value());
+                    b = fn_body_dec_cont(b);
+                    break;
+                case fn_body_kind::Del:
+                    emit(bytecode_op::Del); emit_reg(fn_body_del_var(b));
+                    b = fn_body_del_cont(b);
+                    break;
+                case fn_body_kind::Case:
+                    lower_case(b);
+                    return;
+                case fn_body_kind::Ret:
+                    emit(bytecode_op::Ret); emit_arg(fn_body_ret_arg(b));
+                    return;
+                case fn_body_kind::Jmp: {
+                    auto it = m_jps.find(fn_body_jmp_jp(b).get_small_value());
+                    if (it == m_jps.end() || it->second.m_params.size() != fn_body_jmp_args(b).size()) {
+                        throw exception(sstream() << "(interpreter) invalid jump in IR of '" << decl_fun_id(m_fn.m_decl) << "'");
+                    }
+                    jp_info & jp = it->second;
+                    buffer<uint32> dsts;
+                    for (uint32 r : jp.m_params)
+                        dsts.push_back(r);
+                    emit_parallel_move(arg_moves(dsts, fn_body_jmp_args(b)));
+                    emit_irrelevant_moves(dsts, fn_body_jmp_args(b));
+                    emit_jump_to(jp);
+                    return;
+                }
+                case fn_body_kind::Unreachable:
+                    emit_throw("unreachable code");
+                    return;
+            }
+        }
+    }
+
+public:
+    explicit bytecode_compiler(bytecode_fn & fn) : m_fn(fn), m_code(fn.m_code) {}
+
+    void operator()() {
+        array_ref<param> const & params = decl_params(m_fn.m_decl);
+        for (size_t i = 0; i < params.size(); i++) {
+            uint32 r = reg(param_var(params[i]));
+            m_fn.m_param_regs.push_back(r);
+            m_fn.m_canonical_params = m_fn.m_canonical_params && r == i;
+        }
+        lower_body(decl_fun_body(m_fn.m_decl));
+        m_fn.m_irrelevant_reg = m_num_vars;
+        m_fn.m_num_regs = m_num_vars + 1 + m_num_scratch;
+        for (size_t pos : m_irrelevant_fixups)
+            m_code[pos] = m_fn.m_irrelevant_reg;
+        for (size_t pos : m_scratch_fixups)
+            m_code[pos] += m_fn.m_irrelevant_reg + 1;
+    }
+};
+
+/** \brief Collect the functions that are applied or partially applied in `b`. */
+static void collect_used_fns(fn_body const & b0, buffer<name> & fns) {
+    std::reference_wrapper<fn_body const> b(b0);
+    while (true) {
+        switch (fn_body_tag(b)) {
+            case fn_body_kind::VDecl: {
+                expr const & e = fn_body_vdecl_expr(b);
+                if (expr_tag(e) == expr_kind::FAp) {
+                    fns.push_back(expr_fap_fun(e));
+                } else if (expr_tag(e) == expr_kind::PAp) {
+                    fns.push_back(expr_pap_fun(e));
+                }
+                b = fn_body_vdecl_cont(b);
+                break;
+            }
+            case fn_body_kind::JDecl:
+                collect_used_fns(fn_body_jdecl_body(b), fns);
+                b = fn_body_jdecl_cont(b);
+                break;
+            case fn_body_kind::Set: b = fn_body_set_cont(b); break;
+            case fn_body_kind::SetTag: b = fn_body_set_tag_cont(b); break;
+            case fn_body_kind::USet: b = fn_body_uset_cont(b); break;
+            case fn_body_kind::SSet: b = fn_body_sset_cont(b); break;
+            case fn_body_kind::Inc: b = fn_body_inc_cont(b); break;
+            case fn_body_kind::Dec: b = fn_body_dec_cont(b); break;
+            case fn_body_kind::Del: b = fn_body_del_cont(b); break;
+            case fn_body_kind::Case:
+                for (alt_core const & a : fn_body_case_alts(b)) {
+                    collect_used_fns(alt_core_tag(a) == alt_core_kind::Ctor ? alt_core_ctor_cont(a) : alt_core_default_cont(a), fns);
+                }
+                return;
+            case fn_body_kind::Ret:
+            case fn_body_kind::Jmp:
+            case fn_body_kind::Unreachable:
+                return;
+        }
+    }
+}
+
 class interpreter {
     // stack of IR variable slots
     std::vector<value> m_arg_stack;
@@ -389,20 +1084,18 @@ class interpreter {
     options const & m_opts;
     // if `false`, use IR code where possible
     bool m_prefer_native;
-    struct constant_cache_entry {
-      bool m_is_scalar;
-      value m_val;
-    };
     // caches values of nullary functions ("constants")
     name_hash_map<constant_cache_entry> m_constant_cache;
-    struct symbol_cache_entry {
-        // looking up IR from .oleans is slow enough to warrant its own cache; but as local IR can
-        // be backtracked, this cache needs to be local as well.
-        decl m_decl;
-        native_symbol_cache_entry m_native;
-    };
     // caches symbol lookup successes _and_ failures
     name_hash_map<symbol_cache_entry> m_symbol_cache;
+    // caches for imported declarations shared with other interpreters; `nullptr` if there are no imports
+    std::shared_ptr<imported_cache> m_imported_cache;
+    // if `true`, lower IR to bytecode before executing it
+    bool m_bytecode;
+    // caches bytecode by (the address of) the IR declaration it was lowered from
+    lean::unordered_map<object *, std::unique_ptr<bytecode_fn>> m_bytecode_cache;
+    // number of interpreted calls after which a function is compiled to native code; 0 if disabled
+    unsigned m_jit_threshold;
 
     /** \brief Get current stack frame */
     inline frame & get_frame() {
@@ -423,13 +1116,16 @@ class interpreter {
 public:
     template<class T>
     static inline T with_interpreter(elab_environment const & env, options const & opts, name const & fn, std::function<T(interpreter &)> const & f) {
+        // an exception thrown by `f` skips the `pop_frame`s of the functions it has entered
+        sampling_profiler_scope profiler_scope;
         if (g_interpreter && is_eqp(g_interpreter->m_env, env) && is_eqp(g_interpreter->m_opts, opts)) {
             return f(*g_interpreter);
         } else {
             // We changed threads or the closure was stored and called in a different context.
             time_task t("interpretation", opts, fn);
             scope_trace_env scope_trace(env, opts);
-            // the caches contain data from the Environment, so we cannot reuse them when changing it
+            // the caches contain data from the Environment, so we cannot reuse them when changing it; caches of
+            // imported data are shared between interpreters with the same imports, however
             interpreter interp(env, opts);
             flet<interpreter *> fl(g_interpreter, &interp);
             return f(interp);
@@ -790,24 +1486,367 @@ private:
         }
     }
 
+    /** \brief Return the (cached) bytecode of `d`. */
+    bytecode_fn & get_bytecode(decl const & d) {
+        auto it = m_bytecode_cache.find(d.raw());
+        if (it != m_bytecode_cache.end()) {
+            return *it->second;
+        }
+        std::unique_ptr<bytecode_fn> fn(new bytecode_fn(d));
+        bytecode_compiler compile(*fn);
+        compile();
+        return *m_bytecode_cache.insert({ d.raw(), std::move(fn) }).first->second;
+    }
+
+    /** \brief Evaluate the body of `d` in the current frame, after its arguments have been pushed. */
+    value eval_decl_body(decl const & d) {
+        if (!m_bytecode) {
+            return eval_body(decl_fun_body(d));
+        }
+        bytecode_fn & fn = get_bytecode(d);
+        size_t bp = get_frame().m_arg_bp;
+        lean_assert(m_arg_stack.size() - bp == fn.m_param_regs.size());
+        if (!fn.m_canonical_params) {
+            size_t n = fn.m_param_regs.size();
+            value * args = static_cast<value *>(LEAN_ALLOCA(n * sizeof(value))); // NOLINT
+            std::copy(m_arg_stack.begin() + bp, m_arg_stack.end(), args);
+            m_arg_stack.resize(bp + fn.m_num_regs);
+            for (size_t i = 0; i < n; i++) {
+                m_arg_stack[bp + fn.m_param_regs[i]] = args[i];
+            }
+        } else {
+            m_arg_stack.resize(bp + fn.m_num_regs);
+        }
+        m_arg_stack[bp + fn.m_irrelevant_reg] = box(0);
+        return run_bytecode(fn, bp);
+    }
+
+    /** \brief Resolve the callee of a call site on its first execution. */
+    symbol_cache_entry & resolve(bytecode_call_site & site) {
+        if (!site.m_entry) {
+            site.m_entry = &lookup_symbol(site.m_fn);
+        }
+        return *site.m_entry;
+    }
+
+    bytecode_fn & resolve_code(bytecode_call_site & site) {
+        if (!site.m_code) {
+            check_not_extern(site.m_fn, site.m_entry->m_decl);
+            site.m_code = &get_bytecode(site.m_entry->m_decl);
+        }
+        return *site.m_code;
+    }
+
+    object * alloc_ctor(bytecode_ctor const & c, value const * regs, uint32 const * args, size_t n) {
+        if (c.m_num_objs == 0 && c.m_scalar_sz == 0) {
+            return box(c.m_tag);
+        }
+        object * o = alloc_cnstr(c.m_tag, c.m_num_objs, c.m_scalar_sz);
+        for (size_t i = 0; i < n; i++) {
+            cnstr_set(o, i, regs[args[i]].m_obj);
+        }
+        return o;
+    }
+
+    /** \brief Execute the bytecode of `fn` in the frame at `bp`, whose registers have been allocated and whose
+        parameters have been set. */
+    value run_bytecode(bytecode_fn & fn, size_t bp) {
+        check_system();
+        uint32 const * const code = fn.m_code.data();
+        uint32 const * pc = code;
+        // must be reloaded after anything that may reenter the interpreter and thus resize `m_arg_stack`
+        value * regs = m_arg_stack.data() + bp;
+        // allocated once instead of per instruction so that `Loop` does not grow the native stack
+        value * vals = static_cast<value *>(LEAN_ALLOCA(fn.m_max_args * sizeof(value))); // NOLINT
+        object ** objs = static_cast<object **>(LEAN_ALLOCA(fn.m_max_args * sizeof(object *))); // NOLINT
+#define BC_RELOAD() (regs = m_arg_stack.data() + bp)
+#ifdef LEAN_BYTECODE_THREADED
+        // must be in the order of `bytecode_op`
+        static void * const s_labels[] = {
+            &&op_Ctor, &&op_Reset, &&op_Reuse, &&op_Proj, &&op_UProj, &&op_SProj, &&op_FAp, &&op_Load, &&op_PAp,
+            &&op_Ap, &&op_Box, &&op_Unbox, &&op_Const, &&op_LitObj, &&op_IsShared, &&op_IsTaggedPtr, &&op_Move,
+            &&op_Set, &&op_SetTag, &&op_USet, &&op_SSet, &&op_Inc, &&op_Dec, &&op_Del, &&op_Case, &&op_Jmp,
+            &&op_Loop, &&op_Ret, &&op_Throw };
+        static_assert(sizeof(s_labels) / sizeof(s_labels[0]) == static_cast<size_t>(bytecode_op::Throw) + 1,
+                      "missing bytecode instruction label");
+#define BC_OP(op) op_##op
+#define BC_NEXT() goto *s_labels[*pc]
+        BC_NEXT();
+        {
+#else
+#define BC_OP(op) case bytecode_op::op
+#define BC_NEXT() goto dispatch
+    dispatch:
+        switch (static_cast<bytecode_op>(*pc)) {
+#endif
+        BC_OP(Ctor): {
+            uint32 n = pc[3];
+            regs[pc[1]] = alloc_ctor(fn.m_ctors[pc[2]], regs, pc + 4, n);
+            pc += 4 + n;
+            BC_NEXT();
+        }
+        BC_OP(Reset): { // release fields if unique reference in preparation for `Reuse` below
+            object * o = regs[pc[2]].m_obj;
+            if (is_exclusive(o)) {
+                for (uint32 i = 0; i < pc[3]; i++) {
+                    cnstr_release(o, i);
+                }
+                BC_RELOAD();
+                regs[pc[1]] = o;
+            } else {
+                dec_ref(o);
+                BC_RELOAD();
+                regs[pc[1]] = box(0);
+            }
+            pc += 4;
+            BC_NEXT();
+        }
+        BC_OP(Reuse): { // reuse dead allocation if possible
+            object * o = regs[pc[2]].m_obj;
+            bytecode_ctor const & c = fn.m_ctors[pc[3]];
+            uint32 n = pc[5];
+            if (is_scalar(o)) {
+                // `Reset` did not have a unique reference, fall back to regular allocation
+                o = alloc_ctor(c, regs, pc + 6, n);
+            } else {
+                if (pc[4]) {
+                    cnstr_set_tag(o, c.m_tag);
+                }
+                for (uint32 i = 0; i < n; i++) {
+                    cnstr_set(o, i, regs[pc[6 + i]].m_obj);
+                }
+            }
+            regs[pc[1]] = o;
+            pc += 6 + n;
+            BC_NEXT();
+        }
+        BC_OP(Proj):
+            regs[pc[1]] = cnstr_get(regs[pc[2]].m_obj, pc[3]);
+            pc += 4;
+            BC_NEXT();
+        BC_OP(UProj):
+            regs[pc[1]] = cnstr_get_usize(regs[pc[2]].m_obj, pc[3]);
+            pc += 4;
+            BC_NEXT();
+        BC_OP(SProj): {
+            object * o = regs[pc[2]].m_obj;
+            uint32 offset = pc[3];
+            value v;
+            switch (static_cast<type>(pc[4])) {
+                case type::Float: v = value::from_float(cnstr_get_float(o, offset)); break;
+                case type::Float32: v = value::from_float32(cnstr_get_float32(o, offset)); break;
+                case type::UInt8: v = cnstr_get_uint8(o, offset); break;
+                case type::UInt16: v = cnstr_get_uint16(o, offset); break;
+                case type::UInt32: v = cnstr_get_uint32(o, offset); break;
+                default: v = cnstr_get_uint64(o, offset); break;
+            }
+            regs[pc[1]] = v;
+            pc += 5;
+            BC_NEXT();
+        }
+        BC_OP(FAp): { // saturated application of top-level function
+            bytecode_call_site & site = fn.m_sites[pc[2]];
+            symbol_cache_entry & e = resolve(site);
+            uint32 n = pc[3];
+            uint32 const * args = pc + 4;
+            value r;
+            if (e.m_native.m_addr || jit_if_hot(site.m_fn, e)) {
+                for (uint32 i = 0; i < n; i++) {
+                    vals[i] = regs[args[i]];
+                }
+                r = call_native(e, n, vals);
+            } else {
+                bytecode_fn & callee = resolve_code(site);
+                size_t callee_bp = m_arg_stack.size();
+                m_arg_stack.resize(callee_bp + callee.m_num_regs);
+                BC_RELOAD();
+                value * callee_regs = m_arg_stack.data() + callee_bp;
+                for (uint32 i = 0; i < n; i++) {
+                    callee_regs[callee.m_param_regs[i]] = regs[args[i]];
+                }
+                callee_regs[callee.m_irrelevant_reg] = box(0);
+                push_frame(callee.m_decl, callee_bp);
+                r = run_bytecode(callee, callee_bp);
+                pop_frame(r, decl_type(callee.m_decl));
+            }
+            BC_RELOAD();
+            regs[pc[1]] = r;
+            pc += 4 + n;
+            BC_NEXT();
+        }
+        BC_OP(Load): { // nullary function ("constant")
+            bytecode_call_site & site = fn.m_sites[pc[2]];
+            value v;
+            if (site.m_const) {
+                v = site.m_const->m_val;
+                if (!site.m_const->m_is_scalar) {
+                    inc(v.m_obj);
+                }
+            } else {
+                v = load(site.m_fn, static_cast<type>(pc[3]));
+                BC_RELOAD();
+                site.m_const = find_cached_constant(site.m_fn);
+            }
+            regs[pc[1]] = v;
+            pc += 4;
+            BC_NEXT();
+        }
+        BC_OP(PAp): { // partial application of top-level function
+            bytecode_call_site & site = fn.m_sites[pc[2]];
+            symbol_cache_entry & e = resolve(site);
+            uint32 n = pc[3];
+            uint32 const * args = pc + 4;
+            object * cls;
+            if (e.m_native.m_addr) {
+                // point closure directly at native symbol
+                cls = alloc_closure(e.m_native.m_addr, decl_params(e.m_decl).size(), n);
+                for (uint32 i = 0; i < n; i++) {
+                    closure_set(cls, i, regs[args[i]].m_obj);
+                }
+            } else {
+                // point closure at interpreter stub
+                for (uint32 i = 0; i < n; i++) {
+                    objs[i] = regs[args[i]].m_obj;
+                }
+                cls = mk_stub_closure(e.m_decl, n, objs);
+            }
+            regs[pc[1]] = cls;
+            pc += 4 + n;
+            BC_NEXT();
+        }
+        BC_OP(Ap): { // application of closure; mostly handled by runtime
+            uint32 n = pc[3];
+            for (uint32 i = 0; i < n; i++) {
+                objs[i] = regs[pc[4 + i]].m_obj;
+            }
+            object * r = apply_n(regs[pc[2]].m_obj, n, objs);
+            BC_RELOAD();
+            regs[pc[1]] = r;
+            pc += 4 + n;
+            BC_NEXT();
+        }
+        BC_OP(Box):
+            regs[pc[1]] = box_t(regs[pc[2]], static_cast<type>(pc[3]));
+            pc += 4;
+            BC_NEXT();
+        BC_OP(Unbox):
+            regs[pc[1]] = unbox_t(regs[pc[2]].m_obj, static_cast<type>(pc[3]));
+            pc += 4;
+            BC_NEXT();
+        BC_OP(Const):
+            regs[pc[1]] = fn.m_consts[pc[2]];
+            pc += 3;
+            BC_NEXT();
+        BC_OP(LitObj):
+            regs[pc[1]] = fn.m_obj_consts[pc[2]].to_obj_arg();
+            pc += 3;
+            BC_NEXT();
+        BC_OP(IsShared):
+            regs[pc[1]] = static_cast<uint64>(!is_exclusive(regs[pc[2]].m_obj));
+            pc += 3;
+            BC_NEXT();
+        BC_OP(IsTaggedPtr):
+            regs[pc[1]] = static_cast<uint64>(!is_scalar(regs[pc[2]].m_obj));
+            pc += 3;
+            BC_NEXT();
+        BC_OP(Move):
+            regs[pc[1]] = regs[pc[2]];
+            pc += 3;
+            BC_NEXT();
+        BC_OP(Set): // set boxed field of unique reference
+            lean_assert(is_exclusive(regs[pc[1]].m_obj));
+            cnstr_set(regs[pc[1]].m_obj, pc[2], regs[pc[3]].m_obj);
+            pc += 4;
+            BC_NEXT();
+        BC_OP(SetTag): // set constructor tag of unique reference
+            lean_assert(is_exclusive(regs[pc[1]].m_obj));
+            cnstr_set_tag(regs[pc[1]].m_obj, pc[2]);
+            pc += 3;
+            BC_NEXT();
+        BC_OP(USet): // set USize field of unique reference
+            lean_assert(is_exclusive(regs[pc[1]].m_obj));
+            cnstr_set_usize(regs[pc[1]].m_obj, pc[2], regs[pc[3]].m_num);
+            pc += 4;
+            BC_NEXT();
+        BC_OP(SSet): { // set other unboxed field of unique reference
+            object * o = regs[pc[1]].m_obj;
+            uint32 offset = pc[2];
+            value v = regs[pc[3]];
+            lean_assert(is_exclusive(o));
+            switch (static_cast<type>(pc[4])) {
+                case type::Float: cnstr_set_float(o, offset, v.m_float); break;
+                case type::Float32: cnstr_set_float32(o, offset, v.m_float32); break;
+                case type::UInt8: cnstr_set_uint8(o, offset, v.m_num); break;
+                case type::UInt16: cnstr_set_uint16(o, offset, v.m_num); break;
+                case type::UInt32: cnstr_set_uint32(o, offset, v.m_num); break;
+                default: cnstr_set_uint64(o, offset, v.m_num); break;
+            }
+            pc += 5;
+            BC_NEXT();
+        }
+        BC_OP(Inc):
+            inc(regs[pc[1]].m_obj, pc[2]);
+            pc += 3;
+            BC_NEXT();
+        BC_OP(Dec):
+            for (uint32 i = 0; i < pc[2]; i++) {
+                dec(regs[pc[1]].m_obj);
+            }
+            BC_RELOAD();
+            pc += 3;
+            BC_NEXT();
+        BC_OP(Del):
+            lean_free_object(regs[pc[1]].m_obj);
+            pc += 2;
+            BC_NEXT();
+        BC_OP(Case): { // branch according to constructor tag
+            value v = regs[pc[1]];
+            unsigned tag = pc[2] ? static_cast<unsigned>(v.m_num) : lean_obj_tag(v.m_obj);
+            uint32 target = tag < pc[3] ? pc[5 + tag] : pc[4];
+            if (target == g_bytecode_no_target) {
+                throw exception("incomplete case");
+            }
+            pc = code + target;
+            BC_NEXT();
+        }
+        BC_OP(Jmp):
+            pc = code + pc[1];
+            BC_NEXT();
+        BC_OP(Loop):
+            check_system();
+            pc = code;
+            BC_NEXT();
+        BC_OP(Ret):
+            return regs[pc[1]];
+        BC_OP(Throw):
+            throw exception(fn.m_errors[pc[1]]);
+        }
+#undef BC_NEXT
+#undef BC_OP
+#undef BC_RELOAD
+        lean_unreachable();
+    }
+
     // specify argument base pointer explicitly because we've usually already pushed some function arguments
     void push_frame(decl const & d, size_t arg_bp) {
         DEBUG_CODE({
             lean_trace(name({"interpreter", "call"}),
                        tout() << std::string(m_call_stack.size(), ' ')
                               << decl_fun_id(d);
-                       for (size_t i = arg_bp; i < m_arg_stack.size(); i++) {
+                       for (size_t i = arg_bp; i < std::min(m_arg_stack.size(), arg_bp + decl_params(d).size()); i++) {
                            tout() << " "; print_value(tout(), m_arg_stack[i], param_type(decl_params(d)[i - arg_bp]));
                        }
                        tout() << "\n";);
         });
         m_call_stack.emplace_back(decl_fun_id(d), arg_bp, m_jp_stack.size());
+        sampling_profiler_enter(decl_fun_id(d), __builtin_frame_address(0));
     }
 
     void pop_frame(value DEBUG_CODE(r), type DEBUG_CODE(t)) {
         m_arg_stack.resize(get_frame().m_arg_bp);
         m_jp_stack.resize(get_frame().m_jp_bp);
         m_call_stack.pop_back();
+        sampling_profiler_leave();
         DEBUG_CODE({
             lean_trace(name({"interpreter", "call"}),
                        tout() << std::string(m_call_stack.size(), ' ')
@@ -818,7 +1857,7 @@ private:
     }
 
     /** \brief Return cached lookup result for given unmangled function name in the current binary. */
-    symbol_cache_entry lookup_symbol(name const & fn) {
+    symbol_cache_entry & lookup_symbol(name const & fn) {
         auto e = m_symbol_cache.find(fn);
         if (e != m_symbol_cache.end()) {
             return e->second;
@@ -827,16 +1866,14 @@ private:
         auto ne = g_native_symbol_cache->find(fn);
         if (ne != g_native_symbol_cache->end()) {
             symbol_cache_entry e_new { get_decl(fn), ne->second };
-            m_symbol_cache.insert({ fn, e_new });
-            return e_new;
+            return insert_symbol(fn, e_new);
         }
         lock.unlock();
         std::unique_lock<std::shared_timed_mutex> unique_lock(*g_native_symbol_cache_mutex);
         ne = g_native_symbol_cache->find(fn);
         if (ne != g_native_symbol_cache->end()) {
             symbol_cache_entry e_new { get_decl(fn), ne->second };
-            m_symbol_cache.insert({ fn, e_new });
-            return e_new;
+            return insert_symbol(fn, e_new);
         }
         symbol_cache_entry e_new { get_decl(fn), {nullptr, false} };
         if (m_prefer_native || decl_tag(e_new.m_decl) == decl_kind::Extern || has_init_attribute(m_env, fn)) {
@@ -858,12 +1895,119 @@ private:
             }
         }
         g_native_symbol_cache->insert({ fn, e_new.m_native });
-        m_symbol_cache.insert({ fn, e_new });
-        return e_new;
+        return insert_symbol(fn, e_new);
+    }
+
+    symbol_cache_entry & insert_symbol(name const & fn, symbol_cache_entry & e) {
+        if (!e.m_native.m_addr && m_jit_threshold) {
+            // reuse code compiled by other interpreters
+            std::lock_guard<std::mutex> lock(*g_jit_cache_mutex);
+            auto it = g_jit_cache->find(e.m_decl.raw());
+            if (it != g_jit_cache->end()) {
+                e.m_native = it->second.m_native;
+                // do not try again if compilation failed
+                e.m_num_calls = m_jit_threshold;
+            }
+        }
+        return m_symbol_cache.insert({ fn, e }).first->second;
+    }
+
+    /** \brief Count an interpreted call of the function of `e` and try to compile it to native code when it reaches
+        the JIT threshold. Returns true iff `e` now refers to native code. */
+    bool jit_if_hot(name const & fn, symbol_cache_entry & e) {
+        if (m_jit_threshold == 0 || ++e.m_num_calls != m_jit_threshold) {
+            return false;
+        }
+        e.m_native = jit(fn, e.m_decl);
+        return e.m_native.m_addr != nullptr;
+    }
+
+    /** \brief Return the symbol under which the unboxed version of `fn` is compiled; see also `toCName`. */
+    std::string get_symbol_name(name const & fn) {
+        if (optional<name> n = get_export_name_for(m_env, fn)) {
+            return n->get_string().to_std_string();
+        }
+        return get_symbol_stem(m_env, fn).to_std_string();
+    }
+
+    /** \brief Add `d` as well as all interpreted functions it uses to `decls`, which must be compiled together. */
+    void collect_jit_decls(decl const & d, name_hash_set & visited, buffer<decl> & decls) {
+        decls.push_back(d);
+        buffer<name> fns;
+        collect_used_fns(decl_fun_body(d), fns);
+        for (name const & fn : fns) {
+            if (visited.count(fn)) {
+                continue;
+            }
+            visited.insert(fn);
+            decl d_fn = get_decl(fn);
+            if (decl_tag(d_fn) == decl_kind::Extern || lookup_symbol_in_cur_exe(get_symbol_name(fn).c_str())) {
+                // references are resolved by the JIT linker
+                continue;
+            }
+            if (decl_params(d_fn).size() == 0 || has_init_attribute(m_env, fn)) {
+                // would have to be initialized by the JIT-compiled code
+                throw exception(sstream() << "(JIT) cannot compile use of interpreted constant '" << fn << "'");
+            }
+            collect_jit_decls(d_fn, visited, decls);
+        }
+    }
+
+    /** \brief Compile `d`, the declaration of `fn`, and all interpreted functions it uses to native code. */
+    native_symbol_cache_entry jit(name const & fn, decl const & d) {
+        {
+            std::lock_guard<std::mutex> lock(*g_jit_cache_mutex);
+            auto it = g_jit_cache->find(d.raw());
+            if (it != g_jit_cache->end()) {
+                return it->second.m_native;
+            }
+        }
+        native_symbol_cache_entry r { nullptr, false };
+        try {
+            if (decl_params(d).size() == 0 || has_init_attribute(m_env, fn)) {
+                throw exception("(JIT) can only compile functions");
+            }
+            name_hash_set visited;
+            visited.insert(fn);
+            buffer<decl> decls;
+            collect_jit_decls(d, visited, decls);
+            std::string sym;
+            // prefer the boxed version, like `lookup_symbol`
+            if (option_ref<decl> d_boxed = find_ir_decl_boxed(m_env, fn)) {
+                name fn_boxed = decl_fun_id(*d_boxed.get());
+                if (!visited.count(fn_boxed)) {
+                    visited.insert(fn_boxed);
+                    collect_jit_decls(*d_boxed.get(), visited, decls);
+                }
+                sym = get_symbol_stem(m_env, fn).to_std_string() + g_boxed_mangled_suffix->to_std_string();
+                r.m_boxed = true;
+            } else {
+                sym = get_symbol_name(fn);
+            }
+            time_task t("JIT compilation", m_opts, fn);
+            r.m_addr = jit_compile(m_env, array_ref<decl>(decls), sym);
+        } catch (exception & ex) {
+            r.m_boxed = false;
+            lean_trace(name({"interpreter", "jit"}), tout() << "failed to compile '" << fn << "': " << ex.what() << "\n";);
+        }
+        std::lock_guard<std::mutex> lock(*g_jit_cache_mutex);
+        return g_jit_cache->insert({ d.raw(), jit_cache_entry { d, r } }).first->second.m_native;
     }
 
     /** \brief Retrieve Lean declaration from elab_environment. */
     decl get_decl(name const & fn) {
+        if (m_imported_cache) {
+            std::shared_lock<std::shared_timed_mutex> lock(m_imported_cache->m_mutex);
+            auto it = m_imported_cache->m_decls.find(fn);
+            if (it != m_imported_cache->m_decls.end()) {
+                return it->second;
+            }
+            lock.unlock();
+            if (option_ref<decl> d = find_imported_ir_decl(m_env, fn)) {
+                std::unique_lock<std::shared_timed_mutex> unique_lock(m_imported_cache->m_mutex);
+                return m_imported_cache->m_decls.insert({ fn, d.get().value() }).first->second;
+            }
+        }
         option_ref<decl> d = find_ir_decl(m_env, fn);
         if (!d) {
             throw exception(sstream() << "(interpreter) unknown declaration '" << fn << "'");
@@ -871,6 +2015,29 @@ private:
         return d.get().value();
     }
 
+    /** \brief Return true iff `fn` is an imported declaration whose IR has been looked up before. */
+    bool is_cached_imported_decl(name const & fn) {
+        std::shared_lock<std::shared_timed_mutex> lock(m_imported_cache->m_mutex);
+        return m_imported_cache->m_decls.find(fn) != m_imported_cache->m_decls.end();
+    }
+
+    /** \brief Return the cache entry of the constant `fn` if it has been evaluated. Entries are never removed while
+        the interpreter is alive, so the result can be cached. */
+    constant_cache_entry const * find_cached_constant(name const & fn) {
+        auto it = m_constant_cache.find(fn);
+        if (it != m_constant_cache.end()) {
+            return &it->second;
+        }
+        if (m_imported_cache) {
+            std::shared_lock<std::shared_timed_mutex> lock(m_imported_cache->m_mutex);
+            auto imported_it = m_imported_cache->m_constants.find(fn);
+            if (imported_it != m_imported_cache->m_constants.end()) {
+                return &imported_it->second;
+            }
+        }
+        return nullptr;
+    }
+
     /** \brief Evaluate nullary function ("constant"). */
     value load(name const & fn, type t) {
         auto cached_entry = m_constant_cache.find(fn);
@@ -881,6 +2048,17 @@ private:
             }
             return cached.m_val;
         }
+        if (m_imported_cache) {
+            std::shared_lock<std::shared_timed_mutex> lock(m_imported_cache->m_mutex);
+            auto it = m_imported_cache->m_constants.find(fn);
+            if (it != m_imported_cache->m_constants.end()) {
+                auto cached = it->second;
+                if (!cached.m_is_scalar) {
+                    inc(cached.m_val.m_obj);
+                }
+                return cached.m_val;
+            }
+        }
         auto o_entry = g_init_globals->find(fn);
         if (o_entry != g_init_globals->end()) {
             // persistent, so no `inc` needed
@@ -923,59 +2101,89 @@ private:
         // initializer, suggesting some incorrect `meta` phase setup. Let's make sure we give a
         // better signal than a segfault in that case.
         lean_always_assert(fn_body_tag(decl_fun_body(e.m_decl)) != fn_body_kind::Unreachable);
-        value r = eval_body(decl_fun_body(e.m_decl));
+        value r = eval_decl_body(e.m_decl);
         pop_frame(r, decl_type(e.m_decl));
+        if (m_imported_cache && is_cached_imported_decl(fn)) {
+            if (!type_is_scalar(t)) {
+                // the value may now be shared with other threads
+                mark_mt(r.m_obj);
+            }
+            std::unique_lock<std::shared_timed_mutex> lock(m_imported_cache->m_mutex);
+            auto it = m_imported_cache->m_constants.insert({ fn, constant_cache_entry { type_is_scalar(t), r } });
+            if (!it.second) {
+                // evaluated concurrently by another interpreter; use its value
+                if (!type_is_scalar(t)) {
+                    dec(r.m_obj);
+                }
+                r = it.first->second.m_val;
+            }
+        } else {
+            m_constant_cache.insert({ fn, constant_cache_entry { type_is_scalar(t), r } });
+        }
         if (!type_is_scalar(t)) {
             inc(r.m_obj);
         }
-        m_constant_cache.insert({ fn, constant_cache_entry { type_is_scalar(t), r } });
         return r;
     }
 
+    /** \brief Call the native code of `e` with the (unboxed) arguments `args`. */
+    value call_native(symbol_cache_entry const & e, size_t n, value const * args) {
+        object ** args2 = static_cast<object **>(LEAN_ALLOCA(n * sizeof(object *))); // NOLINT
+        for (size_t i = 0; i < n; i++) {
+            type t = param_type(decl_params(e.m_decl)[i]);
+            args2[i] = box_t(args[i], t);
+            if (e.m_native.m_boxed && param_borrow(decl_params(e.m_decl)[i])) {
+                // NOTE: If we chose the boxed version where the IR chose the unboxed one, we need to manually increment
+                // originally borrowed parameters because the wrapper will decrement these after the call.
+                // Basically the wrapper is more homogeneous (removing both unboxed and borrowed parameters) than we
+                // would need in this instance.
+                inc(args2[i]);
+            }
+        }
+        push_frame(e.m_decl, m_arg_stack.size());
+        object * o = curry(e.m_native.m_addr, n, args2);
+        type t = decl_type(e.m_decl);
+        value r;
+        if (type_is_scalar(t)) {
+            lean_assert(e.m_native.m_boxed);
+            // NOTE: this unboxing does not exist in the IR, so we should manually consume `o`
+            r = unbox_t(o, t);
+            lean_dec(o);
+        } else {
+            r = o;
+        }
+        pop_frame(r, t);
+        return r;
+    }
+
+    void check_not_extern(name const & fn, decl const & d) {
+        if (decl_tag(d) == decl_kind::Extern) {
+            string_ref mangled = get_symbol_stem(m_env, fn);
+            string_ref boxed_mangled(string_append(mangled.to_obj_arg(), g_boxed_mangled_suffix->raw()));
+            throw exception(sstream() << "Could not find native implementation of external declaration '" << fn
+                                      << "' (symbols '" << boxed_mangled.data() << "' or '" << mangled.data() << "').\n"
+                                      << "For declarations from `Init`, `Std`, or `Lean`, you need to set `supportInterpreter := true` "
+                                      << "in the relevant `lean_exe` statement in your `lakefile.lean`.");
+        }
+    }
+
     value call(name const & fn, array_ref<arg> const & args) {
         size_t old_size = m_arg_stack.size();
-        value r;
-        symbol_cache_entry e = lookup_symbol(fn);
-        if (e.m_native.m_addr) {
-            object ** args2 = static_cast<object **>(LEAN_ALLOCA(args.size() * sizeof(object *))); // NOLINT
+        symbol_cache_entry & e = lookup_symbol(fn);
+        if (e.m_native.m_addr || jit_if_hot(fn, e)) {
+            value * args2 = static_cast<value *>(LEAN_ALLOCA(args.size() * sizeof(value))); // NOLINT
             for (size_t i = 0; i < args.size(); i++) {
-                type t = param_type(decl_params(e.m_decl)[i]);
-                args2[i] = box_t(eval_arg(args[i]), t);
-                if (e.m_native.m_boxed && param_borrow(decl_params(e.m_decl)[i])) {
-                    // NOTE: If we chose the boxed version where the IR chose the unboxed one, we need to manually increment
-                    // originally borrowed parameters because the wrapper will decrement these after the call.
-                    // Basically the wrapper is more homogeneous (removing both unboxed and borrowed parameters) than we
-                    // would need in this instance.
-                    inc(args2[i]);
-                }
-            }
-            push_frame(e.m_decl, old_size);
-            object * o = curry(e.m_native.m_addr, args.size(), args2);
-            type t = decl_type(e.m_decl);
-            if (type_is_scalar(t)) {
-                lean_assert(e.m_native.m_boxed);
-                // NOTE: this unboxing does not exist in the IR, so we should manually consume `o`
-                r = unbox_t(o, t);
-                lean_dec(o);
-            } else {
-                r = o;
-            }
-        } else {
-            if (decl_tag(e.m_decl) == decl_kind::Extern) {
-                string_ref mangled = get_symbol_stem(m_env, fn);
-                string_ref boxed_mangled(string_append(mangled.to_obj_arg(), g_boxed_mangled_suffix->raw()));
-                throw exception(sstream() << "Could not find native implementation of external declaration '" << fn
-                                          << "' (symbols '" << boxed_mangled.data() << "' or '" << mangled.data() << "').\n"
-                                          << "For declarations from `Init`, `Std`, or `Lean`, you need to set `supportInterpreter := true` "
-                                          << "in the relevant `lean_exe` statement in your `lakefile.lean`.");
-            }
-            // evaluate args in old stack frame
-            for (const auto & arg : args) {
-                m_arg_stack.push_back(eval_arg(arg));
+                args2[i] = eval_arg(args[i]);
             }
-            push_frame(e.m_decl, old_size);
-            r = eval_body(decl_fun_body(e.m_decl));
+            return call_native(e, args.size(), args2);
+        }
+        check_not_extern(fn, e.m_decl);
+        // evaluate args in old stack frame
+        for (const auto & arg : args) {
+            m_arg_stack.push_back(eval_arg(arg));
         }
+        push_frame(e.m_decl, old_size);
+        value r = eval_decl_body(e.m_decl);
         pop_frame(r, decl_type(e.m_decl));
         return r;
     }
@@ -988,7 +2196,7 @@ private:
             m_arg_stack.push_back(args[3 + i]);
         }
         push_frame(d, old_size);
-        object * r = eval_body(decl_fun_body(d)).m_obj;
+        object * r = eval_decl_body(d).m_obj;
         pop_frame(r, type::TObject);
         return r;
     }
@@ -1045,6 +2253,9 @@ private:
 public:
     explicit interpreter(elab_environment const & env, options const & opts) : m_env(env), m_opts(opts) {
         m_prefer_native = opts.get_bool(*g_interpreter_prefer_native, LEAN_DEFAULT_INTERPRETER_PREFER_NATIVE);
+        m_bytecode = opts.get_bool(*g_interpreter_bytecode, LEAN_DEFAULT_INTERPRETER_BYTECODE);
+        m_jit_threshold = jit_available() ? opts.get_unsigned(*g_interpreter_jit_threshold, LEAN_DEFAULT_INTERPRETER_JIT_THRESHOLD) : 0;
+        m_imported_cache = get_imported_cache(env);
     }
 
     interpreter(interpreter const &) = delete;
@@ -1185,6 +2396,14 @@ extern "C" LEAN_EXPORT object * lean_eval_const(object * env, object * opts, obj
     }
 }
 
+/* clearNativeSymbolCache : BaseIO Unit */
+extern "C" LEAN_EXPORT obj_res lean_ir_clear_native_symbol_cache() {
+    // forget negative lookups from before a library was loaded
+    std::unique_lock<std::shared_timed_mutex> lock(*g_native_symbol_cache_mutex);
+    g_native_symbol_cache->clear();
+    return box(0);
+}
+
 /* runModInitCore (sym : @& String) : IO Bool */
 extern "C" LEAN_EXPORT obj_res lean_run_mod_init_core(b_obj_arg  sym) {
     if (void * init = lookup_symbol_in_cur_exe(string_cstr(sym))) {
@@ -1213,21 +2432,36 @@ void initialize_ir_interpreter() {
     ir::g_boxed_mangled_suffix = new string_ref("___boxed");
     mark_persistent(ir::g_boxed_mangled_suffix->raw());
     ir::g_interpreter_prefer_native = new name({"interpreter", "prefer_native"});
+    ir::g_interpreter_bytecode = new name({"interpreter", "bytecode"});
+    ir::g_interpreter_jit_threshold = new name({"interpreter", "jit_threshold"});
     ir::g_init_globals = new name_hash_map<object *>();
     register_bool_option(*ir::g_interpreter_prefer_native, LEAN_DEFAULT_INTERPRETER_PREFER_NATIVE, "(interpreter) whether to use precompiled code where available");
+    register_bool_option(*ir::g_interpreter_bytecode, LEAN_DEFAULT_INTERPRETER_BYTECODE, "(interpreter) whether to lower IR to register bytecode before interpreting it, instead of walking the IR directly");
+    register_unsigned_option(*ir::g_interpreter_jit_threshold, LEAN_DEFAULT_INTERPRETER_JIT_THRESHOLD, "(interpreter) number of interpreted calls of a function after which it is compiled to native code using LLVM (0 = never); has no effect if Lean was built without LLVM support");
     DEBUG_CODE({
         register_trace_class({"interpreter"});
         register_trace_class({"interpreter", "call"});
         register_trace_class({"interpreter", "step"});
     });
+    register_trace_class({"interpreter", "jit"});
     ir::g_native_symbol_cache = new name_hash_map<ir::native_symbol_cache_entry>();
     ir::g_native_symbol_cache_mutex = new std::shared_timed_mutex();
+    ir::g_jit_cache = new lean::unordered_map<object *, ir::jit_cache_entry>();
+    ir::g_jit_cache_mutex = new std::mutex();
+    ir::g_imported_caches = new lean::unordered_map<object *, std::shared_ptr<ir::imported_cache>>();
+    ir::g_imported_caches_mutex = new std::mutex();
 }
 
 void finalize_ir_interpreter() {
+    delete ir::g_imported_caches_mutex;
+    delete ir::g_imported_caches;
+    delete ir::g_jit_cache_mutex;
+    delete ir::g_jit_cache;
     delete ir::g_native_symbol_cache_mutex;
     delete ir::g_native_symbol_cache;
     delete ir::g_init_globals;
+    delete ir::g_interpreter_jit_threshold;
+    delete ir::g_interpreter_bytecode;
     delete ir::g_interpreter_prefer_native;
     delete ir::g_boxed_mangled_suffix;
 }
@@ -0,0 +1,162 @@
+/*
+Copyright (c) 2025 Lean FRO, LLC. All rights reserved.
+Released under Apache 2.0 license as described in the file LICENSE.
+
+JIT tier of the IR interpreter: IR declarations that have become hot in the interpreter are compiled by the LLVM
+backend (`src/Lean/Compiler/IR/EmitLLVM.lean`) into an LLVM module, which is then compiled and linked into the running
+process using ORC's LLJIT.
+
+Every compiled module is self-contained except for references to native code of the current process: it contains
+all interpreted functions it uses. Thus the same declaration may be compiled into several modules, e.g. after local
+declarations are backtracked and elaborated again. As all modules share a single JITDylib, we give every function
+defined in a module a unique name before adding it to the JIT.
+*/
+#include <string>
+#include <mutex>
+#include <atomic>
+#include "runtime/sstream.h"
+#include "util/io.h"
+#include "library/ir_jit.h"
+
+#ifdef LEAN_LLVM
+#include "llvm-c/BitReader.h"
+#include "llvm-c/BitWriter.h"
+#include "llvm-c/Core.h"
+#include "llvm-c/Error.h"
+#include "llvm-c/LLJIT.h"
+#include "llvm-c/Orc.h"
+#include "llvm-c/Target.h"
+#endif
+
+namespace lean {
+/* emitLLVMJit (env : Environment) (decls : Array Decl) : IO (USize × USize) */
+extern "C" object * lean_ir_emit_llvm_jit(object * env, object * decls);
+
+namespace ir {
+#ifdef LEAN_LLVM
+static std::mutex * g_jit_mutex = nullptr;
+// created on first use
+static LLVMOrcLLJITRef g_jit = nullptr;
+// used to make the names of JIT-compiled functions unique
+static unsigned g_jit_next_module_idx = 0;
+static std::atomic<size_t> g_jit_num_compiled{0};
+
+static void check_llvm_error(LLVMErrorRef err) {
+    if (err) {
+        char * msg = LLVMGetErrorMessage(err);
+        std::string s(msg);
+        LLVMDisposeErrorMessage(msg);
+        throw exception(sstream() << "(JIT) " << s);
+    }
+}
+
+static LLVMOrcLLJITRef get_jit() {
+    if (!g_jit) {
+        LLVMInitializeNativeTarget();
+        LLVMInitializeNativeAsmPrinter();
+        LLVMOrcLLJITRef jit;
+        check_llvm_error(LLVMOrcCreateLLJIT(&jit, nullptr));
+        // resolve references to runtime functions and compiled Lean code in the current process
+        LLVMOrcDefinitionGeneratorRef gen;
+        LLVMErrorRef err = LLVMOrcCreateDynamicLibrarySearchGeneratorForProcess(&gen, LLVMOrcLLJITGetGlobalPrefix(jit), nullptr, nullptr);
+        if (err) {
+            LLVMOrcDisposeLLJIT(jit);
+            check_llvm_error(err);
+        }
+        LLVMOrcJITDylibAddGenerator(LLVMOrcLLJITGetMainJITDylib(jit), gen);
+        g_jit = jit;
+    }
+    return g_jit;
+}
+
+/** \brief Move `mod` into a fresh thread-safe context owned by the JIT, consuming `mod` and its context `ctx`. */
+static LLVMOrcThreadSafeModuleRef to_thread_safe_module(LLVMContextRef ctx, LLVMModuleRef mod) {
+    // there is no way to wrap an existing context in the C API, so we round-trip through bitcode
+    LLVMMemoryBufferRef buf = LLVMWriteBitcodeToMemoryBuffer(mod);
+    LLVMDisposeModule(mod);
+    LLVMContextDispose(ctx);
+    LLVMOrcThreadSafeContextRef tsctx = LLVMOrcCreateNewThreadSafeContext();
+    LLVMModuleRef new_mod;
+    bool failed = LLVMParseBitcodeInContext2(LLVMOrcThreadSafeContextGetContext(tsctx), buf, &new_mod);
+    LLVMDisposeMemoryBuffer(buf);
+    if (failed) {
+        LLVMOrcDisposeThreadSafeContext(tsctx);
+        throw exception("(JIT) failed to read back emitted bitcode");
+    }
+    LLVMOrcThreadSafeModuleRef tsm = LLVMOrcCreateNewThreadSafeModule(new_mod, tsctx);
+    // the module keeps the context alive
+    LLVMOrcDisposeThreadSafeContext(tsctx);
+    return tsm;
+}
+
+/** \brief Append `suffix` to the name of every non-internal function defined in `mod`. */
+static void rename_definitions(LLVMModuleRef mod, std::string const & suffix) {
+    for (LLVMValueRef fn = LLVMGetFirstFunction(mod); fn; fn = LLVMGetNextFunction(fn)) {
+        if (!LLVMIsDeclaration(fn) && LLVMGetLinkage(fn) != LLVMInternalLinkage && LLVMGetLinkage(fn) != LLVMPrivateLinkage) {
+            size_t len;
+            char const * old_name = LLVMGetValueName2(fn, &len);
+            std::string n = std::string(old_name, len) + suffix;
+            LLVMSetValueName2(fn, n.data(), n.size());
+        }
+    }
+}
+
+bool jit_available() {
+    return true;
+}
+
+void * jit_compile(elab_environment const & env, object_ref const & decls, std::string const & sym) {
+    object_ref r = get_io_result<object_ref>(lean_ir_emit_llvm_jit(env.to_obj_arg(), decls.to_obj_arg()));
+    LLVMContextRef ctx = reinterpret_cast<LLVMContextRef>(unbox_size_t(cnstr_get(r.raw(), 0)));
+    LLVMModuleRef mod = reinterpret_cast<LLVMModuleRef>(unbox_size_t(cnstr_get(r.raw(), 1)));
+    std::lock_guard<std::mutex> lock(*g_jit_mutex);
+    std::string suffix = "$jit" + std::to_string(g_jit_next_module_idx++);
+    rename_definitions(mod, suffix);
+    LLVMOrcLLJITRef jit = get_jit();
+    LLVMOrcThreadSafeModuleRef tsm = to_thread_safe_module(ctx, mod);
+    // takes ownership of `tsm` even on failure
+    check_llvm_error(LLVMOrcLLJITAddLLVMIRModule(jit, LLVMOrcLLJITGetMainJITDylib(jit), tsm));
+    // compilation happens on lookup
+    LLVMOrcExecutorAddress addr;
+    check_llvm_error(LLVMOrcLLJITLookup(jit, &addr, (sym + suffix).c_str()));
+    g_jit_num_compiled++;
+    return reinterpret_cast<void *>(addr);
+}
+#else
+bool jit_available() {
+    return false;
+}
+
+void * jit_compile(elab_environment const &, object_ref const &, std::string const &) {
+    throw exception("(JIT) Lean was built without LLVM support");
+}
+#endif
+}
+
+/* jitAvailable : Unit → Bool */
+extern "C" LEAN_EXPORT uint8 lean_ir_jit_available(obj_arg) {
+    return ir::jit_available();
+}
+
+/* getNumJitCompiled : BaseIO Nat */
+extern "C" LEAN_EXPORT obj_res lean_ir_get_num_jit_compiled() {
+#ifdef LEAN_LLVM
+    return usize_to_nat(ir::g_jit_num_compiled);
+#else
+    return usize_to_nat(0);
+#endif
+}
+
+void initialize_ir_jit() {
+#ifdef LEAN_LLVM
+    ir::g_jit_mutex = new std::mutex();
+#endif
+}
+
+void finalize_ir_jit() {
+#ifdef LEAN_LLVM
+    // JIT-compiled code may still be referenced from closures, so we do not dispose of `g_jit`
+    delete ir::g_jit_mutex;
+#endif
+}
+}
@@ -0,0 +1,21 @@
+/*
+Copyright (c) 2025 Lean FRO, LLC. All rights reserved.
+Released under Apache 2.0 license as described in the file LICENSE.
+*/
+#pragma once
+#include <string>
+#include "library/elab_environment.h"
+#include "runtime/object_ref.h"
+
+namespace lean {
+namespace ir {
+/** \brief Return true iff IR can be compiled to native code at runtime, i.e. Lean was built with LLVM support. */
+bool jit_available();
+/** \brief Compile the IR declarations `decls` (an `Array Decl`) using the LLVM backend and return the address of
+    the function named `sym` among them. Functions used by `decls` must either be in `decls` or be available in the
+    current process. Throws an exception on failure. */
+void * jit_compile(elab_environment const & env, object_ref const & decls, std::string const & sym);
+}
+void initialize_ir_jit();
+void finalize_ir_jit();
+}
@@ -44,10 +44,12 @@ extern "C" LEAN_EXPORT obj_res lean_init_llvm() {
     return initialize_Lean_Compiler_IR_EmitLLVM(/*builtin*/ false);
 }
 
+/*  emitLLVM (env : Environment) (modName : Name) (filepath : FilePath) (numThreads : Nat) : IO Unit */
+extern "C" obj_res lean_ir_emit_llvm(obj_arg env, obj_arg mod_name, obj_arg filepath, obj_arg num_threads);
 /*  emitLLVM (env : Environment) (modName : Name) (filepath : FilePath) : IO Unit */
-extern "C" obj_res lean_ir_emit_llvm(obj_arg env, obj_arg mod_name, obj_arg filepath);
 extern "C" LEAN_EXPORT obj_res lean_emit_llvm(obj_arg env, obj_arg mod_name, obj_arg filepath) {
-    return lean_ir_emit_llvm(env, mod_name, filepath);
+    // split the module over as many threads as we use for elaboration (`-j`)
+    return lean_ir_emit_llvm(env, mod_name, filepath, lean_unsigned_to_nat(get_num_task_workers()));
 }
 }
 
@@ -250,6 +252,17 @@ extern "C" LEAN_EXPORT size_t lean_llvm_create_context() {
 #endif  // LEAN_LLVM
 };
 
+extern "C" LEAN_EXPORT lean_object *lean_llvm_dispose_context(size_t ctx) {
+#ifndef LEAN_LLVM
+    lean_always_assert(
+        false && ("Please build a version of Lean4 with -DLLVM=ON to invoke "
+                  "the LLVM backend function."));
+#else
+    LLVMContextDispose(lean_to_Context(ctx));
+    return lean_box(0);
+#endif  // LEAN_LLVM
+}
+
 extern "C" LEAN_EXPORT size_t lean_llvm_create_module(
     size_t ctx, lean_object *str) {
 #ifndef LEAN_LLVM
@@ -1055,6 +1068,17 @@ extern "C" LEAN_EXPORT size_t lean_llvm_parse_bitcode(
 #endif  // LEAN_LLVM
 }
 
+extern "C" LEAN_EXPORT lean_object *lean_llvm_dispose_memory_buffer(size_t ctx, size_t membuf) {
+#ifndef LEAN_LLVM
+    lean_always_assert(
+        false && ("Please build a version of Lean4 with -DLLVM=ON to invoke "
+                  "the LLVM backend function."));
+#else
+    LLVMDisposeMemoryBuffer(lean_to_MemoryBuffer(membuf));
+    return lean_box(0);
+#endif  // LEAN_LLVM
+}
+
 extern "C" LEAN_EXPORT lean_object *lean_llvm_link_modules(size_t ctx,
     size_t dest_module, size_t src_module) {
 #ifndef LEAN_LLVM
@@ -0,0 +1,479 @@
+/*
+Copyright (c) 2025 Lean FRO, LLC. All rights reserved.
+Released under Apache 2.0 license as described in the file LICENSE.
+
+Sampling profiler for native and interpreted code.
+
+A `SIGPROF` timer interrupts whichever thread is consuming CPU time. The signal handler records the native stack and
+copies the interpreted functions the thread is currently executing, which the interpreter maintains in a per-thread
+"shadow stack" of interned function names (see `sampling_profiler_enter`). As the handler may not allocate or take
+locks, samples are stored in a fixed-size array of slots that is drained and aggregated by a background thread.
+
+As the unwinder and the dynamic loader take locks that the interrupted thread may be holding, the handler walks the
+native stack by following frame pointers from the interrupted context instead. Native frames of code compiled without
+frame pointers (e.g. with the default flags of x86-64 release builds) are therefore missing from samples; use
+`-fno-omit-frame-pointer` (as in `RelWithDebInfo` builds) for complete native stacks.
+
+Native and interpreted frames are merged by their position on the native stack: for native frames we record their
+frame pointer, for interpreted frames the frame address of the interpreter function that entered them.
+Native frames of the interpreter itself (which are not exported, so we cannot name them anyway) are omitted in the
+report. Native frames of Lean code are named after their declaration, other frames after their C/C++ symbol.
+*/
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <atomic>
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+#include "runtime/sstream.h"
+#include "runtime/thread.h"
+#include "runtime/exception.h"
+#include "runtime/option_ref.h"
+#include "util/name_hash_map.h"
+#include "library/sampling_profiler.h"
+
+// samples are drained by a background thread
+#if !defined(LEAN_MULTI_THREAD) || defined(LEAN_EMSCRIPTEN) || defined(LEAN_WINDOWS) || !(defined(__GLIBC__) || defined(__APPLE__))
+#define LEAN_SAMPLING_PROFILER 0
+#else
+#define LEAN_SAMPLING_PROFILER 1
+#include <signal.h>
+#include <sys/time.h>
+#include <ucontext.h>
+#include <dlfcn.h>
+#include <cxxabi.h>
+#include <cerrno>
+#ifdef __GLIBC__
+#include <link.h>
+#endif
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+#endif
+
+namespace lean {
+std::atomic<bool> g_sampling_profiler_active(false);
+
+#if LEAN_SAMPLING_PROFILER
+// maximum number of native resp. interpreted frames recorded per sample; further frames are dropped
+static constexpr unsigned g_max_native_frames = 128;
+static constexpr unsigned g_max_interp_frames = 128;
+static constexpr unsigned g_num_sample_slots = 4096;
+// maximum distance between consecutive frame pointers; larger ones are assumed to be garbage
+static constexpr uintptr_t g_max_frame_size = 1 << 20;
+
+struct interp_stack {
+    // interned names of the functions being interpreted, outermost first
+    unsigned  m_fns[g_max_interp_frames];
+    // native frame addresses at which they were entered
+    uintptr_t m_addrs[g_max_interp_frames];
+    // may exceed `g_max_interp_frames`
+    std::atomic<unsigned> m_depth{0};
+};
+// allocated on the first `sampling_profiler_enter` of a thread and never freed, as the signal handler may read it
+LEAN_THREAD_PTR(interp_stack, g_interp_stack);
+// the interning table of the current thread
+LEAN_THREAD_PTR(name_hash_map<unsigned>, g_interp_fn_ids);
+
+enum class slot_state : unsigned { Free, Writing, Full };
+struct sample_slot {
+    std::atomic<slot_state> m_state{slot_state::Free};
+    unsigned  m_num_native;
+    unsigned  m_num_interp;
+    // instruction pointers and frame addresses, innermost first
+    uintptr_t m_native_ips[g_max_native_frames];
+    uintptr_t m_native_addrs[g_max_native_frames];
+    unsigned  m_interp_fns[g_max_interp_frames];
+    uintptr_t m_interp_addrs[g_max_interp_frames];
+};
+
+// a native (instruction pointer) or an interpreted (interned name) frame
+struct frame_ref {
+    bool      m_interp;
+    uintptr_t m_val;
+    bool operator<(frame_ref const & other) const {
+        return m_interp != other.m_interp ? m_interp < other.m_interp : m_val < other.m_val;
+    }
+};
+
+struct sampling_profiler {
+    std::string m_fname;
+    sample_slot * m_slots;
+    std::atomic<unsigned> m_next_slot{0};
+    std::atomic<size_t> m_num_dropped{0};
+    // interned interpreted function names
+    std::vector<std::string> m_fn_names;
+    mutex m_fn_names_mutex;
+    // aggregated stacks, outermost frame first
+    std::map<std::vector<frame_ref>, size_t> m_stacks;
+    std::atomic<bool> m_stop{false};
+    std::unique_ptr<lthread> m_drain_thread;
+};
+// Never freed, as the signal handler may still be running on some thread after the profiler has been stopped. For
+// the same reason, and because interning tables are thread-local, the profiler can only be started once.
+static sampling_profiler * g_profiler = nullptr;
+static mutex * g_profiler_mutex = new mutex();
+
+void sampling_profiler_enter_slow(name const & fn, void * frame_addr) {
+    if (!g_interp_stack) {
+        g_interp_stack = new interp_stack();
+        g_interp_fn_ids = new name_hash_map<unsigned>();
+    }
+    unsigned id;
+    auto it = g_interp_fn_ids->find(fn);
+    if (it != g_interp_fn_ids->end()) {
+        id = it->second;
+    } else {
+        lock_guard<mutex> lock(g_profiler->m_fn_names_mutex);
+        id = g_profiler->m_fn_names.size();
+        g_profiler->m_fn_names.push_back(fn.to_string());
+        g_interp_fn_ids->insert({ fn, id });
+    }
+    interp_stack & s = *g_interp_stack;
+    unsigned d = s.m_depth.load(std::memory_order_relaxed);
+    if (d < g_max_interp_frames) {
+        s.m_fns[d] = id;
+        s.m_addrs[d] = reinterpret_cast<uintptr_t>(frame_addr);
+    }
+    // make sure the signal handler never sees an uninitialized entry
+    std::atomic_signal_fence(std::memory_order_release);
+    s.m_depth.store(d + 1, std::memory_order_relaxed);
+}
+
+void sampling_profiler_leave_slow() {
+    if (interp_stack * s = g_interp_stack) {
+        unsigned d = s->m_depth.load(std::memory_order_relaxed);
+        if (d > 0) {
+            s->m_depth.store(d - 1, std::memory_order_relaxed);
+        }
+    }
+}
+
+unsigned sampling_profiler_get_depth() {
+    interp_stack * s = g_interp_stack;
+    return s ? s->m_depth.load(std::memory_order_relaxed) : 0;
+}
+
+void sampling_profiler_set_depth(unsigned depth) {
+    if (interp_stack * s = g_interp_stack) {
+        if (s->m_depth.load(std::memory_order_relaxed) > depth) {
+            s->m_depth.store(depth, std::memory_order_relaxed);
+        }
+    }
+}
+
+/** \brief Extract the instruction, stack and frame pointer of the interrupted context, if supported. */
+static bool get_context_regs(void * uctx, uintptr_t & pc, uintptr_t & sp, uintptr_t & fp) {
+    ucontext_t * uc = static_cast<ucontext_t *>(uctx);
+#if defined(__linux__) && defined(__x86_64__)
+    pc = uc->uc_mcontext.gregs[REG_RIP];
+    sp = uc->uc_mcontext.gregs[REG_RSP];
+    fp = uc->uc_mcontext.gregs[REG_RBP];
+    return true;
+#elif defined(__linux__) && defined(__aarch64__)
+    pc = uc->uc_mcontext.pc;
+    sp = uc->uc_mcontext.sp;
+    fp = uc->uc_mcontext.regs[29];
+    return true;
+#elif defined(__APPLE__) && defined(__x86_64__)
+    pc = uc->uc_mcontext->__ss.__rip;
+    sp = uc->uc_mcontext->__ss.__rsp;
+    fp = uc->uc_mcontext->__ss.__rbp;
+    return true;
+#elif defined(__APPLE__) && defined(__aarch64__)
+    pc = __darwin_arm_thread_state64_get_pc(uc->uc_mcontext->__ss);
+    sp = __darwin_arm_thread_state64_get_sp(uc->uc_mcontext->__ss);
+    fp = __darwin_arm_thread_state64_get_fp(uc->uc_mcontext->__ss);
+    return true;
+#else
+    (void)uc; (void)pc; (void)sp; (void)fp;
+    return false;
+#endif
+}
+
+/** \brief Return true if `fp` points to a frame record (saved frame pointer and return address) outside of the frame
+    ending at `prev` that can be read. */
+static bool is_valid_frame(uintptr_t fp, uintptr_t prev, uintptr_t & readable_page) {
+    // the stack grows downwards, so outer frames must be at higher addresses
+    if (fp % (2 * sizeof(uintptr_t)) != 0 || fp < prev || fp - prev > g_max_frame_size) {
+        return false;
+    }
+#ifdef __linux__
+    // Frame records are 16-byte aligned and thus do not cross pages. The kernel reads the signal set before rejecting
+    // the invalid `how` argument, so `EFAULT` tells us that the memory is not readable without faulting.
+    uintptr_t page = fp & ~static_cast<uintptr_t>(4095);
+    if (page == readable_page) {
+        return true;
+    }
+    if (syscall(SYS_rt_sigprocmask, ~0, reinterpret_cast<void *>(fp), nullptr, 8) == -1 && errno == EFAULT) {
+        return false;
+    }
+    readable_page = page;
+#else
+    // frame pointers are mandatory on Apple platforms
+    (void)readable_page;
+#endif
+    return true;
+}
+
+/** \brief Record the native frames of the interrupted context by following its frame pointers. Unlike the unwinder,
+    this does not take any locks and so is safe to use in a signal handler. */
+static void record_native_frames(void * uctx, sample_slot & s) {
+    s.m_num_native = 0;
+    uintptr_t pc, sp, fp;
+    if (!get_context_regs(uctx, pc, sp, fp)) {
+        return;
+    }
+    // Symbolization looks up `ip - 1` to account for return addresses. The interrupted function may not have set up
+    // its own frame pointer yet, so we use the stack pointer as its frame address.
+    s.m_native_ips[0] = pc + 1;
+    s.m_native_addrs[0] = sp;
+    s.m_num_native = 1;
+    uintptr_t readable_page = 0;
+    uintptr_t prev = sp;
+    bool valid = is_valid_frame(fp, prev, readable_page);
+    while (valid && s.m_num_native < g_max_native_frames) {
+        uintptr_t const * frame = reinterpret_cast<uintptr_t const *>(fp);
+        uintptr_t ip = frame[1];
+        if (ip == 0) {
+            break;
+        }
+        prev = fp + 2 * sizeof(uintptr_t);
+        fp = frame[0];
+        valid = is_valid_frame(fp, prev, readable_page);
+        s.m_native_ips[s.m_num_native] = ip;
+        // if the function of `ip` has no frame pointer, its frame is at least above the frame record we just read
+        s.m_native_addrs[s.m_num_native] = valid ? fp : prev;
+        s.m_num_native++;
+    }
+}
+
+static void handle_sigprof(int, siginfo_t *, void * uctx) {
+    int saved_errno = errno;
+    sampling_profiler * p = g_profiler;
+    if (p && g_sampling_profiler_active.load(std::memory_order_relaxed)) {
+        unsigned start = p->m_next_slot.fetch_add(1, std::memory_order_relaxed);
+        sample_slot * slot = nullptr;
+        // try a few slots in case the next one has not been drained yet
+        for (unsigned i = 0; i < 8; i++) {
+            sample_slot & s = p->m_slots[(start + i) % g_num_sample_slots];
+            slot_state expected = slot_state::Free;
+            if (s.m_state.compare_exchange_strong(expected, slot_state::Writing, std::memory_order_acquire)) {
+                slot = &s;
+                break;
+            }
+        }
+        if (slot) {
+            record_native_frames(uctx, *slot);
+            slot->m_num_interp = 0;
+            if (interp_stack * is = g_interp_stack) {
+                slot->m_num_interp = std::min(is->m_depth.load(std::memory_order_relaxed), g_max_interp_frames);
+                std::atomic_signal_fence(std::memory_order_acquire);
+                std::copy(is->m_fns, is->m_fns + slot->m_num_interp, slot->m_interp_fns);
+                std::copy(is->m_addrs, is->m_addrs + slot->m_num_interp, slot->m_interp_addrs);
+            }
+            slot->m_state.store(slot_state::Full, std::memory_order_release);
+        } else {
+            p->m_num_dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    errno = saved_errno;
+}
+
+static void drain(sampling_profiler & p) {
+    for (unsigned i = 0; i < g_num_sample_slots; i++) {
+        sample_slot & s = p.m_slots[i];
+        if (s.m_state.load(std::memory_order_acquire) != slot_state::Full) {
+            continue;
+        }
+        // the stack grows downwards, so outer frames have higher addresses
+        std::vector<frame_ref> stack;
+        unsigned j = 0;
+        for (unsigned k = s.m_num_native; k-- > 0;) {
+            uintptr_t addr = s.m_native_addrs[k];
+            for (; j < s.m_num_interp && s.m_interp_addrs[j] > addr; j++) {
+                stack.push_back({ true, s.m_interp_fns[j] });
+            }
+            if (s.m_native_ips[k] != 0) {
+                stack.push_back({ false, s.m_native_ips[k] });
+            }
+        }
+        for (; j < s.m_num_interp; j++) {
+            stack.push_back({ true, s.m_interp_fns[j] });
+        }
+        s.m_state.store(slot_state::Free, std::memory_order_release);
+        p.m_stacks[stack]++;
+    }
+}
+
+/* Name.demangleSymbol? (s : String) : Option Name */
+extern "C" object * lean_demangle_symbol(object * s);
+
+static std::string sanitize_frame(std::string s) {
+    // `;` separates frames and lines separate stacks in the collapsed stack format
+    for (char & c : s) {
+        if (c == ';') c = ':';
+        if (c == '\n') c = ' ';
+    }
+    return s;
+}
+
+struct native_symbol {
+    std::string m_name;
+    // false if the address is not part of an exported function and thus likely part of the interpreter
+    bool m_exported;
+};
+
+static native_symbol symbolize(uintptr_t ip) {
+    // `ip` is usually a return address, so look up the preceding call instruction instead
+    void * addr = reinterpret_cast<void *>(ip - 1);
+    Dl_info info;
+    memset(&info, 0, sizeof(info));
+    bool found;
+#ifdef __GLIBC__
+    void * sym_entry = nullptr;
+    found = dladdr1(addr, &info, &sym_entry, RTLD_DL_SYMENT) && info.dli_sname && sym_entry;
+    if (found) {
+        // `dladdr` returns the closest preceding symbol, so check that `addr` is actually part of it
+        ElfW(Sym) const * sym = static_cast<ElfW(Sym) const *>(sym_entry);
+        found = sym->st_size == 0 || ip - 1 < reinterpret_cast<uintptr_t>(info.dli_saddr) + sym->st_size;
+    }
+#else
+    found = dladdr(addr, &info) && info.dli_sname;
+#endif
+    if (found) {
+        option_ref<name> n(lean_demangle_symbol(mk_string(info.dli_sname)));
+        if (n) {
+            return { n.get()->to_string(), true };
+        }
+        int status;
+        char * demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+        if (status == 0 && demangled) {
+            std::string r(demangled);
+            free(demangled);
+            return { r, true };
+        }
+        return { info.dli_sname, true };
+    }
+    sstream ss;
+    if (info.dli_fname) {
+        char const * base = strrchr(info.dli_fname, '/');
+        ss << "[" << (base ? base + 1 : info.dli_fname) << "+0x" << std::hex
+           << (ip - reinterpret_cast<uintptr_t>(info.dli_fbase)) << "]";
+    } else {
+        ss << "[0x" << std::hex << ip << "]";
+    }
+    return { ss.str(), false };
+}
+
+static void write_report(sampling_profiler & p) {
+    std::ofstream out(p.m_fname);
+    if (!out) {
+        std::cerr << "failed to write sampling profile to '" << p.m_fname << "'\n";
+        return;
+    }
+    // interpreter threads may still be registering functions
+    std::vector<std::string> fn_names;
+    {
+        lock_guard<mutex> lock(p.m_fn_names_mutex);
+        fn_names = p.m_fn_names;
+    }
+    std::unordered_map<uintptr_t, native_symbol> symbols;
+    std::map<std::string, size_t> lines;
+    for (auto const & e : p.m_stacks) {
+        sstream ss;
+        bool first = true;
+        bool in_interpreter = false;
+        for (frame_ref const & f : e.first) {
+            std::string s;
+            if (f.m_interp) {
+                in_interpreter = true;
+                s = fn_names[f.m_val];
+            } else {
+                auto it = symbols.find(f.m_val);
+                if (it == symbols.end()) {
+                    it = symbols.insert({ f.m_val, symbolize(f.m_val) }).first;
+                }
+                if (in_interpreter && !it->second.m_exported) {
+                    continue;
+                }
+                s = it->second.m_name;
+            }
+            if (!first) ss << ";";
+            first = false;
+            ss << sanitize_frame(s);
+        }
+        lines[ss.str()] += e.second;
+    }
+    for (auto const & l : lines) {
+        out << l.first << " " << l.second << "\n";
+    }
+    if (size_t dropped = p.m_num_dropped.load()) {
+        out << "[dropped samples] " << dropped << "\n";
+    }
+}
+
+static void set_timer(unsigned frequency) {
+    itimerval t;
+    t.it_interval.tv_sec = 0;
+    t.it_interval.tv_usec = frequency ? std::max(1000000 / frequency, 1u) : 0;
+    t.it_value = t.it_interval;
+    setitimer(ITIMER_PROF, &t, nullptr);
+}
+
+void start_sampling_profiler(std::string const & fname, unsigned frequency) {
+    lock_guard<mutex> lock(*g_profiler_mutex);
+    if (g_profiler) {
+        throw exception("sampling profiler can only be started once");
+    }
+    sampling_profiler * p = new sampling_profiler();
+    p->m_fname = fname;
+    p->m_slots = new sample_slot[g_num_sample_slots];
+    g_profiler = p;
+    g_sampling_profiler_active = true;
+    p->m_drain_thread.reset(new lthread([p]() {
+        while (!p->m_stop.load()) {
+            drain(*p);
+            this_thread::sleep_for(chrono::milliseconds(10));
+        }
+    }));
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_sigaction = handle_sigprof;
+    sa.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGPROF, &sa, nullptr);
+    set_timer(frequency);
+    // write the report even if the process is terminated using `exit`
+    std::atexit(stop_sampling_profiler);
+}
+
+void stop_sampling_profiler() {
+    lock_guard<mutex> lock(*g_profiler_mutex);
+    sampling_profiler * p = g_profiler;
+    if (!p || !g_sampling_profiler_active) {
+        return;
+    }
+    set_timer(0);
+    g_sampling_profiler_active = false;
+    p->m_stop = true;
+    p->m_drain_thread->join();
+    drain(*p);
+    write_report(*p);
+}
+#else
+void sampling_profiler_enter_slow(name const &, void *) {}
+void sampling_profiler_leave_slow() {}
+unsigned sampling_profiler_get_depth() { return 0; }
+void sampling_profiler_set_depth(unsigned) {}
+
+void start_sampling_profiler(std::string const &, unsigned) {
+    throw exception("sampling profiler is not supported on this platform");
+}
+
+void stop_sampling_profiler() {}
+#endif
+}
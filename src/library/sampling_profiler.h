@@ -0,0 +1,62 @@
+/*
+Copyright (c) 2025 Lean FRO, LLC. All rights reserved.
+Released under Apache 2.0 license as described in the file LICENSE.
+*/
+#pragma once
+#include <string>
+#include <atomic>
+#include "runtime/object.h"
+#include "util/name.h"
+
+#ifndef LEAN_DEFAULT_SAMPLING_PROFILER_FREQUENCY
+#define LEAN_DEFAULT_SAMPLING_PROFILER_FREQUENCY 997
+#endif
+
+namespace lean {
+LEAN_EXPORT extern std::atomic<bool> g_sampling_profiler_active;
+
+/** \brief Start sampling the call stacks of all threads consuming CPU time, `frequency` times per CPU second. The
+    samples are written to `fname` in the collapsed stack format (one line `frame_1;...;frame_n count` per distinct
+    stack, as consumed by e.g. `flamegraph.pl` or speedscope) when the profiler is stopped, at the latest on process
+    exit. Throws an exception if sampling is not supported on this platform. */
+LEAN_EXPORT void start_sampling_profiler(std::string const & fname, unsigned frequency);
+/** \brief Stop the sampling profiler and write its report, if it is running. */
+LEAN_EXPORT void stop_sampling_profiler();
+
+/** \brief Run the sampling profiler until the end of the scope. */
+class scoped_sampling_profiler {
+public:
+    scoped_sampling_profiler(std::string const & fname, unsigned frequency = LEAN_DEFAULT_SAMPLING_PROFILER_FREQUENCY) {
+        start_sampling_profiler(fname, frequency);
+    }
+    ~scoped_sampling_profiler() { stop_sampling_profiler(); }
+};
+
+LEAN_EXPORT void sampling_profiler_enter_slow(name const & fn, void * frame_addr);
+LEAN_EXPORT void sampling_profiler_leave_slow();
+LEAN_EXPORT unsigned sampling_profiler_get_depth();
+LEAN_EXPORT void sampling_profiler_set_depth(unsigned depth);
+/** \brief Record that the current thread started interpreting `fn`. `frame_addr` should be the address of the native
+    stack frame of the interpreter function doing so (`__builtin_frame_address(0)`), which is used to place `fn`
+    among the native frames of samples. */
+inline void sampling_profiler_enter(name const & fn, void * frame_addr) {
+    if (LEAN_UNLIKELY(g_sampling_profiler_active.load(std::memory_order_relaxed))) sampling_profiler_enter_slow(fn, frame_addr);
+}
+/** \brief Record that the current thread finished interpreting the function of the last `sampling_profiler_enter`. */
+inline void sampling_profiler_leave() {
+    if (LEAN_UNLIKELY(g_sampling_profiler_active.load(std::memory_order_relaxed))) sampling_profiler_leave_slow();
+}
+
+/** \brief Restore the interpreted functions recorded for the current thread to those at the start of the scope when
+    leaving it. Needed where an exception may skip the `sampling_profiler_leave` of interpreted functions. */
+class sampling_profiler_scope {
+    unsigned m_depth;
+public:
+    sampling_profiler_scope() {
+        m_depth = LEAN_UNLIKELY(g_sampling_profiler_active.load(std::memory_order_relaxed)) ? sampling_profiler_get_depth() : 0;
+    }
+    ~sampling_profiler_scope() {
+        if (LEAN_UNLIKELY(g_sampling_profiler_active.load(std::memory_order_relaxed))) sampling_profiler_set_depth(m_depth);
+    }
+};
+}
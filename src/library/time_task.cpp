@@ -7,6 +7,8 @@ Author: Sebastian Ullrich
 #include <string>
 #include <map>
 #include "library/time_task.h"
+#include "library/chrome_trace.h"
+#include "library/alloc_profiler.h"
 #include "kernel/trace.h"
 
 namespace lean {
@@ -69,9 +71,21 @@ time_task::time_task(std::string const & category, options const & opts, name de
         m_parent_task = g_current_time_task;
         g_current_time_task = this;
     }
+    if (g_chrome_trace_active) {
+        chrome_trace_begin(m_category, decl);
+        m_traced = true;
+    }
+    if (g_alloc_profiler_active) {
+        m_prev_alloc_site = alloc_profiler_enter(m_category, decl);
+        m_alloc_profiled = true;
+    }
 }
 
 time_task::~time_task() {
+    if (m_alloc_profiled)
+        alloc_profiler_leave(m_prev_alloc_site);
+    if (m_traced)
+        chrome_trace_end();
     if (m_timeit) {
         g_current_time_task = m_parent_task;
         report_profiling_time(m_category, m_timeit->get_elapsed());
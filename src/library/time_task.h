@@ -21,6 +21,9 @@ class LEAN_EXPORT time_task {
     std::string     m_category;
     optional<xtimeit> m_timeit;
     time_task *     m_parent_task;
+    bool            m_traced = false;
+    bool            m_alloc_profiled = false;
+    unsigned        m_prev_alloc_site;
 public:
     time_task(std::string const & category, options const & opts, name decl = name());
     ~time_task();
@@ -26,12 +26,18 @@ Author: Leonardo de Moura
 #define LEAN_SEGMENT_SIZE          8*1024*1024 // 8 Mb
 #define LEAN_NUM_SLOTS             (LEAN_MAX_SMALL_OBJECT_SIZE / LEAN_OBJECT_SIZE_DELTA)
 #define LEAN_MAX_TO_EXPORT_OBJS    1024
+// number of allocations after which a heap checks whether allocation sampling has been enabled
+#define LEAN_ALLOC_SAMPLE_POLL_INTERVAL 65536
 
 LEAN_CASSERT(LEAN_PAGE_SIZE > LEAN_MAX_SMALL_OBJECT_SIZE);
 LEAN_CASSERT(LEAN_SEGMENT_SIZE > LEAN_PAGE_SIZE);
 
 namespace lean {
 
+LEAN_EXPORT atomic<unsigned> g_lean_alloc_sample_rate(0);
+LEAN_EXPORT atomic<void (*)(void *, size_t)> g_lean_report_alloc_sample(nullptr);
+LEAN_EXPORT atomic<bool (*)(void *)> g_lean_report_sampled_free(nullptr);
+
 #ifdef LEAN_SMALL_ALLOCATOR
 
 namespace allocator {
@@ -71,6 +77,9 @@ struct page_header {
     unsigned         m_num_free;
     unsigned         m_slot_idx;
     bool             m_in_page_free_list;
+    /* Number of sampled objects in the page, see `g_lean_alloc_sample_rate`.
+       Decremented by whichever thread frees them. */
+    atomic<unsigned> m_num_sampled{0};
 };
 
 struct page {
@@ -125,6 +134,8 @@ struct heap {
        by other heaps. */
     void *    m_to_import_list{nullptr};
     uint64_t  m_heartbeat{0}; /* Counter for implementing "deterministic timeouts". It is currently the number of small allocations */
+    uint64_t  m_sample_countdown{LEAN_ALLOC_SAMPLE_POLL_INTERVAL}; /* Allocations until the next sample, see `sample_alloc`. */
+    uint64_t  m_sample_rng{0x9E3779B97F4A7C15ull};
     void import_objs();
     void export_objs();
     void alloc_segment();
@@ -360,6 +371,37 @@ void init_thread_heap() {
     init_heap(false);
 }
 
+LEAN_NOINLINE
+static void sample_alloc(void * r, size_t sz) {
+    heap * h = g_heap;
+    unsigned rate = g_lean_alloc_sample_rate.load(std::memory_order_relaxed);
+    void (*report)(void *, size_t) = g_lean_report_alloc_sample.load(std::memory_order_relaxed);
+    if (rate == 0 || report == nullptr) {
+        h->m_sample_countdown = LEAN_ALLOC_SAMPLE_POLL_INTERVAL;
+        return;
+    }
+    /* Draw the distance to the next sample uniformly from `[1, 2*rate]` so that sampling does not
+       alias with periodic allocation patterns. */
+    uint64_t x = h->m_sample_rng;
+    x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+    h->m_sample_rng = x;
+    h->m_sample_countdown = 1 + x % (2 * static_cast<uint64_t>(rate));
+    if (sz <= LEAN_MAX_SMALL_OBJECT_SIZE)
+        get_page_of(r)->m_header.m_num_sampled.fetch_add(1, std::memory_order_relaxed);
+    report(r, sz);
+}
+
+LEAN_NOINLINE
+static void free_sampled(page * p, void * o) {
+    bool (*report)(void *) = g_lean_report_sampled_free.load(std::memory_order_relaxed);
+    if (report == nullptr) {
+        /* Sampled objects are not tracked anymore, so return the page to the fast path. */
+        p->m_header.m_num_sampled.store(0, std::memory_order_relaxed);
+    } else if (report(o)) {
+        p->m_header.m_num_sampled.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
 LEAN_NOINLINE
 void * lean_alloc_small_cold(unsigned sz, unsigned slot_idx, page * p) {
     if (g_heap->m_page_free_list[slot_idx] == nullptr) {
@@ -386,11 +428,14 @@ extern "C" LEAN_EXPORT void * lean_alloc_small(unsigned sz, unsigned slot_idx) {
     g_heap->m_heartbeat++;
     void * r = p->m_header.m_free_list;
     if (LEAN_UNLIKELY(r == nullptr)) {
-        return lean_alloc_small_cold(sz, slot_idx, p);
+        r = lean_alloc_small_cold(sz, slot_idx, p);
+    } else {
+        p->m_header.m_free_list = get_next_obj(r);
+        p->m_header.m_num_free--;
+        lean_assert(get_page_of(r) == p);
     }
-    p->m_header.m_free_list = get_next_obj(r);
-    p->m_header.m_num_free--;
-    lean_assert(get_page_of(r) == p);
+    if (LEAN_UNLIKELY(--g_heap->m_sample_countdown == 0))
+        sample_alloc(r, sz);
     return r;
 }
 
@@ -400,6 +445,8 @@ void * alloc(size_t sz) {
     if (LEAN_UNLIKELY(sz > LEAN_MAX_SMALL_OBJECT_SIZE)) {
         void * r = malloc(sz);
         if (r == nullptr) lean_internal_panic_out_of_memory();
+        if (g_heap && LEAN_UNLIKELY(--g_heap->m_sample_countdown == 0))
+            sample_alloc(r, sz);
         return r;
     }
     lean_assert(g_heap);
@@ -426,6 +473,8 @@ static inline void dealloc_small_core(void * o) {
     }
     lean_assert(g_heap);
     page * p = get_page_of(o);
+    if (LEAN_UNLIKELY(p->m_header.m_num_sampled.load(std::memory_order_relaxed) != 0))
+        free_sampled(p, o);
     if (LEAN_LIKELY(p->get_heap() == g_heap)) {
         p->push_free_obj(o);
     } else {
@@ -437,6 +486,9 @@ void dealloc(void * o, size_t sz) {
     LEAN_RUNTIME_STAT_CODE(g_num_dealloc++);
     sz = lean_align(sz, LEAN_OBJECT_SIZE_DELTA);
     if (LEAN_UNLIKELY(sz > LEAN_MAX_SMALL_OBJECT_SIZE)) {
+        bool (*report)(void *) = g_lean_report_sampled_free.load(std::memory_order_relaxed);
+        if (LEAN_UNLIKELY(report != nullptr))
+            report(o);
         return free_sized(o, sz);
     }
     dealloc_small_core(o);
@@ -8,6 +8,7 @@ Author: Leonardo de Moura
 #include <stddef.h>
 #include <stdint.h>
 #include <lean/lean.h>
+#include "runtime/thread.h"
 
 namespace lean {
 void init_thread_heap();
@@ -16,6 +17,16 @@ LEAN_EXPORT void dealloc(void * o, size_t sz);
 LEAN_EXPORT void set_heartbeats(uint64_t count);
 LEAN_EXPORT void add_heartbeats(uint64_t count);
 LEAN_EXPORT uint64_t get_num_heartbeats();
+
+/* Allocation sampling for memory profilers such as `library/alloc_profiler.cpp`. When the small allocator is enabled and
+   `g_lean_alloc_sample_rate` is nonzero, on average one in that many allocations is reported to
+   `g_lean_report_alloc_sample` together with its size. Each sampled object is later reported to
+   `g_lean_report_sampled_free` right before it is freed (on any thread), which should return whether the object was
+   still known to the profiler. Threads notice a change of the rate only after some allocations. The hooks may be reset
+   to `nullptr` after setting the rate to zero, which stops tracking sampled objects. */
+LEAN_EXPORT extern atomic<unsigned> g_lean_alloc_sample_rate;
+LEAN_EXPORT extern atomic<void (*)(void * o, size_t sz)> g_lean_report_alloc_sample;
+LEAN_EXPORT extern atomic<bool (*)(void * o)> g_lean_report_sampled_free;
 void initialize_alloc();
 void finalize_alloc();
 }
@@ -40,6 +40,23 @@ static obj* fix_args(obj* f, unsigned n, obj*const* as) {
 static inline obj* fix_args(obj* f, std::initializer_list<obj*> const & l) {
     return fix_args(f, l.size(), l.begin());
 }
+
+/*
+Copy the fixed arguments of `f` to `args` and release `f`. The arguments are moved when `f` is
+not shared. Returns the function pointer of `f`.
+*/
+static void * move_fixed_args(obj* f, obj** args) {
+    void * fn = lean_closure_fun(f);
+    unsigned fixed = lean_closure_num_fixed(f);
+    if (lean_is_exclusive(f)) {
+        for (unsigned i = 0; i < fixed; i++) args[i] = fx(i);
+        lean_free_object(f);
+    } else {
+        for (unsigned i = 0; i < fixed; i++) { lean_inc(fx(i)); args[i] = fx(i); }
+        lean_dec_ref(f);
+    }
+    return fn;
+}
 typedef obj* (*fn1)(obj*); // NOLINT
 #define FN1(f) reinterpret_cast<fn1>(lean_closure_fun(f))
 typedef obj* (*fn2)(obj*, obj*); // NOLINT
@@ -96,59 +113,57 @@ case 16: return reinterpret_cast<fn16>(f)(as[0], as[1], as[2], as[3], as[4], as[
 default: return reinterpret_cast<fnn>(f)(as);
 }
 }
-static obj* curry(obj* f, unsigned n, obj** as) { return curry(lean_closure_fun(f), n, as); }
 extern "C" obj* lean_apply_n(obj*, unsigned, obj**);
 extern "C" LEAN_EXPORT obj* lean_apply_1(obj* f, obj* a1) {
 if (lean_is_scalar(f)) { lean_dec(a1); return f; } // f is an erased proof
 unsigned arity = lean_closure_arity(f);
 unsigned fixed = lean_closure_num_fixed(f);
 if (arity == fixed + 1) {
+  void * fn = lean_closure_fun(f);
   if (lean_is_exclusive(f)) {
     switch (arity) {
-    case 1: { obj* r = FN1(f)(a1); lean_free_object(f); return r; }
-    case 2: { obj* r = FN2(f)(fx(0), a1); lean_free_object(f); return r; }
-    case 3: { obj* r = FN3(f)(fx(0), fx(1), a1); lean_free_object(f); return r; }
-    case 4: { obj* r = FN4(f)(fx(0), fx(1), fx(2), a1); lean_free_object(f); return r; }
-    case 5: { obj* r = FN5(f)(fx(0), fx(1), fx(2), fx(3), a1); lean_free_object(f); return r; }
-    case 6: { obj* r = FN6(f)(fx(0), fx(1), fx(2), fx(3), fx(4), a1); lean_free_object(f); return r; }
-    case 7: { obj* r = FN7(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), a1); lean_free_object(f); return r; }
-    case 8: { obj* r = FN8(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), a1); lean_free_object(f); return r; }
-    case 9: { obj* r = FN9(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), a1); lean_free_object(f); return r; }
-    case 10: { obj* r = FN10(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), a1); lean_free_object(f); return r; }
-    case 11: { obj* r = FN11(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), fx(9), a1); lean_free_object(f); return r; }
-    case 12: { obj* r = FN12(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), fx(9), fx(10), a1); lean_free_object(f); return r; }
-    case 13: { obj* r = FN13(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), fx(9), fx(10), fx(11), a1); lean_free_object(f); return r; }
-    case 14: { obj* r = FN14(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), fx(9), fx(10), fx(11), fx(12), a1); lean_free_object(f); return r; }
-    case 15: { obj* r = FN15(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), fx(9), fx(10), fx(11), fx(12), fx(13), a1); lean_free_object(f); return r; }
-    case 16: { obj* r = FN16(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), fx(9), fx(10), fx(11), fx(12), fx(13), fx(14), a1); lean_free_object(f); return r; }
+    case 1: { lean_free_object(f); return reinterpret_cast<fn1>(fn)(a1); }
+    case 2: { obj* x0 = fx(0); lean_free_object(f); return reinterpret_cast<fn2>(fn)(x0, a1); }
+    case 3: { obj* x0 = fx(0); obj* x1 = fx(1); lean_free_object(f); return reinterpret_cast<fn3>(fn)(x0, x1, a1); }
+    case 4: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); lean_free_object(f); return reinterpret_cast<fn4>(fn)(x0, x1, x2, a1); }
+    case 5: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); lean_free_object(f); return reinterpret_cast<fn5>(fn)(x0, x1, x2, x3, a1); }
+    case 6: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); lean_free_object(f); return reinterpret_cast<fn6>(fn)(x0, x1, x2, x3, x4, a1); }
+    case 7: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); lean_free_object(f); return reinterpret_cast<fn7>(fn)(x0, x1, x2, x3, x4, x5, a1); }
+    case 8: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); obj* x6 = fx(6); lean_free_object(f); return reinterpret_cast<fn8>(fn)(x0, x1, x2, x3, x4, x5, x6, a1); }
+    case 9: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); obj* x6 = fx(6); obj* x7 = fx(7); lean_free_object(f); return reinterpret_cast<fn9>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, a1); }
+    case 10: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); obj* x6 = fx(6); obj* x7 = fx(7); obj* x8 = fx(8); lean_free_object(f); return reinterpret_cast<fn10>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, a1); }
+    case 11: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); obj* x6 = fx(6); obj* x7 = fx(7); obj* x8 = fx(8); obj* x9 = fx(9); lean_free_object(f); return reinterpret_cast<fn11>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, a1); }
+    case 12: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); obj* x6 = fx(6); obj* x7 = fx(7); obj* x8 = fx(8); obj* x9 = fx(9); obj* x10 = fx(10); lean_free_object(f); return reinterpret_cast<fn12>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, a1); }
+    case 13: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); obj* x6 = fx(6); obj* x7 = fx(7); obj* x8 = fx(8); obj* x9 = fx(9); obj* x10 = fx(10); obj* x11 = fx(11); lean_free_object(f); return reinterpret_cast<fn13>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, a1); }
+    case 14: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); obj* x6 = fx(6); obj* x7 = fx(7); obj* x8 = fx(8); obj* x9 = fx(9); obj* x10 = fx(10); obj* x11 = fx(11); obj* x12 = fx(12); lean_free_object(f); return reinterpret_cast<fn14>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, a1); }
+    case 15: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); obj* x6 = fx(6); obj* x7 = fx(7); obj* x8 = fx(8); obj* x9 = fx(9); obj* x10 = fx(10); obj* x11 = fx(11); obj* x12 = fx(12); obj* x13 = fx(13); lean_free_object(f); return reinterpret_cast<fn15>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, a1); }
+    case 16: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); obj* x6 = fx(6); obj* x7 = fx(7); obj* x8 = fx(8); obj* x9 = fx(9); obj* x10 = fx(10); obj* x11 = fx(11); obj* x12 = fx(12); obj* x13 = fx(13); obj* x14 = fx(14); lean_free_object(f); return reinterpret_cast<fn16>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14, a1); }
     }
   }
   switch (arity) {
-  case 1: { obj* r = FN1(f)(a1); lean_dec_ref(f); return r; }
-  case 2: { lean_inc(fx(0)); obj* r = FN2(f)(fx(0), a1); lean_dec_ref(f); return r; }
-  case 3: { lean_inc(fx(0)); lean_inc(fx(1)); obj* r = FN3(f)(fx(0), fx(1), a1); lean_dec_ref(f); return r; }
-  case 4: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); obj* r = FN4(f)(fx(0), fx(1), fx(2), a1); lean_dec_ref(f); return r; }
-  case 5: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); obj* r = FN5(f)(fx(0), fx(1), fx(2), fx(3), a1); lean_dec_ref(f); return r; }
-  case 6: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); obj* r = FN6(f)(fx(0), fx(1), fx(2), fx(3), fx(4), a1); lean_dec_ref(f); return r; }
-  case 7: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); obj* r = FN7(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), a1); lean_dec_ref(f); return r; }
-  case 8: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); lean_inc(fx(6)); obj* r = FN8(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), a1); lean_dec_ref(f); return r; }
-  case 9: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); lean_inc(fx(6)); lean_inc(fx(7)); obj* r = FN9(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), a1); lean_dec_ref(f); return r; }
-  case 10: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); lean_inc(fx(6)); lean_inc(fx(7)); lean_inc(fx(8)); obj* r = FN10(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), a1); lean_dec_ref(f); return r; }
-  case 11: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); lean_inc(fx(6)); lean_inc(fx(7)); lean_inc(fx(8)); lean_inc(fx(9)); obj* r = FN11(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), fx(9), a1); lean_dec_ref(f); return r; }
-  case 12: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); lean_inc(fx(6)); lean_inc(fx(7)); lean_inc(fx(8)); lean_inc(fx(9)); lean_inc(fx(10)); obj* r = FN12(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), fx(9), fx(10), a1); lean_dec_ref(f); return r; }
-  case 13: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); lean_inc(fx(6)); lean_inc(fx(7)); lean_inc(fx(8)); lean_inc(fx(9)); lean_inc(fx(10)); lean_inc(fx(11)); obj* r = FN13(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), fx(9), fx(10), fx(11), a1); lean_dec_ref(f); return r; }
-  case 14: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); lean_inc(fx(6)); lean_inc(fx(7)); lean_inc(fx(8)); lean_inc(fx(9)); lean_inc(fx(10)); lean_inc(fx(11)); lean_inc(fx(12)); obj* r = FN14(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), fx(9), fx(10), fx(11), fx(12), a1); lean_dec_ref(f); return r; }
-  case 15: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); lean_inc(fx(6)); lean_inc(fx(7)); lean_inc(fx(8)); lean_inc(fx(9)); lean_inc(fx(10)); lean_inc(fx(11)); lean_inc(fx(12)); lean_inc(fx(13)); obj* r = FN15(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), fx(9), fx(10), fx(11), fx(12), fx(13), a1); lean_dec_ref(f); return r; }
-  case 16: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); lean_inc(fx(6)); lean_inc(fx(7)); lean_inc(fx(8)); lean_inc(fx(9)); lean_inc(fx(10)); lean_inc(fx(11)); lean_inc(fx(12)); lean_inc(fx(13)); lean_inc(fx(14)); obj* r = FN16(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), fx(9), fx(10), fx(11), fx(12), fx(13), fx(14), a1); lean_dec_ref(f); return r; }
+  case 1: { lean_dec_ref(f); return reinterpret_cast<fn1>(fn)(a1); }
+  case 2: { obj* x0 = fx(0); lean_inc(x0); lean_dec_ref(f); return reinterpret_cast<fn2>(fn)(x0, a1); }
+  case 3: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); lean_dec_ref(f); return reinterpret_cast<fn3>(fn)(x0, x1, a1); }
+  case 4: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); lean_dec_ref(f); return reinterpret_cast<fn4>(fn)(x0, x1, x2, a1); }
+  case 5: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); lean_dec_ref(f); return reinterpret_cast<fn5>(fn)(x0, x1, x2, x3, a1); }
+  case 6: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); lean_dec_ref(f); return reinterpret_cast<fn6>(fn)(x0, x1, x2, x3, x4, a1); }
+  case 7: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); lean_dec_ref(f); return reinterpret_cast<fn7>(fn)(x0, x1, x2, x3, x4, x5, a1); }
+  case 8: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); obj* x6 = fx(6); lean_inc(x6); lean_dec_ref(f); return reinterpret_cast<fn8>(fn)(x0, x1, x2, x3, x4, x5, x6, a1); }
+  case 9: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); obj* x6 = fx(6); lean_inc(x6); obj* x7 = fx(7); lean_inc(x7); lean_dec_ref(f); return reinterpret_cast<fn9>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, a1); }
+  case 10: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); obj* x6 = fx(6); lean_inc(x6); obj* x7 = fx(7); lean_inc(x7); obj* x8 = fx(8); lean_inc(x8); lean_dec_ref(f); return reinterpret_cast<fn10>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, a1); }
+  case 11: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); obj* x6 = fx(6); lean_inc(x6); obj* x7 = fx(7); lean_inc(x7); obj* x8 = fx(8); lean_inc(x8); obj* x9 = fx(9); lean_inc(x9); lean_dec_ref(f); return reinterpret_cast<fn11>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, a1); }
+  case 12: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); obj* x6 = fx(6); lean_inc(x6); obj* x7 = fx(7); lean_inc(x7); obj* x8 = fx(8); lean_inc(x8); obj* x9 = fx(9); lean_inc(x9); obj* x10 = fx(10); lean_inc(x10); lean_dec_ref(f); return reinterpret_cast<fn12>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, a1); }
+  case 13: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); obj* x6 = fx(6); lean_inc(x6); obj* x7 = fx(7); lean_inc(x7); obj* x8 = fx(8); lean_inc(x8); obj* x9 = fx(9); lean_inc(x9); obj* x10 = fx(10); lean_inc(x10); obj* x11 = fx(11); lean_inc(x11); lean_dec_ref(f); return reinterpret_cast<fn13>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, a1); }
+  case 14: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); obj* x6 = fx(6); lean_inc(x6); obj* x7 = fx(7); lean_inc(x7); obj* x8 = fx(8); lean_inc(x8); obj* x9 = fx(9); lean_inc(x9); obj* x10 = fx(10); lean_inc(x10); obj* x11 = fx(11); lean_inc(x11); obj* x12 = fx(12); lean_inc(x12); lean_dec_ref(f); return reinterpret_cast<fn14>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, a1); }
+  case 15: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); obj* x6 = fx(6); lean_inc(x6); obj* x7 = fx(7); lean_inc(x7); obj* x8 = fx(8); lean_inc(x8); obj* x9 = fx(9); lean_inc(x9); obj* x10 = fx(10); lean_inc(x10); obj* x11 = fx(11); lean_inc(x11); obj* x12 = fx(12); lean_inc(x12); obj* x13 = fx(13); lean_inc(x13); lean_dec_ref(f); return reinterpret_cast<fn15>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, a1); }
+  case 16: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); obj* x6 = fx(6); lean_inc(x6); obj* x7 = fx(7); lean_inc(x7); obj* x8 = fx(8); lean_inc(x8); obj* x9 = fx(9); lean_inc(x9); obj* x10 = fx(10); lean_inc(x10); obj* x11 = fx(11); lean_inc(x11); obj* x12 = fx(12); lean_inc(x12); obj* x13 = fx(13); lean_inc(x13); obj* x14 = fx(14); lean_inc(x14); lean_dec_ref(f); return reinterpret_cast<fn16>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14, a1); }
   default:
     lean_assert(arity > 16);
     obj * as[1] = { a1 };
     obj ** args = static_cast<obj**>(LEAN_ALLOCA(arity*sizeof(obj*))); // NOLINT
-    for (unsigned i = 0; i < fixed; i++) { lean_inc(fx(i)); args[i] = fx(i); }
+    move_fixed_args(f, args);
     for (unsigned i = 0; i < 1; i++) args[fixed+i] = as[i];
-    obj * r = FNN(f)(args);
-    lean_dec_ref(f);
-    return r;
+    return reinterpret_cast<fnn>(fn)(args);
   }
 } else if (arity < fixed + 1) {
   lean_assert(fixed < arity);
@@ -162,58 +177,56 @@ if (lean_is_scalar(f)) { lean_dec(a1); lean_dec(a2); return f; } // f is an eras
 unsigned arity = lean_closure_arity(f);
 unsigned fixed = lean_closure_num_fixed(f);
 if (arity == fixed + 2) {
+  void * fn = lean_closure_fun(f);
   if (lean_is_exclusive(f)) {
     switch (arity) {
-    case 2: { obj* r = FN2(f)(a1, a2); lean_free_object(f); return r; }
-    case 3: { obj* r = FN3(f)(fx(0), a1, a2); lean_free_object(f); return r; }
-    case 4: { obj* r = FN4(f)(fx(0), fx(1), a1, a2); lean_free_object(f); return r; }
-    case 5: { obj* r = FN5(f)(fx(0), fx(1), fx(2), a1, a2); lean_free_object(f); return r; }
-    case 6: { obj* r = FN6(f)(fx(0), fx(1), fx(2), fx(3), a1, a2); lean_free_object(f); return r; }
-    case 7: { obj* r = FN7(f)(fx(0), fx(1), fx(2), fx(3), fx(4), a1, a2); lean_free_object(f); return r; }
-    case 8: { obj* r = FN8(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), a1, a2); lean_free_object(f); return r; }
-    case 9: { obj* r = FN9(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), a1, a2); lean_free_object(f); return r; }
-    case 10: { obj* r = FN10(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), a1, a2); lean_free_object(f); return r; }
-    case 11: { obj* r = FN11(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), a1, a2); lean_free_object(f); return r; }
-    case 12: { obj* r = FN12(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), fx(9), a1, a2); lean_free_object(f); return r; }
-    case 13: { obj* r = FN13(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), fx(9), fx(10), a1, a2); lean_free_object(f); return r; }
-    case 14: { obj* r = FN14(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), fx(9), fx(10), fx(11), a1, a2); lean_free_object(f); return r; }
-    case 15: { obj* r = FN15(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), fx(9), fx(10), fx(11), fx(12), a1, a2); lean_free_object(f); return r; }
-    case 16: { obj* r = FN16(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), fx(9), fx(10), fx(11), fx(12), fx(13), a1, a2); lean_free_object(f); return r; }
+    case 2: { lean_free_object(f); return reinterpret_cast<fn2>(fn)(a1, a2); }
+    case 3: { obj* x0 = fx(0); lean_free_object(f); return reinterpret_cast<fn3>(fn)(x0, a1, a2); }
+    case 4: { obj* x0 = fx(0); obj* x1 = fx(1); lean_free_object(f); return reinterpret_cast<fn4>(fn)(x0, x1, a1, a2); }
+    case 5: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); lean_free_object(f); return reinterpret_cast<fn5>(fn)(x0, x1, x2, a1, a2); }
+    case 6: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); lean_free_object(f); return reinterpret_cast<fn6>(fn)(x0, x1, x2, x3, a1, a2); }
+    case 7: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); lean_free_object(f); return reinterpret_cast<fn7>(fn)(x0, x1, x2, x3, x4, a1, a2); }
+    case 8: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); lean_free_object(f); return reinterpret_cast<fn8>(fn)(x0, x1, x2, x3, x4, x5, a1, a2); }
+    case 9: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); obj* x6 = fx(6); lean_free_object(f); return reinterpret_cast<fn9>(fn)(x0, x1, x2, x3, x4, x5, x6, a1, a2); }
+    case 10: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); obj* x6 = fx(6); obj* x7 = fx(7); lean_free_object(f); return reinterpret_cast<fn10>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, a1, a2); }
+    case 11: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); obj* x6 = fx(6); obj* x7 = fx(7); obj* x8 = fx(8); lean_free_object(f); return reinterpret_cast<fn11>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, a1, a2); }
+    case 12: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); obj* x6 = fx(6); obj* x7 = fx(7); obj* x8 = fx(8); obj* x9 = fx(9); lean_free_object(f); return reinterpret_cast<fn12>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, a1, a2); }
+    case 13: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); obj* x6 = fx(6); obj* x7 = fx(7); obj* x8 = fx(8); obj* x9 = fx(9); obj* x10 = fx(10); lean_free_object(f); return reinterpret_cast<fn13>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, a1, a2); }
+    case 14: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); obj* x6 = fx(6); obj* x7 = fx(7); obj* x8 = fx(8); obj* x9 = fx(9); obj* x10 = fx(10); obj* x11 = fx(11); lean_free_object(f); return reinterpret_cast<fn14>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, a1, a2); }
+    case 15: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); obj* x6 = fx(6); obj* x7 = fx(7); obj* x8 = fx(8); obj* x9 = fx(9); obj* x10 = fx(10); obj* x11 = fx(11); obj* x12 = fx(12); lean_free_object(f); return reinterpret_cast<fn15>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, a1, a2); }
+    case 16: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); obj* x6 = fx(6); obj* x7 = fx(7); obj* x8 = fx(8); obj* x9 = fx(9); obj* x10 = fx(10); obj* x11 = fx(11); obj* x12 = fx(12); obj* x13 = fx(13); lean_free_object(f); return reinterpret_cast<fn16>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, a1, a2); }
     }
   }
   switch (arity) {
-  case 2: { obj* r = FN2(f)(a1, a2); lean_dec_ref(f); return r; }
-  case 3: { lean_inc(fx(0)); obj* r = FN3(f)(fx(0), a1, a2); lean_dec_ref(f); return r; }
-  case 4: { lean_inc(fx(0)); lean_inc(fx(1)); obj* r = FN4(f)(fx(0), fx(1), a1, a2); lean_dec_ref(f); return r; }
-  case 5: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); obj* r = FN5(f)(fx(0), fx(1), fx(2), a1, a2); lean_dec_ref(f); return r; }
-  case 6: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); obj* r = FN6(f)(fx(0), fx(1), fx(2), fx(3), a1, a2); lean_dec_ref(f); return r; }
-  case 7: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); obj* r = FN7(f)(fx(0), fx(1), fx(2), fx(3), fx(4), a1, a2); lean_dec_ref(f); return r; }
-  case 8: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); obj* r = FN8(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), a1, a2); lean_dec_ref(f); return r; }
-  case 9: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); lean_inc(fx(6)); obj* r = FN9(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), a1, a2); lean_dec_ref(f); return r; }
-  case 10: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); lean_inc(fx(6)); lean_inc(fx(7)); obj* r = FN10(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), a1, a2); lean_dec_ref(f); return r; }
-  case 11: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); lean_inc(fx(6)); lean_inc(fx(7)); lean_inc(fx(8)); obj* r = FN11(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), a1, a2); lean_dec_ref(f); return r; }
-  case 12: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); lean_inc(fx(6)); lean_inc(fx(7)); lean_inc(fx(8)); lean_inc(fx(9)); obj* r = FN12(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), fx(9), a1, a2); lean_dec_ref(f); return r; }
-  case 13: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); lean_inc(fx(6)); lean_inc(fx(7)); lean_inc(fx(8)); lean_inc(fx(9)); lean_inc(fx(10)); obj* r = FN13(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), fx(9), fx(10), a1, a2); lean_dec_ref(f); return r; }
-  case 14: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); lean_inc(fx(6)); lean_inc(fx(7)); lean_inc(fx(8)); lean_inc(fx(9)); lean_inc(fx(10)); lean_inc(fx(11)); obj* r = FN14(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), fx(9), fx(10), fx(11), a1, a2); lean_dec_ref(f); return r; }
-  case 15: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); lean_inc(fx(6)); lean_inc(fx(7)); lean_inc(fx(8)); lean_inc(fx(9)); lean_inc(fx(10)); lean_inc(fx(11)); lean_inc(fx(12)); obj* r = FN15(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), fx(9), fx(10), fx(11), fx(12), a1, a2); lean_dec_ref(f); return r; }
-  case 16: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); lean_inc(fx(6)); lean_inc(fx(7)); lean_inc(fx(8)); lean_inc(fx(9)); lean_inc(fx(10)); lean_inc(fx(11)); lean_inc(fx(12)); lean_inc(fx(13)); obj* r = FN16(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), fx(9), fx(10), fx(11), fx(12), fx(13), a1, a2); lean_dec_ref(f); return r; }
+  case 2: { lean_dec_ref(f); return reinterpret_cast<fn2>(fn)(a1, a2); }
+  case 3: { obj* x0 = fx(0); lean_inc(x0); lean_dec_ref(f); return reinterpret_cast<fn3>(fn)(x0, a1, a2); }
+  case 4: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); lean_dec_ref(f); return reinterpret_cast<fn4>(fn)(x0, x1, a1, a2); }
+  case 5: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); lean_dec_ref(f); return reinterpret_cast<fn5>(fn)(x0, x1, x2, a1, a2); }
+  case 6: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); lean_dec_ref(f); return reinterpret_cast<fn6>(fn)(x0, x1, x2, x3, a1, a2); }
+  case 7: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); lean_dec_ref(f); return reinterpret_cast<fn7>(fn)(x0, x1, x2, x3, x4, a1, a2); }
+  case 8: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); lean_dec_ref(f); return reinterpret_cast<fn8>(fn)(x0, x1, x2, x3, x4, x5, a1, a2); }
+  case 9: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); obj* x6 = fx(6); lean_inc(x6); lean_dec_ref(f); return reinterpret_cast<fn9>(fn)(x0, x1, x2, x3, x4, x5, x6, a1, a2); }
+  case 10: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); obj* x6 = fx(6); lean_inc(x6); obj* x7 = fx(7); lean_inc(x7); lean_dec_ref(f); return reinterpret_cast<fn10>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, a1, a2); }
+  case 11: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); obj* x6 = fx(6); lean_inc(x6); obj* x7 = fx(7); lean_inc(x7); obj* x8 = fx(8); lean_inc(x8); lean_dec_ref(f); return reinterpret_cast<fn11>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, a1, a2); }
+  case 12: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); obj* x6 = fx(6); lean_inc(x6); obj* x7 = fx(7); lean_inc(x7); obj* x8 = fx(8); lean_inc(x8); obj* x9 = fx(9); lean_inc(x9); lean_dec_ref(f); return reinterpret_cast<fn12>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, a1, a2); }
+  case 13: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); obj* x6 = fx(6); lean_inc(x6); obj* x7 = fx(7); lean_inc(x7); obj* x8 = fx(8); lean_inc(x8); obj* x9 = fx(9); lean_inc(x9); obj* x10 = fx(10); lean_inc(x10); lean_dec_ref(f); return reinterpret_cast<fn13>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, a1, a2); }
+  case 14: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); obj* x6 = fx(6); lean_inc(x6); obj* x7 = fx(7); lean_inc(x7); obj* x8 = fx(8); lean_inc(x8); obj* x9 = fx(9); lean_inc(x9); obj* x10 = fx(10); lean_inc(x10); obj* x11 = fx(11); lean_inc(x11); lean_dec_ref(f); return reinterpret_cast<fn14>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, a1, a2); }
+  case 15: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); obj* x6 = fx(6); lean_inc(x6); obj* x7 = fx(7); lean_inc(x7); obj* x8 = fx(8); lean_inc(x8); obj* x9 = fx(9); lean_inc(x9); obj* x10 = fx(10); lean_inc(x10); obj* x11 = fx(11); lean_inc(x11); obj* x12 = fx(12); lean_inc(x12); lean_dec_ref(f); return reinterpret_cast<fn15>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, a1, a2); }
+  case 16: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); obj* x6 = fx(6); lean_inc(x6); obj* x7 = fx(7); lean_inc(x7); obj* x8 = fx(8); lean_inc(x8); obj* x9 = fx(9); lean_inc(x9); obj* x10 = fx(10); lean_inc(x10); obj* x11 = fx(11); lean_inc(x11); obj* x12 = fx(12); lean_inc(x12); obj* x13 = fx(13); lean_inc(x13); lean_dec_ref(f); return reinterpret_cast<fn16>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, a1, a2); }
   default:
     lean_assert(arity > 16);
     obj * as[2] = { a1, a2 };
     obj ** args = static_cast<obj**>(LEAN_ALLOCA(arity*sizeof(obj*))); // NOLINT
-    for (unsigned i = 0; i < fixed; i++) { lean_inc(fx(i)); args[i] = fx(i); }
+    move_fixed_args(f, args);
     for (unsigned i = 0; i < 2; i++) args[fixed+i] = as[i];
-    obj * r = FNN(f)(args);
-    lean_dec_ref(f);
-    return r;
+    return reinterpret_cast<fnn>(fn)(args);
   }
 } else if (arity < fixed + 2) {
   obj * as[2] = { a1, a2 };
   obj ** args = static_cast<obj**>(LEAN_ALLOCA(arity*sizeof(obj*))); // NOLINT
-  for (unsigned i = 0; i < fixed; i++) { lean_inc(fx(i)); args[i] = fx(i); }
+  void * fn = move_fixed_args(f, args);
   for (unsigned i = 0; i < arity-fixed; i++) args[fixed+i] = as[i];
-  obj * new_f = curry(f, arity, args);
-  lean_dec_ref(f);
+  obj * new_f = curry(fn, arity, args);
   return lean_apply_n(new_f, 2+fixed-arity, &as[arity-fixed]);
 } else {
   return fix_args(f, {a1, a2});
@@ -224,56 +237,54 @@ if (lean_is_scalar(f)) { lean_dec(a1); lean_dec(a2); lean_dec(a3); return f; } /
 unsigned arity = lean_closure_arity(f);
 unsigned fixed = lean_closure_num_fixed(f);
 if (arity == fixed + 3) {
+  void * fn = lean_closure_fun(f);
   if (lean_is_exclusive(f)) {
     switch (arity) {
-    case 3: { obj* r = FN3(f)(a1, a2, a3); lean_free_object(f); return r; }
-    case 4: { obj* r = FN4(f)(fx(0), a1, a2, a3); lean_free_object(f); return r; }
-    case 5: { obj* r = FN5(f)(fx(0), fx(1), a1, a2, a3); lean_free_object(f); return r; }
-    case 6: { obj* r = FN6(f)(fx(0), fx(1), fx(2), a1, a2, a3); lean_free_object(f); return r; }
-    case 7: { obj* r = FN7(f)(fx(0), fx(1), fx(2), fx(3), a1, a2, a3); lean_free_object(f); return r; }
-    case 8: { obj* r = FN8(f)(fx(0), fx(1), fx(2), fx(3), fx(4), a1, a2, a3); lean_free_object(f); return r; }
-    case 9: { obj* r = FN9(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), a1, a2, a3); lean_free_object(f); return r; }
-    case 10: { obj* r = FN10(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), a1, a2, a3); lean_free_object(f); return r; }
-    case 11: { obj* r = FN11(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), a1, a2, a3); lean_free_object(f); return r; }
-    case 12: { obj* r = FN12(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), a1, a2, a3); lean_free_object(f); return r; }
-    case 13: { obj* r = FN13(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), fx(9), a1, a2, a3); lean_free_object(f); return r; }
-    case 14: { obj* r = FN14(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), fx(9), fx(10), a1, a2, a3); lean_free_object(f); return r; }
-    case 15: { obj* r = FN15(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), fx(9), fx(10), fx(11), a1, a2, a3); lean_free_object(f); return r; }
-    case 16: { obj* r = FN16(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), fx(9), fx(10), fx(11), fx(12), a1, a2, a3); lean_free_object(f); return r; }
+    case 3: { lean_free_object(f); return reinterpret_cast<fn3>(fn)(a1, a2, a3); }
+    case 4: { obj* x0 = fx(0); lean_free_object(f); return reinterpret_cast<fn4>(fn)(x0, a1, a2, a3); }
+    case 5: { obj* x0 = fx(0); obj* x1 = fx(1); lean_free_object(f); return reinterpret_cast<fn5>(fn)(x0, x1, a1, a2, a3); }
+    case 6: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); lean_free_object(f); return reinterpret_cast<fn6>(fn)(x0, x1, x2, a1, a2, a3); }
+    case 7: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); lean_free_object(f); return reinterpret_cast<fn7>(fn)(x0, x1, x2, x3, a1, a2, a3); }
+    case 8: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); lean_free_object(f); return reinterpret_cast<fn8>(fn)(x0, x1, x2, x3, x4, a1, a2, a3); }
+    case 9: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); lean_free_object(f); return reinterpret_cast<fn9>(fn)(x0, x1, x2, x3, x4, x5, a1, a2, a3); }
+    case 10: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); obj* x6 = fx(6); lean_free_object(f); return reinterpret_cast<fn10>(fn)(x0, x1, x2, x3, x4, x5, x6, a1, a2, a3); }
+    case 11: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); obj* x6 = fx(6); obj* x7 = fx(7); lean_free_object(f); return reinterpret_cast<fn11>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, a1, a2, a3); }
+    case 12: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); obj* x6 = fx(6); obj* x7 = fx(7); obj* x8 = fx(8); lean_free_object(f); return reinterpret_cast<fn12>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, a1, a2, a3); }
+    case 13: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); obj* x6 = fx(6); obj* x7 = fx(7); obj* x8 = fx(8); obj* x9 = fx(9); lean_free_object(f); return reinterpret_cast<fn13>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, a1, a2, a3); }
+    case 14: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); obj* x6 = fx(6); obj* x7 = fx(7); obj* x8 = fx(8); obj* x9 = fx(9); obj* x10 = fx(10); lean_free_object(f); return reinterpret_cast<fn14>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, a1, a2, a3); }
+    case 15: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); obj* x6 = fx(6); obj* x7 = fx(7); obj* x8 = fx(8); obj* x9 = fx(9); obj* x10 = fx(10); obj* x11 = fx(11); lean_free_object(f); return reinterpret_cast<fn15>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, a1, a2, a3); }
+    case 16: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); obj* x6 = fx(6); obj* x7 = fx(7); obj* x8 = fx(8); obj* x9 = fx(9); obj* x10 = fx(10); obj* x11 = fx(11); obj* x12 = fx(12); lean_free_object(f); return reinterpret_cast<fn16>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, a1, a2, a3); }
     }
   }
   switch (arity) {
-  case 3: { obj* r = FN3(f)(a1, a2, a3); lean_dec_ref(f); return r; }
-  case 4: { lean_inc(fx(0)); obj* r = FN4(f)(fx(0), a1, a2, a3); lean_dec_ref(f); return r; }
-  case 5: { lean_inc(fx(0)); lean_inc(fx(1)); obj* r = FN5(f)(fx(0), fx(1), a1, a2, a3); lean_dec_ref(f); return r; }
-  case 6: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); obj* r = FN6(f)(fx(0), fx(1), fx(2), a1, a2, a3); lean_dec_ref(f); return r; }
-  case 7: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); obj* r = FN7(f)(fx(0), fx(1), fx(2), fx(3), a1, a2, a3); lean_dec_ref(f); return r; }
-  case 8: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); obj* r = FN8(f)(fx(0), fx(1), fx(2), fx(3), fx(4), a1, a2, a3); lean_dec_ref(f); return r; }
-  case 9: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); obj* r = FN9(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), a1, a2, a3); lean_dec_ref(f); return r; }
-  case 10: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); lean_inc(fx(6)); obj* r = FN10(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), a1, a2, a3); lean_dec_ref(f); return r; }
-  case 11: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); lean_inc(fx(6)); lean_inc(fx(7)); obj* r = FN11(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), a1, a2, a3); lean_dec_ref(f); return r; }
-  case 12: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); lean_inc(fx(6)); lean_inc(fx(7)); lean_inc(fx(8)); obj* r = FN12(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), a1, a2, a3); lean_dec_ref(f); return r; }
-  case 13: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); lean_inc(fx(6)); lean_inc(fx(7)); lean_inc(fx(8)); lean_inc(fx(9)); obj* r = FN13(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), fx(9), a1, a2, a3); lean_dec_ref(f); return r; }
-  case 14: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); lean_inc(fx(6)); lean_inc(fx(7)); lean_inc(fx(8)); lean_inc(fx(9)); lean_inc(fx(10)); obj* r = FN14(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), fx(9), fx(10), a1, a2, a3); lean_dec_ref(f); return r; }
-  case 15: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); lean_inc(fx(6)); lean_inc(fx(7)); lean_inc(fx(8)); lean_inc(fx(9)); lean_inc(fx(10)); lean_inc(fx(11)); obj* r = FN15(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), fx(9), fx(10), fx(11), a1, a2, a3); lean_dec_ref(f); return r; }
-  case 16: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); lean_inc(fx(6)); lean_inc(fx(7)); lean_inc(fx(8)); lean_inc(fx(9)); lean_inc(fx(10)); lean_inc(fx(11)); lean_inc(fx(12)); obj* r = FN16(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), fx(9), fx(10), fx(11), fx(12), a1, a2, a3); lean_dec_ref(f); return r; }
+  case 3: { lean_dec_ref(f); return reinterpret_cast<fn3>(fn)(a1, a2, a3); }
+  case 4: { obj* x0 = fx(0); lean_inc(x0); lean_dec_ref(f); return reinterpret_cast<fn4>(fn)(x0, a1, a2, a3); }
+  case 5: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); lean_dec_ref(f); return reinterpret_cast<fn5>(fn)(x0, x1, a1, a2, a3); }
+  case 6: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); lean_dec_ref(f); return reinterpret_cast<fn6>(fn)(x0, x1, x2, a1, a2, a3); }
+  case 7: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); lean_dec_ref(f); return reinterpret_cast<fn7>(fn)(x0, x1, x2, x3, a1, a2, a3); }
+  case 8: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); lean_dec_ref(f); return reinterpret_cast<fn8>(fn)(x0, x1, x2, x3, x4, a1, a2, a3); }
+  case 9: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); lean_dec_ref(f); return reinterpret_cast<fn9>(fn)(x0, x1, x2, x3, x4, x5, a1, a2, a3); }
+  case 10: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); obj* x6 = fx(6); lean_inc(x6); lean_dec_ref(f); return reinterpret_cast<fn10>(fn)(x0, x1, x2, x3, x4, x5, x6, a1, a2, a3); }
+  case 11: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); obj* x6 = fx(6); lean_inc(x6); obj* x7 = fx(7); lean_inc(x7); lean_dec_ref(f); return reinterpret_cast<fn11>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, a1, a2, a3); }
+  case 12: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); obj* x6 = fx(6); lean_inc(x6); obj* x7 = fx(7); lean_inc(x7); obj* x8 = fx(8); lean_inc(x8); lean_dec_ref(f); return reinterpret_cast<fn12>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, a1, a2, a3); }
+  case 13: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); obj* x6 = fx(6); lean_inc(x6); obj* x7 = fx(7); lean_inc(x7); obj* x8 = fx(8); lean_inc(x8); obj* x9 = fx(9); lean_inc(x9); lean_dec_ref(f); return reinterpret_cast<fn13>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, a1, a2, a3); }
+  case 14: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); obj* x6 = fx(6); lean_inc(x6); obj* x7 = fx(7); lean_inc(x7); obj* x8 = fx(8); lean_inc(x8); obj* x9 = fx(9); lean_inc(x9); obj* x10 = fx(10); lean_inc(x10); lean_dec_ref(f); return reinterpret_cast<fn14>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, a1, a2, a3); }
+  case 15: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); obj* x6 = fx(6); lean_inc(x6); obj* x7 = fx(7); lean_inc(x7); obj* x8 = fx(8); lean_inc(x8); obj* x9 = fx(9); lean_inc(x9); obj* x10 = fx(10); lean_inc(x10); obj* x11 = fx(11); lean_inc(x11); lean_dec_ref(f); return reinterpret_cast<fn15>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, a1, a2, a3); }
+  case 16: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); obj* x6 = fx(6); lean_inc(x6); obj* x7 = fx(7); lean_inc(x7); obj* x8 = fx(8); lean_inc(x8); obj* x9 = fx(9); lean_inc(x9); obj* x10 = fx(10); lean_inc(x10); obj* x11 = fx(11); lean_inc(x11); obj* x12 = fx(12); lean_inc(x12); lean_dec_ref(f); return reinterpret_cast<fn16>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, a1, a2, a3); }
   default:
     lean_assert(arity > 16);
     obj * as[3] = { a1, a2, a3 };
     obj ** args = static_cast<obj**>(LEAN_ALLOCA(arity*sizeof(obj*))); // NOLINT
-    for (unsigned i = 0; i < fixed; i++) { lean_inc(fx(i)); args[i] = fx(i); }
+    move_fixed_args(f, args);
     for (unsigned i = 0; i < 3; i++) args[fixed+i] = as[i];
-    obj * r = FNN(f)(args);
-    lean_dec_ref(f);
-    return r;
+    return reinterpret_cast<fnn>(fn)(args);
   }
 } else if (arity < fixed + 3) {
   obj * as[3] = { a1, a2, a3 };
   obj ** args = static_cast<obj**>(LEAN_ALLOCA(arity*sizeof(obj*))); // NOLINT
-  for (unsigned i = 0; i < fixed; i++) { lean_inc(fx(i)); args[i] = fx(i); }
+  void * fn = move_fixed_args(f, args);
   for (unsigned i = 0; i < arity-fixed; i++) args[fixed+i] = as[i];
-  obj * new_f = curry(f, arity, args);
-  lean_dec_ref(f);
+  obj * new_f = curry(fn, arity, args);
   return lean_apply_n(new_f, 3+fixed-arity, &as[arity-fixed]);
 } else {
   return fix_args(f, {a1, a2, a3});
@@ -284,54 +295,52 @@ if (lean_is_scalar(f)) { lean_dec(a1); lean_dec(a2); lean_dec(a3); lean_dec(a4);
 unsigned arity = lean_closure_arity(f);
 unsigned fixed = lean_closure_num_fixed(f);
 if (arity == fixed + 4) {
+  void * fn = lean_closure_fun(f);
   if (lean_is_exclusive(f)) {
     switch (arity) {
-    case 4: { obj* r = FN4(f)(a1, a2, a3, a4); lean_free_object(f); return r; }
-    case 5: { obj* r = FN5(f)(fx(0), a1, a2, a3, a4); lean_free_object(f); return r; }
-    case 6: { obj* r = FN6(f)(fx(0), fx(1), a1, a2, a3, a4); lean_free_object(f); return r; }
-    case 7: { obj* r = FN7(f)(fx(0), fx(1), fx(2), a1, a2, a3, a4); lean_free_object(f); return r; }
-    case 8: { obj* r = FN8(f)(fx(0), fx(1), fx(2), fx(3), a1, a2, a3, a4); lean_free_object(f); return r; }
-    case 9: { obj* r = FN9(f)(fx(0), fx(1), fx(2), fx(3), fx(4), a1, a2, a3, a4); lean_free_object(f); return r; }
-    case 10: { obj* r = FN10(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), a1, a2, a3, a4); lean_free_object(f); return r; }
-    case 11: { obj* r = FN11(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), a1, a2, a3, a4); lean_free_object(f); return r; }
-    case 12: { obj* r = FN12(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), a1, a2, a3, a4); lean_free_object(f); return r; }
-    case 13: { obj* r = FN13(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), a1, a2, a3, a4); lean_free_object(f); return r; }
-    case 14: { obj* r = FN14(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), fx(9), a1, a2, a3, a4); lean_free_object(f); return r; }
-    case 15: { obj* r = FN15(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), fx(9), fx(10), a1, a2, a3, a4); lean_free_object(f); return r; }
-    case 16: { obj* r = FN16(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), fx(9), fx(10), fx(11), a1, a2, a3, a4); lean_free_object(f); return r; }
+    case 4: { lean_free_object(f); return reinterpret_cast<fn4>(fn)(a1, a2, a3, a4); }
+    case 5: { obj* x0 = fx(0); lean_free_object(f); return reinterpret_cast<fn5>(fn)(x0, a1, a2, a3, a4); }
+    case 6: { obj* x0 = fx(0); obj* x1 = fx(1); lean_free_object(f); return reinterpret_cast<fn6>(fn)(x0, x1, a1, a2, a3, a4); }
+    case 7: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); lean_free_object(f); return reinterpret_cast<fn7>(fn)(x0, x1, x2, a1, a2, a3, a4); }
+    case 8: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); lean_free_object(f); return reinterpret_cast<fn8>(fn)(x0, x1, x2, x3, a1, a2, a3, a4); }
+    case 9: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); lean_free_object(f); return reinterpret_cast<fn9>(fn)(x0, x1, x2, x3, x4, a1, a2, a3, a4); }
+    case 10: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); lean_free_object(f); return reinterpret_cast<fn10>(fn)(x0, x1, x2, x3, x4, x5, a1, a2, a3, a4); }
+    case 11: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); obj* x6 = fx(6); lean_free_object(f); return reinterpret_cast<fn11>(fn)(x0, x1, x2, x3, x4, x5, x6, a1, a2, a3, a4); }
+    case 12: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); obj* x6 = fx(6); obj* x7 = fx(7); lean_free_object(f); return reinterpret_cast<fn12>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, a1, a2, a3, a4); }
+    case 13: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); obj* x6 = fx(6); obj* x7 = fx(7); obj* x8 = fx(8); lean_free_object(f); return reinterpret_cast<fn13>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, a1, a2, a3, a4); }
+    case 14: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); obj* x6 = fx(6); obj* x7 = fx(7); obj* x8 = fx(8); obj* x9 = fx(9); lean_free_object(f); return reinterpret_cast<fn14>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, a1, a2, a3, a4); }
+    case 15: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); obj* x6 = fx(6); obj* x7 = fx(7); obj* x8 = fx(8); obj* x9 = fx(9); obj* x10 = fx(10); lean_free_object(f); return reinterpret_cast<fn15>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, a1, a2, a3, a4); }
+    case 16: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); obj* x6 = fx(6); obj* x7 = fx(7); obj* x8 = fx(8); obj* x9 = fx(9); obj* x10 = fx(10); obj* x11 = fx(11); lean_free_object(f); return reinterpret_cast<fn16>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, a1, a2, a3, a4); }
     }
   }
   switch (arity) {
-  case 4: { obj* r = FN4(f)(a1, a2, a3, a4); lean_dec_ref(f); return r; }
-  case 5: { lean_inc(fx(0)); obj* r = FN5(f)(fx(0), a1, a2, a3, a4); lean_dec_ref(f); return r; }
-  case 6: { lean_inc(fx(0)); lean_inc(fx(1)); obj* r = FN6(f)(fx(0), fx(1), a1, a2, a3, a4); lean_dec_ref(f); return r; }
-  case 7: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); obj* r = FN7(f)(fx(0), fx(1), fx(2), a1, a2, a3, a4); lean_dec_ref(f); return r; }
-  case 8: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); obj* r = FN8(f)(fx(0), fx(1), fx(2), fx(3), a1, a2, a3, a4); lean_dec_ref(f); return r; }
-  case 9: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); obj* r = FN9(f)(fx(0), fx(1), fx(2), fx(3), fx(4), a1, a2, a3, a4); lean_dec_ref(f); return r; }
-  case 10: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); obj* r = FN10(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), a1, a2, a3, a4); lean_dec_ref(f); return r; }
-  case 11: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); lean_inc(fx(6)); obj* r = FN11(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), a1, a2, a3, a4); lean_dec_ref(f); return r; }
-  case 12: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); lean_inc(fx(6)); lean_inc(fx(7)); obj* r = FN12(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), a1, a2, a3, a4); lean_dec_ref(f); return r; }
-  case 13: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); lean_inc(fx(6)); lean_inc(fx(7)); lean_inc(fx(8)); obj* r = FN13(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), a1, a2, a3, a4); lean_dec_ref(f); return r; }
-  case 14: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); lean_inc(fx(6)); lean_inc(fx(7)); lean_inc(fx(8)); lean_inc(fx(9)); obj* r = FN14(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), fx(9), a1, a2, a3, a4); lean_dec_ref(f); return r; }
-  case 15: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); lean_inc(fx(6)); lean_inc(fx(7)); lean_inc(fx(8)); lean_inc(fx(9)); lean_inc(fx(10)); obj* r = FN15(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), fx(9), fx(10), a1, a2, a3, a4); lean_dec_ref(f); return r; }
-  case 16: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); lean_inc(fx(6)); lean_inc(fx(7)); lean_inc(fx(8)); lean_inc(fx(9)); lean_inc(fx(10)); lean_inc(fx(11)); obj* r = FN16(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), fx(9), fx(10), fx(11), a1, a2, a3, a4); lean_dec_ref(f); return r; }
+  case 4: { lean_dec_ref(f); return reinterpret_cast<fn4>(fn)(a1, a2, a3, a4); }
+  case 5: { obj* x0 = fx(0); lean_inc(x0); lean_dec_ref(f); return reinterpret_cast<fn5>(fn)(x0, a1, a2, a3, a4); }
+  case 6: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); lean_dec_ref(f); return reinterpret_cast<fn6>(fn)(x0, x1, a1, a2, a3, a4); }
+  case 7: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); lean_dec_ref(f); return reinterpret_cast<fn7>(fn)(x0, x1, x2, a1, a2, a3, a4); }
+  case 8: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); lean_dec_ref(f); return reinterpret_cast<fn8>(fn)(x0, x1, x2, x3, a1, a2, a3, a4); }
+  case 9: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); lean_dec_ref(f); return reinterpret_cast<fn9>(fn)(x0, x1, x2, x3, x4, a1, a2, a3, a4); }
+  case 10: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); lean_dec_ref(f); return reinterpret_cast<fn10>(fn)(x0, x1, x2, x3, x4, x5, a1, a2, a3, a4); }
+  case 11: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); obj* x6 = fx(6); lean_inc(x6); lean_dec_ref(f); return reinterpret_cast<fn11>(fn)(x0, x1, x2, x3, x4, x5, x6, a1, a2, a3, a4); }
+  case 12: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); obj* x6 = fx(6); lean_inc(x6); obj* x7 = fx(7); lean_inc(x7); lean_dec_ref(f); return reinterpret_cast<fn12>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, a1, a2, a3, a4); }
+  case 13: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); obj* x6 = fx(6); lean_inc(x6); obj* x7 = fx(7); lean_inc(x7); obj* x8 = fx(8); lean_inc(x8); lean_dec_ref(f); return reinterpret_cast<fn13>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, a1, a2, a3, a4); }
+  case 14: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); obj* x6 = fx(6); lean_inc(x6); obj* x7 = fx(7); lean_inc(x7); obj* x8 = fx(8); lean_inc(x8); obj* x9 = fx(9); lean_inc(x9); lean_dec_ref(f); return reinterpret_cast<fn14>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, a1, a2, a3, a4); }
+  case 15: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); obj* x6 = fx(6); lean_inc(x6); obj* x7 = fx(7); lean_inc(x7); obj* x8 = fx(8); lean_inc(x8); obj* x9 = fx(9); lean_inc(x9); obj* x10 = fx(10); lean_inc(x10); lean_dec_ref(f); return reinterpret_cast<fn15>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, a1, a2, a3, a4); }
+  case 16: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); obj* x6 = fx(6); lean_inc(x6); obj* x7 = fx(7); lean_inc(x7); obj* x8 = fx(8); lean_inc(x8); obj* x9 = fx(9); lean_inc(x9); obj* x10 = fx(10); lean_inc(x10); obj* x11 = fx(11); lean_inc(x11); lean_dec_ref(f); return reinterpret_cast<fn16>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, a1, a2, a3, a4); }
   default:
     lean_assert(arity > 16);
     obj * as[4] = { a1, a2, a3, a4 };
     obj ** args = static_cast<obj**>(LEAN_ALLOCA(arity*sizeof(obj*))); // NOLINT
-    for (unsigned i = 0; i < fixed; i++) { lean_inc(fx(i)); args[i] = fx(i); }
+    move_fixed_args(f, args);
     for (unsigned i = 0; i < 4; i++) args[fixed+i] = as[i];
-    obj * r = FNN(f)(args);
-    lean_dec_ref(f);
-    return r;
+    return reinterpret_cast<fnn>(fn)(args);
   }
 } else if (arity < fixed + 4) {
   obj * as[4] = { a1, a2, a3, a4 };
   obj ** args = static_cast<obj**>(LEAN_ALLOCA(arity*sizeof(obj*))); // NOLINT
-  for (unsigned i = 0; i < fixed; i++) { lean_inc(fx(i)); args[i] = fx(i); }
+  void * fn = move_fixed_args(f, args);
   for (unsigned i = 0; i < arity-fixed; i++) args[fixed+i] = as[i];
-  obj * new_f = curry(f, arity, args);
-  lean_dec_ref(f);
+  obj * new_f = curry(fn, arity, args);
   return lean_apply_n(new_f, 4+fixed-arity, &as[arity-fixed]);
 } else {
   return fix_args(f, {a1, a2, a3, a4});
@@ -342,52 +351,50 @@ if (lean_is_scalar(f)) { lean_dec(a1); lean_dec(a2); lean_dec(a3); lean_dec(a4);
 unsigned arity = lean_closure_arity(f);
 unsigned fixed = lean_closure_num_fixed(f);
 if (arity == fixed + 5) {
+  void * fn = lean_closure_fun(f);
   if (lean_is_exclusive(f)) {
     switch (arity) {
-    case 5: { obj* r = FN5(f)(a1, a2, a3, a4, a5); lean_free_object(f); return r; }
-    case 6: { obj* r = FN6(f)(fx(0), a1, a2, a3, a4, a5); lean_free_object(f); return r; }
-    case 7: { obj* r = FN7(f)(fx(0), fx(1), a1, a2, a3, a4, a5); lean_free_object(f); return r; }
-    case 8: { obj* r = FN8(f)(fx(0), fx(1), fx(2), a1, a2, a3, a4, a5); lean_free_object(f); return r; }
-    case 9: { obj* r = FN9(f)(fx(0), fx(1), fx(2), fx(3), a1, a2, a3, a4, a5); lean_free_object(f); return r; }
-    case 10: { obj* r = FN10(f)(fx(0), fx(1), fx(2), fx(3), fx(4), a1, a2, a3, a4, a5); lean_free_object(f); return r; }
-    case 11: { obj* r = FN11(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), a1, a2, a3, a4, a5); lean_free_object(f); return r; }
-    case 12: { obj* r = FN12(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), a1, a2, a3, a4, a5); lean_free_object(f); return r; }
-    case 13: { obj* r = FN13(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), a1, a2, a3, a4, a5); lean_free_object(f); return r; }
-    case 14: { obj* r = FN14(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), a1, a2, a3, a4, a5); lean_free_object(f); return r; }
-    case 15: { obj* r = FN15(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), fx(9), a1, a2, a3, a4, a5); lean_free_object(f); return r; }
-    case 16: { obj* r = FN16(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), fx(9), fx(10), a1, a2, a3, a4, a5); lean_free_object(f); return r; }
+    case 5: { lean_free_object(f); return reinterpret_cast<fn5>(fn)(a1, a2, a3, a4, a5); }
+    case 6: { obj* x0 = fx(0); lean_free_object(f); return reinterpret_cast<fn6>(fn)(x0, a1, a2, a3, a4, a5); }
+    case 7: { obj* x0 = fx(0); obj* x1 = fx(1); lean_free_object(f); return reinterpret_cast<fn7>(fn)(x0, x1, a1, a2, a3, a4, a5); }
+    case 8: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); lean_free_object(f); return reinterpret_cast<fn8>(fn)(x0, x1, x2, a1, a2, a3, a4, a5); }
+    case 9: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); lean_free_object(f); return reinterpret_cast<fn9>(fn)(x0, x1, x2, x3, a1, a2, a3, a4, a5); }
+    case 10: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); lean_free_object(f); return reinterpret_cast<fn10>(fn)(x0, x1, x2, x3, x4, a1, a2, a3, a4, a5); }
+    case 11: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); lean_free_object(f); return reinterpret_cast<fn11>(fn)(x0, x1, x2, x3, x4, x5, a1, a2, a3, a4, a5); }
+    case 12: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); obj* x6 = fx(6); lean_free_object(f); return reinterpret_cast<fn12>(fn)(x0, x1, x2, x3, x4, x5, x6, a1, a2, a3, a4, a5); }
+    case 13: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); obj* x6 = fx(6); obj* x7 = fx(7); lean_free_object(f); return reinterpret_cast<fn13>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, a1, a2, a3, a4, a5); }
+    case 14: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); obj* x6 = fx(6); obj* x7 = fx(7); obj* x8 = fx(8); lean_free_object(f); return reinterpret_cast<fn14>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, a1, a2, a3, a4, a5); }
+    case 15: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); obj* x6 = fx(6); obj* x7 = fx(7); obj* x8 = fx(8); obj* x9 = fx(9); lean_free_object(f); return reinterpret_cast<fn15>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, a1, a2, a3, a4, a5); }
+    case 16: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); obj* x6 = fx(6); obj* x7 = fx(7); obj* x8 = fx(8); obj* x9 = fx(9); obj* x10 = fx(10); lean_free_object(f); return reinterpret_cast<fn16>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, a1, a2, a3, a4, a5); }
     }
   }
   switch (arity) {
-  case 5: { obj* r = FN5(f)(a1, a2, a3, a4, a5); lean_dec_ref(f); return r; }
-  case 6: { lean_inc(fx(0)); obj* r = FN6(f)(fx(0), a1, a2, a3, a4, a5); lean_dec_ref(f); return r; }
-  case 7: { lean_inc(fx(0)); lean_inc(fx(1)); obj* r = FN7(f)(fx(0), fx(1), a1, a2, a3, a4, a5); lean_dec_ref(f); return r; }
-  case 8: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); obj* r = FN8(f)(fx(0), fx(1), fx(2), a1, a2, a3, a4, a5); lean_dec_ref(f); return r; }
-  case 9: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); obj* r = FN9(f)(fx(0), fx(1), fx(2), fx(3), a1, a2, a3, a4, a5); lean_dec_ref(f); return r; }
-  case 10: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); obj* r = FN10(f)(fx(0), fx(1), fx(2), fx(3), fx(4), a1, a2, a3, a4, a5); lean_dec_ref(f); return r; }
-  case 11: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); obj* r = FN11(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), a1, a2, a3, a4, a5); lean_dec_ref(f); return r; }
-  case 12: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); lean_inc(fx(6)); obj* r = FN12(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), a1, a2, a3, a4, a5); lean_dec_ref(f); return r; }
-  case 13: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); lean_inc(fx(6)); lean_inc(fx(7)); obj* r = FN13(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), a1, a2, a3, a4, a5); lean_dec_ref(f); return r; }
-  case 14: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); lean_inc(fx(6)); lean_inc(fx(7)); lean_inc(fx(8)); obj* r = FN14(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), a1, a2, a3, a4, a5); lean_dec_ref(f); return r; }
-  case 15: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); lean_inc(fx(6)); lean_inc(fx(7)); lean_inc(fx(8)); lean_inc(fx(9)); obj* r = FN15(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), fx(9), a1, a2, a3, a4, a5); lean_dec_ref(f); return r; }
-  case 16: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); lean_inc(fx(6)); lean_inc(fx(7)); lean_inc(fx(8)); lean_inc(fx(9)); lean_inc(fx(10)); obj* r = FN16(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), fx(9), fx(10), a1, a2, a3, a4, a5); lean_dec_ref(f); return r; }
+  case 5: { lean_dec_ref(f); return reinterpret_cast<fn5>(fn)(a1, a2, a3, a4, a5); }
+  case 6: { obj* x0 = fx(0); lean_inc(x0); lean_dec_ref(f); return reinterpret_cast<fn6>(fn)(x0, a1, a2, a3, a4, a5); }
+  case 7: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); lean_dec_ref(f); return reinterpret_cast<fn7>(fn)(x0, x1, a1, a2, a3, a4, a5); }
+  case 8: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); lean_dec_ref(f); return reinterpret_cast<fn8>(fn)(x0, x1, x2, a1, a2, a3, a4, a5); }
+  case 9: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); lean_dec_ref(f); return reinterpret_cast<fn9>(fn)(x0, x1, x2, x3, a1, a2, a3, a4, a5); }
+  case 10: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); lean_dec_ref(f); return reinterpret_cast<fn10>(fn)(x0, x1, x2, x3, x4, a1, a2, a3, a4, a5); }
+  case 11: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); lean_dec_ref(f); return reinterpret_cast<fn11>(fn)(x0, x1, x2, x3, x4, x5, a1, a2, a3, a4, a5); }
+  case 12: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); obj* x6 = fx(6); lean_inc(x6); lean_dec_ref(f); return reinterpret_cast<fn12>(fn)(x0, x1, x2, x3, x4, x5, x6, a1, a2, a3, a4, a5); }
+  case 13: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); obj* x6 = fx(6); lean_inc(x6); obj* x7 = fx(7); lean_inc(x7); lean_dec_ref(f); return reinterpret_cast<fn13>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, a1, a2, a3, a4, a5); }
+  case 14: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); obj* x6 = fx(6); lean_inc(x6); obj* x7 = fx(7); lean_inc(x7); obj* x8 = fx(8); lean_inc(x8); lean_dec_ref(f); return reinterpret_cast<fn14>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, a1, a2, a3, a4, a5); }
+  case 15: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); obj* x6 = fx(6); lean_inc(x6); obj* x7 = fx(7); lean_inc(x7); obj* x8 = fx(8); lean_inc(x8); obj* x9 = fx(9); lean_inc(x9); lean_dec_ref(f); return reinterpret_cast<fn15>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, a1, a2, a3, a4, a5); }
+  case 16: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); obj* x6 = fx(6); lean_inc(x6); obj* x7 = fx(7); lean_inc(x7); obj* x8 = fx(8); lean_inc(x8); obj* x9 = fx(9); lean_inc(x9); obj* x10 = fx(10); lean_inc(x10); lean_dec_ref(f); return reinterpret_cast<fn16>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, a1, a2, a3, a4, a5); }
   default:
     lean_assert(arity > 16);
     obj * as[5] = { a1, a2, a3, a4, a5 };
     obj ** args = static_cast<obj**>(LEAN_ALLOCA(arity*sizeof(obj*))); // NOLINT
-    for (unsigned i = 0; i < fixed; i++) { lean_inc(fx(i)); args[i] = fx(i); }
+    move_fixed_args(f, args);
     for (unsigned i = 0; i < 5; i++) args[fixed+i] = as[i];
-    obj * r = FNN(f)(args);
-    lean_dec_ref(f);
-    return r;
+    return reinterpret_cast<fnn>(fn)(args);
   }
 } else if (arity < fixed + 5) {
   obj * as[5] = { a1, a2, a3, a4, a5 };
   obj ** args = static_cast<obj**>(LEAN_ALLOCA(arity*sizeof(obj*))); // NOLINT
-  for (unsigned i = 0; i < fixed; i++) { lean_inc(fx(i)); args[i] = fx(i); }
+  void * fn = move_fixed_args(f, args);
   for (unsigned i = 0; i < arity-fixed; i++) args[fixed+i] = as[i];
-  obj * new_f = curry(f, arity, args);
-  lean_dec_ref(f);
+  obj * new_f = curry(fn, arity, args);
   return lean_apply_n(new_f, 5+fixed-arity, &as[arity-fixed]);
 } else {
   return fix_args(f, {a1, a2, a3, a4, a5});
@@ -398,50 +405,48 @@ if (lean_is_scalar(f)) { lean_dec(a1); lean_dec(a2); lean_dec(a3); lean_dec(a4);
 unsigned arity = lean_closure_arity(f);
 unsigned fixed = lean_closure_num_fixed(f);
 if (arity == fixed + 6) {
+  void * fn = lean_closure_fun(f);
   if (lean_is_exclusive(f)) {
     switch (arity) {
-    case 6: { obj* r = FN6(f)(a1, a2, a3, a4, a5, a6); lean_free_object(f); return r; }
-    case 7: { obj* r = FN7(f)(fx(0), a1, a2, a3, a4, a5, a6); lean_free_object(f); return r; }
-    case 8: { obj* r = FN8(f)(fx(0), fx(1), a1, a2, a3, a4, a5, a6); lean_free_object(f); return r; }
-    case 9: { obj* r = FN9(f)(fx(0), fx(1), fx(2), a1, a2, a3, a4, a5, a6); lean_free_object(f); return r; }
-    case 10: { obj* r = FN10(f)(fx(0), fx(1), fx(2), fx(3), a1, a2, a3, a4, a5, a6); lean_free_object(f); return r; }
-    case 11: { obj* r = FN11(f)(fx(0), fx(1), fx(2), fx(3), fx(4), a1, a2, a3, a4, a5, a6); lean_free_object(f); return r; }
-    case 12: { obj* r = FN12(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), a1, a2, a3, a4, a5, a6); lean_free_object(f); return r; }
-    case 13: { obj* r = FN13(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), a1, a2, a3, a4, a5, a6); lean_free_object(f); return r; }
-    case 14: { obj* r = FN14(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), a1, a2, a3, a4, a5, a6); lean_free_object(f); return r; }
-    case 15: { obj* r = FN15(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), a1, a2, a3, a4, a5, a6); lean_free_object(f); return r; }
-    case 16: { obj* r = FN16(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), fx(9), a1, a2, a3, a4, a5, a6); lean_free_object(f); return r; }
+    case 6: { lean_free_object(f); return reinterpret_cast<fn6>(fn)(a1, a2, a3, a4, a5, a6); }
+    case 7: { obj* x0 = fx(0); lean_free_object(f); return reinterpret_cast<fn7>(fn)(x0, a1, a2, a3, a4, a5, a6); }
+    case 8: { obj* x0 = fx(0); obj* x1 = fx(1); lean_free_object(f); return reinterpret_cast<fn8>(fn)(x0, x1, a1, a2, a3, a4, a5, a6); }
+    case 9: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); lean_free_object(f); return reinterpret_cast<fn9>(fn)(x0, x1, x2, a1, a2, a3, a4, a5, a6); }
+    case 10: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); lean_free_object(f); return reinterpret_cast<fn10>(fn)(x0, x1, x2, x3, a1, a2, a3, a4, a5, a6); }
+    case 11: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); lean_free_object(f); return reinterpret_cast<fn11>(fn)(x0, x1, x2, x3, x4, a1, a2, a3, a4, a5, a6); }
+    case 12: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); lean_free_object(f); return reinterpret_cast<fn12>(fn)(x0, x1, x2, x3, x4, x5, a1, a2, a3, a4, a5, a6); }
+    case 13: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); obj* x6 = fx(6); lean_free_object(f); return reinterpret_cast<fn13>(fn)(x0, x1, x2, x3, x4, x5, x6, a1, a2, a3, a4, a5, a6); }
+    case 14: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); obj* x6 = fx(6); obj* x7 = fx(7); lean_free_object(f); return reinterpret_cast<fn14>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, a1, a2, a3, a4, a5, a6); }
+    case 15: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); obj* x6 = fx(6); obj* x7 = fx(7); obj* x8 = fx(8); lean_free_object(f); return reinterpret_cast<fn15>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, a1, a2, a3, a4, a5, a6); }
+    case 16: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); obj* x6 = fx(6); obj* x7 = fx(7); obj* x8 = fx(8); obj* x9 = fx(9); lean_free_object(f); return reinterpret_cast<fn16>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, a1, a2, a3, a4, a5, a6); }
     }
   }
   switch (arity) {
-  case 6: { obj* r = FN6(f)(a1, a2, a3, a4, a5, a6); lean_dec_ref(f); return r; }
-  case 7: { lean_inc(fx(0)); obj* r = FN7(f)(fx(0), a1, a2, a3, a4, a5, a6); lean_dec_ref(f); return r; }
-  case 8: { lean_inc(fx(0)); lean_inc(fx(1)); obj* r = FN8(f)(fx(0), fx(1), a1, a2, a3, a4, a5, a6); lean_dec_ref(f); return r; }
-  case 9: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); obj* r = FN9(f)(fx(0), fx(1), fx(2), a1, a2, a3, a4, a5, a6); lean_dec_ref(f); return r; }
-  case 10: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); obj* r = FN10(f)(fx(0), fx(1), fx(2), fx(3), a1, a2, a3, a4, a5, a6); lean_dec_ref(f); return r; }
-  case 11: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); obj* r = FN11(f)(fx(0), fx(1), fx(2), fx(3), fx(4), a1, a2, a3, a4, a5, a6); lean_dec_ref(f); return r; }
-  case 12: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); obj* r = FN12(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), a1, a2, a3, a4, a5, a6); lean_dec_ref(f); return r; }
-  case 13: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); lean_inc(fx(6)); obj* r = FN13(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), a1, a2, a3, a4, a5, a6); lean_dec_ref(f); return r; }
-  case 14: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); lean_inc(fx(6)); lean_inc(fx(7)); obj* r = FN14(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), a1, a2, a3, a4, a5, a6); lean_dec_ref(f); return r; }
-  case 15: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); lean_inc(fx(6)); lean_inc(fx(7)); lean_inc(fx(8)); obj* r = FN15(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), a1, a2, a3, a4, a5, a6); lean_dec_ref(f); return r; }
-  case 16: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); lean_inc(fx(6)); lean_inc(fx(7)); lean_inc(fx(8)); lean_inc(fx(9)); obj* r = FN16(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), fx(9), a1, a2, a3, a4, a5, a6); lean_dec_ref(f); return r; }
+  case 6: { lean_dec_ref(f); return reinterpret_cast<fn6>(fn)(a1, a2, a3, a4, a5, a6); }
+  case 7: { obj* x0 = fx(0); lean_inc(x0); lean_dec_ref(f); return reinterpret_cast<fn7>(fn)(x0, a1, a2, a3, a4, a5, a6); }
+  case 8: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); lean_dec_ref(f); return reinterpret_cast<fn8>(fn)(x0, x1, a1, a2, a3, a4, a5, a6); }
+  case 9: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); lean_dec_ref(f); return reinterpret_cast<fn9>(fn)(x0, x1, x2, a1, a2, a3, a4, a5, a6); }
+  case 10: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); lean_dec_ref(f); return reinterpret_cast<fn10>(fn)(x0, x1, x2, x3, a1, a2, a3, a4, a5, a6); }
+  case 11: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); lean_dec_ref(f); return reinterpret_cast<fn11>(fn)(x0, x1, x2, x3, x4, a1, a2, a3, a4, a5, a6); }
+  case 12: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); lean_dec_ref(f); return reinterpret_cast<fn12>(fn)(x0, x1, x2, x3, x4, x5, a1, a2, a3, a4, a5, a6); }
+  case 13: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); obj* x6 = fx(6); lean_inc(x6); lean_dec_ref(f); return reinterpret_cast<fn13>(fn)(x0, x1, x2, x3, x4, x5, x6, a1, a2, a3, a4, a5, a6); }
+  case 14: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); obj* x6 = fx(6); lean_inc(x6); obj* x7 = fx(7); lean_inc(x7); lean_dec_ref(f); return reinterpret_cast<fn14>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, a1, a2, a3, a4, a5, a6); }
+  case 15: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); obj* x6 = fx(6); lean_inc(x6); obj* x7 = fx(7); lean_inc(x7); obj* x8 = fx(8); lean_inc(x8); lean_dec_ref(f); return reinterpret_cast<fn15>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, a1, a2, a3, a4, a5, a6); }
+  case 16: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); obj* x6 = fx(6); lean_inc(x6); obj* x7 = fx(7); lean_inc(x7); obj* x8 = fx(8); lean_inc(x8); obj* x9 = fx(9); lean_inc(x9); lean_dec_ref(f); return reinterpret_cast<fn16>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, a1, a2, a3, a4, a5, a6); }
   default:
     lean_assert(arity > 16);
     obj * as[6] = { a1, a2, a3, a4, a5, a6 };
     obj ** args = static_cast<obj**>(LEAN_ALLOCA(arity*sizeof(obj*))); // NOLINT
-    for (unsigned i = 0; i < fixed; i++) { lean_inc(fx(i)); args[i] = fx(i); }
+    move_fixed_args(f, args);
     for (unsigned i = 0; i < 6; i++) args[fixed+i] = as[i];
-    obj * r = FNN(f)(args);
-    lean_dec_ref(f);
-    return r;
+    return reinterpret_cast<fnn>(fn)(args);
   }
 } else if (arity < fixed + 6) {
   obj * as[6] = { a1, a2, a3, a4, a5, a6 };
   obj ** args = static_cast<obj**>(LEAN_ALLOCA(arity*sizeof(obj*))); // NOLINT
-  for (unsigned i = 0; i < fixed; i++) { lean_inc(fx(i)); args[i] = fx(i); }
+  void * fn = move_fixed_args(f, args);
   for (unsigned i = 0; i < arity-fixed; i++) args[fixed+i] = as[i];
-  obj * new_f = curry(f, arity, args);
-  lean_dec_ref(f);
+  obj * new_f = curry(fn, arity, args);
   return lean_apply_n(new_f, 6+fixed-arity, &as[arity-fixed]);
 } else {
   return fix_args(f, {a1, a2, a3, a4, a5, a6});
@@ -452,48 +457,46 @@ if (lean_is_scalar(f)) { lean_dec(a1); lean_dec(a2); lean_dec(a3); lean_dec(a4);
 unsigned arity = lean_closure_arity(f);
 unsigned fixed = lean_closure_num_fixed(f);
 if (arity == fixed + 7) {
+  void * fn = lean_closure_fun(f);
   if (lean_is_exclusive(f)) {
     switch (arity) {
-    case 7: { obj* r = FN7(f)(a1, a2, a3, a4, a5, a6, a7); lean_free_object(f); return r; }
-    case 8: { obj* r = FN8(f)(fx(0), a1, a2, a3, a4, a5, a6, a7); lean_free_object(f); return r; }
-    case 9: { obj* r = FN9(f)(fx(0), fx(1), a1, a2, a3, a4, a5, a6, a7); lean_free_object(f); return r; }
-    case 10: { obj* r = FN10(f)(fx(0), fx(1), fx(2), a1, a2, a3, a4, a5, a6, a7); lean_free_object(f); return r; }
-    case 11: { obj* r = FN11(f)(fx(0), fx(1), fx(2), fx(3), a1, a2, a3, a4, a5, a6, a7); lean_free_object(f); return r; }
-    case 12: { obj* r = FN12(f)(fx(0), fx(1), fx(2), fx(3), fx(4), a1, a2, a3, a4, a5, a6, a7); lean_free_object(f); return r; }
-    case 13: { obj* r = FN13(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), a1, a2, a3, a4, a5, a6, a7); lean_free_object(f); return r; }
-    case 14: { obj* r = FN14(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), a1, a2, a3, a4, a5, a6, a7); lean_free_object(f); return r; }
-    case 15: { obj* r = FN15(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), a1, a2, a3, a4, a5, a6, a7); lean_free_object(f); return r; }
-    case 16: { obj* r = FN16(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), a1, a2, a3, a4, a5, a6, a7); lean_free_object(f); return r; }
+    case 7: { lean_free_object(f); return reinterpret_cast<fn7>(fn)(a1, a2, a3, a4, a5, a6, a7); }
+    case 8: { obj* x0 = fx(0); lean_free_object(f); return reinterpret_cast<fn8>(fn)(x0, a1, a2, a3, a4, a5, a6, a7); }
+    case 9: { obj* x0 = fx(0); obj* x1 = fx(1); lean_free_object(f); return reinterpret_cast<fn9>(fn)(x0, x1, a1, a2, a3, a4, a5, a6, a7); }
+    case 10: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); lean_free_object(f); return reinterpret_cast<fn10>(fn)(x0, x1, x2, a1, a2, a3, a4, a5, a6, a7); }
+    case 11: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); lean_free_object(f); return reinterpret_cast<fn11>(fn)(x0, x1, x2, x3, a1, a2, a3, a4, a5, a6, a7); }
+    case 12: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); lean_free_object(f); return reinterpret_cast<fn12>(fn)(x0, x1, x2, x3, x4, a1, a2, a3, a4, a5, a6, a7); }
+    case 13: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); lean_free_object(f); return reinterpret_cast<fn13>(fn)(x0, x1, x2, x3, x4, x5, a1, a2, a3, a4, a5, a6, a7); }
+    case 14: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); obj* x6 = fx(6); lean_free_object(f); return reinterpret_cast<fn14>(fn)(x0, x1, x2, x3, x4, x5, x6, a1, a2, a3, a4, a5, a6, a7); }
+    case 15: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); obj* x6 = fx(6); obj* x7 = fx(7); lean_free_object(f); return reinterpret_cast<fn15>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, a1, a2, a3, a4, a5, a6, a7); }
+    case 16: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); obj* x6 = fx(6); obj* x7 = fx(7); obj* x8 = fx(8); lean_free_object(f); return reinterpret_cast<fn16>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, a1, a2, a3, a4, a5, a6, a7); }
     }
   }
   switch (arity) {
-  case 7: { obj* r = FN7(f)(a1, a2, a3, a4, a5, a6, a7); lean_dec_ref(f); return r; }
-  case 8: { lean_inc(fx(0)); obj* r = FN8(f)(fx(0), a1, a2, a3, a4, a5, a6, a7); lean_dec_ref(f); return r; }
-  case 9: { lean_inc(fx(0)); lean_inc(fx(1)); obj* r = FN9(f)(fx(0), fx(1), a1, a2, a3, a4, a5, a6, a7); lean_dec_ref(f); return r; }
-  case 10: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); obj* r = FN10(f)(fx(0), fx(1), fx(2), a1, a2, a3, a4, a5, a6, a7); lean_dec_ref(f); return r; }
-  case 11: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); obj* r = FN11(f)(fx(0), fx(1), fx(2), fx(3), a1, a2, a3, a4, a5, a6, a7); lean_dec_ref(f); return r; }
-  case 12: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); obj* r = FN12(f)(fx(0), fx(1), fx(2), fx(3), fx(4), a1, a2, a3, a4, a5, a6, a7); lean_dec_ref(f); return r; }
-  case 13: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); obj* r = FN13(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), a1, a2, a3, a4, a5, a6, a7); lean_dec_ref(f); return r; }
-  case 14: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); lean_inc(fx(6)); obj* r = FN14(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), a1, a2, a3, a4, a5, a6, a7); lean_dec_ref(f); return r; }
-  case 15: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); lean_inc(fx(6)); lean_inc(fx(7)); obj* r = FN15(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), a1, a2, a3, a4, a5, a6, a7); lean_dec_ref(f); return r; }
-  case 16: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); lean_inc(fx(6)); lean_inc(fx(7)); lean_inc(fx(8)); obj* r = FN16(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), fx(8), a1, a2, a3, a4, a5, a6, a7); lean_dec_ref(f); return r; }
+  case 7: { lean_dec_ref(f); return reinterpret_cast<fn7>(fn)(a1, a2, a3, a4, a5, a6, a7); }
+  case 8: { obj* x0 = fx(0); lean_inc(x0); lean_dec_ref(f); return reinterpret_cast<fn8>(fn)(x0, a1, a2, a3, a4, a5, a6, a7); }
+  case 9: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); lean_dec_ref(f); return reinterpret_cast<fn9>(fn)(x0, x1, a1, a2, a3, a4, a5, a6, a7); }
+  case 10: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); lean_dec_ref(f); return reinterpret_cast<fn10>(fn)(x0, x1, x2, a1, a2, a3, a4, a5, a6, a7); }
+  case 11: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); lean_dec_ref(f); return reinterpret_cast<fn11>(fn)(x0, x1, x2, x3, a1, a2, a3, a4, a5, a6, a7); }
+  case 12: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); lean_dec_ref(f); return reinterpret_cast<fn12>(fn)(x0, x1, x2, x3, x4, a1, a2, a3, a4, a5, a6, a7); }
+  case 13: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); lean_dec_ref(f); return reinterpret_cast<fn13>(fn)(x0, x1, x2, x3, x4, x5, a1, a2, a3, a4, a5, a6, a7); }
+  case 14: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); obj* x6 = fx(6); lean_inc(x6); lean_dec_ref(f); return reinterpret_cast<fn14>(fn)(x0, x1, x2, x3, x4, x5, x6, a1, a2, a3, a4, a5, a6, a7); }
+  case 15: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); obj* x6 = fx(6); lean_inc(x6); obj* x7 = fx(7); lean_inc(x7); lean_dec_ref(f); return reinterpret_cast<fn15>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, a1, a2, a3, a4, a5, a6, a7); }
+  case 16: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); obj* x6 = fx(6); lean_inc(x6); obj* x7 = fx(7); lean_inc(x7); obj* x8 = fx(8); lean_inc(x8); lean_dec_ref(f); return reinterpret_cast<fn16>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, x8, a1, a2, a3, a4, a5, a6, a7); }
   default:
     lean_assert(arity > 16);
     obj * as[7] = { a1, a2, a3, a4, a5, a6, a7 };
     obj ** args = static_cast<obj**>(LEAN_ALLOCA(arity*sizeof(obj*))); // NOLINT
-    for (unsigned i = 0; i < fixed; i++) { lean_inc(fx(i)); args[i] = fx(i); }
+    move_fixed_args(f, args);
     for (unsigned i = 0; i < 7; i++) args[fixed+i] = as[i];
-    obj * r = FNN(f)(args);
-    lean_dec_ref(f);
-    return r;
+    return reinterpret_cast<fnn>(fn)(args);
   }
 } else if (arity < fixed + 7) {
   obj * as[7] = { a1, a2, a3, a4, a5, a6, a7 };
   obj ** args = static_cast<obj**>(LEAN_ALLOCA(arity*sizeof(obj*))); // NOLINT
-  for (unsigned i = 0; i < fixed; i++) { lean_inc(fx(i)); args[i] = fx(i); }
+  void * fn = move_fixed_args(f, args);
   for (unsigned i = 0; i < arity-fixed; i++) args[fixed+i] = as[i];
-  obj * new_f = curry(f, arity, args);
-  lean_dec_ref(f);
+  obj * new_f = curry(fn, arity, args);
   return lean_apply_n(new_f, 7+fixed-arity, &as[arity-fixed]);
 } else {
   return fix_args(f, {a1, a2, a3, a4, a5, a6, a7});
@@ -504,46 +507,44 @@ if (lean_is_scalar(f)) { lean_dec(a1); lean_dec(a2); lean_dec(a3); lean_dec(a4);
 unsigned arity = lean_closure_arity(f);
 unsigned fixed = lean_closure_num_fixed(f);
 if (arity == fixed + 8) {
+  void * fn = lean_closure_fun(f);
   if (lean_is_exclusive(f)) {
     switch (arity) {
-    case 8: { obj* r = FN8(f)(a1, a2, a3, a4, a5, a6, a7, a8); lean_free_object(f); return r; }
-    case 9: { obj* r = FN9(f)(fx(0), a1, a2, a3, a4, a5, a6, a7, a8); lean_free_object(f); return r; }
-    case 10: { obj* r = FN10(f)(fx(0), fx(1), a1, a2, a3, a4, a5, a6, a7, a8); lean_free_object(f); return r; }
-    case 11: { obj* r = FN11(f)(fx(0), fx(1), fx(2), a1, a2, a3, a4, a5, a6, a7, a8); lean_free_object(f); return r; }
-    case 12: { obj* r = FN12(f)(fx(0), fx(1), fx(2), fx(3), a1, a2, a3, a4, a5, a6, a7, a8); lean_free_object(f); return r; }
-    case 13: { obj* r = FN13(f)(fx(0), fx(1), fx(2), fx(3), fx(4), a1, a2, a3, a4, a5, a6, a7, a8); lean_free_object(f); return r; }
-    case 14: { obj* r = FN14(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), a1, a2, a3, a4, a5, a6, a7, a8); lean_free_object(f); return r; }
-    case 15: { obj* r = FN15(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), a1, a2, a3, a4, a5, a6, a7, a8); lean_free_object(f); return r; }
-    case 16: { obj* r = FN16(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), a1, a2, a3, a4, a5, a6, a7, a8); lean_free_object(f); return r; }
+    case 8: { lean_free_object(f); return reinterpret_cast<fn8>(fn)(a1, a2, a3, a4, a5, a6, a7, a8); }
+    case 9: { obj* x0 = fx(0); lean_free_object(f); return reinterpret_cast<fn9>(fn)(x0, a1, a2, a3, a4, a5, a6, a7, a8); }
+    case 10: { obj* x0 = fx(0); obj* x1 = fx(1); lean_free_object(f); return reinterpret_cast<fn10>(fn)(x0, x1, a1, a2, a3, a4, a5, a6, a7, a8); }
+    case 11: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); lean_free_object(f); return reinterpret_cast<fn11>(fn)(x0, x1, x2, a1, a2, a3, a4, a5, a6, a7, a8); }
+    case 12: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); lean_free_object(f); return reinterpret_cast<fn12>(fn)(x0, x1, x2, x3, a1, a2, a3, a4, a5, a6, a7, a8); }
+    case 13: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); lean_free_object(f); return reinterpret_cast<fn13>(fn)(x0, x1, x2, x3, x4, a1, a2, a3, a4, a5, a6, a7, a8); }
+    case 14: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); lean_free_object(f); return reinterpret_cast<fn14>(fn)(x0, x1, x2, x3, x4, x5, a1, a2, a3, a4, a5, a6, a7, a8); }
+    case 15: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); obj* x6 = fx(6); lean_free_object(f); return reinterpret_cast<fn15>(fn)(x0, x1, x2, x3, x4, x5, x6, a1, a2, a3, a4, a5, a6, a7, a8); }
+    case 16: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); obj* x6 = fx(6); obj* x7 = fx(7); lean_free_object(f); return reinterpret_cast<fn16>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, a1, a2, a3, a4, a5, a6, a7, a8); }
     }
   }
   switch (arity) {
-  case 8: { obj* r = FN8(f)(a1, a2, a3, a4, a5, a6, a7, a8); lean_dec_ref(f); return r; }
-  case 9: { lean_inc(fx(0)); obj* r = FN9(f)(fx(0), a1, a2, a3, a4, a5, a6, a7, a8); lean_dec_ref(f); return r; }
-  case 10: { lean_inc(fx(0)); lean_inc(fx(1)); obj* r = FN10(f)(fx(0), fx(1), a1, a2, a3, a4, a5, a6, a7, a8); lean_dec_ref(f); return r; }
-  case 11: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); obj* r = FN11(f)(fx(0), fx(1), fx(2), a1, a2, a3, a4, a5, a6, a7, a8); lean_dec_ref(f); return r; }
-  case 12: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); obj* r = FN12(f)(fx(0), fx(1), fx(2), fx(3), a1, a2, a3, a4, a5, a6, a7, a8); lean_dec_ref(f); return r; }
-  case 13: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); obj* r = FN13(f)(fx(0), fx(1), fx(2), fx(3), fx(4), a1, a2, a3, a4, a5, a6, a7, a8); lean_dec_ref(f); return r; }
-  case 14: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); obj* r = FN14(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), a1, a2, a3, a4, a5, a6, a7, a8); lean_dec_ref(f); return r; }
-  case 15: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); lean_inc(fx(6)); obj* r = FN15(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), a1, a2, a3, a4, a5, a6, a7, a8); lean_dec_ref(f); return r; }
-  case 16: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); lean_inc(fx(6)); lean_inc(fx(7)); obj* r = FN16(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), fx(7), a1, a2, a3, a4, a5, a6, a7, a8); lean_dec_ref(f); return r; }
+  case 8: { lean_dec_ref(f); return reinterpret_cast<fn8>(fn)(a1, a2, a3, a4, a5, a6, a7, a8); }
+  case 9: { obj* x0 = fx(0); lean_inc(x0); lean_dec_ref(f); return reinterpret_cast<fn9>(fn)(x0, a1, a2, a3, a4, a5, a6, a7, a8); }
+  case 10: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); lean_dec_ref(f); return reinterpret_cast<fn10>(fn)(x0, x1, a1, a2, a3, a4, a5, a6, a7, a8); }
+  case 11: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); lean_dec_ref(f); return reinterpret_cast<fn11>(fn)(x0, x1, x2, a1, a2, a3, a4, a5, a6, a7, a8); }
+  case 12: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); lean_dec_ref(f); return reinterpret_cast<fn12>(fn)(x0, x1, x2, x3, a1, a2, a3, a4, a5, a6, a7, a8); }
+  case 13: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); lean_dec_ref(f); return reinterpret_cast<fn13>(fn)(x0, x1, x2, x3, x4, a1, a2, a3, a4, a5, a6, a7, a8); }
+  case 14: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); lean_dec_ref(f); return reinterpret_cast<fn14>(fn)(x0, x1, x2, x3, x4, x5, a1, a2, a3, a4, a5, a6, a7, a8); }
+  case 15: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); obj* x6 = fx(6); lean_inc(x6); lean_dec_ref(f); return reinterpret_cast<fn15>(fn)(x0, x1, x2, x3, x4, x5, x6, a1, a2, a3, a4, a5, a6, a7, a8); }
+  case 16: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); obj* x6 = fx(6); lean_inc(x6); obj* x7 = fx(7); lean_inc(x7); lean_dec_ref(f); return reinterpret_cast<fn16>(fn)(x0, x1, x2, x3, x4, x5, x6, x7, a1, a2, a3, a4, a5, a6, a7, a8); }
   default:
     lean_assert(arity > 16);
     obj * as[8] = { a1, a2, a3, a4, a5, a6, a7, a8 };
     obj ** args = static_cast<obj**>(LEAN_ALLOCA(arity*sizeof(obj*))); // NOLINT
-    for (unsigned i = 0; i < fixed; i++) { lean_inc(fx(i)); args[i] = fx(i); }
+    move_fixed_args(f, args);
     for (unsigned i = 0; i < 8; i++) args[fixed+i] = as[i];
-    obj * r = FNN(f)(args);
-    lean_dec_ref(f);
-    return r;
+    return reinterpret_cast<fnn>(fn)(args);
   }
 } else if (arity < fixed + 8) {
   obj * as[8] = { a1, a2, a3, a4, a5, a6, a7, a8 };
   obj ** args = static_cast<obj**>(LEAN_ALLOCA(arity*sizeof(obj*))); // NOLINT
-  for (unsigned i = 0; i < fixed; i++) { lean_inc(fx(i)); args[i] = fx(i); }
+  void * fn = move_fixed_args(f, args);
   for (unsigned i = 0; i < arity-fixed; i++) args[fixed+i] = as[i];
-  obj * new_f = curry(f, arity, args);
-  lean_dec_ref(f);
+  obj * new_f = curry(fn, arity, args);
   return lean_apply_n(new_f, 8+fixed-arity, &as[arity-fixed]);
 } else {
   return fix_args(f, {a1, a2, a3, a4, a5, a6, a7, a8});
@@ -554,44 +555,42 @@ if (lean_is_scalar(f)) { lean_dec(a1); lean_dec(a2); lean_dec(a3); lean_dec(a4);
 unsigned arity = lean_closure_arity(f);
 unsigned fixed = lean_closure_num_fixed(f);
 if (arity == fixed + 9) {
+  void * fn = lean_closure_fun(f);
   if (lean_is_exclusive(f)) {
     switch (arity) {
-    case 9: { obj* r = FN9(f)(a1, a2, a3, a4, a5, a6, a7, a8, a9); lean_free_object(f); return r; }
-    case 10: { obj* r = FN10(f)(fx(0), a1, a2, a3, a4, a5, a6, a7, a8, a9); lean_free_object(f); return r; }
-    case 11: { obj* r = FN11(f)(fx(0), fx(1), a1, a2, a3, a4, a5, a6, a7, a8, a9); lean_free_object(f); return r; }
-    case 12: { obj* r = FN12(f)(fx(0), fx(1), fx(2), a1, a2, a3, a4, a5, a6, a7, a8, a9); lean_free_object(f); return r; }
-    case 13: { obj* r = FN13(f)(fx(0), fx(1), fx(2), fx(3), a1, a2, a3, a4, a5, a6, a7, a8, a9); lean_free_object(f); return r; }
-    case 14: { obj* r = FN14(f)(fx(0), fx(1), fx(2), fx(3), fx(4), a1, a2, a3, a4, a5, a6, a7, a8, a9); lean_free_object(f); return r; }
-    case 15: { obj* r = FN15(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), a1, a2, a3, a4, a5, a6, a7, a8, a9); lean_free_object(f); return r; }
-    case 16: { obj* r = FN16(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), a1, a2, a3, a4, a5, a6, a7, a8, a9); lean_free_object(f); return r; }
+    case 9: { lean_free_object(f); return reinterpret_cast<fn9>(fn)(a1, a2, a3, a4, a5, a6, a7, a8, a9); }
+    case 10: { obj* x0 = fx(0); lean_free_object(f); return reinterpret_cast<fn10>(fn)(x0, a1, a2, a3, a4, a5, a6, a7, a8, a9); }
+    case 11: { obj* x0 = fx(0); obj* x1 = fx(1); lean_free_object(f); return reinterpret_cast<fn11>(fn)(x0, x1, a1, a2, a3, a4, a5, a6, a7, a8, a9); }
+    case 12: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); lean_free_object(f); return reinterpret_cast<fn12>(fn)(x0, x1, x2, a1, a2, a3, a4, a5, a6, a7, a8, a9); }
+    case 13: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); lean_free_object(f); return reinterpret_cast<fn13>(fn)(x0, x1, x2, x3, a1, a2, a3, a4, a5, a6, a7, a8, a9); }
+    case 14: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); lean_free_object(f); return reinterpret_cast<fn14>(fn)(x0, x1, x2, x3, x4, a1, a2, a3, a4, a5, a6, a7, a8, a9); }
+    case 15: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); lean_free_object(f); return reinterpret_cast<fn15>(fn)(x0, x1, x2, x3, x4, x5, a1, a2, a3, a4, a5, a6, a7, a8, a9); }
+    case 16: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); obj* x6 = fx(6); lean_free_object(f); return reinterpret_cast<fn16>(fn)(x0, x1, x2, x3, x4, x5, x6, a1, a2, a3, a4, a5, a6, a7, a8, a9); }
     }
   }
   switch (arity) {
-  case 9: { obj* r = FN9(f)(a1, a2, a3, a4, a5, a6, a7, a8, a9); lean_dec_ref(f); return r; }
-  case 10: { lean_inc(fx(0)); obj* r = FN10(f)(fx(0), a1, a2, a3, a4, a5, a6, a7, a8, a9); lean_dec_ref(f); return r; }
-  case 11: { lean_inc(fx(0)); lean_inc(fx(1)); obj* r = FN11(f)(fx(0), fx(1), a1, a2, a3, a4, a5, a6, a7, a8, a9); lean_dec_ref(f); return r; }
-  case 12: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); obj* r = FN12(f)(fx(0), fx(1), fx(2), a1, a2, a3, a4, a5, a6, a7, a8, a9); lean_dec_ref(f); return r; }
-  case 13: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); obj* r = FN13(f)(fx(0), fx(1), fx(2), fx(3), a1, a2, a3, a4, a5, a6, a7, a8, a9); lean_dec_ref(f); return r; }
-  case 14: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); obj* r = FN14(f)(fx(0), fx(1), fx(2), fx(3), fx(4), a1, a2, a3, a4, a5, a6, a7, a8, a9); lean_dec_ref(f); return r; }
-  case 15: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); obj* r = FN15(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), a1, a2, a3, a4, a5, a6, a7, a8, a9); lean_dec_ref(f); return r; }
-  case 16: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); lean_inc(fx(6)); obj* r = FN16(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), fx(6), a1, a2, a3, a4, a5, a6, a7, a8, a9); lean_dec_ref(f); return r; }
+  case 9: { lean_dec_ref(f); return reinterpret_cast<fn9>(fn)(a1, a2, a3, a4, a5, a6, a7, a8, a9); }
+  case 10: { obj* x0 = fx(0); lean_inc(x0); lean_dec_ref(f); return reinterpret_cast<fn10>(fn)(x0, a1, a2, a3, a4, a5, a6, a7, a8, a9); }
+  case 11: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); lean_dec_ref(f); return reinterpret_cast<fn11>(fn)(x0, x1, a1, a2, a3, a4, a5, a6, a7, a8, a9); }
+  case 12: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); lean_dec_ref(f); return reinterpret_cast<fn12>(fn)(x0, x1, x2, a1, a2, a3, a4, a5, a6, a7, a8, a9); }
+  case 13: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); lean_dec_ref(f); return reinterpret_cast<fn13>(fn)(x0, x1, x2, x3, a1, a2, a3, a4, a5, a6, a7, a8, a9); }
+  case 14: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); lean_dec_ref(f); return reinterpret_cast<fn14>(fn)(x0, x1, x2, x3, x4, a1, a2, a3, a4, a5, a6, a7, a8, a9); }
+  case 15: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); lean_dec_ref(f); return reinterpret_cast<fn15>(fn)(x0, x1, x2, x3, x4, x5, a1, a2, a3, a4, a5, a6, a7, a8, a9); }
+  case 16: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); obj* x6 = fx(6); lean_inc(x6); lean_dec_ref(f); return reinterpret_cast<fn16>(fn)(x0, x1, x2, x3, x4, x5, x6, a1, a2, a3, a4, a5, a6, a7, a8, a9); }
   default:
     lean_assert(arity > 16);
     obj * as[9] = { a1, a2, a3, a4, a5, a6, a7, a8, a9 };
     obj ** args = static_cast<obj**>(LEAN_ALLOCA(arity*sizeof(obj*))); // NOLINT
-    for (unsigned i = 0; i < fixed; i++) { lean_inc(fx(i)); args[i] = fx(i); }
+    move_fixed_args(f, args);
     for (unsigned i = 0; i < 9; i++) args[fixed+i] = as[i];
-    obj * r = FNN(f)(args);
-    lean_dec_ref(f);
-    return r;
+    return reinterpret_cast<fnn>(fn)(args);
   }
 } else if (arity < fixed + 9) {
   obj * as[9] = { a1, a2, a3, a4, a5, a6, a7, a8, a9 };
   obj ** args = static_cast<obj**>(LEAN_ALLOCA(arity*sizeof(obj*))); // NOLINT
-  for (unsigned i = 0; i < fixed; i++) { lean_inc(fx(i)); args[i] = fx(i); }
+  void * fn = move_fixed_args(f, args);
   for (unsigned i = 0; i < arity-fixed; i++) args[fixed+i] = as[i];
-  obj * new_f = curry(f, arity, args);
-  lean_dec_ref(f);
+  obj * new_f = curry(fn, arity, args);
   return lean_apply_n(new_f, 9+fixed-arity, &as[arity-fixed]);
 } else {
   return fix_args(f, {a1, a2, a3, a4, a5, a6, a7, a8, a9});
@@ -602,42 +601,40 @@ if (lean_is_scalar(f)) { lean_dec(a1); lean_dec(a2); lean_dec(a3); lean_dec(a4);
 unsigned arity = lean_closure_arity(f);
 unsigned fixed = lean_closure_num_fixed(f);
 if (arity == fixed + 10) {
+  void * fn = lean_closure_fun(f);
   if (lean_is_exclusive(f)) {
     switch (arity) {
-    case 10: { obj* r = FN10(f)(a1, a2, a3, a4, a5, a6, a7, a8, a9, a10); lean_free_object(f); return r; }
-    case 11: { obj* r = FN11(f)(fx(0), a1, a2, a3, a4, a5, a6, a7, a8, a9, a10); lean_free_object(f); return r; }
-    case 12: { obj* r = FN12(f)(fx(0), fx(1), a1, a2, a3, a4, a5, a6, a7, a8, a9, a10); lean_free_object(f); return r; }
-    case 13: { obj* r = FN13(f)(fx(0), fx(1), fx(2), a1, a2, a3, a4, a5, a6, a7, a8, a9, a10); lean_free_object(f); return r; }
-    case 14: { obj* r = FN14(f)(fx(0), fx(1), fx(2), fx(3), a1, a2, a3, a4, a5, a6, a7, a8, a9, a10); lean_free_object(f); return r; }
-    case 15: { obj* r = FN15(f)(fx(0), fx(1), fx(2), fx(3), fx(4), a1, a2, a3, a4, a5, a6, a7, a8, a9, a10); lean_free_object(f); return r; }
-    case 16: { obj* r = FN16(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), a1, a2, a3, a4, a5, a6, a7, a8, a9, a10); lean_free_object(f); return r; }
+    case 10: { lean_free_object(f); return reinterpret_cast<fn10>(fn)(a1, a2, a3, a4, a5, a6, a7, a8, a9, a10); }
+    case 11: { obj* x0 = fx(0); lean_free_object(f); return reinterpret_cast<fn11>(fn)(x0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10); }
+    case 12: { obj* x0 = fx(0); obj* x1 = fx(1); lean_free_object(f); return reinterpret_cast<fn12>(fn)(x0, x1, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10); }
+    case 13: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); lean_free_object(f); return reinterpret_cast<fn13>(fn)(x0, x1, x2, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10); }
+    case 14: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); lean_free_object(f); return reinterpret_cast<fn14>(fn)(x0, x1, x2, x3, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10); }
+    case 15: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); lean_free_object(f); return reinterpret_cast<fn15>(fn)(x0, x1, x2, x3, x4, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10); }
+    case 16: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); obj* x5 = fx(5); lean_free_object(f); return reinterpret_cast<fn16>(fn)(x0, x1, x2, x3, x4, x5, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10); }
     }
   }
   switch (arity) {
-  case 10: { obj* r = FN10(f)(a1, a2, a3, a4, a5, a6, a7, a8, a9, a10); lean_dec_ref(f); return r; }
-  case 11: { lean_inc(fx(0)); obj* r = FN11(f)(fx(0), a1, a2, a3, a4, a5, a6, a7, a8, a9, a10); lean_dec_ref(f); return r; }
-  case 12: { lean_inc(fx(0)); lean_inc(fx(1)); obj* r = FN12(f)(fx(0), fx(1), a1, a2, a3, a4, a5, a6, a7, a8, a9, a10); lean_dec_ref(f); return r; }
-  case 13: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); obj* r = FN13(f)(fx(0), fx(1), fx(2), a1, a2, a3, a4, a5, a6, a7, a8, a9, a10); lean_dec_ref(f); return r; }
-  case 14: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); obj* r = FN14(f)(fx(0), fx(1), fx(2), fx(3), a1, a2, a3, a4, a5, a6, a7, a8, a9, a10); lean_dec_ref(f); return r; }
-  case 15: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); obj* r = FN15(f)(fx(0), fx(1), fx(2), fx(3), fx(4), a1, a2, a3, a4, a5, a6, a7, a8, a9, a10); lean_dec_ref(f); return r; }
-  case 16: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); lean_inc(fx(5)); obj* r = FN16(f)(fx(0), fx(1), fx(2), fx(3), fx(4), fx(5), a1, a2, a3, a4, a5, a6, a7, a8, a9, a10); lean_dec_ref(f); return r; }
+  case 10: { lean_dec_ref(f); return reinterpret_cast<fn10>(fn)(a1, a2, a3, a4, a5, a6, a7, a8, a9, a10); }
+  case 11: { obj* x0 = fx(0); lean_inc(x0); lean_dec_ref(f); return reinterpret_cast<fn11>(fn)(x0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10); }
+  case 12: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); lean_dec_ref(f); return reinterpret_cast<fn12>(fn)(x0, x1, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10); }
+  case 13: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); lean_dec_ref(f); return reinterpret_cast<fn13>(fn)(x0, x1, x2, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10); }
+  case 14: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); lean_dec_ref(f); return reinterpret_cast<fn14>(fn)(x0, x1, x2, x3, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10); }
+  case 15: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); lean_dec_ref(f); return reinterpret_cast<fn15>(fn)(x0, x1, x2, x3, x4, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10); }
+  case 16: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); obj* x5 = fx(5); lean_inc(x5); lean_dec_ref(f); return reinterpret_cast<fn16>(fn)(x0, x1, x2, x3, x4, x5, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10); }
   default:
     lean_assert(arity > 16);
     obj * as[10] = { a1, a2, a3, a4, a5, a6, a7, a8, a9, a10 };
     obj ** args = static_cast<obj**>(LEAN_ALLOCA(arity*sizeof(obj*))); // NOLINT
-    for (unsigned i = 0; i < fixed; i++) { lean_inc(fx(i)); args[i] = fx(i); }
+    move_fixed_args(f, args);
     for (unsigned i = 0; i < 10; i++) args[fixed+i] = as[i];
-    obj * r = FNN(f)(args);
-    lean_dec_ref(f);
-    return r;
+    return reinterpret_cast<fnn>(fn)(args);
   }
 } else if (arity < fixed + 10) {
   obj * as[10] = { a1, a2, a3, a4, a5, a6, a7, a8, a9, a10 };
   obj ** args = static_cast<obj**>(LEAN_ALLOCA(arity*sizeof(obj*))); // NOLINT
-  for (unsigned i = 0; i < fixed; i++) { lean_inc(fx(i)); args[i] = fx(i); }
+  void * fn = move_fixed_args(f, args);
   for (unsigned i = 0; i < arity-fixed; i++) args[fixed+i] = as[i];
-  obj * new_f = curry(f, arity, args);
-  lean_dec_ref(f);
+  obj * new_f = curry(fn, arity, args);
   return lean_apply_n(new_f, 10+fixed-arity, &as[arity-fixed]);
 } else {
   return fix_args(f, {a1, a2, a3, a4, a5, a6, a7, a8, a9, a10});
@@ -648,40 +645,38 @@ if (lean_is_scalar(f)) { lean_dec(a1); lean_dec(a2); lean_dec(a3); lean_dec(a4);
 unsigned arity = lean_closure_arity(f);
 unsigned fixed = lean_closure_num_fixed(f);
 if (arity == fixed + 11) {
+  void * fn = lean_closure_fun(f);
   if (lean_is_exclusive(f)) {
     switch (arity) {
-    case 11: { obj* r = FN11(f)(a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11); lean_free_object(f); return r; }
-    case 12: { obj* r = FN12(f)(fx(0), a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11); lean_free_object(f); return r; }
-    case 13: { obj* r = FN13(f)(fx(0), fx(1), a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11); lean_free_object(f); return r; }
-    case 14: { obj* r = FN14(f)(fx(0), fx(1), fx(2), a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11); lean_free_object(f); return r; }
-    case 15: { obj* r = FN15(f)(fx(0), fx(1), fx(2), fx(3), a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11); lean_free_object(f); return r; }
-    case 16: { obj* r = FN16(f)(fx(0), fx(1), fx(2), fx(3), fx(4), a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11); lean_free_object(f); return r; }
+    case 11: { lean_free_object(f); return reinterpret_cast<fn11>(fn)(a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11); }
+    case 12: { obj* x0 = fx(0); lean_free_object(f); return reinterpret_cast<fn12>(fn)(x0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11); }
+    case 13: { obj* x0 = fx(0); obj* x1 = fx(1); lean_free_object(f); return reinterpret_cast<fn13>(fn)(x0, x1, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11); }
+    case 14: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); lean_free_object(f); return reinterpret_cast<fn14>(fn)(x0, x1, x2, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11); }
+    case 15: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); lean_free_object(f); return reinterpret_cast<fn15>(fn)(x0, x1, x2, x3, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11); }
+    case 16: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); obj* x4 = fx(4); lean_free_object(f); return reinterpret_cast<fn16>(fn)(x0, x1, x2, x3, x4, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11); }
     }
   }
   switch (arity) {
-  case 11: { obj* r = FN11(f)(a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11); lean_dec_ref(f); return r; }
-  case 12: { lean_inc(fx(0)); obj* r = FN12(f)(fx(0), a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11); lean_dec_ref(f); return r; }
-  case 13: { lean_inc(fx(0)); lean_inc(fx(1)); obj* r = FN13(f)(fx(0), fx(1), a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11); lean_dec_ref(f); return r; }
-  case 14: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); obj* r = FN14(f)(fx(0), fx(1), fx(2), a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11); lean_dec_ref(f); return r; }
-  case 15: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); obj* r = FN15(f)(fx(0), fx(1), fx(2), fx(3), a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11); lean_dec_ref(f); return r; }
-  case 16: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); lean_inc(fx(4)); obj* r = FN16(f)(fx(0), fx(1), fx(2), fx(3), fx(4), a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11); lean_dec_ref(f); return r; }
+  case 11: { lean_dec_ref(f); return reinterpret_cast<fn11>(fn)(a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11); }
+  case 12: { obj* x0 = fx(0); lean_inc(x0); lean_dec_ref(f); return reinterpret_cast<fn12>(fn)(x0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11); }
+  case 13: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); lean_dec_ref(f); return reinterpret_cast<fn13>(fn)(x0, x1, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11); }
+  case 14: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); lean_dec_ref(f); return reinterpret_cast<fn14>(fn)(x0, x1, x2, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11); }
+  case 15: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); lean_dec_ref(f); return reinterpret_cast<fn15>(fn)(x0, x1, x2, x3, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11); }
+  case 16: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); obj* x4 = fx(4); lean_inc(x4); lean_dec_ref(f); return reinterpret_cast<fn16>(fn)(x0, x1, x2, x3, x4, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11); }
   default:
     lean_assert(arity > 16);
     obj * as[11] = { a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11 };
     obj ** args = static_cast<obj**>(LEAN_ALLOCA(arity*sizeof(obj*))); // NOLINT
-    for (unsigned i = 0; i < fixed; i++) { lean_inc(fx(i)); args[i] = fx(i); }
+    move_fixed_args(f, args);
     for (unsigned i = 0; i < 11; i++) args[fixed+i] = as[i];
-    obj * r = FNN(f)(args);
-    lean_dec_ref(f);
-    return r;
+    return reinterpret_cast<fnn>(fn)(args);
   }
 } else if (arity < fixed + 11) {
   obj * as[11] = { a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11 };
   obj ** args = static_cast<obj**>(LEAN_ALLOCA(arity*sizeof(obj*))); // NOLINT
-  for (unsigned i = 0; i < fixed; i++) { lean_inc(fx(i)); args[i] = fx(i); }
+  void * fn = move_fixed_args(f, args);
   for (unsigned i = 0; i < arity-fixed; i++) args[fixed+i] = as[i];
-  obj * new_f = curry(f, arity, args);
-  lean_dec_ref(f);
+  obj * new_f = curry(fn, arity, args);
   return lean_apply_n(new_f, 11+fixed-arity, &as[arity-fixed]);
 } else {
   return fix_args(f, {a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11});
@@ -692,38 +687,36 @@ if (lean_is_scalar(f)) { lean_dec(a1); lean_dec(a2); lean_dec(a3); lean_dec(a4);
 unsigned arity = lean_closure_arity(f);
 unsigned fixed = lean_closure_num_fixed(f);
 if (arity == fixed + 12) {
+  void * fn = lean_closure_fun(f);
   if (lean_is_exclusive(f)) {
     switch (arity) {
-    case 12: { obj* r = FN12(f)(a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12); lean_free_object(f); return r; }
-    case 13: { obj* r = FN13(f)(fx(0), a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12); lean_free_object(f); return r; }
-    case 14: { obj* r = FN14(f)(fx(0), fx(1), a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12); lean_free_object(f); return r; }
-    case 15: { obj* r = FN15(f)(fx(0), fx(1), fx(2), a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12); lean_free_object(f); return r; }
-    case 16: { obj* r = FN16(f)(fx(0), fx(1), fx(2), fx(3), a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12); lean_free_object(f); return r; }
+    case 12: { lean_free_object(f); return reinterpret_cast<fn12>(fn)(a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12); }
+    case 13: { obj* x0 = fx(0); lean_free_object(f); return reinterpret_cast<fn13>(fn)(x0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12); }
+    case 14: { obj* x0 = fx(0); obj* x1 = fx(1); lean_free_object(f); return reinterpret_cast<fn14>(fn)(x0, x1, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12); }
+    case 15: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); lean_free_object(f); return reinterpret_cast<fn15>(fn)(x0, x1, x2, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12); }
+    case 16: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); obj* x3 = fx(3); lean_free_object(f); return reinterpret_cast<fn16>(fn)(x0, x1, x2, x3, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12); }
     }
   }
   switch (arity) {
-  case 12: { obj* r = FN12(f)(a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12); lean_dec_ref(f); return r; }
-  case 13: { lean_inc(fx(0)); obj* r = FN13(f)(fx(0), a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12); lean_dec_ref(f); return r; }
-  case 14: { lean_inc(fx(0)); lean_inc(fx(1)); obj* r = FN14(f)(fx(0), fx(1), a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12); lean_dec_ref(f); return r; }
-  case 15: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); obj* r = FN15(f)(fx(0), fx(1), fx(2), a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12); lean_dec_ref(f); return r; }
-  case 16: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); lean_inc(fx(3)); obj* r = FN16(f)(fx(0), fx(1), fx(2), fx(3), a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12); lean_dec_ref(f); return r; }
+  case 12: { lean_dec_ref(f); return reinterpret_cast<fn12>(fn)(a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12); }
+  case 13: { obj* x0 = fx(0); lean_inc(x0); lean_dec_ref(f); return reinterpret_cast<fn13>(fn)(x0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12); }
+  case 14: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); lean_dec_ref(f); return reinterpret_cast<fn14>(fn)(x0, x1, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12); }
+  case 15: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); lean_dec_ref(f); return reinterpret_cast<fn15>(fn)(x0, x1, x2, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12); }
+  case 16: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); obj* x3 = fx(3); lean_inc(x3); lean_dec_ref(f); return reinterpret_cast<fn16>(fn)(x0, x1, x2, x3, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12); }
   default:
     lean_assert(arity > 16);
     obj * as[12] = { a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12 };
     obj ** args = static_cast<obj**>(LEAN_ALLOCA(arity*sizeof(obj*))); // NOLINT
-    for (unsigned i = 0; i < fixed; i++) { lean_inc(fx(i)); args[i] = fx(i); }
+    move_fixed_args(f, args);
     for (unsigned i = 0; i < 12; i++) args[fixed+i] = as[i];
-    obj * r = FNN(f)(args);
-    lean_dec_ref(f);
-    return r;
+    return reinterpret_cast<fnn>(fn)(args);
   }
 } else if (arity < fixed + 12) {
   obj * as[12] = { a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12 };
   obj ** args = static_cast<obj**>(LEAN_ALLOCA(arity*sizeof(obj*))); // NOLINT
-  for (unsigned i = 0; i < fixed; i++) { lean_inc(fx(i)); args[i] = fx(i); }
+  void * fn = move_fixed_args(f, args);
   for (unsigned i = 0; i < arity-fixed; i++) args[fixed+i] = as[i];
-  obj * new_f = curry(f, arity, args);
-  lean_dec_ref(f);
+  obj * new_f = curry(fn, arity, args);
   return lean_apply_n(new_f, 12+fixed-arity, &as[arity-fixed]);
 } else {
   return fix_args(f, {a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12});
@@ -734,36 +727,34 @@ if (lean_is_scalar(f)) { lean_dec(a1); lean_dec(a2); lean_dec(a3); lean_dec(a4);
 unsigned arity = lean_closure_arity(f);
 unsigned fixed = lean_closure_num_fixed(f);
 if (arity == fixed + 13) {
+  void * fn = lean_closure_fun(f);
   if (lean_is_exclusive(f)) {
     switch (arity) {
-    case 13: { obj* r = FN13(f)(a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13); lean_free_object(f); return r; }
-    case 14: { obj* r = FN14(f)(fx(0), a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13); lean_free_object(f); return r; }
-    case 15: { obj* r = FN15(f)(fx(0), fx(1), a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13); lean_free_object(f); return r; }
-    case 16: { obj* r = FN16(f)(fx(0), fx(1), fx(2), a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13); lean_free_object(f); return r; }
+    case 13: { lean_free_object(f); return reinterpret_cast<fn13>(fn)(a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13); }
+    case 14: { obj* x0 = fx(0); lean_free_object(f); return reinterpret_cast<fn14>(fn)(x0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13); }
+    case 15: { obj* x0 = fx(0); obj* x1 = fx(1); lean_free_object(f); return reinterpret_cast<fn15>(fn)(x0, x1, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13); }
+    case 16: { obj* x0 = fx(0); obj* x1 = fx(1); obj* x2 = fx(2); lean_free_object(f); return reinterpret_cast<fn16>(fn)(x0, x1, x2, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13); }
     }
   }
   switch (arity) {
-  case 13: { obj* r = FN13(f)(a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13); lean_dec_ref(f); return r; }
-  case 14: { lean_inc(fx(0)); obj* r = FN14(f)(fx(0), a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13); lean_dec_ref(f); return r; }
-  case 15: { lean_inc(fx(0)); lean_inc(fx(1)); obj* r = FN15(f)(fx(0), fx(1), a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13); lean_dec_ref(f); return r; }
-  case 16: { lean_inc(fx(0)); lean_inc(fx(1)); lean_inc(fx(2)); obj* r = FN16(f)(fx(0), fx(1), fx(2), a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13); lean_dec_ref(f); return r; }
+  case 13: { lean_dec_ref(f); return reinterpret_cast<fn13>(fn)(a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13); }
+  case 14: { obj* x0 = fx(0); lean_inc(x0); lean_dec_ref(f); return reinterpret_cast<fn14>(fn)(x0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13); }
+  case 15: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); lean_dec_ref(f); return reinterpret_cast<fn15>(fn)(x0, x1, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13); }
+  case 16: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); obj* x2 = fx(2); lean_inc(x2); lean_dec_ref(f); return reinterpret_cast<fn16>(fn)(x0, x1, x2, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13); }
   default:
     lean_assert(arity > 16);
     obj * as[13] = { a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13 };
     obj ** args = static_cast<obj**>(LEAN_ALLOCA(arity*sizeof(obj*))); // NOLINT
-    for (unsigned i = 0; i < fixed; i++) { lean_inc(fx(i)); args[i] = fx(i); }
+    move_fixed_args(f, args);
     for (unsigned i = 0; i < 13; i++) args[fixed+i] = as[i];
-    obj * r = FNN(f)(args);
-    lean_dec_ref(f);
-    return r;
+    return reinterpret_cast<fnn>(fn)(args);
   }
 } else if (arity < fixed + 13) {
   obj * as[13] = { a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13 };
   obj ** args = static_cast<obj**>(LEAN_ALLOCA(arity*sizeof(obj*))); // NOLINT
-  for (unsigned i = 0; i < fixed; i++) { lean_inc(fx(i)); args[i] = fx(i); }
+  void * fn = move_fixed_args(f, args);
   for (unsigned i = 0; i < arity-fixed; i++) args[fixed+i] = as[i];
-  obj * new_f = curry(f, arity, args);
-  lean_dec_ref(f);
+  obj * new_f = curry(fn, arity, args);
   return lean_apply_n(new_f, 13+fixed-arity, &as[arity-fixed]);
 } else {
   return fix_args(f, {a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13});
@@ -774,34 +765,32 @@ if (lean_is_scalar(f)) { lean_dec(a1); lean_dec(a2); lean_dec(a3); lean_dec(a4);
 unsigned arity = lean_closure_arity(f);
 unsigned fixed = lean_closure_num_fixed(f);
 if (arity == fixed + 14) {
+  void * fn = lean_closure_fun(f);
   if (lean_is_exclusive(f)) {
     switch (arity) {
-    case 14: { obj* r = FN14(f)(a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14); lean_free_object(f); return r; }
-    case 15: { obj* r = FN15(f)(fx(0), a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14); lean_free_object(f); return r; }
-    case 16: { obj* r = FN16(f)(fx(0), fx(1), a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14); lean_free_object(f); return r; }
+    case 14: { lean_free_object(f); return reinterpret_cast<fn14>(fn)(a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14); }
+    case 15: { obj* x0 = fx(0); lean_free_object(f); return reinterpret_cast<fn15>(fn)(x0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14); }
+    case 16: { obj* x0 = fx(0); obj* x1 = fx(1); lean_free_object(f); return reinterpret_cast<fn16>(fn)(x0, x1, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14); }
     }
   }
   switch (arity) {
-  case 14: { obj* r = FN14(f)(a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14); lean_dec_ref(f); return r; }
-  case 15: { lean_inc(fx(0)); obj* r = FN15(f)(fx(0), a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14); lean_dec_ref(f); return r; }
-  case 16: { lean_inc(fx(0)); lean_inc(fx(1)); obj* r = FN16(f)(fx(0), fx(1), a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14); lean_dec_ref(f); return r; }
+  case 14: { lean_dec_ref(f); return reinterpret_cast<fn14>(fn)(a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14); }
+  case 15: { obj* x0 = fx(0); lean_inc(x0); lean_dec_ref(f); return reinterpret_cast<fn15>(fn)(x0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14); }
+  case 16: { obj* x0 = fx(0); lean_inc(x0); obj* x1 = fx(1); lean_inc(x1); lean_dec_ref(f); return reinterpret_cast<fn16>(fn)(x0, x1, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14); }
   default:
     lean_assert(arity > 16);
     obj * as[14] = { a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14 };
     obj ** args = static_cast<obj**>(LEAN_ALLOCA(arity*sizeof(obj*))); // NOLINT
-    for (unsigned i = 0; i < fixed; i++) { lean_inc(fx(i)); args[i] = fx(i); }
+    move_fixed_args(f, args);
     for (unsigned i = 0; i < 14; i++) args[fixed+i] = as[i];
-    obj * r = FNN(f)(args);
-    lean_dec_ref(f);
-    return r;
+    return reinterpret_cast<fnn>(fn)(args);
   }
 } else if (arity < fixed + 14) {
   obj * as[14] = { a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14 };
   obj ** args = static_cast<obj**>(LEAN_ALLOCA(arity*sizeof(obj*))); // NOLINT
-  for (unsigned i = 0; i < fixed; i++) { lean_inc(fx(i)); args[i] = fx(i); }
+  void * fn = move_fixed_args(f, args);
   for (unsigned i = 0; i < arity-fixed; i++) args[fixed+i] = as[i];
-  obj * new_f = curry(f, arity, args);
-  lean_dec_ref(f);
+  obj * new_f = curry(fn, arity, args);
   return lean_apply_n(new_f, 14+fixed-arity, &as[arity-fixed]);
 } else {
   return fix_args(f, {a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14});
@@ -812,32 +801,30 @@ if (lean_is_scalar(f)) { lean_dec(a1); lean_dec(a2); lean_dec(a3); lean_dec(a4);
 unsigned arity = lean_closure_arity(f);
 unsigned fixed = lean_closure_num_fixed(f);
 if (arity == fixed + 15) {
+  void * fn = lean_closure_fun(f);
   if (lean_is_exclusive(f)) {
     switch (arity) {
-    case 15: { obj* r = FN15(f)(a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15); lean_free_object(f); return r; }
-    case 16: { obj* r = FN16(f)(fx(0), a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15); lean_free_object(f); return r; }
+    case 15: { lean_free_object(f); return reinterpret_cast<fn15>(fn)(a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15); }
+    case 16: { obj* x0 = fx(0); lean_free_object(f); return reinterpret_cast<fn16>(fn)(x0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15); }
     }
   }
   switch (arity) {
-  case 15: { obj* r = FN15(f)(a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15); lean_dec_ref(f); return r; }
-  case 16: { lean_inc(fx(0)); obj* r = FN16(f)(fx(0), a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15); lean_dec_ref(f); return r; }
+  case 15: { lean_dec_ref(f); return reinterpret_cast<fn15>(fn)(a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15); }
+  case 16: { obj* x0 = fx(0); lean_inc(x0); lean_dec_ref(f); return reinterpret_cast<fn16>(fn)(x0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15); }
   default:
     lean_assert(arity > 16);
     obj * as[15] = { a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15 };
     obj ** args = static_cast<obj**>(LEAN_ALLOCA(arity*sizeof(obj*))); // NOLINT
-    for (unsigned i = 0; i < fixed; i++) { lean_inc(fx(i)); args[i] = fx(i); }
+    move_fixed_args(f, args);
     for (unsigned i = 0; i < 15; i++) args[fixed+i] = as[i];
-    obj * r = FNN(f)(args);
-    lean_dec_ref(f);
-    return r;
+    return reinterpret_cast<fnn>(fn)(args);
   }
 } else if (arity < fixed + 15) {
   obj * as[15] = { a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15 };
   obj ** args = static_cast<obj**>(LEAN_ALLOCA(arity*sizeof(obj*))); // NOLINT
-  for (unsigned i = 0; i < fixed; i++) { lean_inc(fx(i)); args[i] = fx(i); }
+  void * fn = move_fixed_args(f, args);
   for (unsigned i = 0; i < arity-fixed; i++) args[fixed+i] = as[i];
-  obj * new_f = curry(f, arity, args);
-  lean_dec_ref(f);
+  obj * new_f = curry(fn, arity, args);
   return lean_apply_n(new_f, 15+fixed-arity, &as[arity-fixed]);
 } else {
   return fix_args(f, {a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15});
@@ -848,30 +835,28 @@ if (lean_is_scalar(f)) { lean_dec(a1); lean_dec(a2); lean_dec(a3); lean_dec(a4);
 unsigned arity = lean_closure_arity(f);
 unsigned fixed = lean_closure_num_fixed(f);
 if (arity == fixed + 16) {
+  void * fn = lean_closure_fun(f);
   if (lean_is_exclusive(f)) {
     switch (arity) {
-    case 16: { obj* r = FN16(f)(a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16); lean_free_object(f); return r; }
+    case 16: { lean_free_object(f); return reinterpret_cast<fn16>(fn)(a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16); }
     }
   }
   switch (arity) {
-  case 16: { obj* r = FN16(f)(a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16); lean_dec_ref(f); return r; }
+  case 16: { lean_dec_ref(f); return reinterpret_cast<fn16>(fn)(a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16); }
   default:
     lean_assert(arity > 16);
     obj * as[16] = { a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16 };
     obj ** args = static_cast<obj**>(LEAN_ALLOCA(arity*sizeof(obj*))); // NOLINT
-    for (unsigned i = 0; i < fixed; i++) { lean_inc(fx(i)); args[i] = fx(i); }
+    move_fixed_args(f, args);
     for (unsigned i = 0; i < 16; i++) args[fixed+i] = as[i];
-    obj * r = FNN(f)(args);
-    lean_dec_ref(f);
-    return r;
+    return reinterpret_cast<fnn>(fn)(args);
   }
 } else if (arity < fixed + 16) {
   obj * as[16] = { a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16 };
   obj ** args = static_cast<obj**>(LEAN_ALLOCA(arity*sizeof(obj*))); // NOLINT
-  for (unsigned i = 0; i < fixed; i++) { lean_inc(fx(i)); args[i] = fx(i); }
+  void * fn = move_fixed_args(f, args);
   for (unsigned i = 0; i < arity-fixed; i++) args[fixed+i] = as[i];
-  obj * new_f = curry(f, arity, args);
-  lean_dec_ref(f);
+  obj * new_f = curry(fn, arity, args);
   return lean_apply_n(new_f, 16+fixed-arity, &as[arity-fixed]);
 } else {
   return fix_args(f, {a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16});
@@ -884,17 +869,14 @@ unsigned arity = lean_closure_arity(f);
 unsigned fixed = lean_closure_num_fixed(f);
 if (arity == fixed + n) {
   obj ** args = static_cast<obj**>(LEAN_ALLOCA(arity*sizeof(obj*))); // NOLINT
-  for (unsigned i = 0; i < fixed; i++) { lean_inc(fx(i)); args[i] = fx(i); }
+  void * fn = move_fixed_args(f, args);
   for (unsigned i = 0; i < n; i++) args[fixed+i] = as[i];
-  obj * r = FNN(f)(args);
-  lean_dec_ref(f);
-  return r;
+  return reinterpret_cast<fnn>(fn)(args);
 } else if (arity < fixed + n) {
   obj ** args = static_cast<obj**>(LEAN_ALLOCA(arity*sizeof(obj*))); // NOLINT
-  for (unsigned i = 0; i < fixed; i++) { lean_inc(fx(i)); args[i] = fx(i); }
+  void * fn = move_fixed_args(f, args);
   for (unsigned i = 0; i < arity-fixed; i++) args[fixed+i] = as[i];
-  obj * new_f = FNN(f)(args);
-  lean_dec_ref(f);
+  obj * new_f = curry(fn, arity, args);
   return lean_apply_n(new_f, n+fixed-arity, &as[arity-fixed]);
 } else {
   return fix_args(f, n, as);
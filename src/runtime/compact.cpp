@@ -57,9 +57,11 @@ struct object_compactor::max_sharing_table {
     }
 };
 
-object_compactor::object_compactor(void * base_addr):
+object_compactor::object_compactor(void * base_addr, void * code_base, bool keep_mutable_identity):
     m_max_sharing_table(new max_sharing_table(this)),
     m_base_addr(base_addr),
+    m_code_base(code_base),
+    m_keep_mutable_identity(keep_mutable_identity),
     m_begin(malloc(LEAN_COMPACTOR_INIT_SZ)),
     m_end(m_begin),
     m_capacity(static_cast<char*>(m_begin) + LEAN_COMPACTOR_INIT_SZ) {
@@ -113,6 +115,13 @@ void object_compactor::save_max_sharing(object * o, object * new_o, size_t new_o
     save(o, new_o);
 }
 
+void object_compactor::save_mutable(object * o, object * new_o) {
+    if (m_keep_mutable_identity)
+        save(o, new_o);
+    else
+        save_max_sharing(o, new_o, lean_object_byte_size(o));
+}
+
 object_offset object_compactor::to_offset(object * o) {
     if (lean_is_scalar(o)) {
         return o;
@@ -226,6 +235,32 @@ bool object_compactor::insert_array(object * o) {
     return true;
 }
 
+bool object_compactor::insert_closure(object * o) {
+    if (!m_code_base)
+        throw exception("closures cannot be compacted. One possible cause of this error is trying to store a function in a persistent environment extension.");
+    std::vector<object_offset> & offsets = m_tmp;
+    bool missing_children = false;
+    unsigned num_fixed    = lean_closure_num_fixed(o);
+    offsets.resize(num_fixed);
+    unsigned i = num_fixed;
+    while (i > 0) {
+        i--;
+        object_offset c = to_offset(lean_closure_get(o, i));
+        if (c == g_null_offset)
+            missing_children = true;
+        offsets[i] = c;
+    }
+    if (missing_children)
+        return false;
+    object * new_o = copy_object(o);
+    lean_to_closure(new_o)->m_fun =
+        reinterpret_cast<void *>(reinterpret_cast<size_t>(lean_closure_fun(o)) - reinterpret_cast<size_t>(m_code_base));
+    for (unsigned i = 0; i < num_fixed; i++)
+        lean_closure_set(new_o, i, offsets[i]);
+    save_max_sharing(o, new_o, lean_object_byte_size(o));
+    return true;
+}
+
 bool object_compactor::insert_thunk(object * o) {
     object * v = lean_thunk_get(o);
     object_offset c = to_offset(v);
@@ -244,7 +279,7 @@ bool object_compactor::insert_ref(object * o) {
         return false;
     object * r = copy_object(o);
     lean_to_ref(r)->m_value = c;
-    save_max_sharing(o, r, lean_object_byte_size(o));
+    save_mutable(o, r);
     return true;
 }
 
@@ -267,7 +302,7 @@ bool object_compactor::insert_promise(object * o) {
         return false;
     object * r = copy_object(o);
     lean_to_promise(r)->m_result = (lean_task_object *)c;
-    save_max_sharing(o, r, lean_object_byte_size(o));
+    save_mutable(o, r);
     return true;
 }
 
@@ -358,7 +393,7 @@ void object_compactor::operator()(object * o) {
             g_tag_counters[lean_ptr_tag(curr)]++;
 #endif
             switch (lean_ptr_tag(curr)) {
-            case LeanClosure:         throw exception("closures cannot be compacted. One possible cause of this error is trying to store a function in a persistent environment extension.");
+            case LeanClosure:         r = insert_closure(curr); break;
             case LeanArray:           r = insert_array(curr); break;
             case LeanScalarArray:     insert_sarray(curr); break;
             case LeanString:          insert_string(curr); break;
@@ -379,9 +414,11 @@ void object_compactor::operator()(object * o) {
     *root = to_offset(o);
 }
 
-compacted_region::compacted_region(size_t sz, void * data, void * base_addr, bool is_mmap, std::function<void()> free_data):
+compacted_region::compacted_region(size_t sz, void * data, void * base_addr, bool is_mmap, std::function<void()> free_data,
+                                   void * code_base):
     m_size(sz),
     m_base_addr(base_addr),
+    m_code_base(code_base),
     m_is_mmap(is_mmap),
     m_free_data(free_data),
     m_begin(data),
@@ -432,6 +469,17 @@ inline void compacted_region::fix_array(object * o) {
     move(o);
 }
 
+inline void compacted_region::fix_closure(object * o) {
+    lean_closure_object * c = lean_to_closure(o);
+    c->m_fun = static_cast<char*>(m_code_base) + reinterpret_cast<size_t>(c->m_fun);
+    object ** it  = c->m_objs;
+    object ** end = it + c->m_num_fixed;
+    for (; it != end; it++) {
+        *it = fix_object_ptr(*it);
+    }
+    move(o);
+}
+
 inline void compacted_region::fix_thunk(object * o) {
     lean_to_thunk(o)->m_value = fix_object_ptr(lean_to_thunk(o)->m_value);
     move(sizeof(lean_thunk_object));
@@ -452,15 +500,23 @@ inline void compacted_region::fix_promise(object * o) {
     move(sizeof(lean_promise_object));
 }
 
+/* Size of a compacted bignum including its digits, which the object header may be too small to store. */
+size_t compacted_region::mpz_byte_size(object * o) {
+#ifdef LEAN_USE_GMP
+    return sizeof(mpz_object) + sizeof(mp_limb_t) * mpz_size(to_mpz(o)->m_value.m_val);
+#else
+    return sizeof(mpz_object) + sizeof(mpn_digit) * to_mpz(o)->m_value.m_size;
+#endif
+}
+
 void compacted_region::fix_mpz(object * o) {
 #ifdef LEAN_USE_GMP
     __mpz_struct & m = to_mpz(o)->m_value.m_val[0];
     m._mp_d = reinterpret_cast<mp_limb_t *>(static_cast<char *>(m_begin) + reinterpret_cast<size_t>(m._mp_d) - reinterpret_cast<size_t>(m_base_addr));
-    move(sizeof(mpz_object) + sizeof(mp_limb_t) * mpz_size(to_mpz(o)->m_value.m_val));
 #else
     to_mpz(o)->m_value.m_digits = reinterpret_cast<mpn_digit*>(reinterpret_cast<char*>(o) + sizeof(mpz_object));
-    move(sizeof(mpz_object) + sizeof(mpn_digit) * to_mpz(o)->m_value.m_size);
 #endif
+    move(mpz_byte_size(o));
 }
 
 object * compacted_region::read() {
@@ -469,21 +525,26 @@ object * compacted_region::read() {
 
     object * root = fix_object_ptr(*static_cast<object_offset *>(m_next));
     move(sizeof(object_offset));
-    if (m_begin == m_base_addr) {
+    if (m_begin == m_base_addr && !m_code_base) {
         // no relocations needed
         m_end = m_next;
         return root;
     }
-    lean_assert(!m_is_mmap);
+    // at the base address, only the code pointers of closures need to be relocated
+    bool relocate = m_begin != m_base_addr;
+    lean_assert(!m_is_mmap || !relocate);
 
     while (m_next < m_end) {
         object * curr = reinterpret_cast<object*>(m_next);
         uint8 tag = lean_ptr_tag(curr);
-        if (tag <= LeanMaxCtorTag) {
+        if (!relocate && tag != LeanClosure) {
+            // skip without writing to the object so as not to copy pages of a memory-mapped region
+            move(tag == LeanMPZ ? mpz_byte_size(curr) : lean_object_byte_size(curr));
+        } else if (tag <= LeanMaxCtorTag) {
             fix_constructor(curr);
         } else {
             switch (tag) {
-            case LeanClosure:         lean_unreachable();
+            case LeanClosure:         lean_assert(m_code_base); fix_closure(curr); break;
             case LeanArray:           fix_array(curr); break;
             case LeanScalarArray:     move(lean_sarray_byte_size(curr)); break;
             case LeanString:          move(lean_string_byte_size(curr)); break;
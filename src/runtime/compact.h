@@ -25,12 +25,20 @@ class LEAN_EXPORT object_compactor {
     // References within the compacted region are rewritten by subtracting `m_begin` and adding `m_base_addr`
     // In the simplest case `base_addr == nullptr`, we get region-relative pointers
     void * m_base_addr;
+    // Function pointers of closures are stored relative to `m_code_base`, or closures are rejected if it is null.
+    // All functions must be contained in the same binary as `m_code_base` for this to survive address space
+    // randomization, which is up to the caller to check.
+    void * m_code_base;
+    // If set, `IO.Ref`s and promises are never merged with equal objects by max sharing. Their identity is
+    // observable as they are mutable, which matters when the region is used as the state of a process.
+    bool m_keep_mutable_identity;
     void * m_begin;
     void * m_end;
     void * m_capacity;
     size_t capacity() const { return static_cast<char*>(m_capacity) - static_cast<char*>(m_begin); }
     void save(object * o, object * new_o);
     void save_max_sharing(object * o, object * new_o, size_t new_o_sz);
+    void save_mutable(object * o, object * new_o);
     object_offset to_offset(object * o);
     void insert_terminator(object * o);
     object * copy_object(object * o);
@@ -38,13 +46,14 @@ class LEAN_EXPORT object_compactor {
     bool insert_array(object * o);
     void insert_sarray(object * o);
     void insert_string(object * o);
+    bool insert_closure(object * o);
     bool insert_thunk(object * o);
     bool insert_task(object * o);
     bool insert_promise(object * o);
     bool insert_ref(object * o);
     void insert_mpz(object * o);
 public:
-    object_compactor(void * base_addr = nullptr);
+    object_compactor(void * base_addr = nullptr, void * code_base = nullptr, bool keep_mutable_identity = false);
     object_compactor(object_compactor const &) = delete;
     object_compactor(object_compactor &&) = delete;
     ~object_compactor();
@@ -60,6 +69,8 @@ class LEAN_EXPORT compacted_region {
     size_t m_size;
     // see `object_compactor::m_base_addr`
     void * m_base_addr;
+    // see `object_compactor::m_code_base`
+    void * m_code_base;
     bool m_is_mmap;
     std::function<void()> m_free_data;
     void * m_begin;
@@ -70,15 +81,19 @@ class LEAN_EXPORT compacted_region {
     object * fix_object_ptr(object * o);
     void fix_constructor(object * o);
     void fix_array(object * o);
+    void fix_closure(object * o);
     void fix_thunk(object * o);
     void fix_ref(object * o);
     void fix_task(object * o);
     void fix_promise(object * o);
     void fix_mpz(object * o);
+    static size_t mpz_byte_size(object * o);
 public:
     /* Creates a compacted object region using the given region in memory.
-       This object takes ownership of the region. */
-    compacted_region(size_t sz, void * data, void * base_addr, bool is_mmap, std::function<void()> free_data);
+       This object takes ownership of the region. If `code_base` is not null, the region may contain closures
+       compacted relative to it and must be writable. */
+    compacted_region(size_t sz, void * data, void * base_addr, bool is_mmap, std::function<void()> free_data,
+                     void * code_base = nullptr);
     /* Creates a compacted object region using the object_compactor current state.
        It creates a copy of the compacted region generated by the object compactor. */
     explicit compacted_region(object_compactor const & c);
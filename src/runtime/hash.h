@@ -10,8 +10,17 @@ Author: Leonardo de Moura
 
 namespace lean {
 
+/*
+String hash functions. Hashes computed by `hash_str` are stored in .olean files (e.g., in `Name`s), so
+its results must never change. Faster hash functions are added as new versions next to it instead.
+*/
+
+/* Version 1: MurmurHash64A, used by `String.hash`, `ByteArray.hash` and `String.Slice.hash`. */
 uint64 hash_str(size_t len, unsigned char const * str, uint64 init_value);
 
+/* Version 2: wyhash (final version 4), used by `String.hashV2` and friends. */
+uint64 hash_str_v2(size_t len, unsigned char const * str, uint64 seed);
+
 inline uint64 hash(uint64 h, uint64 k) {
     uint64 m = 0xc6a4a7935bd1e995;
     uint64 r = 47;
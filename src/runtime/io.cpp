@@ -610,28 +610,72 @@ extern "C" LEAN_EXPORT obj_res lean_io_prim_handle_write(b_obj_arg h, b_obj_arg
     }
 }
 
-/* Handle.getLine : (@& Handle) → IO Unit */
-extern "C" LEAN_EXPORT obj_res lean_io_prim_handle_get_line(b_obj_arg h) {
-    FILE * fp = io_get_handle(h);
-
-    std::string result;
+/* Scratch buffer for `getdelim`, reused across calls on the same thread so that reading a line
+   does not allocate anything besides the resulting Lean object. */
+LEAN_THREAD_PTR(char, g_read_until_buffer);
+LEAN_THREAD_VALUE(size_t, g_read_until_buffer_size, 0);
+/* Larger scratch buffers are released after use instead of being kept alive by the thread. */
+static const size_t g_read_until_buffer_max_size = 64 * 1024;
+
+/* Read bytes from `fp` up to and including the next occurrence of `delim` (or EOF), and build the
+   result object from them using `mk`. On POSIX systems, we use `getdelim`, which scans the stdio
+   buffer with `memchr` instead of going through `fgetc` for every single byte. */
+template<typename F> static obj_res io_read_until(FILE * fp, int delim, F && mk) {
+#if defined(LEAN_WINDOWS)
+    std::string buffer;
     int c; // Note: int, not char, required to handle EOF
     while ((c = std::fgetc(fp)) != EOF) {
-        result.push_back(c);
-        if (c == '\n') {
+        buffer.push_back(c);
+        if (c == delim) {
             break;
         }
     }
+    char const * data = buffer.data();
+    size_t n = buffer.size();
+#else
+    ssize_t r = getdelim(&g_read_until_buffer, &g_read_until_buffer_size, delim, fp);
+    char const * data = g_read_until_buffer;
+    size_t n = r > 0 ? static_cast<size_t>(r) : 0;
+#endif
 
     if (std::ferror(fp)) {
         return io_result_mk_error(decode_io_error(errno, nullptr));
-    } else if (std::feof(fp)) {
+    }
+#if !defined(LEAN_WINDOWS)
+    if (r < 0 && !std::feof(fp)) {
+        // `getdelim` itself failed, e.g. with `ENOMEM`
+        return io_result_mk_error(decode_io_error(errno, nullptr));
+    }
+#endif
+    if (std::feof(fp)) {
         clearerr(fp);
-        return io_result_mk_ok(mk_string(result));
-    } else {
-        obj_res ret = io_result_mk_ok(mk_string(result));
-        return ret;
     }
+    obj_res ret = io_result_mk_ok(mk(data, n));
+#if !defined(LEAN_WINDOWS)
+    if (g_read_until_buffer_size > g_read_until_buffer_max_size) {
+        free(g_read_until_buffer);
+        g_read_until_buffer = nullptr;
+        g_read_until_buffer_size = 0;
+    }
+#endif
+    return ret;
+}
+
+/* Handle.getLine : (@& Handle) → IO String */
+extern "C" LEAN_EXPORT obj_res lean_io_prim_handle_get_line(b_obj_arg h) {
+    // `lean_mk_string_from_bytes` validates the line and computes its length in a single pass
+    return io_read_until(io_get_handle(h), '\n', [](char const * data, size_t n) {
+        return lean_mk_string_from_bytes(data, n);
+    });
+}
+
+/* Handle.readUntil : (@& Handle) → UInt8 → IO ByteArray */
+extern "C" LEAN_EXPORT obj_res lean_io_prim_handle_read_until(b_obj_arg h, uint8 delim) {
+    return io_read_until(io_get_handle(h), delim, [](char const * data, size_t n) {
+        obj_res res = lean_alloc_sarray(1, n, n);
+        memcpy(lean_sarray_cptr(res), data, n);
+        return res;
+    });
 }
 
 /* Handle.putStr : (@& Handle) → (@& String) → IO Unit */
@@ -1412,24 +1456,89 @@ static inline atomic<object*> * mt_ref_val_addr(object * o) {
 */
 static inline bool ref_maybe_mt(b_obj_arg ref) { return lean_is_mt(ref) || lean_is_persistent(ref); }
 
+/*
+  Reading a multi-threaded ref must not `inc` a value that a concurrent writer may have just removed from the
+  ref and `dec`ed to zero. Instead of taking the value out of the ref while incrementing it, which would make
+  concurrent readers wait for each other, readers announce the value they are about to `inc` in a per-thread
+  hazard slot, and re-check that the ref still contains it. Any thread that removes a value from a
+  multi-threaded ref (`set`, `take`, `swap`) waits until no slot announces it before giving up or passing on
+  its RC token. Readers thus never write to the ref itself, and only writers pay for the synchronization by
+  scanning the slots. Slots are reused by later threads but never freed, so that the scan can walk the list
+  without locking.
+*/
+struct ref_hazard_slot {
+    atomic<object *>  m_value{nullptr};
+    atomic<bool>      m_in_use{true};
+    ref_hazard_slot * m_next{nullptr};
+    /* Keeps the fields of slots of different threads off each other's cache line. We pad instead of using
+       `alignas(64)`, which `new` does not honor before C++17. */
+    char              m_padding[64];
+};
+
+static atomic<ref_hazard_slot *> g_ref_hazard_slots{nullptr};
+LEAN_THREAD_PTR(ref_hazard_slot, g_ref_hazard_slot);
+
+static void release_ref_hazard_slot(void * p) {
+    static_cast<ref_hazard_slot *>(p)->m_in_use.store(false, memory_order_release);
+    g_ref_hazard_slot = nullptr;
+}
+
+static ref_hazard_slot * get_ref_hazard_slot() {
+    if (g_ref_hazard_slot)
+        return g_ref_hazard_slot;
+    ref_hazard_slot * slot = nullptr;
+    for (ref_hazard_slot * it = g_ref_hazard_slots.load(memory_order_acquire); it != nullptr; it = it->m_next) {
+        bool in_use = false;
+        if (!it->m_in_use.load(memory_order_relaxed) && it->m_in_use.compare_exchange_strong(in_use, true)) {
+            slot = it;
+            break;
+        }
+    }
+    if (slot == nullptr) {
+        slot = new ref_hazard_slot();
+        ref_hazard_slot * head = g_ref_hazard_slots.load(memory_order_relaxed);
+        do {
+            slot->m_next = head;
+        } while (!g_ref_hazard_slots.compare_exchange_weak(head, slot));
+    }
+    register_thread_finalizer(release_ref_hazard_slot, slot);
+    g_ref_hazard_slot = slot;
+    return slot;
+}
+
+/* Wait until no reader is about to `inc` `val`, which has been removed from the multi-threaded ref at `val_addr`.
+   Readers only announce a value for the few instructions between reading it and incrementing it. If `val` has
+   been stored in the ref again in the meantime, the RC token held by the ref keeps it alive, and whoever removes
+   it next waits for the readers instead. */
+static void wait_for_ref_readers(atomic<object *> * val_addr, object * val) {
+    if (lean_is_scalar(val))
+        return;
+    for (ref_hazard_slot * it = g_ref_hazard_slots.load(memory_order_acquire); it != nullptr; it = it->m_next) {
+        while (it->m_value.load(memory_order_seq_cst) == val) {
+            if (val_addr->load(memory_order_seq_cst) == val)
+                return;
+        }
+    }
+}
+
 extern "C" LEAN_EXPORT obj_res lean_st_ref_get(b_obj_arg ref) {
     if (ref_maybe_mt(ref)) {
         atomic<object *> * val_addr = mt_ref_val_addr(ref);
+        ref_hazard_slot * slot = get_ref_hazard_slot();
         while (true) {
-            /*
-              We cannot simply read `val` from the ref and `inc` it like in the `else` branch since someone else could
-              write to the ref in between and remove the last owning reference to the object. Instead, we must take
-              ownership of the RC token in the ref via `exchange`, duplicate it, then put one RC token back. */
-            object * val = val_addr->exchange(nullptr);
-            if (val != nullptr) {
+            object * val = val_addr->load(memory_order_acquire);
+            if (val == nullptr) {
+                /* another thread has taken the value and will put it back */
+                continue;
+            }
+            slot->m_value.store(val, memory_order_seq_cst);
+            /* If `val` is still in `ref` after announcing it, any writer removing it from now on will wait for us. */
+            bool ok = val_addr->load(memory_order_seq_cst) == val;
+            if (ok)
                 inc(val);
-                object * tmp = val_addr->exchange(val);
-                if (tmp != nullptr) {
-                    /* this may happen if another thread wrote `ref` */
-                    dec(tmp);
-                }
+            slot->m_value.store(nullptr, memory_order_release);
+            if (ok)
                 return val;
-            }
         }
     } else {
         object * val = lean_to_ref(ref)->m_value;
@@ -1444,8 +1553,10 @@ extern "C" LEAN_EXPORT obj_res lean_st_ref_take(b_obj_arg ref) {
         atomic<object *> * val_addr = mt_ref_val_addr(ref);
         while (true) {
             object * val = val_addr->exchange(nullptr);
-            if (val != nullptr)
+            if (val != nullptr) {
+                wait_for_ref_readers(val_addr, val);
                 return val;
+            }
         }
     } else {
         object * val = lean_to_ref(ref)->m_value;
@@ -1465,8 +1576,10 @@ extern "C" LEAN_EXPORT obj_res lean_st_ref_set(b_obj_arg ref, obj_arg a) {
         mark_mt(a);
         atomic<object *> * val_addr = mt_ref_val_addr(ref);
         object * old_a = val_addr->exchange(a);
-        if (old_a != nullptr)
+        if (old_a != nullptr) {
+            wait_for_ref_readers(val_addr, old_a);
             dec(old_a);
+        }
         return box(0);
     } else {
         if (lean_to_ref(ref)->m_value != nullptr)
@@ -1483,8 +1596,10 @@ extern "C" LEAN_EXPORT obj_res lean_st_ref_swap(b_obj_arg ref, obj_arg a) {
         atomic<object *> * val_addr = mt_ref_val_addr(ref);
         while (true) {
             object * old_a = val_addr->exchange(a);
-            if (old_a != nullptr)
+            if (old_a != nullptr) {
+                wait_for_ref_readers(val_addr, old_a);
                 return old_a;
+            }
         }
     } else {
         object * old_a = lean_to_ref(ref)->m_value;
@@ -1577,6 +1692,12 @@ extern "C" LEAN_EXPORT obj_res lean_runtime_mark_persistent(obj_arg a) {
     return a;
 }
 
+/* Runtime.setDeferredMTDecrements (enabled : Bool) : BaseIO Unit */
+extern "C" LEAN_EXPORT obj_res lean_runtime_set_deferred_mt_decrements(uint8_t enabled) {
+    lean_set_deferred_mt_dec(enabled);
+    return box(0);
+}
+
 #if defined(__has_feature)
 #if __has_feature(address_sanitizer)
 #include <sanitizer/lsan_interface.h>
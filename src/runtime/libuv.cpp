@@ -17,12 +17,18 @@ namespace lean {
 #ifndef LEAN_EMSCRIPTEN
 
 extern "C" void initialize_libuv() {
+    initialize_libuv_loop();
     initialize_libuv_timer();
     initialize_libuv_tcp_socket();
     initialize_libuv_udp_socket();
     initialize_libuv_signal();
-    initialize_libuv_loop();
+    initialize_libuv_process();
+
+    lthread([]() { event_loop_run_loop(&global_ev); });
+}
 
+extern "C" LEAN_EXPORT void lean_libuv_after_fork() {
+    event_loop_after_fork(&global_ev);
     lthread([]() { event_loop_run_loop(&global_ev); });
 }
 
@@ -39,6 +45,8 @@ extern "C" LEAN_EXPORT lean_obj_res lean_libuv_version(lean_obj_arg o) {
 
 extern "C" void initialize_libuv() {}
 
+extern "C" LEAN_EXPORT void lean_libuv_after_fork() {}
+
 extern "C" LEAN_EXPORT lean_obj_res lean_libuv_version(lean_obj_arg o) {
     return lean_box(0);
 }
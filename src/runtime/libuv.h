@@ -12,6 +12,7 @@ Author: Markus Himmel, Sofia Rodrigues
 #include "runtime/uv/dns.h"
 #include "runtime/uv/udp.h"
 #include "runtime/uv/signal.h"
+#include "runtime/uv/process.h"
 #include "runtime/alloc.h"
 #include "runtime/io.h"
 #include "runtime/utf8.h"
@@ -23,6 +24,8 @@ Author: Markus Himmel, Sofia Rodrigues
 namespace lean {
 
 extern "C" void initialize_libuv();
+/* Restart the event loop in a child process after `fork`, which only preserves the forking thread. */
+extern "C" LEAN_EXPORT void lean_libuv_after_fork();
 extern "C" LEAN_EXPORT char ** lean_setup_args(int argc, char ** argv);
 
 // =======================================
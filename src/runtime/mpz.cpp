@@ -114,6 +114,47 @@ size_t mpz::get_size_t() const {
     return static_cast<size_t>(mpz_getlimbn(m_val, 0));
 }
 
+size_t mpz::digits_byte_size() const {
+    return mpz_size(m_val) * sizeof(mp_limb_t);
+}
+
+void mpz::init_digits_at(mpz const & v, void * buf) {
+    size_t n = mpz_size(v.m_val);
+    lean_assert(n > 0);
+    m_val->_mp_alloc = static_cast<int>(n);
+    m_val->_mp_size  = v.m_val->_mp_size;
+    m_val->_mp_d     = static_cast<mp_limb_t *>(buf);
+    memcpy(buf, v.m_val->_mp_d, n * sizeof(mp_limb_t));
+}
+
+#ifdef __SIZEOF_INT128__
+bool mpz::get_uint128(unsigned __int128 & r) const {
+    int n = m_val->_mp_size;
+    if (n < 0 || n * GMP_NUMB_BITS > 128)
+        return false;
+    r = 0;
+    for (int i = n - 1; i >= 0; i--)
+        r = (r << GMP_NUMB_BITS) | m_val->_mp_d[i];
+    return true;
+}
+
+size_t mpz::uint128_digits_byte_size(unsigned __int128 v) {
+    size_t n = 0;
+    for (; v != 0; v = v >> GMP_NUMB_BITS) n++;
+    return n * sizeof(mp_limb_t);
+}
+
+void mpz::init_uint128_at(unsigned __int128 v, void * buf) {
+    mp_limb_t * d = static_cast<mp_limb_t *>(buf);
+    int n = 0;
+    for (; v != 0; v = v >> GMP_NUMB_BITS) d[n++] = static_cast<mp_limb_t>(v);
+    lean_assert(n > 0);
+    m_val->_mp_alloc = n;
+    m_val->_mp_size  = n;
+    m_val->_mp_d     = d;
+}
+#endif
+
 mpz & mpz::operator=(mpz const & v) {
     mpz_set(m_val, v.m_val); return *this;
 }
@@ -513,6 +554,42 @@ size_t mpz::get_size_t() const {
     }
 }
 
+size_t mpz::digits_byte_size() const {
+    return m_size * sizeof(mpn_digit);
+}
+
+void mpz::init_digits_at(mpz const & v, void * buf) {
+    m_sign   = v.m_sign;
+    m_size   = v.m_size;
+    m_digits = static_cast<mpn_digit *>(buf);
+    memcpy(buf, v.m_digits, m_size * sizeof(mpn_digit));
+}
+
+#ifdef __SIZEOF_INT128__
+bool mpz::get_uint128(unsigned __int128 & r) const {
+    if (m_sign || m_size * sizeof(mpn_digit) > sizeof(unsigned __int128))
+        return false;
+    r = 0;
+    for (size_t i = m_size; i > 0; i--)
+        r = (r << (8 * sizeof(mpn_digit))) | m_digits[i - 1];
+    return true;
+}
+
+size_t mpz::uint128_digits_byte_size(unsigned __int128 v) {
+    size_t n = 1;
+    for (v = v >> (8 * sizeof(mpn_digit)); v != 0; v = v >> (8 * sizeof(mpn_digit))) n++;
+    return n * sizeof(mpn_digit);
+}
+
+void mpz::init_uint128_at(unsigned __int128 v, void * buf) {
+    m_sign   = false;
+    m_size   = uint128_digits_byte_size(v) / sizeof(mpn_digit);
+    m_digits = static_cast<mpn_digit *>(buf);
+    for (size_t i = 0; i < m_size; i++, v = v >> (8 * sizeof(mpn_digit)))
+        m_digits[i] = static_cast<mpn_digit>(v);
+}
+#endif
+
 mpz & mpz::operator=(mpz const & v) {
     if (v.m_digits != m_digits) {
         if (v.m_size == m_size) {
@@ -140,6 +140,20 @@ public:
     unsigned int get_unsigned_int() const;
     size_t get_size_t() const;
 
+    /*
+    Support for values whose digits are stored in a buffer owned by someone else, e.g., right after
+    an `mpz_object` (see `alloc_mpz`). `init_digits_at` initializes `*this` from scratch, without running
+    the constructor. The resulting value must not be updated, and its destructor must not be executed.
+    */
+    size_t digits_byte_size() const;
+    void init_digits_at(mpz const & v, void * buf);
+#ifdef __SIZEOF_INT128__
+    /* Return true and store `*this` in `r` if it is a natural number smaller than 2^128. */
+    bool get_uint128(unsigned __int128 & r) const;
+    static size_t uint128_digits_byte_size(unsigned __int128 v);
+    void init_uint128_at(unsigned __int128 v, void * buf);
+#endif
+
     mpz & operator=(mpz const & v);
     mpz & operator=(mpz && v) { swap(*this, v); return *this; }
     mpz & operator=(char const * v);
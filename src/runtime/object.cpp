@@ -21,6 +21,7 @@ Author: Leonardo de Moura
 #include "runtime/buffer.h"
 #include "runtime/io.h"
 #include "runtime/hash.h"
+#include "runtime/simd.h"
 
 #if defined(__GLIBC__) || defined(__APPLE__)
     #define LEAN_SUPPORTS_BACKTRACE 1
@@ -234,13 +235,22 @@ static inline void lean_dealloc(lean_object * o, size_t sz) {
 #endif
 }
 
+/* `m_other` field of `mpz_object`s whose digits are stored right after the object, see `alloc_mpz`. */
+#define LEAN_MPZ_INLINE_DIGITS 1
+
+static inline void free_mpz_object(lean_object * o) {
+    if (lean_ptr_other(o) != LEAN_MPZ_INLINE_DIGITS)
+        to_mpz(o)->m_value.~mpz();
+    lean_free_small_object(o);
+}
+
 extern "C" LEAN_EXPORT void lean_free_object(lean_object * o) {
     switch (lean_ptr_tag(o)) {
     case LeanArray:       return lean_dealloc(o, lean_array_byte_size(o));
     case LeanScalarArray: return lean_dealloc(o, lean_sarray_byte_size(o));
     case LeanString:      return lean_dealloc(o, lean_string_byte_size(o));
     case LeanClosure:     return lean_dealloc(o, lean_closure_byte_size(o));
-    case LeanMPZ:         to_mpz(o)->m_value.~mpz(); return lean_free_small_object(o);
+    case LeanMPZ:         return free_mpz_object(o);
     default:              return lean_free_small_object(o);
     }
 }
@@ -281,6 +291,99 @@ static inline lean_object * pop_back(lean_object * & todo) {
     return r;
 }
 
+static void lean_del_list(lean_object * todo);
+
+#ifdef LEAN_MULTI_THREAD
+/*
+  Deferred decrements of multi-threaded objects.
+
+  When enabled, decrementing a multi-threaded object does not immediately perform the atomic
+  operation. Instead, the decrement is recorded in a small thread-local direct-mapped table that
+  combines repeated decrements of the same object, and the accumulated count is applied with a single
+  atomic operation when the entry is evicted or the table is flushed. This is safe since delaying a
+  decrement can only delay the deallocation of an object. Increments are never deferred.
+  The table is flushed after `LEAN_DEFERRED_DEC_LIMIT` deferred decrements, after each task run by
+  the task manager, when the mode is disabled, and when the thread exits.
+
+  Objects whose count drops to zero are pushed to the caller's `todo` list instead of being deleted
+  right away, so that deleting large structures does not recurse.
+*/
+#define LEAN_DEFERRED_DEC_TABLE_SIZE 256
+#define LEAN_DEFERRED_DEC_LIMIT 4096
+
+struct deferred_dec_entry {
+    lean_object * m_obj;
+    unsigned      m_count;
+};
+
+static std::atomic<bool> g_deferred_mt_dec(false);
+LEAN_THREAD_VALUE(unsigned, g_deferred_dec_pending, 0);
+LEAN_THREAD_PTR(deferred_dec_entry, g_deferred_dec_table);
+
+static inline void apply_deferred_dec(lean_object * o, unsigned n, lean_object * & todo) {
+    // The object may have been marked persistent in the meantime.
+    if (o->m_rc == 0)
+        return;
+    if (std::atomic_fetch_add_explicit(lean_get_rc_mt_addr(o), (int)n, std::memory_order_acq_rel) == -(int)n)
+        push_back(todo, o);
+}
+
+static void flush_deferred_decs(lean_object * & todo) {
+    g_deferred_dec_pending = 0;
+    for (size_t i = 0; i < LEAN_DEFERRED_DEC_TABLE_SIZE; i++) {
+        deferred_dec_entry & e = g_deferred_dec_table[i];
+        if (e.m_obj != nullptr) {
+            apply_deferred_dec(e.m_obj, e.m_count, todo);
+            e.m_obj = nullptr;
+        }
+    }
+}
+
+static void finalize_deferred_decs(void *) {
+    lean_object * todo = nullptr;
+    flush_deferred_decs(todo);
+    lean_del_list(todo);
+    free(g_deferred_dec_table);
+    g_deferred_dec_table = nullptr;
+}
+
+static void defer_dec(lean_object * o, lean_object * & todo) {
+    if (LEAN_UNLIKELY(g_deferred_dec_table == nullptr)) {
+        g_deferred_dec_table = (deferred_dec_entry*)calloc(LEAN_DEFERRED_DEC_TABLE_SIZE, sizeof(deferred_dec_entry));
+        if (g_deferred_dec_table == nullptr) lean_internal_panic_out_of_memory();
+        register_thread_finalizer(finalize_deferred_decs, nullptr);
+    }
+    deferred_dec_entry & e = g_deferred_dec_table[(reinterpret_cast<size_t>(o) >> 4) % LEAN_DEFERRED_DEC_TABLE_SIZE];
+    if (e.m_obj == o) {
+        e.m_count++;
+    } else {
+        if (e.m_obj != nullptr)
+            apply_deferred_dec(e.m_obj, e.m_count, todo);
+        e.m_obj = o;
+        e.m_count = 1;
+    }
+    if (++g_deferred_dec_pending >= LEAN_DEFERRED_DEC_LIMIT)
+        flush_deferred_decs(todo);
+}
+
+extern "C" LEAN_EXPORT void lean_flush_deferred_decs() {
+    if (g_deferred_dec_pending > 0) {
+        lean_object * todo = nullptr;
+        flush_deferred_decs(todo);
+        lean_del_list(todo);
+    }
+}
+
+extern "C" LEAN_EXPORT void lean_set_deferred_mt_dec(bool enabled) {
+    g_deferred_mt_dec.store(enabled, std::memory_order_relaxed);
+    if (!enabled)
+        lean_flush_deferred_decs();
+}
+#else
+extern "C" LEAN_EXPORT void lean_flush_deferred_decs() {}
+extern "C" LEAN_EXPORT void lean_set_deferred_mt_dec(bool) {}
+#endif
+
 static inline void dec(lean_object * o, lean_object* & todo) {
     if (lean_is_scalar(o))
         return;
@@ -290,6 +393,10 @@ static inline void dec(lean_object * o, lean_object* & todo) {
         push_back(todo, o);
     } else if (o->m_rc == 0) {
         return;
+#ifdef LEAN_MULTI_THREAD
+    } else if (g_deferred_mt_dec.load(std::memory_order_relaxed)) {
+        defer_dec(o, todo);
+#endif
     } else if (std::atomic_fetch_add_explicit(lean_get_rc_mt_addr(o), 1, std::memory_order_acq_rel) == -1) {
         push_back(todo, o);
     }
@@ -357,8 +464,7 @@ static void lean_del_core(object * o, object * & todo) {
             lean_dealloc(o, lean_string_byte_size(o));
             break;
         case LeanMPZ:
-            to_mpz(o)->m_value.~mpz();
-            lean_free_small_object(o);
+            free_mpz_object(o);
             break;
         case LeanThunk:
             if (object * c = lean_to_thunk(o)->m_closure) dec(c, todo);
@@ -385,7 +491,32 @@ static void lean_del_core(object * o, object * & todo) {
     }
 }
 
+static void lean_del_list(lean_object * todo) {
+#ifdef LEAN_LAZY_RC
+    while (todo != nullptr)
+        push_back(g_to_free, pop_back(todo));
+#else
+    while (todo != nullptr) {
+        object * o = pop_back(todo);
+        lean_del_core(o, todo);
+    }
+#endif
+}
+
 extern "C" LEAN_EXPORT void lean_dec_ref_cold(lean_object * o) {
+#ifdef LEAN_MULTI_THREAD
+    if (o->m_rc < 0) {
+        if (g_deferred_mt_dec.load(std::memory_order_relaxed)) {
+            lean_object * todo = nullptr;
+            defer_dec(o, todo);
+            lean_del_list(todo);
+            return;
+        } else if (LEAN_UNLIKELY(g_deferred_dec_pending > 0)) {
+            // The mode was disabled by another thread.
+            lean_flush_deferred_decs();
+        }
+    }
+#endif
     if (o->m_rc == 1 || std::atomic_fetch_add_explicit(lean_get_rc_mt_addr(o), 1, std::memory_order_acq_rel) == -1) {
 #ifdef LEAN_LAZY_RC
         push_back(g_to_free, o);
@@ -465,7 +596,11 @@ extern "C" LEAN_EXPORT b_obj_res lean_thunk_get_core(b_obj_arg t) {
         object * r = lean_apply_1(c, lean_box(0));
         lean_assert(r != nullptr); /* Closure must return a valid lean object */
         lean_assert(lean_to_thunk(t)->m_value == nullptr);
-        mark_mt(r);
+        /* A single-threaded thunk is only reachable from the current thread, and marking it later
+           also marks its value. So the value only needs to be marked when the thunk has already
+           been shared. This check must happen after evaluation since `c` may publish `t`. */
+        if (!lean_is_st(t))
+            mark_mt(r);
         lean_to_thunk(t)->m_value = r;
         return r;
     } else {
@@ -575,6 +710,12 @@ static obj_res mark_mt_fn(obj_arg o) {
     return lean_box(0);
 }
 
+static inline void mark_mt_push(buffer<object*> & todo, object * o) {
+    // Shared objects only point to shared objects, so the walk stops there.
+    if (!lean_is_scalar(o) && lean_is_st(o))
+        todo.push_back(o);
+}
+
 extern "C" LEAN_EXPORT void lean_mark_mt(object * o) {
 #ifndef LEAN_MULTI_THREAD
     return;
@@ -582,6 +723,7 @@ extern "C" LEAN_EXPORT void lean_mark_mt(object * o) {
     if (lean_is_scalar(o) || !lean_is_st(o)) return;
 
     buffer<object*> todo;
+    object * foreach_fn = nullptr;
     todo.push_back(o);
     while (!todo.empty()) {
         object * o = todo.back();
@@ -592,7 +734,7 @@ extern "C" LEAN_EXPORT void lean_mark_mt(object * o) {
             if (tag <= LeanMaxCtorTag) {
                 object ** it  = lean_ctor_obj_cptr(o);
                 object ** end = it + lean_ctor_num_objs(o);
-                for (; it != end; ++it) todo.push_back(*it);
+                for (; it != end; ++it) mark_mt_push(todo, *it);
             } else {
                 switch (tag) {
                 case LeanScalarArray:
@@ -600,35 +742,35 @@ extern "C" LEAN_EXPORT void lean_mark_mt(object * o) {
                 case LeanMPZ:
                     break;
                 case LeanExternal: {
-                    object * fn = lean_alloc_closure((void*)mark_mt_fn, 1, 0);
-                    lean_to_external(o)->m_class->m_foreach(lean_to_external(o)->m_data, fn);
-                    lean_dec(fn);
+                    if (foreach_fn == nullptr)
+                        foreach_fn = lean_alloc_closure((void*)mark_mt_fn, 1, 0);
+                    lean_to_external(o)->m_class->m_foreach(lean_to_external(o)->m_data, foreach_fn);
                     break;
                 }
                 case LeanTask:
-                    todo.push_back(lean_task_get(o));
+                    mark_mt_push(todo, lean_task_get(o));
                     break;
                 case LeanPromise:
-                    todo.push_back((lean_object *)lean_to_promise(o)->m_result);
+                    mark_mt_push(todo, (lean_object *)lean_to_promise(o)->m_result);
                     break;
                 case LeanClosure: {
                     object ** it  = lean_closure_arg_cptr(o);
                     object ** end = it + lean_closure_num_fixed(o);
-                    for (; it != end; ++it) todo.push_back(*it);
+                    for (; it != end; ++it) mark_mt_push(todo, *it);
                     break;
                 }
                 case LeanArray: {
                     object ** it  = lean_array_cptr(o);
                     object ** end = it + lean_array_size(o);
-                    for (; it != end; ++it) todo.push_back(*it);
+                    for (; it != end; ++it) mark_mt_push(todo, *it);
                     break;
                 }
                 case LeanThunk:
-                    if (object * c = lean_to_thunk(o)->m_closure) todo.push_back(c);
-                    if (object * v = lean_to_thunk(o)->m_value) todo.push_back(v);
+                    if (object * c = lean_to_thunk(o)->m_closure) mark_mt_push(todo, c);
+                    if (object * v = lean_to_thunk(o)->m_value) mark_mt_push(todo, v);
                     break;
                 case LeanRef:
-                    if (object * v = lean_to_ref(o)->m_value) todo.push_back(v);
+                    if (object * v = lean_to_ref(o)->m_value) mark_mt_push(todo, v);
                     break;
                 default:
                     lean_unreachable();
@@ -637,6 +779,8 @@ extern "C" LEAN_EXPORT void lean_mark_mt(object * o) {
             }
         }
     }
+    if (foreach_fn != nullptr)
+        lean_dec(foreach_fn);
 }
 
 // =======================================
@@ -665,6 +809,16 @@ static void free_task(lean_task_object * t) {
     lean_free_small_object((lean_object*)t);
 }
 
+// Hook for timeline profilers such as `library/chrome_trace.cpp`. It may be called while holding the task manager lock
+// and must not call back into the task manager.
+LEAN_EXPORT atomic<void (*)(task_event, lean_task_object *)> g_lean_report_task_event(nullptr);
+
+static inline void report_task_event(task_event e, lean_task_object * t) {
+    void (*report)(task_event, lean_task_object *) = g_lean_report_task_event.load(std::memory_order_relaxed);
+    if (LEAN_UNLIKELY(report != nullptr))
+        report(e, t);
+}
+
 struct scoped_current_task_object : flet<lean_task_object *> {
     scoped_current_task_object(lean_task_object * t):flet(g_current_task_object, t) {}
 };
@@ -795,7 +949,17 @@ class task_manager {
             object * c = t->m_imp->m_closure;
             t->m_imp->m_closure = nullptr;
             lock.unlock();
+            report_task_event(task_event::started, t);
             v = lean_apply_1(c, box(0));
+            if (v != nullptr)
+                report_task_event(task_event::resolved, t);
+            report_task_event(task_event::stopped, t);
+            // Do not keep objects released by the task alive until this worker runs another one.
+            lean_flush_deferred_decs();
+            // Mark the result before retaking `m_mutex`, publishing a large value should not
+            // block the task manager for the duration of the graph walk.
+            if (v != nullptr)
+                mark_mt(v);
             // If deactivation was delayed by `m_keep_alive`, deactivate after the final execution (`v != nulltpr`)
             if (v != nullptr && t->m_imp->m_keep_alive) {
                 lean_dec_ref((lean_object*)t);
@@ -823,8 +987,9 @@ class task_manager {
         }
     }
 
+    /* `v` must already be marked as multi-threaded, see `run_task` and `resolve`. */
     void resolve_core(unique_lock<mutex> & lock, lean_task_object * t, object * v) {
-        mark_mt(v);
+        lean_assert(lean_is_scalar(v) || !lean_is_st(v));
         t->m_value = v;
         lean_task_imp * imp = t->m_imp;
         t->m_imp   = nullptr;
@@ -864,8 +1029,11 @@ class task_manager {
     }
 
 public:
+    // the configured number of workers, which `m_max_std_workers` temporarily exceeds while workers are blocked
+    unsigned const m_num_workers;
+
     task_manager(unsigned max_std_workers):
-        m_max_std_workers(max_std_workers) {
+        m_max_std_workers(max_std_workers), m_num_workers(max_std_workers) {
     }
 
     ~task_manager() {
@@ -896,12 +1064,14 @@ public:
             dec(v);
             return;
         }
+        mark_mt(v);
         unique_lock<mutex> lock(m_mutex);
         if (t->m_value) {
             lock.unlock(); // `dec(v)` could lead to `deactivate_task` trying to take the lock
             dec(v);
             return;
         }
+        report_task_event(task_event::resolved, t);
         resolve_core(lock, t, v);
     }
 
@@ -1025,6 +1195,10 @@ extern "C" LEAN_EXPORT void lean_finalize_task_manager() {
     }
 }
 
+unsigned get_num_task_workers() {
+    return g_task_manager ? g_task_manager->m_num_workers : 0;
+}
+
 scoped_task_manager::scoped_task_manager(unsigned num_workers) {
     lean_assert(g_task_manager == nullptr);
 #if defined(LEAN_MULTI_THREAD)
@@ -1083,6 +1257,7 @@ extern "C" LEAN_EXPORT obj_res lean_task_spawn_core(obj_arg c, unsigned prio, bo
         return lean_task_pure(apply_1(c, box(0)));
     } else {
         lean_task_object * new_task = alloc_task(c, prio, keep_alive);
+        report_task_event(task_event::spawned, new_task);
         g_task_manager->enqueue(new_task);
         return (lean_object*)new_task;
     }
@@ -1106,6 +1281,7 @@ extern "C" LEAN_EXPORT obj_res lean_task_map_core(obj_arg f, obj_arg t, unsigned
         return lean_task_pure(apply_1(f, lean_task_get_own(t)));
     } else {
         lean_task_object * new_task = alloc_task(mk_closure_3_2(task_map_fn, f, t), sync ? LEAN_SYNC_PRIO : prio, keep_alive);
+        report_task_event(task_event::spawned, new_task);
         g_task_manager->add_dep(lean_to_task(t), new_task);
         return (lean_object*)new_task;
     }
@@ -1118,6 +1294,7 @@ LEAN_EXPORT void (*g_lean_report_task_get_blocked_time)(std::chrono::nanoseconds
 extern "C" LEAN_EXPORT b_obj_res lean_task_get(b_obj_arg t) {
     if (object * v = lean_to_task(t)->m_value)
         return v;
+    report_task_event(task_event::wait_started, lean_to_task(t));
     if (g_lean_report_task_get_blocked_time) {
         std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
         g_task_manager->wait_for(lean_to_task(t));
@@ -1126,6 +1303,7 @@ extern "C" LEAN_EXPORT b_obj_res lean_task_get(b_obj_arg t) {
     } else {
         g_task_manager->wait_for(lean_to_task(t));
     }
+    report_task_event(task_event::wait_stopped, lean_to_task(t));
     lean_assert(lean_to_task(t)->m_value != nullptr);
     object * r = lean_to_task(t)->m_value;
     return r;
@@ -1167,6 +1345,7 @@ extern "C" LEAN_EXPORT obj_res lean_task_bind_core(obj_arg x, obj_arg f, unsigne
         return apply_1(f, lean_task_get_own(x));
     } else {
         lean_task_object * new_task = alloc_task(mk_closure_3_2(task_bind_fn1, x, f), sync ? LEAN_SYNC_PRIO : prio, keep_alive);
+        report_task_event(task_event::spawned, new_task);
         g_task_manager->add_dep(lean_to_task(x), new_task);
         return (lean_object*)new_task;
     }
@@ -1244,7 +1423,28 @@ void deactivate_promise(lean_promise_object * promise) {
 // =======================================
 // Natural numbers
 
+/* Values with at most this many bytes of digits (256 bits) store them inside the `mpz_object` itself,
+   so that creating and freeing them takes a single small object allocation. */
+#define LEAN_MPZ_MAX_INLINE_DIGITS_SIZE 32
+
+static inline void * mpz_inline_digits(lean_object * o) {
+    return reinterpret_cast<char *>(o) + sizeof(mpz_object);
+}
+
+static inline lean_object * alloc_mpz_inline(size_t digits_sz) {
+    lean_assert(0 < digits_sz && digits_sz <= LEAN_MPZ_MAX_INLINE_DIGITS_SIZE);
+    lean_object * o = lean_alloc_small_object(sizeof(mpz_object) + digits_sz);
+    lean_set_st_header(o, LeanMPZ, LEAN_MPZ_INLINE_DIGITS);
+    return o;
+}
+
 object * alloc_mpz(mpz const & m) {
+    size_t digits_sz = m.digits_byte_size();
+    if (0 < digits_sz && digits_sz <= LEAN_MPZ_MAX_INLINE_DIGITS_SIZE) {
+        lean_object * o = alloc_mpz_inline(digits_sz);
+        to_mpz(o)->m_value.init_digits_at(m, mpz_inline_digits(o));
+        return o;
+    }
     void * mem = lean_alloc_small_object(sizeof(mpz_object));
 #ifdef LEAN_MIMALLOC
     // placement new is not guaranteed to preserve this field so store and restore it
@@ -1280,6 +1480,29 @@ static inline obj_res mpz_to_nat(mpz const & m) {
         return mpz_to_nat_core(m);
 }
 
+#ifdef __SIZEOF_INT128__
+/* Fast paths for natural numbers smaller than 2^128. They avoid temporary `mpz` values, and the result
+   is created directly in an inline `mpz_object` (see `alloc_mpz`). */
+typedef unsigned __int128 uint128;
+
+static inline bool nat_to_uint128(b_obj_arg a, uint128 & r) {
+    if (lean_is_scalar(a)) {
+        r = lean_unbox(a);
+        return true;
+    } else {
+        return mpz_value(a).get_uint128(r);
+    }
+}
+
+static obj_res uint128_to_nat(uint128 v) {
+    if (v <= LEAN_MAX_SMALL_NAT)
+        return lean_box(static_cast<size_t>(v));
+    lean_object * o = alloc_mpz_inline(mpz::uint128_digits_byte_size(v));
+    to_mpz(o)->m_value.init_uint128_at(v, mpz_inline_digits(o));
+    return o;
+}
+#endif
+
 extern "C" LEAN_EXPORT object * lean_cstr_to_nat(char const * n) {
     return mpz_to_nat(mpz(n));
 }
@@ -1288,7 +1511,11 @@ extern "C" LEAN_EXPORT object * lean_big_usize_to_nat(size_t n) {
     if (n <= LEAN_MAX_SMALL_NAT) {
         return lean_box(n);
     } else {
+#ifdef __SIZEOF_INT128__
+        return uint128_to_nat(n);
+#else
         return mpz_to_nat_core(mpz::of_size_t(n));
+#endif
     }
 }
 
@@ -1296,16 +1523,30 @@ extern "C" LEAN_EXPORT object * lean_big_uint64_to_nat(uint64_t n) {
     if (LEAN_LIKELY(n <= LEAN_MAX_SMALL_NAT)) {
         return lean_box(n);
     } else {
+#ifdef __SIZEOF_INT128__
+        return uint128_to_nat(n);
+#else
         return mpz_to_nat_core(mpz(n));
+#endif
     }
 }
 
 extern "C" LEAN_EXPORT object * lean_nat_big_succ(object * a) {
+#ifdef __SIZEOF_INT128__
+    uint128 v;
+    if (nat_to_uint128(a, v) && v + 1 != 0)
+        return uint128_to_nat(v + 1);
+#endif
     return mpz_to_nat_core(mpz_value(a) + 1);
 }
 
 extern "C" LEAN_EXPORT object * lean_nat_big_add(object * a1, object * a2) {
     lean_assert(!lean_is_scalar(a1) || !lean_is_scalar(a2));
+#ifdef __SIZEOF_INT128__
+    uint128 v1, v2, r;
+    if (nat_to_uint128(a1, v1) && nat_to_uint128(a2, v2) && !__builtin_add_overflow(v1, v2, &r))
+        return uint128_to_nat(r);
+#endif
     if (lean_is_scalar(a1))
         return mpz_to_nat_core(mpz::of_size_t(lean_unbox(a1)) + mpz_value(a2));
     else if (lean_is_scalar(a2))
@@ -1316,6 +1557,11 @@ extern "C" LEAN_EXPORT object * lean_nat_big_add(object * a1, object * a2) {
 
 extern "C" LEAN_EXPORT object * lean_nat_big_sub(object * a1, object * a2) {
     lean_assert(!lean_is_scalar(a1) || !lean_is_scalar(a2));
+#ifdef __SIZEOF_INT128__
+    uint128 v1, v2;
+    if (nat_to_uint128(a1, v1) && nat_to_uint128(a2, v2))
+        return v1 < v2 ? lean_box(0) : uint128_to_nat(v1 - v2);
+#endif
     if (lean_is_scalar(a1)) {
         lean_assert(mpz::of_size_t(lean_unbox(a1)) < mpz_value(a2));
         return lean_box(0);
@@ -1332,6 +1578,11 @@ extern "C" LEAN_EXPORT object * lean_nat_big_sub(object * a1, object * a2) {
 
 extern "C" LEAN_EXPORT object * lean_nat_big_mul(object * a1, object * a2) {
     lean_assert(!lean_is_scalar(a1) || !lean_is_scalar(a2));
+#ifdef __SIZEOF_INT128__
+    uint128 v1, v2, r;
+    if (nat_to_uint128(a1, v1) && nat_to_uint128(a2, v2) && !__builtin_mul_overflow(v1, v2, &r))
+        return uint128_to_nat(r);
+#endif
     if (lean_is_scalar(a1))
         return mpz_to_nat(mpz::of_size_t(lean_unbox(a1)) * mpz_value(a2));
     else if (lean_is_scalar(a2))
@@ -1341,11 +1592,20 @@ extern "C" LEAN_EXPORT object * lean_nat_big_mul(object * a1, object * a2) {
 }
 
 extern "C" LEAN_EXPORT object * lean_nat_overflow_mul(size_t a1, size_t a2) {
+#ifdef __SIZEOF_INT128__
+    return uint128_to_nat(static_cast<uint128>(a1) * a2);
+#else
     return mpz_to_nat(mpz::of_size_t(a1) * mpz::of_size_t(a2));
+#endif
 }
 
 extern "C" LEAN_EXPORT object * lean_nat_big_div(object * a1, object * a2) {
     lean_assert(!lean_is_scalar(a1) || !lean_is_scalar(a2));
+#ifdef __SIZEOF_INT128__
+    uint128 v1, v2;
+    if (nat_to_uint128(a1, v1) && nat_to_uint128(a2, v2))
+        return v2 == 0 ? lean_box(0) : uint128_to_nat(v1 / v2);
+#endif
     if (lean_is_scalar(a1)) {
         lean_assert(mpz_value(a2) != 0);
         lean_assert(mpz::of_size_t(lean_unbox(a1)) / mpz_value(a2) == 0);
@@ -1361,6 +1621,13 @@ extern "C" LEAN_EXPORT object * lean_nat_big_div(object * a1, object * a2) {
 
 extern "C" LEAN_EXPORT object * lean_nat_big_div_exact(object * a1, object * a2) {
     lean_assert(!lean_is_scalar(a1) || !lean_is_scalar(a2));
+#ifdef __SIZEOF_INT128__
+    uint128 v1, v2;
+    if (nat_to_uint128(a1, v1) && nat_to_uint128(a2, v2)) {
+        lean_assert(v2 != 0 && v1 % v2 == 0);
+        return uint128_to_nat(v1 / v2);
+    }
+#endif
     if (lean_is_scalar(a1)) {
         lean_assert(a1 == lean_box(0));
         lean_assert(mpz_value(a2) != 0);
@@ -1377,6 +1644,16 @@ extern "C" LEAN_EXPORT object * lean_nat_big_div_exact(object * a1, object * a2)
 
 extern "C" LEAN_EXPORT object * lean_nat_big_mod(object * a1, object * a2) {
     lean_assert(!lean_is_scalar(a1) || !lean_is_scalar(a2));
+#ifdef __SIZEOF_INT128__
+    uint128 v1, v2;
+    if (nat_to_uint128(a1, v1) && nat_to_uint128(a2, v2)) {
+        if (v2 == 0) {
+            lean_inc(a1);
+            return a1;
+        }
+        return uint128_to_nat(v1 % v2);
+    }
+#endif
     if (lean_is_scalar(a1)) {
         lean_assert(mpz_value(a2) != 0);
         return a1;
@@ -1432,6 +1709,11 @@ extern "C" LEAN_EXPORT bool lean_nat_big_lt(object * a1, object * a2) {
 
 extern "C" LEAN_EXPORT object * lean_nat_big_land(object * a1, object * a2) {
     lean_assert(!lean_is_scalar(a1) || !lean_is_scalar(a2));
+#ifdef __SIZEOF_INT128__
+    uint128 v1, v2;
+    if (nat_to_uint128(a1, v1) && nat_to_uint128(a2, v2))
+        return uint128_to_nat(v1 & v2);
+#endif
     if (lean_is_scalar(a1))
         return mpz_to_nat(mpz::of_size_t(lean_unbox(a1)) & mpz_value(a2));
     else if (lean_is_scalar(a2))
@@ -1442,6 +1724,11 @@ extern "C" LEAN_EXPORT object * lean_nat_big_land(object * a1, object * a2) {
 
 extern "C" LEAN_EXPORT object * lean_nat_big_lor(object * a1, object * a2) {
     lean_assert(!lean_is_scalar(a1) || !lean_is_scalar(a2));
+#ifdef __SIZEOF_INT128__
+    uint128 v1, v2;
+    if (nat_to_uint128(a1, v1) && nat_to_uint128(a2, v2))
+        return uint128_to_nat(v1 | v2);
+#endif
     if (lean_is_scalar(a1))
         return mpz_to_nat(mpz::of_size_t(lean_unbox(a1)) | mpz_value(a2));
     else if (lean_is_scalar(a2))
@@ -1452,6 +1739,11 @@ extern "C" LEAN_EXPORT object * lean_nat_big_lor(object * a1, object * a2) {
 
 extern "C" LEAN_EXPORT object * lean_nat_big_xor(object * a1, object * a2) {
     lean_assert(!lean_is_scalar(a1) || !lean_is_scalar(a2));
+#ifdef __SIZEOF_INT128__
+    uint128 v1, v2;
+    if (nat_to_uint128(a1, v1) && nat_to_uint128(a2, v2))
+        return uint128_to_nat(v1 ^ v2);
+#endif
     if (lean_is_scalar(a1))
         return mpz_to_nat(mpz::of_size_t(lean_unbox(a1)) ^ mpz_value(a2));
     else if (lean_is_scalar(a2))
@@ -1465,6 +1757,14 @@ extern "C" LEAN_EXPORT lean_obj_res lean_nat_shiftl(b_lean_obj_arg a1, b_lean_ob
     if (lean_is_scalar(a1) && lean_unbox(a1) == 0) {
         return lean_box(0);
     }
+#ifdef __SIZEOF_INT128__
+    uint128 v;
+    if (lean_is_scalar(a2) && lean_unbox(a2) < 128 && nat_to_uint128(a1, v)) {
+        size_t s = lean_unbox(a2);
+        if (s == 0 || (v >> (128 - s)) == 0)
+            return uint128_to_nat(v << s);
+    }
+#endif
     auto a = lean_is_scalar(a1)
            ? mpz::of_size_t(lean_unbox(a1))
            : mpz_value(a1);
@@ -1480,6 +1780,11 @@ extern "C" LEAN_EXPORT lean_obj_res lean_nat_big_shiftr(b_lean_obj_arg a1, b_lea
     if (!lean_is_scalar(a2)) {
         return lean_box(0); // This large of an exponent must be 0.
     }
+#ifdef __SIZEOF_INT128__
+    uint128 v;
+    if (nat_to_uint128(a1, v))
+        return lean_unbox(a2) >= 128 ? lean_box(0) : uint128_to_nat(v >> lean_unbox(a2));
+#endif
     auto a = lean_is_scalar(a1)
            ? mpz::of_size_t(lean_unbox(a1))
            : mpz_value(a1);
@@ -2360,6 +2665,12 @@ extern "C" LEAN_EXPORT uint64 lean_string_hash(b_obj_arg s) {
     return hash_str(sz, (unsigned char const *) str, 11);
 }
 
+extern "C" LEAN_EXPORT uint64 lean_string_hash_v2(b_obj_arg s, uint64 seed) {
+    usize sz = lean_string_size(s) - 1;
+    char const * str = lean_string_cstr(s);
+    return hash_str_v2(sz, (unsigned char const *) str, seed);
+}
+
 extern "C" LEAN_EXPORT obj_res lean_string_of_usize(size_t n) {
     return mk_ascii_string_unchecked(std::to_string(n));
 }
@@ -2396,6 +2707,12 @@ extern "C" LEAN_EXPORT uint64_t lean_slice_hash(b_obj_arg s) {
     return hash_str(sz, (unsigned char const *) str, 11);
 }
 
+extern "C" LEAN_EXPORT uint64_t lean_slice_hash_v2(b_obj_arg s, uint64_t seed) {
+    size_t sz = lean_slice_size(s);
+    char const * str = lean_slice_base(s);
+    return hash_str_v2(sz, (unsigned char const *) str, seed);
+}
+
 extern "C" LEAN_EXPORT uint8_t lean_slice_dec_lt(object * s1, object * s2) {
     size_t sz1 = lean_slice_size(s1);
     size_t sz2 = lean_slice_size(s2);
@@ -2512,6 +2829,10 @@ extern "C" LEAN_EXPORT uint64_t lean_byte_array_hash(b_obj_arg a) {
     return hash_str(lean_sarray_size(a), lean_sarray_cptr(a), 11);
 }
 
+extern "C" LEAN_EXPORT uint64_t lean_byte_array_hash_v2(b_obj_arg a, uint64_t seed) {
+    return hash_str_v2(lean_sarray_size(a), lean_sarray_cptr(a), seed);
+}
+
 extern "C" LEAN_EXPORT obj_res lean_copy_float_array(obj_arg a) {
     return lean_copy_sarray(a, lean_sarray_capacity(a));
 }
@@ -2551,6 +2872,214 @@ extern "C" LEAN_EXPORT obj_res lean_float_array_push(obj_arg a, double d) {
     return r;
 }
 
+// =======================================
+// Bulk operations on scalar arrays
+
+/* Convert a `Nat` bound to `size_t`, saturating at `max`. */
+static inline size_t nat_to_size_t_clamped(b_obj_arg n, size_t max) {
+    return lean_is_scalar(n) ? std::min(lean_unbox(n), max) : max;
+}
+
+extern "C" LEAN_EXPORT obj_res lean_byte_array_fill(obj_arg a, uint8 v, b_obj_arg o_start, b_obj_arg o_stop) {
+    size_t stop  = nat_to_size_t_clamped(o_stop, lean_sarray_size(a));
+    size_t start = nat_to_size_t_clamped(o_start, stop);
+    if (start == stop)
+        return a;
+    object * r = lean_sarray_ensure_exclusive(a);
+    memset(lean_sarray_cptr(r) + start, v, stop - start);
+    return r;
+}
+
+extern "C" LEAN_EXPORT obj_res lean_byte_array_idx_of(b_obj_arg a, uint8 v, b_obj_arg o_start) {
+    size_t sz    = lean_sarray_size(a);
+    size_t start = nat_to_size_t_clamped(o_start, sz);
+    uint8 * it   = lean_sarray_cptr(a);
+    void * r     = memchr(it + start, v, sz - start);
+    if (r == nullptr)
+        return mk_option_none();
+    return mk_option_some(lean_usize_to_nat(static_cast<uint8 *>(r) - it));
+}
+
+extern "C" LEAN_EXPORT uint8 lean_byte_array_compare(b_obj_arg a, b_obj_arg b) {
+    size_t sz1 = lean_sarray_size(a);
+    size_t sz2 = lean_sarray_size(b);
+    int c = memcmp(lean_sarray_cptr(a), lean_sarray_cptr(b), std::min(sz1, sz2));
+    if (c == 0)
+        c = sz1 < sz2 ? -1 : (sz1 > sz2 ? 1 : 0);
+    // `Ordering.lt`, `Ordering.eq` and `Ordering.gt`
+    return c < 0 ? 0 : (c == 0 ? 1 : 2);
+}
+
+struct byte_xor {
+    static uint8 scalar(uint8 a, uint8 b) { return a ^ b; }
+#if defined(LEAN_SIMD_SSE2)
+    static __m128i vector(__m128i a, __m128i b) { return _mm_xor_si128(a, b); }
+#elif defined(LEAN_SIMD_NEON)
+    static uint8x16_t vector(uint8x16_t a, uint8x16_t b) { return veorq_u8(a, b); }
+#endif
+};
+
+struct byte_and {
+    static uint8 scalar(uint8 a, uint8 b) { return a & b; }
+#if defined(LEAN_SIMD_SSE2)
+    static __m128i vector(__m128i a, __m128i b) { return _mm_and_si128(a, b); }
+#elif defined(LEAN_SIMD_NEON)
+    static uint8x16_t vector(uint8x16_t a, uint8x16_t b) { return vandq_u8(a, b); }
+#endif
+};
+
+struct byte_or {
+    static uint8 scalar(uint8 a, uint8 b) { return a | b; }
+#if defined(LEAN_SIMD_SSE2)
+    static __m128i vector(__m128i a, __m128i b) { return _mm_or_si128(a, b); }
+#elif defined(LEAN_SIMD_NEON)
+    static uint8x16_t vector(uint8x16_t a, uint8x16_t b) { return vorrq_u8(a, b); }
+#endif
+};
+
+/* Combine the common prefix of `a` and `b` byte by byte, reusing `a` if it is exclusive. */
+template<typename Op> static obj_res byte_array_bitwise(obj_arg a, b_obj_arg b) {
+    size_t n   = std::min(lean_sarray_size(a), lean_sarray_size(b));
+    object * r = lean_is_exclusive(a) ? a : lean_alloc_sarray(1, n, n);
+    uint8 * d       = lean_sarray_cptr(r);
+    uint8 const * x = lean_sarray_cptr(a);
+    uint8 const * y = lean_sarray_cptr(b);
+    size_t i = 0;
+#if defined(LEAN_SIMD_SSE2)
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = Op::vector(_mm_loadu_si128(reinterpret_cast<__m128i const *>(x + i)),
+                               _mm_loadu_si128(reinterpret_cast<__m128i const *>(y + i)));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(d + i), v);
+    }
+#elif defined(LEAN_SIMD_NEON)
+    for (; i + 16 <= n; i += 16)
+        vst1q_u8(d + i, Op::vector(vld1q_u8(x + i), vld1q_u8(y + i)));
+#endif
+    for (; i < n; i++)
+        d[i] = Op::scalar(x[i], y[i]);
+    lean_to_sarray(r)->m_size = n;
+    if (r != a)
+        lean_dec_ref(a);
+    return r;
+}
+
+extern "C" LEAN_EXPORT obj_res lean_byte_array_xor(obj_arg a, b_obj_arg b) {
+    return byte_array_bitwise<byte_xor>(a, b);
+}
+
+extern "C" LEAN_EXPORT obj_res lean_byte_array_and(obj_arg a, b_obj_arg b) {
+    return byte_array_bitwise<byte_and>(a, b);
+}
+
+extern "C" LEAN_EXPORT obj_res lean_byte_array_or(obj_arg a, b_obj_arg b) {
+    return byte_array_bitwise<byte_or>(a, b);
+}
+
+extern "C" LEAN_EXPORT obj_res lean_float_array_fill(obj_arg a, double v, b_obj_arg o_start, b_obj_arg o_stop) {
+    size_t stop  = nat_to_size_t_clamped(o_stop, lean_sarray_size(a));
+    size_t start = nat_to_size_t_clamped(o_start, stop);
+    if (start == stop)
+        return a;
+    object * r = lean_sarray_ensure_exclusive(a);
+    double * it = lean_float_array_cptr(r);
+    std::fill(it + start, it + stop, v);
+    return r;
+}
+
+/*
+Sum of `x[i] * y[i]` (or of `x[i]` if `y` is null). We use four interleaved partial sums, which keeps
+the SIMD units busy and makes the result the same with and without SIMD support.
+*/
+static double float_dot(double const * x, double const * y, size_t n) {
+    size_t i = 0;
+    double s[4] = {0.0, 0.0, 0.0, 0.0};
+#if defined(LEAN_SIMD_SSE2)
+    __m128d s01 = _mm_setzero_pd();
+    __m128d s23 = _mm_setzero_pd();
+    for (; i + 4 <= n; i += 4) {
+        __m128d x01 = _mm_loadu_pd(x + i);
+        __m128d x23 = _mm_loadu_pd(x + i + 2);
+        s01 = _mm_add_pd(s01, y ? _mm_mul_pd(x01, _mm_loadu_pd(y + i)) : x01);
+        s23 = _mm_add_pd(s23, y ? _mm_mul_pd(x23, _mm_loadu_pd(y + i + 2)) : x23);
+    }
+    _mm_storeu_pd(s, s01);
+    _mm_storeu_pd(s + 2, s23);
+#elif defined(LEAN_SIMD_NEON)
+    float64x2_t s01 = vdupq_n_f64(0.0);
+    float64x2_t s23 = vdupq_n_f64(0.0);
+    for (; i + 4 <= n; i += 4) {
+        float64x2_t x01 = vld1q_f64(x + i);
+        float64x2_t x23 = vld1q_f64(x + i + 2);
+        // no fused multiply-add, so that the result does not depend on the architecture
+        s01 = vaddq_f64(s01, y ? vmulq_f64(x01, vld1q_f64(y + i)) : x01);
+        s23 = vaddq_f64(s23, y ? vmulq_f64(x23, vld1q_f64(y + i + 2)) : x23);
+    }
+    vst1q_f64(s, s01);
+    vst1q_f64(s + 2, s23);
+#else
+    for (; i + 4 <= n; i += 4) {
+        for (unsigned j = 0; j < 4; j++)
+            s[j] += y ? x[i + j] * y[i + j] : x[i + j];
+    }
+#endif
+    double r = (s[0] + s[2]) + (s[1] + s[3]);
+    for (; i < n; i++)
+        r += y ? x[i] * y[i] : x[i];
+    return r;
+}
+
+extern "C" LEAN_EXPORT double lean_float_array_sum(b_obj_arg a) {
+    return float_dot(lean_float_array_cptr(a), nullptr, lean_sarray_size(a));
+}
+
+extern "C" LEAN_EXPORT double lean_float_array_dot(b_obj_arg a, b_obj_arg b) {
+    size_t n = std::min(lean_sarray_size(a), lean_sarray_size(b));
+    return float_dot(lean_float_array_cptr(a), lean_float_array_cptr(b), n);
+}
+
+extern "C" LEAN_EXPORT obj_res lean_float_array_axpy(double alpha, b_obj_arg x, obj_arg y) {
+    size_t n = std::min(lean_sarray_size(x), lean_sarray_size(y));
+    if (n == 0)
+        return y;
+    object * r = lean_sarray_ensure_exclusive(y);
+    double const * s = lean_float_array_cptr(x);
+    double * d = lean_float_array_cptr(r);
+    size_t i = 0;
+#if defined(LEAN_SIMD_SSE2)
+    __m128d va = _mm_set1_pd(alpha);
+    for (; i + 2 <= n; i += 2)
+        _mm_storeu_pd(d + i, _mm_add_pd(_mm_mul_pd(va, _mm_loadu_pd(s + i)), _mm_loadu_pd(d + i)));
+#elif defined(LEAN_SIMD_NEON)
+    float64x2_t va = vdupq_n_f64(alpha);
+    for (; i + 2 <= n; i += 2)
+        vst1q_f64(d + i, vaddq_f64(vmulq_f64(va, vld1q_f64(s + i)), vld1q_f64(d + i)));
+#endif
+    for (; i < n; i++)
+        d[i] = alpha * s[i] + d[i];
+    return r;
+}
+
+extern "C" LEAN_EXPORT obj_res lean_float_array_scale(obj_arg a, double c) {
+    size_t n = lean_sarray_size(a);
+    if (n == 0)
+        return a;
+    object * r = lean_sarray_ensure_exclusive(a);
+    double * d = lean_float_array_cptr(r);
+    size_t i = 0;
+#if defined(LEAN_SIMD_SSE2)
+    __m128d vc = _mm_set1_pd(c);
+    for (; i + 2 <= n; i += 2)
+        _mm_storeu_pd(d + i, _mm_mul_pd(_mm_loadu_pd(d + i), vc));
+#elif defined(LEAN_SIMD_NEON)
+    float64x2_t vc = vdupq_n_f64(c);
+    for (; i + 2 <= n; i += 2)
+        vst1q_f64(d + i, vmulq_f64(vld1q_f64(d + i), vc));
+#endif
+    for (; i < n; i++)
+        d[i] = d[i] * c;
+    return r;
+}
+
 // =======================================
 // Array functions for generated code
 
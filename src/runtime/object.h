@@ -278,6 +278,14 @@ public:
     ~scoped_task_manager();
 };
 
+/* Number of worker threads of the task manager, e.g. as set by `lean -j`, or 0 if tasks are run synchronously. */
+LEAN_EXPORT unsigned get_num_task_workers();
+
+/* Task life cycle events reported to `g_lean_report_task_event` if it is set. `started` and `stopped` bracket each
+   execution of the task's closure on the current thread (a `bind` task may be executed twice), `resolved` is reported
+   when the task's value becomes available, and `wait_started` and `wait_stopped` bracket a blocking `Task.get`. */
+enum class task_event { spawned, started, resolved, stopped, wait_started, wait_stopped };
+
 inline obj_res task_spawn(obj_arg c, unsigned prio = 0, bool keep_alive = false) { return lean_task_spawn_core(c, prio, keep_alive); }
 inline obj_res task_pure(obj_arg a) { return lean_task_pure(a); }
 inline obj_res task_bind(obj_arg x, obj_arg f, unsigned prio = 0, bool sync = false, bool keep_alive = false) { return lean_task_bind_core(x, f, prio, sync, keep_alive); }
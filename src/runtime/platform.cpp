@@ -4,10 +4,21 @@ Released under Apache 2.0 license as described in the file LICENSE.
 
 Author: Leonardo de Moura
 */
+#include <cstring>
+#include <cstdio>
 #include "util/macros.h"
 #include "runtime/object.h"
+#include "runtime/platform.h"
 #include "githash.h"
 
+#if !defined(LEAN_WINDOWS) && !defined(LEAN_EMSCRIPTEN)
+#include <dlfcn.h>
+#include <sys/stat.h>
+#if defined(__linux__)
+#include <link.h>
+#endif
+#endif
+
 namespace lean {
 extern "C" LEAN_EXPORT obj_res lean_system_platform_nbits(obj_arg) {
     if (sizeof(void*) == 8) {
@@ -82,4 +93,85 @@ extern "C" LEAN_EXPORT uint8 lean_internal_is_debug(obj_arg) {
 extern "C" LEAN_EXPORT obj_res lean_internal_get_build_type(obj_arg) {
     return mk_string(LEAN_STR(LEAN_BUILD_TYPE));
 }
+
+#if !defined(LEAN_WINDOWS) && !defined(LEAN_EMSCRIPTEN)
+#if defined(__linux__)
+struct build_id_query {
+    void *                m_addr;
+    bool                  m_is_main = false;
+    unsigned char const * m_build_id = nullptr;
+    size_t                m_build_id_size = 0;
+};
+
+static int find_build_id(dl_phdr_info * info, size_t, void * data) {
+    build_id_query & q = *static_cast<build_id_query *>(data);
+    bool contains_addr = false;
+    for (unsigned i = 0; i < info->dlpi_phnum; i++) {
+        ElfW(Phdr) const & ph = info->dlpi_phdr[i];
+        size_t begin = info->dlpi_addr + ph.p_vaddr;
+        size_t addr  = reinterpret_cast<size_t>(q.m_addr);
+        if (ph.p_type == PT_LOAD && begin <= addr && addr < begin + ph.p_memsz)
+            contains_addr = true;
+    }
+    if (!contains_addr)
+        return 0;
+    // the first object is the main program, whose name is empty
+    q.m_is_main = info->dlpi_name[0] == '\0';
+    for (unsigned i = 0; i < info->dlpi_phnum; i++) {
+        ElfW(Phdr) const & ph = info->dlpi_phdr[i];
+        if (ph.p_type != PT_NOTE)
+            continue;
+        char const * it  = reinterpret_cast<char const *>(info->dlpi_addr + ph.p_vaddr);
+        char const * end = it + ph.p_memsz;
+        while (it + sizeof(ElfW(Nhdr)) <= end) {
+            ElfW(Nhdr) const * note = reinterpret_cast<ElfW(Nhdr) const *>(it);
+            char const * name = it + sizeof(ElfW(Nhdr));
+            char const * desc = name + ((note->n_namesz + 3) & ~3u);
+            if (note->n_type == NT_GNU_BUILD_ID && note->n_namesz == 4 && memcmp(name, "GNU", 4) == 0) {
+                q.m_build_id      = reinterpret_cast<unsigned char const *>(desc);
+                q.m_build_id_size = note->n_descsz;
+                return 1;
+            }
+            it = desc + ((note->n_descsz + 3) & ~3u);
+        }
+    }
+    return 1;
+}
+#endif
+
+bool get_binary_id(char (&r)[64]) {
+    memset(r, 0, sizeof(r));
+    void * code = reinterpret_cast<void *>(&lean_get_githash);
+    Dl_info info;
+    if (!dladdr(code, &info) || !info.dli_fname)
+        return false;
+    char const * fname = info.dli_fname;
+#if defined(__linux__)
+    build_id_query q;
+    q.m_addr = code;
+    dl_iterate_phdr(find_build_id, &q);
+    if (q.m_build_id_size > 0) {
+        memcpy(r, "build-id:", 9);
+        for (size_t i = 0; i < q.m_build_id_size && 9 + 2 * i + 2 < sizeof(r); i++)
+            snprintf(r + 9 + 2 * i, 3, "%02x", q.m_build_id[i]);
+        return true;
+    }
+    // `dli_fname` of the main program is its `argv[0]`, which may be relative to a directory in `PATH`
+    if (q.m_is_main)
+        fname = "/proc/self/exe";
+#endif
+    struct stat st;
+    if (stat(fname, &st) != 0)
+        return false;
+    snprintf(r, sizeof(r), "file:%llx:%llx:%llx", static_cast<unsigned long long>(st.st_size),
+             static_cast<unsigned long long>(st.st_mtime), static_cast<unsigned long long>(st.st_ino));
+    return true;
+}
+
+#else
+bool get_binary_id(char (&r)[64]) {
+    memset(r, 0, sizeof(r));
+    return false;
+}
+#endif
 }
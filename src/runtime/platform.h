@@ -5,8 +5,13 @@ Released under Apache 2.0 license as described in the file LICENSE.
 Author: Leonardo de Moura
 */
 #pragma once
+#include "runtime/object.h"
 
 namespace lean {
 void initialize_platform();
 void finalize_platform();
+/* Identify the binary containing the Lean runtime in `r`, padded with `\0` to the right. The githash does not tell apart
+   builds of modified sources or builds with different options, so we use the build-id of the binary if it has one,
+   and otherwise the size, modification time and inode of its file. Returns false if the binary cannot be identified. */
+LEAN_EXPORT bool get_binary_id(char (&r)[64]);
 }
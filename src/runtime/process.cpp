@@ -9,6 +9,7 @@ Author: Jared Roesch
 #include <iostream>
 #include <iomanip>
 #include <utility>
+#include <vector>
 #include <system_error>
 
 #if defined(LEAN_WINDOWS)
@@ -29,6 +30,7 @@ Author: Jared Roesch
 
 #ifdef __linux
 #include <sys/syscall.h>
+#include <spawn.h>
 #endif
 
 #include "runtime/object.h"
@@ -430,10 +432,104 @@ static optional<pipe> setup_stdio(stdio cfg) {
     lean_unreachable();
 }
 
-#ifdef __APPLE__
+#if defined(__APPLE__) || defined(__linux)
 extern "C" char **environ;
 #endif
 
+#ifdef __linux
+/* Try to spawn the process using `posix_spawnp`, which glibc and musl implement using `clone(CLONE_VM | CLONE_VFORK)`.
+   Unlike `fork`, this does not copy the page tables of the parent process, which can take a long time when the parent
+   has a large heap. Return `false` if the configuration cannot be expressed using `posix_spawnp` or if spawning failed,
+   in which case the caller falls back to `fork` so that all error reporting stays the same. */
+static bool try_posix_spawn(pid_t & pid, string_ref const & proc_name, array_ref<string_ref> const & args,
+  optional<pipe> const & stdin_pipe, optional<pipe> const & stdout_pipe, optional<pipe> const & stderr_pipe,
+  stdio stdin_mode, stdio stdout_mode, stdio stderr_mode, option_ref<string_ref> const & cwd,
+  array_ref<pair_ref<string_ref, option_ref<string_ref>>> const & env, bool inherit_env, bool do_setsid) {
+    // `posix_spawnp` resolves the program using the `PATH` of the parent, while `execvp` in the child would use the
+    // modified environment.
+    if (!inherit_env) return false;
+    for (auto & entry : env) {
+        if (strcmp(entry.fst().data(), "PATH") == 0) return false;
+    }
+#if !(defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 29))
+    if (cwd) return false;
+#endif
+#ifndef POSIX_SPAWN_SETSID
+    if (do_setsid) return false;
+#endif
+
+    std::vector<std::string> env_entries;
+    for (char ** e = environ; e && *e; e++) {
+        env_entries.push_back(*e);
+    }
+    for (auto & entry : env) {
+        std::string prefix = std::string(entry.fst().data()) + "=";
+        auto it = env_entries.begin();
+        while (it != env_entries.end()) {
+            if (it->compare(0, prefix.size(), prefix) == 0) {
+                it = env_entries.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        if (entry.snd()) {
+            env_entries.push_back(prefix + entry.snd().get()->data());
+        }
+    }
+    buffer<char *> penv;
+    for (auto & e : env_entries)
+        penv.push_back(const_cast<char *>(e.c_str()));
+    penv.push_back(NULL);
+
+    buffer<char *> pargs;
+    pargs.push_back(const_cast<char *>(proc_name.data()));
+    for (auto & arg : args)
+        pargs.push_back(const_cast<char *>(arg.data()));
+    pargs.push_back(NULL);
+
+    posix_spawn_file_actions_t actions;
+    posix_spawnattr_t attr;
+    if (posix_spawn_file_actions_init(&actions) != 0) return false;
+    if (posix_spawnattr_init(&attr) != 0) {
+        posix_spawn_file_actions_destroy(&actions);
+        return false;
+    }
+    // The other ends of the pipes are closed on `exec` as they are created with `O_CLOEXEC`.
+    int err = 0;
+    if (stdin_pipe) {
+        err |= posix_spawn_file_actions_adddup2(&actions, stdin_pipe->m_read_fd, STDIN_FILENO);
+    } else if (stdin_mode == stdio::NUL) {
+        err |= posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+    }
+    if (stdout_pipe) {
+        err |= posix_spawn_file_actions_adddup2(&actions, stdout_pipe->m_write_fd, STDOUT_FILENO);
+    } else if (stdout_mode == stdio::NUL) {
+        err |= posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+    }
+    if (stderr_pipe) {
+        err |= posix_spawn_file_actions_adddup2(&actions, stderr_pipe->m_write_fd, STDERR_FILENO);
+    } else if (stderr_mode == stdio::NUL) {
+        err |= posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+    }
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 29)
+    if (cwd) {
+        err |= posix_spawn_file_actions_addchdir_np(&actions, cwd.get()->data());
+    }
+#endif
+#ifdef POSIX_SPAWN_SETSID
+    if (do_setsid) {
+        err |= posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSID);
+    }
+#endif
+    if (err == 0) {
+        err = posix_spawnp(&pid, pargs[0], &actions, &attr, pargs.data(), penv.data());
+    }
+    posix_spawnattr_destroy(&attr);
+    posix_spawn_file_actions_destroy(&actions);
+    return err == 0;
+}
+#endif
+
 static obj_res spawn(string_ref const & proc_name, array_ref<string_ref> const & args, stdio stdin_mode, stdio stdout_mode,
   stdio stderr_mode, option_ref<string_ref> const & cwd, array_ref<pair_ref<string_ref, option_ref<string_ref>>> const & env,
   bool inherit_env, bool do_setsid) {
@@ -442,7 +538,15 @@ static obj_res spawn(string_ref const & proc_name, array_ref<string_ref> const &
     auto stdout_pipe = setup_stdio(stdout_mode);
     auto stderr_pipe = setup_stdio(stderr_mode);
 
-    int pid = fork();
+    pid_t pid;
+#ifdef __linux
+    if (!try_posix_spawn(pid, proc_name, args, stdin_pipe, stdout_pipe, stderr_pipe, stdin_mode, stdout_mode,
+                         stderr_mode, cwd, env, inherit_env, do_setsid)) {
+        pid = fork();
+    }
+#else
+    pid = fork();
+#endif
 
     if (pid == 0) {
         if (!inherit_env) {
@@ -5,6 +5,8 @@ Released under Apache 2.0 license as described in the file LICENSE.
 Author: Leonardo de Moura
 */
 #include <cstring>
+#include <algorithm>
+#include <limits>
 #include "runtime/sharecommon.h"
 #include "runtime/hash.h"
 
@@ -13,16 +15,17 @@ namespace lean {
 extern "C" LEAN_EXPORT uint8 lean_sharecommon_eq(b_obj_arg o1, b_obj_arg o2) {
     lean_assert(!lean_is_scalar(o1));
     lean_assert(!lean_is_scalar(o2));
-    size_t sz1 = lean_object_data_byte_size(o1);
-    size_t sz2 = lean_object_data_byte_size(o2);
-    if (sz1 != sz2) return false;
     // compare relevant parts of the header
     uint8_t tag = lean_ptr_tag(o1);
     if (tag != lean_ptr_tag(o2)) return false;
-    if (lean_ptr_other(o1) != lean_ptr_other(o2)) return false;
     if (tag == LeanMPZ) {
+        // the object size depends on whether the digits are stored inline
         return mpz_value(o1) == mpz_value(o2);
     } else {
+        size_t sz1 = lean_object_data_byte_size(o1);
+        size_t sz2 = lean_object_data_byte_size(o2);
+        if (sz1 != sz2) return false;
+        if (lean_ptr_other(o1) != lean_ptr_other(o2)) return false;
         size_t header_sz = sizeof(lean_object);
         lean_assert(sz1 >= header_sz);
         // compare objects' bodies
@@ -453,4 +456,524 @@ lean_object * sharecommon_persistent_fn::operator()(lean_object * e) {
     m_saved.push_back(object_ref(r, true));
     return r;
 }
+
+static inline size_t next_pow2(size_t n) {
+    size_t r = 16;
+    while (r < n) r *= 2;
+    return r;
+}
+
+static inline size_t ptr_hash(lean_object * o) {
+    uint64_t x = reinterpret_cast<uintptr_t>(o) >> 3;
+    x *= 0x9e3779b97f4a7c15ull;
+    return static_cast<size_t>(x ^ (x >> 32));
+}
+
+/* We only maximally share arrays, scalar arrays, strings, big numbers, and constructor objects. */
+static inline bool is_shareable(lean_object * a) {
+    if (lean_is_scalar(a)) return false;
+    switch (lean_ptr_tag(a)) {
+    case LeanClosure: case LeanThunk:
+    case LeanTask:    case LeanPromise:
+    case LeanRef:     case LeanExternal:
+    case LeanReserved:
+        return false;
+    default:
+        return true;
+    }
+}
+
+sharecommon_native_fn::sharecommon_native_fn(size_t capacity):
+    m_set(next_pow2(2*capacity), set_entry{nullptr, 0}),
+    m_cache(next_pow2(capacity), cache_entry{nullptr, nullptr}) {
+}
+
+sharecommon_native_fn::sharecommon_native_fn(sharecommon_native_fn const & other):
+    m_set(other.m_set), m_set_size(other.m_set_size),
+    m_cache(other.m_cache.size(), cache_entry{nullptr, nullptr}) {
+    for (set_entry const & e : m_set) {
+        if (e.m_obj != nullptr) lean_inc(e.m_obj);
+    }
+}
+
+sharecommon_native_fn::~sharecommon_native_fn() {
+    for (set_entry const & e : m_set) {
+        if (e.m_obj != nullptr) lean_dec(e.m_obj);
+    }
+}
+
+void sharecommon_native_fn::for_each(b_obj_arg fn) const {
+    for (set_entry const & e : m_set) {
+        if (e.m_obj != nullptr) {
+            lean_inc(fn);
+            lean_inc(e.m_obj);
+            lean_dec(lean_apply_1(fn, e.m_obj));
+        }
+    }
+}
+
+lean_object * sharecommon_native_fn::set_find(lean_object * a, uint64_t h) const {
+    size_t mask = m_set.size() - 1;
+    for (size_t i = static_cast<size_t>(h) & mask;; i = (i + 1) & mask) {
+        set_entry const & e = m_set[i];
+        if (e.m_obj == nullptr)
+            return nullptr;
+        if (e.m_hash == h && (e.m_obj == a || lean_sharecommon_eq(e.m_obj, a)))
+            return e.m_obj;
+    }
+}
+
+/* `a` must not be in the set yet. The set takes ownership of one reference to `a`. */
+void sharecommon_native_fn::set_insert(lean_object * a, uint64_t h) {
+    if (2 * (m_set_size + 1) > m_set.size()) {
+        std::vector<set_entry> old(2 * m_set.size(), set_entry{nullptr, 0});
+        old.swap(m_set);
+        size_t mask = m_set.size() - 1;
+        for (set_entry const & e : old) {
+            if (e.m_obj == nullptr) continue;
+            size_t i = static_cast<size_t>(e.m_hash) & mask;
+            while (m_set[i].m_obj != nullptr) i = (i + 1) & mask;
+            m_set[i] = e;
+        }
+    }
+    size_t mask = m_set.size() - 1;
+    size_t i = static_cast<size_t>(h) & mask;
+    while (m_set[i].m_obj != nullptr) i = (i + 1) & mask;
+    m_set[i] = set_entry{a, h};
+    m_set_size++;
+}
+
+lean_object * sharecommon_native_fn::cache_find(lean_object * a) const {
+    size_t mask = m_cache.size() - 1;
+    for (size_t i = ptr_hash(a) & mask;; i = (i + 1) & mask) {
+        cache_entry const & e = m_cache[i];
+        if (e.m_key == a) return e.m_value;
+        if (e.m_key == nullptr) return nullptr;
+    }
+}
+
+/*
+We do not increment reference counters when inserting into `m_cache`: its domain only contains
+sub-objects of the argument of `operator()`, and its range only contains objects in `m_set`.
+*/
+void sharecommon_native_fn::cache_insert(lean_object * a, lean_object * r) {
+    if (2 * (m_cache_size + 1) > m_cache.size()) {
+        std::vector<cache_entry> old(2 * m_cache.size(), cache_entry{nullptr, nullptr});
+        old.swap(m_cache);
+        size_t mask = m_cache.size() - 1;
+        for (cache_entry const & e : old) {
+            if (e.m_key == nullptr) continue;
+            size_t i = ptr_hash(e.m_key) & mask;
+            while (m_cache[i].m_key != nullptr) i = (i + 1) & mask;
+            m_cache[i] = e;
+        }
+    }
+    size_t mask = m_cache.size() - 1;
+    size_t i = ptr_hash(a) & mask;
+    while (m_cache[i].m_key != nullptr) i = (i + 1) & mask;
+    m_cache[i] = cache_entry{a, r};
+    m_cache_size++;
+}
+
+void sharecommon_native_fn::cache_clear() {
+    if (m_cache_size > 0) {
+        std::fill(m_cache.begin(), m_cache.end(), cache_entry{nullptr, nullptr});
+        m_cache_size = 0;
+    }
+}
+
+/* Return the maximally shared version of `a` if it is already known, and `nullptr` otherwise. */
+lean_object * sharecommon_native_fn::resolve(lean_object * a) const {
+    if (!is_shareable(a)) return a;
+    return cache_find(a);
+}
+
+/* Push the children of `a` that have not been visited yet, and return `true` if there are none. */
+bool sharecommon_native_fn::push_children(lean_object * a) {
+    bool ready = true;
+    auto push = [&](lean_object * c) {
+        if (resolve(c) == nullptr) {
+            m_todo.push_back(todo_entry{c, 0, false});
+            ready = false;
+        }
+    };
+    if (lean_is_array(a)) {
+        size_t sz = lean_array_size(a);
+        for (size_t i = 0; i < sz; i++) push(lean_array_get_core(a, i));
+    } else if (lean_is_ctor(a)) {
+        unsigned num_objs = lean_ctor_num_objs(a);
+        for (unsigned i = 0; i < num_objs; i++) push(lean_ctor_get(a, i));
+    }
+    return ready;
+}
+
+/*
+All children of `a` have been visited, and `h` is the hash of `a`.
+If the children are already maximally shared, `a` itself is a candidate for the set,
+otherwise we create a copy of `a` using the maximally shared children.
+*/
+lean_object * sharecommon_native_fn::intern(lean_object * a, uint64_t h) {
+    lean_object * new_a = nullptr;
+    if (lean_is_array(a)) {
+        size_t sz = lean_array_size(a);
+        bool same = lean_array_capacity(a) == sz;
+        for (size_t i = 0; same && i < sz; i++) {
+            lean_object * c = lean_array_get_core(a, i);
+            same = resolve(c) == c;
+        }
+        if (!same) {
+            new_a = lean_alloc_array(sz, sz);
+            for (size_t i = 0; i < sz; i++) {
+                lean_object * c = resolve(lean_array_get_core(a, i));
+                lean_inc(c);
+                lean_array_set_core(new_a, i, c);
+            }
+        }
+    } else if (lean_is_ctor(a)) {
+        unsigned num_objs = lean_ctor_num_objs(a);
+        bool same = true;
+        for (unsigned i = 0; same && i < num_objs; i++) {
+            lean_object * c = lean_ctor_get(a, i);
+            same = resolve(c) == c;
+        }
+        if (!same) {
+            unsigned sz            = lean_object_byte_size(a);
+            unsigned scalar_offset = sizeof(lean_object) + num_objs*sizeof(void*);
+            unsigned scalar_sz     = sz - scalar_offset;
+            new_a = lean_alloc_ctor(lean_ptr_tag(a), num_objs, scalar_sz);
+            for (unsigned i = 0; i < num_objs; i++) {
+                lean_object * c = resolve(lean_ctor_get(a, i));
+                lean_inc(c);
+                lean_ctor_set(new_a, i, c);
+            }
+            if (scalar_sz > 0) {
+                memcpy(reinterpret_cast<char*>(new_a) + scalar_offset, reinterpret_cast<char*>(a) + scalar_offset, scalar_sz);
+            }
+        }
+    }
+    if (new_a == nullptr) {
+        if (lean_object * r = set_find(a, h))
+            return r;
+        lean_inc_ref(a);
+        set_insert(a, h);
+        return a;
+    } else {
+        uint64_t new_h = lean_sharecommon_hash(new_a);
+        if (lean_object * r = set_find(new_a, new_h)) {
+            lean_dec_ref(new_a);
+            return r;
+        }
+        set_insert(new_a, new_h);
+        return new_a;
+    }
+}
+
+/*
+Returns a borrowed reference to the maximally shared version of `a`.
+We use an explicit stack to avoid stack overflows on deep objects.
+*/
+lean_object * sharecommon_native_fn::visit(lean_object * a) {
+    if (lean_object * r = resolve(a))
+        return r;
+    lean_assert(m_todo.empty());
+    m_todo.push_back(todo_entry{a, 0, false});
+    while (!m_todo.empty()) {
+        todo_entry e = m_todo.back();
+        if (e.m_expanded) {
+            m_todo.pop_back();
+            cache_insert(e.m_obj, intern(e.m_obj, e.m_hash));
+            continue;
+        }
+        if (cache_find(e.m_obj) != nullptr) {
+            m_todo.pop_back();
+            continue;
+        }
+        /*
+        If `e.m_obj` is structurally equal to an element of the set, then we are done. This is the
+        case for inputs that have been maximally shared by previous calls, since the children of
+        an element of the set are in the set as well.
+        */
+        uint64_t h = lean_sharecommon_hash(e.m_obj);
+        if (lean_object * r = set_find(e.m_obj, h)) {
+            m_todo.pop_back();
+            cache_insert(e.m_obj, r);
+            continue;
+        }
+        m_todo.back().m_hash     = h;
+        m_todo.back().m_expanded = true;
+        push_children(e.m_obj);
+    }
+    return cache_find(a);
+}
+
+lean_object * sharecommon_native_fn::operator()(b_obj_arg a) {
+    lean_object * r = visit(a);
+    lean_inc(r);
+    cache_clear();
+    return r;
+}
+
+/* Inputs with fewer shareable nodes are processed by `sharecommon_quick_fn`. */
+static constexpr size_t LEAN_SHARECOMMON_PAR_MIN_NODES = 4096;
+/* Levels with fewer nodes are processed by the calling thread. */
+static constexpr size_t LEAN_SHARECOMMON_PAR_MIN_LEVEL = 1024;
+/* Number of nodes claimed at once by a worker. */
+static constexpr size_t LEAN_SHARECOMMON_PAR_CHUNK     = 256;
+
+sharecommon_par_fn::sharecommon_par_fn(unsigned num_threads):
+    m_num_threads(num_threads == 0 ? hardware_concurrency() : num_threads) {
+}
+
+/*
+Store the shareable nodes of `a` at `m_nodes` in post-order, and the positions of the nodes of
+each height at `levels`.
+*/
+void sharecommon_par_fn::collect(lean_object * a, std::vector<std::vector<size_t>> & levels) {
+    std::vector<unsigned> heights;
+    std::vector<std::pair<lean_object *, bool>> todo;
+    todo.emplace_back(a, false);
+    while (!todo.empty()) {
+        lean_object * o = todo.back().first;
+        bool expanded   = todo.back().second;
+        todo.pop_back();
+        if (m_index.find(o) != m_index.end())
+            continue;
+        unsigned h = 0;
+        auto child = [&](lean_object * c) {
+            if (!is_shareable(c)) return;
+            if (expanded)
+                h = std::max(h, heights[m_index.find(c)->second] + 1);
+            else if (m_index.find(c) == m_index.end())
+                todo.emplace_back(c, false);
+        };
+        if (!expanded)
+            todo.emplace_back(o, true);
+        if (lean_is_array(o)) {
+            size_t sz = lean_array_size(o);
+            for (size_t i = 0; i < sz; i++) child(lean_array_get_core(o, i));
+        } else if (lean_is_ctor(o)) {
+            unsigned num_objs = lean_ctor_num_objs(o);
+            for (unsigned i = 0; i < num_objs; i++) child(lean_ctor_get(o, i));
+        }
+        if (expanded) {
+            m_index.insert(std::make_pair(o, m_nodes.size()));
+            if (h >= levels.size()) levels.resize(h + 1);
+            levels[h].push_back(m_nodes.size());
+            m_nodes.push_back(o);
+            heights.push_back(h);
+        }
+    }
+}
+
+lean_object * sharecommon_par_fn::resolve(lean_object * a) const {
+    if (!is_shareable(a)) return a;
+    return m_result[m_index.find(a)->second];
+}
+
+bool sharecommon_par_fn::children_changed(lean_object * a) const {
+    if (lean_is_array(a)) {
+        size_t sz = lean_array_size(a);
+        for (size_t j = 0; j < sz; j++)
+            if (resolve(lean_array_get_core(a, j)) != lean_array_get_core(a, j)) return true;
+    } else if (lean_is_ctor(a)) {
+        unsigned num_objs = lean_ctor_num_objs(a);
+        for (unsigned j = 0; j < num_objs; j++)
+            if (resolve(lean_ctor_get(a, j)) != lean_ctor_get(a, j)) return true;
+    }
+    return false;
+}
+
+/*
+Compute `m_result[i]`. The children of `m_nodes[i]` have already been processed.
+We do not increment the reference counters of the children here since they may be
+shared with objects being created by other workers.
+Unlike `sharecommon_quick_fn`, which copies every array and constructor, we keep `m_nodes[i]`
+itself if none of its children changed, so that input that is already maximally shared is
+not copied.
+*/
+void sharecommon_par_fn::process(size_t i) {
+    lean_object * a = m_nodes[i];
+    lean_object * new_a;
+    bool is_new = true;
+    if (!children_changed(a)) {
+        // `a` itself is a candidate, which includes `sarray`, `string` and `mpz` objects as they are never copied
+        new_a  = a;
+        is_new = false;
+    } else if (lean_is_array(a)) {
+        size_t sz = lean_array_size(a);
+        new_a = lean_alloc_array(sz, sz);
+        for (size_t j = 0; j < sz; j++)
+            lean_array_set_core(new_a, j, resolve(lean_array_get_core(a, j)));
+    } else {
+        lean_assert(lean_is_ctor(a));
+        unsigned num_objs      = lean_ctor_num_objs(a);
+        unsigned sz            = lean_object_byte_size(a);
+        unsigned scalar_offset = sizeof(lean_object) + num_objs*sizeof(void*);
+        unsigned scalar_sz     = sz - scalar_offset;
+        new_a = lean_alloc_ctor(lean_ptr_tag(a), num_objs, scalar_sz);
+        for (unsigned j = 0; j < num_objs; j++)
+            lean_ctor_set(new_a, j, resolve(lean_ctor_get(a, j)));
+        if (scalar_sz > 0) {
+            memcpy(reinterpret_cast<char*>(new_a) + scalar_offset, reinterpret_cast<char*>(a) + scalar_offset, scalar_sz);
+        }
+    }
+    entry e{new_a, lean_sharecommon_hash(new_a), is_new};
+    shard & s = m_shards[(e.m_hash >> 32) % NUM_SHARDS];
+    lean_object * r;
+    {
+        lock_guard<mutex> lock(s.m_mutex);
+        r = s.m_set.insert(e).first->m_obj;
+    }
+    if (r != new_a && is_new) {
+        // Its children were not retained, so we only release its memory.
+        lean_free_object(new_a);
+    }
+    m_result[i] = r;
+}
+
+lean_object * sharecommon_par_fn::worker(lean_object * self, lean_object *) {
+    sharecommon_par_fn * fn = reinterpret_cast<sharecommon_par_fn *>(lean_unbox_usize(self));
+    lean_dec(self);
+    size_t sz = fn->m_level.size();
+    while (true) {
+        size_t begin = fn->m_next.fetch_add(LEAN_SHARECOMMON_PAR_CHUNK);
+        if (begin >= sz) break;
+        size_t end = std::min(sz, begin + LEAN_SHARECOMMON_PAR_CHUNK);
+        for (size_t i = begin; i < end; i++)
+            fn->process(fn->m_level[i]);
+    }
+    return lean_box(0);
+}
+
+void sharecommon_par_fn::run_level() {
+    m_next = 0;
+    if (m_level.size() < LEAN_SHARECOMMON_PAR_MIN_LEVEL) {
+        for (size_t i : m_level) process(i);
+        return;
+    }
+    size_t num_tasks = std::min<size_t>(m_num_threads, m_level.size() / LEAN_SHARECOMMON_PAR_CHUNK) - 1;
+    std::vector<lean_object *> tasks;
+    for (size_t i = 0; i < num_tasks; i++) {
+        lean_object * c = lean_alloc_closure(reinterpret_cast<void *>(worker), 2, 1);
+        lean_closure_set(c, 0, lean_box_usize(reinterpret_cast<size_t>(this)));
+        tasks.push_back(lean_task_spawn_core(c, 0, false));
+    }
+    // The calling thread also works on the level, so we make progress even if the workers are busy.
+    lean_dec(worker(lean_box_usize(reinterpret_cast<size_t>(this)), lean_box(0)));
+    for (lean_object * t : tasks)
+        lean_dec(lean_task_get_own(t));
+}
+
+lean_object * sharecommon_par_fn::operator()(b_obj_arg a) {
+    if (!is_shareable(a)) {
+        lean_inc(a);
+        return a;
+    }
+    if (m_num_threads <= 1)
+        return sharecommon_quick_fn()(a);
+    std::vector<std::vector<size_t>> levels;
+    collect(a, levels);
+    if (m_nodes.size() < LEAN_SHARECOMMON_PAR_MIN_NODES) {
+        lean_object * r = sharecommon_quick_fn()(a);
+        m_nodes.clear();
+        m_index.clear();
+        return r;
+    }
+    m_result.resize(m_nodes.size());
+    m_shards.reset(new shard[NUM_SHARDS]);
+    for (std::vector<size_t> & level : levels) {
+        m_level.swap(level);
+        run_level();
+    }
+    /*
+    Fix the reference counters. A new object starts with RC 1, and gets one more for each
+    parent. Every new object but the result has at least one parent, so we remove the initial
+    reference from them.
+    */
+    lean_object * r = m_result[m_index.find(a)->second];
+    bool r_new = false;
+    for (unsigned i = 0; i < NUM_SHARDS; i++) {
+        for (entry const & e : m_shards[i].m_set) {
+            if (e.m_obj == r) r_new = e.m_new;
+            if (!e.m_new) continue;
+            lean_object * o = e.m_obj;
+            if (lean_is_array(o)) {
+                size_t sz = lean_array_size(o);
+                for (size_t j = 0; j < sz; j++) lean_inc(lean_array_get_core(o, j));
+            } else {
+                unsigned num_objs = lean_ctor_num_objs(o);
+                for (unsigned j = 0; j < num_objs; j++) lean_inc(lean_ctor_get(o, j));
+            }
+        }
+    }
+    for (unsigned i = 0; i < NUM_SHARDS; i++) {
+        for (entry const & e : m_shards[i].m_set) {
+            if (e.m_new && e.m_obj != r) {
+                lean_assert(e.m_obj->m_rc > 1);
+                e.m_obj->m_rc--;
+            }
+        }
+    }
+    if (!r_new) {
+        // `r` is the input itself or an equal object from the input
+        lean_inc(r);
+    }
+    m_nodes.clear();
+    m_index.clear();
+    m_result.clear();
+    m_shards.reset();
+    return r;
+}
+
+// def ShareCommon.shareCommonPar' (a : @& α) (numThreads : @& Nat) : α
+extern "C" LEAN_EXPORT obj_res lean_sharecommon_par(b_obj_arg a, b_obj_arg num_threads) {
+    size_t n = lean_is_scalar(num_threads) ? lean_unbox(num_threads) : std::numeric_limits<unsigned>::max();
+    n = std::min<size_t>(n, std::numeric_limits<unsigned>::max());
+    return sharecommon_par_fn(static_cast<unsigned>(n))(a);
+}
+
+static lean_external_class * g_sharecommon_native_external_class = nullptr;
+
+static void sharecommon_native_finalizer(void * s) {
+    delete static_cast<sharecommon_native_fn *>(s);
+}
+
+static void sharecommon_native_foreach(void * s, b_obj_arg fn) {
+    static_cast<sharecommon_native_fn *>(s)->for_each(fn);
+}
+
+static sharecommon_native_fn * sharecommon_native_get(b_obj_arg s) {
+    return static_cast<sharecommon_native_fn *>(lean_get_external_data(s));
+}
+
+// opaque NativeState.mk (capacity : USize := 1024) : NativeState
+extern "C" LEAN_EXPORT obj_res lean_sharecommon_native_mk(size_t capacity) {
+    return lean_alloc_external(g_sharecommon_native_external_class, new sharecommon_native_fn(capacity));
+}
+
+// opaque NativeState.size (s : @& NativeState) : Nat
+extern "C" LEAN_EXPORT obj_res lean_sharecommon_native_size(b_obj_arg s) {
+    return lean_usize_to_nat(sharecommon_native_get(s)->size());
+}
+
+// def NativeState.shareCommon {α} (s : NativeState) (a : α) : α × NativeState
+extern "C" LEAN_EXPORT obj_res lean_sharecommon_native(obj_arg s, obj_arg a) {
+    if (!lean_is_exclusive(s)) {
+        // The table is mutated in place, so we need a copy when the state is shared.
+        lean_object * new_s = lean_alloc_external(g_sharecommon_native_external_class,
+                                                  new sharecommon_native_fn(*sharecommon_native_get(s)));
+        lean_dec_ref(s);
+        s = new_s;
+    }
+    lean_object * r = (*sharecommon_native_get(s))(a);
+    lean_dec(a);
+    return mk_pair(r, s);
+}
+
+void initialize_sharecommon() {
+    g_sharecommon_native_external_class = lean_register_external_class(sharecommon_native_finalizer, sharecommon_native_foreach);
+}
+
+void finalize_sharecommon() {
+}
 };
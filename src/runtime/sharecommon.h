@@ -6,7 +6,9 @@ Author: Leonardo de Moura
 */
 #pragma once
 #include <vector>
+#include <memory>
 #include "runtime/object_ref.h"
+#include "runtime/thread.h"
 #include "util/alloc.h"
 
 namespace lean {
@@ -67,4 +69,108 @@ public:
     lean_object * operator()(lean_object * e);
 };
 
+/*
+Native hash-consing engine that does not call back into Lean code.
+The set of maximally shared objects is an open addressing table that owns a reference to each
+of its elements, and it is kept across calls. Thus, objects shared in previous calls are reused,
+and an input that is already maximally shared is recognized without being copied.
+The pointer cache is also an open addressing table, but it only lives for the duration of a call.
+*/
+class LEAN_EXPORT sharecommon_native_fn {
+    struct set_entry {
+        lean_object * m_obj;
+        uint64_t      m_hash;
+    };
+    struct cache_entry {
+        lean_object * m_key;
+        lean_object * m_value;
+    };
+    struct todo_entry {
+        lean_object * m_obj;
+        uint64_t      m_hash;
+        bool          m_expanded;
+    };
+    /* Capacities are powers of two, and `nullptr` marks an empty slot. */
+    std::vector<set_entry>   m_set;
+    size_t                   m_set_size = 0;
+    std::vector<cache_entry> m_cache;
+    size_t                   m_cache_size = 0;
+    std::vector<todo_entry>  m_todo;
+
+    lean_object * set_find(lean_object * a, uint64_t h) const;
+    void set_insert(lean_object * a, uint64_t h);
+    lean_object * cache_find(lean_object * a) const;
+    void cache_insert(lean_object * a, lean_object * r);
+    void cache_clear();
+    lean_object * resolve(lean_object * a) const;
+    bool push_children(lean_object * a);
+    lean_object * intern(lean_object * a, uint64_t h);
+    lean_object * visit(lean_object * a);
+public:
+    explicit sharecommon_native_fn(size_t capacity = 1024);
+    sharecommon_native_fn(sharecommon_native_fn const & other);
+    ~sharecommon_native_fn();
+    /* Number of maximally shared objects in the table. */
+    size_t size() const { return m_set_size; }
+    /* Apply `fn` to every object in the table. It is used to implement `lean_external_foreach_proc`. */
+    void for_each(b_obj_arg fn) const;
+    /* Return a maximally shared object equal to `a`. The result is a new reference. */
+    lean_object * operator()(b_obj_arg a);
+};
+
+/*
+Parallel version of `sharecommon_quick_fn` for large objects. The result is equal to the one
+produced by `sharecommon_quick_fn`, but it is computed by `m_num_threads` workers.
+
+We first traverse the input sequentially, assigning each node its height (leaves have height 0).
+Nodes with the same height do not depend on each other, so each height level is processed in
+parallel on the task manager workers using a sharded hash-consing table. New objects are created
+without incrementing the reference counters of their children, and the counters are fixed
+sequentially at the end.
+*/
+class LEAN_EXPORT sharecommon_par_fn {
+    struct entry {
+        lean_object * m_obj;
+        uint64_t      m_hash;
+        bool          m_new; // `true` if `m_obj` was created by `sharecommon_par_fn`
+    };
+    struct entry_hash {
+        std::size_t operator()(entry const & e) const { return e.m_hash; }
+    };
+    struct entry_eq {
+        bool operator()(entry const & e1, entry const & e2) const {
+            return e1.m_hash == e2.m_hash && lean_sharecommon_eq(e1.m_obj, e2.m_obj);
+        }
+    };
+    struct shard {
+        mutex                                             m_mutex;
+        lean::unordered_set<entry, entry_hash, entry_eq>  m_set;
+    };
+    static constexpr unsigned NUM_SHARDS = 64;
+
+    unsigned                                  m_num_threads;
+    /* Shareable nodes of the input in post-order, and their positions in `m_nodes`. */
+    std::vector<lean_object *>                m_nodes;
+    lean::unordered_map<lean_object *, size_t> m_index;
+    /* `m_result[i]` is the maximally shared version of `m_nodes[i]`. */
+    std::vector<lean_object *>                m_result;
+    std::unique_ptr<shard[]>                  m_shards;
+    /* Nodes of the level being processed, and the next position to be claimed by a worker. */
+    std::vector<size_t>                       m_level;
+    atomic<size_t>                            m_next{0};
+
+    void collect(lean_object * a, std::vector<std::vector<size_t>> & levels);
+    lean_object * resolve(lean_object * a) const;
+    bool children_changed(lean_object * a) const;
+    void process(size_t i);
+    void run_level();
+    static lean_object * worker(lean_object * self, lean_object * unit);
+public:
+    explicit sharecommon_par_fn(unsigned num_threads = 0);
+    /* Return a maximally shared object equal to `a`. The result is a new reference. */
+    lean_object * operator()(b_obj_arg a);
+};
+
+void initialize_sharecommon();
+void finalize_sharecommon();
 };
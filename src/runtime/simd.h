@@ -0,0 +1,17 @@
+/*
+Copyright (c) 2025 Lean FRO, LLC. All rights reserved.
+Released under Apache 2.0 license as described in the file LICENSE.
+*/
+#pragma once
+
+/*
+SIMD instruction sets that are part of the baseline of the target architecture, and can thus be used
+without runtime feature detection. Code using them must always provide a portable scalar fallback.
+*/
+#if defined(__SSE2__) || defined(_M_X64)
+#define LEAN_SIMD_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define LEAN_SIMD_NEON
+#include <arm_neon.h>
+#endif
@@ -0,0 +1,320 @@
+/*
+Copyright (c) 2025 Lean FRO, LLC. All rights reserved.
+Released under Apache 2.0 license as described in the file LICENSE.
+
+Startup snapshots.
+
+Running the `[init]` and `builtin_initialize` declarations of the core libraries dominates the startup time of short
+`lean` invocations. A snapshot records the values of the globals of all modules initialized by `lean_initialize` after
+their initializers have run, and later processes restore the globals from it instead of running the initializers.
+
+The module initializers emitted by the C backend pass a table of the addresses of their globals to
+`lean_startup_snapshot_restore_module` before and to `lean_startup_snapshot_record_module` after running their
+initializers. All values are compacted into a single region so that objects shared between modules, in particular
+`IO.Ref`s modified by the initializers of other modules, stay shared when restored. The region is mapped at a fixed
+address if possible, like .olean files. Closures are stored relative to the code of this file and restored only in
+the same binary, which is identified by its build-id or by the size and modification time of its file.
+
+A module is either restored as a whole or initialized as usual, as the effects of its initializers on the globals of
+other modules are only captured by the snapshot. Thus if the value of any global cannot be compacted, e.g. because it
+contains a mutex, no snapshot is written at all.
+*/
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#include <iostream>
+#include "runtime/compact.h"
+#include "runtime/object_ref.h"
+#include "runtime/exception.h"
+#include "runtime/sstream.h"
+#include "runtime/platform.h"
+#include "githash.h"
+
+#if !defined(LEAN_WINDOWS) && !defined(LEAN_EMSCRIPTEN)
+#define LEAN_STARTUP_SNAPSHOTS
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+// address at which snapshots are attempted to be mapped, see `lean_save_module_data_parts`
+#define LEAN_STARTUP_SNAPSHOT_BASE_ADDR 0x7e0000000000
+
+namespace lean {
+#ifdef LEAN_STARTUP_SNAPSHOTS
+struct snapshot_header {
+    // 8 bytes: magic number
+    char marker[8] = {'l', 'e', 'a', 'n', 's', 'n', 'a', 'p'};
+    // 40 bytes: build githash, padded with `\0` to the right
+    char githash[40];
+    // 64 bytes: identity of the binary containing the code base (see `get_binary_id`), padded with `\0` to the right
+    char binary_id[64];
+    // address at which the beginning of the file (including header) is attempted to be mmapped
+    size_t base_addr;
+    // payload, a compacted array of `snapshot_module`s
+    size_t data[];
+};
+static_assert(sizeof(snapshot_header) == 8 + 40 + 64 + sizeof(size_t), "snapshot_header must be packed");
+
+/* The recorded globals of a module, see `lean_startup_snapshot_record_module`. In the snapshot, a module is stored
+   as a pair of its name and an array of the values of its globals (scalars as byte arrays). */
+struct snapshot_module {
+    std::string    m_name;
+    void **        m_globals;
+    size_t const * m_sizes;
+    size_t         m_num_globals;
+};
+
+enum class snapshot_state { inactive, recording, restoring };
+static snapshot_state g_state = snapshot_state::inactive;
+static std::string * g_fname = nullptr;
+static std::vector<snapshot_module> * g_recorded = nullptr;
+static std::unordered_map<std::string, object *> * g_restored = nullptr;
+// The region of a restored snapshot, never freed as it holds the values of globals.
+static compacted_region * g_region = nullptr;
+
+static void * get_code_base() {
+    return reinterpret_cast<void *>(&lean_startup_snapshot_restore_module);
+}
+
+/* Checks whether the values of globals can be compacted: they must not contain external objects, and all closures
+   must point into the binary of the code base. */
+class compactability_checker {
+    void * m_code_fbase = nullptr;
+    // objects reachable from globals found to be compactable
+    std::unordered_set<object *> m_ok;
+    std::unordered_map<void *, bool> m_funs;
+    std::vector<object *> m_todo;
+
+    bool check_fun(void * f) {
+        auto it = m_funs.find(f);
+        if (it != m_funs.end())
+            return it->second;
+        Dl_info info;
+        bool ok = m_code_fbase && dladdr(f, &info) && info.dli_fbase == m_code_fbase;
+        m_funs[f] = ok;
+        return ok;
+    }
+
+    void push(object * o) {
+        if (o && !lean_is_scalar(o) && !m_ok.count(o))
+            m_todo.push_back(o);
+    }
+public:
+    compactability_checker() {
+        Dl_info info;
+        if (dladdr(get_code_base(), &info))
+            m_code_fbase = info.dli_fbase;
+    }
+
+    bool operator()(object * o) {
+        std::unordered_set<object *> visited;
+        m_todo.clear();
+        push(o);
+        while (!m_todo.empty()) {
+            object * curr = m_todo.back();
+            m_todo.pop_back();
+            if (!visited.insert(curr).second)
+                continue;
+            uint8 tag = lean_ptr_tag(curr);
+            if (tag <= LeanMaxCtorTag) {
+                for (unsigned i = 0; i < lean_ctor_num_objs(curr); i++)
+                    push(lean_ctor_get(curr, i));
+                continue;
+            }
+            switch (tag) {
+            case LeanClosure:
+                if (!check_fun(lean_closure_fun(curr)))
+                    return false;
+                for (unsigned i = 0; i < lean_closure_num_fixed(curr); i++)
+                    push(lean_closure_get(curr, i));
+                break;
+            case LeanArray:
+                for (size_t i = 0; i < lean_array_size(curr); i++)
+                    push(lean_array_get_core(curr, i));
+                break;
+            case LeanScalarArray: case LeanString: case LeanMPZ:
+                break;
+            // the compactor forces thunks and waits for tasks as well
+            case LeanThunk:   push(lean_thunk_get(curr)); break;
+            case LeanTask:    push(lean_task_get(curr)); break;
+            case LeanPromise: push(reinterpret_cast<object *>(lean_to_promise(curr)->m_result)); break;
+            case LeanRef:     push(lean_to_ref(curr)->m_value); break;
+            default:
+                return false;
+            }
+        }
+        m_ok.insert(visited.begin(), visited.end());
+        return true;
+    }
+};
+
+static void save_snapshot() {
+    snapshot_header header = {};
+    if (!get_binary_id(header.binary_id))
+        throw exception("failed to identify the binary of the Lean runtime");
+    compactability_checker compactable;
+    for (snapshot_module const & m : *g_recorded) {
+        for (size_t i = 0; i < m.m_num_globals; i++) {
+            if (m.m_sizes[i] == 0 && !compactable(*static_cast<object **>(m.m_globals[i])))
+                throw exception(sstream() << "global #" << i << " of '" << m.m_name << "' cannot be compacted");
+        }
+    }
+    object * modules = alloc_array(0, g_recorded->size());
+    for (snapshot_module const & m : *g_recorded) {
+        object * values = alloc_array(m.m_num_globals, m.m_num_globals);
+        for (size_t i = 0; i < m.m_num_globals; i++) {
+            object * v;
+            if (m.m_sizes[i] == 0) {
+                v = *static_cast<object **>(m.m_globals[i]);
+                inc(v);
+            } else {
+                v = alloc_sarray(1, m.m_sizes[i], m.m_sizes[i]);
+                memcpy(sarray_cptr(v), m.m_globals[i], m.m_sizes[i]);
+            }
+            array_set(values, i, v);
+        }
+        object * entry = alloc_cnstr(0, 2, 0);
+        cnstr_set(entry, 0, mk_string(m.m_name));
+        cnstr_set(entry, 1, values);
+        modules = lean_array_push(modules, entry);
+    }
+    object_ref root(modules);
+
+    // refs must stay distinct as the restored process may modify them
+    object_compactor compactor(reinterpret_cast<void *>(LEAN_STARTUP_SNAPSHOT_BASE_ADDR), get_code_base(),
+                               /* keep_mutable_identity */ true);
+    // reserve space for the header so that the offsets of objects are relative to the beginning of the file
+    compactor.alloc(sizeof(snapshot_header));
+    compactor(root.raw());
+    strncpy(header.githash, LEAN_GITHASH, sizeof(header.githash));
+    header.base_addr   = LEAN_STARTUP_SNAPSHOT_BASE_ADDR;
+
+    // write to a temp file first so that concurrent processes never read a partial snapshot
+    std::string tmp_fname = *g_fname + ".tmp." + std::to_string(getpid());
+    FILE * out = fopen(tmp_fname.c_str(), "wb");
+    if (!out)
+        throw exception(sstream() << "failed to create '" << tmp_fname << "': " << strerror(errno));
+    size_t data_size = compactor.size() - sizeof(header);
+    bool ok = fwrite(&header, sizeof(header), 1, out) == 1
+        && fwrite(static_cast<char const *>(compactor.data()) + sizeof(header), 1, data_size, out) == data_size;
+    ok = fclose(out) == 0 && ok;
+    if (!ok || std::rename(tmp_fname.c_str(), g_fname->c_str()) != 0) {
+        std::remove(tmp_fname.c_str());
+        throw exception(sstream() << "failed to write '" << *g_fname << "'");
+    }
+}
+
+/* Returns the root of the snapshot in `fname` if it can be used by this binary. */
+static object * load_snapshot(std::string const & fname) {
+    int fd = open(fname.c_str(), O_RDONLY);
+    if (fd == -1)
+        return nullptr;
+    struct stat st;
+    snapshot_header default_header = {};
+    snapshot_header header;
+    char binary_id[64];
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(header)
+        || pread(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))
+        || memcmp(header.marker, default_header.marker, sizeof(header.marker)) != 0
+        || strncmp(header.githash, LEAN_GITHASH, sizeof(header.githash)) != 0
+        || !get_binary_id(binary_id) || memcmp(header.binary_id, binary_id, sizeof(binary_id)) != 0) {
+        close(fd);
+        return nullptr;
+    }
+    size_t size = st.st_size;
+    char * base_addr = reinterpret_cast<char *>(header.base_addr);
+    // writable as closures are relocated and `IO.Ref`s may be modified, but private to this process
+    char * buffer = static_cast<char *>(mmap(base_addr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0));
+    bool is_mmap = buffer == base_addr;
+    if (!is_mmap) {
+        if (buffer != MAP_FAILED)
+            munmap(buffer, size);
+        buffer = static_cast<char *>(malloc(size));
+        if (pread(fd, buffer, size, 0) != static_cast<ssize_t>(size)) {
+            free(buffer);
+            close(fd);
+            return nullptr;
+        }
+    }
+    close(fd);
+    g_region = new compacted_region(size - sizeof(snapshot_header), buffer + sizeof(snapshot_header),
+                                    base_addr + sizeof(snapshot_header), is_mmap, nullptr, get_code_base());
+    return g_region->read();
+}
+
+extern "C" LEAN_EXPORT void lean_startup_snapshot_start(char const * fname) {
+    lean_assert(g_state == snapshot_state::inactive);
+    g_fname = new std::string(fname);
+    if (object * root = load_snapshot(fname)) {
+        g_restored = new std::unordered_map<std::string, object *>();
+        for (size_t i = 0; i < array_size(root); i++) {
+            object * entry = array_get(root, i);
+            (*g_restored)[string_cstr(cnstr_get(entry, 0))] = entry;
+        }
+        g_state = snapshot_state::restoring;
+    } else {
+        g_recorded = new std::vector<snapshot_module>();
+        g_state = snapshot_state::recording;
+    }
+}
+
+extern "C" LEAN_EXPORT void lean_startup_snapshot_finish() {
+    if (g_state == snapshot_state::recording) {
+        try {
+            save_snapshot();
+        } catch (exception & ex) {
+            std::cerr << "warning: failed to write startup snapshot '" << *g_fname << "': " << ex.what() << "\n";
+        }
+    }
+    g_state = snapshot_state::inactive;
+    delete g_recorded;
+    g_recorded = nullptr;
+    delete g_restored;
+    g_restored = nullptr;
+    delete g_fname;
+    g_fname = nullptr;
+}
+
+extern "C" LEAN_EXPORT bool lean_startup_snapshot_restore_module(char const * mod, void ** globals, size_t const * sizes,
+                                                                 size_t num_globals) {
+    if (g_state != snapshot_state::restoring)
+        return false;
+    auto it = g_restored->find(mod);
+    if (it == g_restored->end())
+        return false;
+    object * values = cnstr_get(it->second, 1);
+    if (array_size(values) != num_globals)
+        lean_internal_panic("startup snapshot does not match module initializer");
+    for (size_t i = 0; i < num_globals; i++) {
+        object * v = array_get(values, i);
+        if (sizes[i] == 0)
+            *reinterpret_cast<object **>(globals[i]) = v;
+        else
+            memcpy(globals[i], sarray_cptr(v), sizes[i]);
+    }
+    return true;
+}
+
+extern "C" LEAN_EXPORT void lean_startup_snapshot_record_module(char const * mod, void ** globals, size_t const * sizes,
+                                                                size_t num_globals) {
+    if (g_state == snapshot_state::recording)
+        g_recorded->push_back({ mod, globals, sizes, num_globals });
+}
+#else
+extern "C" LEAN_EXPORT void lean_startup_snapshot_start(char const *) {}
+extern "C" LEAN_EXPORT void lean_startup_snapshot_finish() {}
+
+extern "C" LEAN_EXPORT bool lean_startup_snapshot_restore_module(char const *, void **, size_t const *, size_t) {
+    return false;
+}
+
+extern "C" LEAN_EXPORT void lean_startup_snapshot_record_module(char const *, void **, size_t const *, size_t) {}
+#endif
+}
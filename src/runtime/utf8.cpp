@@ -5,14 +5,79 @@ Released under Apache 2.0 license as described in the file LICENSE.
 Author: Leonardo de Moura
 */
 #include <cstdlib>
+#include <cstring>
 #include <string>
 #include "runtime/debug.h"
 #include "runtime/optional.h"
+#include "runtime/simd.h"
 #include "runtime/utf8.h"
 
 namespace lean {
 bool is_utf8_next(unsigned char c) { return (c & 0xC0) == 0x80; }
 
+/*
+Bulk helpers. They process 16 bytes at a time using SIMD instructions when available, and 8 bytes at
+a time using 64-bit words otherwise, which makes mostly-ASCII text much faster to scan than decoding
+it one character at a time.
+*/
+
+static inline uint64_t load_word(uchar const * str) {
+    uint64_t w;
+    memcpy(&w, str, sizeof(w));
+    return w;
+}
+
+/* Return the length of the longest prefix of `str[0, size)` containing only ASCII characters. */
+static size_t ascii_prefix_size(uchar const * str, size_t size) {
+    size_t i = 0;
+#if defined(LEAN_SIMD_SSE2)
+    for (; i + 16 <= size; i += 16) {
+        int mask = _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const *>(str + i)));
+        if (mask != 0)
+            return i + __builtin_ctz(mask);
+    }
+#elif defined(LEAN_SIMD_NEON)
+    for (; i + 16 <= size; i += 16) {
+        if (vmaxvq_u8(vld1q_u8(str + i)) >= 0x80)
+            break;
+    }
+#endif
+    for (; i + 8 <= size; i += 8) {
+        if ((load_word(str + i) & 0x8080808080808080ull) != 0)
+            break;
+    }
+    while (i < size && str[i] < 0x80)
+        i++;
+    return i;
+}
+
+/* Return the number of continuation bytes (`10xxxxxx`) in `str[0, size)`. */
+static size_t count_utf8_next(uchar const * str, size_t size) {
+    size_t r = 0;
+    size_t i = 0;
+#if defined(LEAN_SIMD_SSE2)
+    // continuation bytes are exactly the bytes smaller than `0xC0` when interpreted as signed integers
+    __m128i bound = _mm_set1_epi8(static_cast<char>(0xC0));
+    for (; i + 16 <= size; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<__m128i const *>(str + i));
+        r += __builtin_popcount(_mm_movemask_epi8(_mm_cmplt_epi8(v, bound)));
+    }
+#elif defined(LEAN_SIMD_NEON)
+    for (; i + 16 <= size; i += 16) {
+        uint8x16_t v = vandq_u8(vld1q_u8(str + i), vdupq_n_u8(0xC0));
+        r += vaddvq_u8(vshrq_n_u8(vceqq_u8(v, vdupq_n_u8(0x80)), 7));
+    }
+#endif
+    for (; i + 8 <= size; i += 8) {
+        uint64_t w = load_word(str + i);
+        // the lowest bit of each byte is set iff its two highest bits are `10`
+        r += __builtin_popcountll((w >> 7) & ~(w >> 6) & 0x0101010101010101ull);
+    }
+    for (; i < size; i++)
+        r += is_utf8_next(str[i]);
+    return r;
+}
+
 unsigned get_utf8_size(unsigned char c) {
     if ((c & 0x80) == 0)
         return 1;
@@ -33,28 +98,16 @@ unsigned get_utf8_size(unsigned char c) {
 }
 
 extern "C" LEAN_EXPORT size_t lean_utf8_strlen(char const * str) {
-    size_t r = 0;
-    while (*str != 0) {
-        unsigned sz = get_utf8_size(*str);
-        r++;
-        str += sz;
-    }
-    return r;
+    return lean_utf8_n_strlen(str, strlen(str));
 }
 
 size_t utf8_strlen(char const * str) {
     return lean_utf8_strlen(str);
 }
 
+/* Remark: for valid UTF-8, the number of characters is the number of bytes that are not continuation bytes. */
 extern "C" LEAN_EXPORT size_t lean_utf8_n_strlen(char const * str, size_t sz) {
-    size_t r = 0;
-    size_t i = 0;
-    while (i < sz) {
-        unsigned d = get_utf8_size(str[i]);
-        r++;
-        i += d;
-    }
-    return r;
+    return sz - count_utf8_next(reinterpret_cast<uchar const *>(str), sz);
 }
 
 size_t utf8_strlen(char const * str, size_t sz) {
@@ -66,14 +119,23 @@ size_t utf8_strlen(std::string const & str) {
 }
 
 optional<size_t> utf8_char_pos(char const * str, size_t char_idx) {
-    size_t r = 0;
-    while (*str != 0) {
-        if (char_idx == 0)
-            return some<size_t>(r);
-        char_idx--;
-        unsigned sz = get_utf8_size(*str);
-        r += sz;
-        str += sz;
+    uchar const * s = reinterpret_cast<uchar const *>(str);
+    size_t sz = strlen(str);
+    size_t r  = 0;
+    // skip whole blocks that do not contain the start of the character we are looking for
+    while (r + 16 <= sz) {
+        size_t n = 16 - count_utf8_next(s + r, 16);
+        if (n > char_idx)
+            break;
+        char_idx -= n;
+        r += 16;
+    }
+    for (; r < sz; r++) {
+        if (!is_utf8_next(s[r])) {
+            if (char_idx == 0)
+                return some<size_t>(r);
+            char_idx--;
+        }
     }
     return optional<size_t>();
 }
@@ -269,6 +331,10 @@ bool validate_utf8_one(uint8_t const * str, size_t size, size_t & pos) {
 
 bool validate_utf8(uint8_t const * str, size_t size, size_t & pos, size_t & i) {
     while (pos < size) {
+        size_t n = ascii_prefix_size(str + pos, size - pos);
+        pos += n;
+        i   += n;
+        if (pos == size) break;
         if (!validate_utf8_one(str, size, pos)) return false;
         i++;
     }
@@ -6,6 +6,11 @@ Author: Sofia Rodrigues, Henrik Böving
 */
 #include "runtime/uv/dns.h"
 #include <cstring>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 #ifndef LEAN_EMSCRIPTEN
 #include <uv.h>
@@ -32,26 +37,195 @@ bool is_safe_ascii_str(const char *s, size_t len) {
     return true;
 }
 
-// Std.Internal.IO.Async.DNS.getAddrInfo (host service : @& String) (family : UInt8) : IO (IO.Promise (Except IO.Error (Array IPAddr)))
-extern "C" LEAN_EXPORT lean_obj_res lean_uv_dns_get_info(b_obj_arg name, b_obj_arg service, uint8_t family) {
-    char const * name_cstr = lean_string_cstr(name);
-    char const * service_cstr = lean_string_cstr(service);
+// =======================================
+// Resolver cache
+
+// Results of `uv_getaddrinfo` are cached per (host, service, family) for `g_dns_positive_ttl`
+// milliseconds. Lookups that failed because the name does not exist are cached for
+// `g_dns_negative_ttl` milliseconds. Concurrent lookups of the same key share a single query.
+// The cache is protected by `g_dns_mutex` so that hits don't need the event loop lock.
+#define DNS_CACHE_MAX_ENTRIES 4096
+
+// A batch lookup, its promise is resolved once all of its queries have completed.
+struct dns_batch {
+    lean_object *       m_promise;
+    lean_object *       m_results;   // `Array (Except IO.Error (Array IPAddr))`, filled in by index.
+    std::atomic<size_t> m_remaining;
+};
+
+// Someone waiting for the result of a lookup, either a promise or a slot of a batch.
+struct dns_waiter {
+    lean_object * m_promise;
+    dns_batch *   m_batch;
+    size_t        m_index;
+};
+
+struct dns_entry {
+    bool               m_pending = false;   // Whether a query for this entry is in flight.
+    lean_object *      m_result  = nullptr; // The resolved addresses, `nullptr` for a failed lookup.
+    int                m_status  = 0;       // The error code of a failed lookup.
+    uint64_t           m_expires = 0;       // When the entry becomes stale, in milliseconds.
+    vector<dns_waiter> m_waiters;           // Waiters for the query in flight.
+};
+
+static mutex                             g_dns_mutex;
+static unordered_map<string, dns_entry> g_dns_cache;
+static uint64_t                          g_dns_positive_ttl = 30000;
+static uint64_t                          g_dns_negative_ttl = 10000;
+
+static uint64_t dns_now_ms() {
+    return uv_hrtime() / 1000000;
+}
 
-    if (!is_safe_ascii_str(name_cstr, lean_string_size(name) - 1)) {
-        return lean_io_result_mk_error(lean_mk_io_error_invalid_argument(EINVAL, mk_string("name is not ASCII")));
+static string dns_key(char const * name, char const * service, uint8_t family) {
+    string key(name);
+    key += '\0';
+    key += service;
+    key += '\0';
+    key += (char)family;
+    return key;
+}
+
+// Only failures saying that the name does not exist are cached, transient errors are retried.
+static bool dns_status_is_cacheable(int status) {
+    return status == UV_EAI_NONAME || status == UV_EAI_NODATA;
+}
+
+// Resolves `waiter` with the `Except IO.Error (Array IPAddr)` value `r`.
+static void dns_deliver(dns_waiter const & waiter, obj_arg r) {
+    if (waiter.m_batch == nullptr) {
+        lean_promise_resolve(r, waiter.m_promise);
+        lean_dec(waiter.m_promise);
+        return;
+    }
+    dns_batch * batch = waiter.m_batch;
+    lean_array_set_core(batch->m_results, waiter.m_index, r);
+    if (batch->m_remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        lean_promise_resolve(batch->m_results, batch->m_promise);
+        lean_dec(batch->m_promise);
+        delete batch;
     }
+}
 
-    if (!is_safe_ascii_str(service_cstr, lean_string_size(service) - 1)) {
-        return lean_io_result_mk_error(lean_mk_io_error_invalid_argument(EINVAL, mk_string("service is not ASCII")));
+static obj_res dns_entry_value(dns_entry const & entry) {
+    if (entry.m_result != nullptr) {
+        lean_inc(entry.m_result);
+        return mk_except_ok(entry.m_result);
+    } else {
+        return mk_except_err(lean_decode_uv_error(entry.m_status, nullptr));
     }
+}
 
-    lean_object* promise = lean_promise_new();
-    mark_mt(promise);
+// Must be called with `g_dns_mutex` held.
+static void dns_cache_make_room() {
+    if (g_dns_cache.size() < DNS_CACHE_MAX_ENTRIES) return;
+    uint64_t now = dns_now_ms();
+    for (auto it = g_dns_cache.begin(); it != g_dns_cache.end();) {
+        if (!it->second.m_pending && it->second.m_expires <= now) {
+            if (it->second.m_result != nullptr) lean_dec(it->second.m_result);
+            it = g_dns_cache.erase(it);
+        } else {
+            it++;
+        }
+    }
+    // If everything is still fresh, drop arbitrary entries.
+    for (auto it = g_dns_cache.begin(); it != g_dns_cache.end() && g_dns_cache.size() >= DNS_CACHE_MAX_ENTRIES;) {
+        if (!it->second.m_pending) {
+            if (it->second.m_result != nullptr) lean_dec(it->second.m_result);
+            it = g_dns_cache.erase(it);
+        } else {
+            it++;
+        }
+    }
+}
 
-    uv_getaddrinfo_t* resolver = (uv_getaddrinfo_t*)malloc(sizeof(uv_getaddrinfo_t));
-    resolver->data = promise;
+// On a cache hit returns the value to deliver. Otherwise `waiter` is registered for the result and
+// `*start` is set if the caller has to start the query for `key`.
+static obj_res dns_cache_find_or_wait(string const & key, dns_waiter const & waiter, bool * start) {
+    unique_lock<mutex> lock(g_dns_mutex);
+    *start = false;
+    auto it = g_dns_cache.find(key);
+    if (it == g_dns_cache.end()) {
+        dns_cache_make_room();
+        it = g_dns_cache.emplace(key, dns_entry()).first;
+    } else if (it->second.m_pending) {
+        it->second.m_waiters.push_back(waiter);
+        return nullptr;
+    } else if (it->second.m_expires > dns_now_ms()) {
+        return dns_entry_value(it->second);
+    } else if (it->second.m_result != nullptr) {
+        lean_dec(it->second.m_result);
+        it->second.m_result = nullptr;
+    }
+    it->second.m_pending = true;
+    it->second.m_waiters.push_back(waiter);
+    *start = true;
+    return nullptr;
+}
 
+// Records the outcome of the query for `key` and resolves everyone waiting for it. Takes ownership
+// of `arr`, which is `nullptr` if the query failed with `status`.
+static void dns_complete(string const & key, int status, obj_arg arr) {
+    vector<dns_waiter> waiters;
+    {
+        unique_lock<mutex> lock(g_dns_mutex);
+        auto it = g_dns_cache.find(key);
+        lean_assert(it != g_dns_cache.end() && it->second.m_pending);
+        dns_entry & entry = it->second;
+        waiters.swap(entry.m_waiters);
+        entry.m_pending = false;
+
+        uint64_t ttl = arr != nullptr ? g_dns_positive_ttl : (dns_status_is_cacheable(status) ? g_dns_negative_ttl : 0);
+        if (ttl == 0) {
+            g_dns_cache.erase(it);
+        } else {
+            if (arr != nullptr) lean_inc(arr);
+            entry.m_result = arr;
+            entry.m_status = status;
+            entry.m_expires = dns_now_ms() + ttl;
+        }
+    }
+
+    for (dns_waiter const & waiter : waiters) {
+        if (arr != nullptr) {
+            lean_inc(arr);
+            dns_deliver(waiter, mk_except_ok(arr));
+        } else {
+            dns_deliver(waiter, mk_except_err(lean_decode_uv_error(status, nullptr)));
+        }
+    }
 
+    if (arr != nullptr) lean_dec(arr);
+}
+
+static lean_object * addrinfo_to_ip_addr_array(struct addrinfo * res) {
+    lean_object * arr = lean_alloc_array(0, 1);
+
+    for (struct addrinfo* ai = res; ai != NULL; ai = ai->ai_next) {
+        const struct sockaddr* sin_addr = (const struct sockaddr*)ai->ai_addr;
+
+        in_addr_storage* storage_addr;
+
+        if (sin_addr->sa_family == AF_INET) {
+            struct sockaddr_in* ipv4 = (struct sockaddr_in*)sin_addr;
+            storage_addr = (in_addr_storage*)&(ipv4->sin_addr);
+        } else if (sin_addr->sa_family == AF_INET6) {
+            struct sockaddr_in6* ipv6 = (struct sockaddr_in6*)sin_addr;
+            storage_addr = (in_addr_storage*)&(ipv6->sin6_addr);
+        } else {
+            continue;
+        }
+
+        lean_object* addr = lean_in_addr_storage_to_ip_addr((short)sin_addr->sa_family, storage_addr);
+        arr = lean_array_push(arr, addr);
+    }
+
+    return arr;
+}
+
+// Starts the query for `key`, whose waiters are resolved once it finishes. Must be called with the
+// event loop lock held.
+static void dns_start_query(string const & key, char const * name, char const * service, uint8_t family) {
     struct addrinfo hints;
     memset(&hints, 0, sizeof(hints));
 
@@ -64,63 +238,150 @@ extern "C" LEAN_EXPORT lean_obj_res lean_uv_dns_get_info(b_obj_arg name, b_obj_a
         default: hints.ai_family = PF_UNSPEC; break;
     }
 
-    event_loop_lock(&global_ev);
-    lean_inc(promise);
+    uv_getaddrinfo_t* resolver = (uv_getaddrinfo_t*)malloc(sizeof(uv_getaddrinfo_t));
+    resolver->data = new string(key);
 
     int result = uv_getaddrinfo(global_ev.loop, resolver, [](uv_getaddrinfo_t* req, int status, struct addrinfo* res) {
-        lean_object* promise = (lean_object*) req->data;
+        string * key = (string*) req->data;
 
         if (status != 0) {
-            lean_promise_resolve_with_code(status, promise);
-            lean_dec(promise);
-            free(req);
-            return;
+            dns_complete(*key, status, nullptr);
+        } else {
+            lean_object * arr = addrinfo_to_ip_addr_array(res);
+            // The array is shared through the cache.
+            lean_mark_mt(arr);
+            uv_freeaddrinfo(res);
+            dns_complete(*key, 0, arr);
         }
 
-        lean_object * arr = lean_alloc_array(0, 1);
+        delete key;
+        free(req);
+    }, name, service, &hints);
 
-        for (struct addrinfo* ai = res; ai != NULL; ai = ai->ai_next) {
-            const struct sockaddr* sin_addr = (const struct sockaddr*)ai->ai_addr;
+    if (result != 0) {
+        delete (string*)resolver->data;
+        free(resolver);
+        dns_complete(key, result, nullptr);
+    }
+}
 
-            in_addr_storage* storage_addr;
+// Std.Internal.IO.Async.DNS.getAddrInfo (host service : @& String) (family : UInt8) : IO (IO.Promise (Except IO.Error (Array IPAddr)))
+extern "C" LEAN_EXPORT lean_obj_res lean_uv_dns_get_info(b_obj_arg name, b_obj_arg service, uint8_t family) {
+    char const * name_cstr = lean_string_cstr(name);
+    char const * service_cstr = lean_string_cstr(service);
 
-            if (sin_addr->sa_family == AF_INET) {
-                struct sockaddr_in* ipv4 = (struct sockaddr_in*)sin_addr;
-                storage_addr = (in_addr_storage*)&(ipv4->sin_addr);
-            } else if (sin_addr->sa_family == AF_INET6) {
-                struct sockaddr_in6* ipv6 = (struct sockaddr_in6*)sin_addr;
-                storage_addr = (in_addr_storage*)&(ipv6->sin6_addr);
-            } else {
-                continue;
-            }
+    if (!is_safe_ascii_str(name_cstr, lean_string_size(name) - 1)) {
+        return lean_io_result_mk_error(lean_mk_io_error_invalid_argument(EINVAL, mk_string("name is not ASCII")));
+    }
 
-            lean_object* addr = lean_in_addr_storage_to_ip_addr((short)sin_addr->sa_family, storage_addr);
-            arr = lean_array_push(arr, addr);
-        }
+    if (!is_safe_ascii_str(service_cstr, lean_string_size(service) - 1)) {
+        return lean_io_result_mk_error(lean_mk_io_error_invalid_argument(EINVAL, mk_string("service is not ASCII")));
+    }
 
-        lean_promise_resolve(mk_except_ok(arr), promise);
+    lean_object* promise = lean_promise_new();
+    mark_mt(promise);
 
-        uv_freeaddrinfo(res);
-        lean_dec(promise);
+    // The waiter owns a reference to the promise.
+    lean_inc(promise);
+    string key = dns_key(name_cstr, service_cstr, family);
+    bool start;
+    lean_object * hit = dns_cache_find_or_wait(key, dns_waiter{promise, nullptr, 0}, &start);
+
+    if (hit != nullptr) {
+        dns_deliver(dns_waiter{promise, nullptr, 0}, hit);
+    } else if (start) {
+        event_loop_lock(&global_ev);
+        dns_start_query(key, name_cstr, service_cstr, family);
+        event_loop_unlock(&global_ev);
+    }
 
-        free(req);
-    }, name_cstr, service_cstr, &hints);
+    return lean_io_result_mk_ok(promise);
+}
 
-    if (result != 0) {
-        lean_dec(promise); // The structure does not own it.
-        lean_dec(promise); // We are not going to return it.
+// Std.Internal.IO.Async.DNS.getAddrInfoBatch (hosts : @& Array String) (service : @& String) (family : UInt8) : IO (IO.Promise (Array (Except IO.Error (Array IPAddr))))
+extern "C" LEAN_EXPORT lean_obj_res lean_uv_dns_get_info_batch(b_obj_arg hosts, b_obj_arg service, uint8_t family) {
+    char const * service_cstr = lean_string_cstr(service);
 
-        free(resolver);
+    if (!is_safe_ascii_str(service_cstr, lean_string_size(service) - 1)) {
+        return lean_io_result_mk_error(lean_mk_io_error_invalid_argument(EINVAL, mk_string("service is not ASCII")));
+    }
 
-        event_loop_unlock(&global_ev);
+    size_t n = lean_array_size(hosts);
+    lean_object* promise = lean_promise_new();
+    mark_mt(promise);
 
-        return lean_io_result_mk_error(lean_decode_uv_error(result, nullptr));
+    lean_object * results = lean_alloc_array(n, n);
+    for (size_t i = 0; i < n; i++) {
+        lean_array_set_core(results, i, lean_box(0));
+    }
+
+    if (n == 0) {
+        lean_promise_resolve(results, promise);
+        return lean_io_result_mk_ok(promise);
+    }
+
+    // The batch owns a reference to the promise.
+    lean_inc(promise);
+    dns_batch * batch = new dns_batch;
+    batch->m_promise = promise;
+    batch->m_results = results;
+    batch->m_remaining = n;
+
+    // Cache hits are delivered right away, the missing queries are started under a single lock.
+    vector<pair<string, size_t>> to_start;
+    for (size_t i = 0; i < n; i++) {
+        b_obj_arg name = lean_array_get_core(hosts, i);
+        char const * name_cstr = lean_string_cstr(name);
+        dns_waiter waiter{nullptr, batch, i};
+
+        if (!is_safe_ascii_str(name_cstr, lean_string_size(name) - 1)) {
+            dns_deliver(waiter, mk_except_err(lean_mk_io_error_invalid_argument(EINVAL, mk_string("name is not ASCII"))));
+            continue;
+        }
+
+        string key = dns_key(name_cstr, service_cstr, family);
+        bool start;
+        lean_object * hit = dns_cache_find_or_wait(key, waiter, &start);
+        if (hit != nullptr) {
+            dns_deliver(waiter, hit);
+        } else if (start) {
+            to_start.emplace_back(std::move(key), i);
+        }
+    }
+
+    if (!to_start.empty()) {
+        event_loop_lock(&global_ev);
+        for (auto const & q : to_start) {
+            dns_start_query(q.first, lean_string_cstr(lean_array_get_core(hosts, q.second)), service_cstr, family);
+        }
+        event_loop_unlock(&global_ev);
     }
 
-    event_loop_unlock(&global_ev);
     return lean_io_result_mk_ok(promise);
 }
 
+// Std.Internal.UV.DNS.setCacheTTL (positive negative : UInt64) : IO Unit
+extern "C" LEAN_EXPORT lean_obj_res lean_uv_dns_set_cache_ttl(uint64_t positive, uint64_t negative) {
+    unique_lock<mutex> lock(g_dns_mutex);
+    g_dns_positive_ttl = positive;
+    g_dns_negative_ttl = negative;
+    return lean_io_result_mk_ok(lean_box(0));
+}
+
+// Std.Internal.UV.DNS.flushCache : IO Unit
+extern "C" LEAN_EXPORT lean_obj_res lean_uv_dns_flush_cache() {
+    unique_lock<mutex> lock(g_dns_mutex);
+    for (auto it = g_dns_cache.begin(); it != g_dns_cache.end();) {
+        if (!it->second.m_pending) {
+            if (it->second.m_result != nullptr) lean_dec(it->second.m_result);
+            it = g_dns_cache.erase(it);
+        } else {
+            it++;
+        }
+    }
+    return lean_io_result_mk_ok(lean_box(0));
+}
+
 // Std.Internal.IO.Async.DNS.getNameInfo (host : @& SocketAddress) : IO (IO.Promise (Except IO.Error (String × String)))
 extern "C" LEAN_EXPORT lean_obj_res lean_uv_dns_get_name(b_obj_arg addr) {
     lean_object* promise = lean_promise_new();
@@ -179,6 +440,27 @@ extern "C" LEAN_EXPORT lean_obj_res lean_uv_dns_get_info(b_obj_arg name, b_obj_a
     );
 }
 
+// Std.Internal.IO.Async.DNS.getAddrInfoBatch (hosts : @& Array String) (service : @& String) (family : UInt8) : IO (IO.Promise (Array (Except IO.Error (Array IPAddr))))
+extern "C" LEAN_EXPORT lean_obj_res lean_uv_dns_get_info_batch(b_obj_arg hosts, b_obj_arg service, uint8_t family) {
+    lean_always_assert(
+        false && ("Please build a version of Lean4 with libuv to invoke this.")
+    );
+}
+
+// Std.Internal.UV.DNS.setCacheTTL (positive negative : UInt64) : IO Unit
+extern "C" LEAN_EXPORT lean_obj_res lean_uv_dns_set_cache_ttl(uint64_t positive, uint64_t negative) {
+    lean_always_assert(
+        false && ("Please build a version of Lean4 with libuv to invoke this.")
+    );
+}
+
+// Std.Internal.UV.DNS.flushCache : IO Unit
+extern "C" LEAN_EXPORT lean_obj_res lean_uv_dns_flush_cache() {
+    lean_always_assert(
+        false && ("Please build a version of Lean4 with libuv to invoke this.")
+    );
+}
+
 // Std.Internal.IO.Async.DNS.getNameInfo (host : @& SocketAddress) : IO (IO.Promise (Except IO.Error (String × String)))
 extern "C" LEAN_EXPORT lean_obj_res lean_uv_dns_get_name(b_obj_arg ip_addr) {
     lean_always_assert(
@@ -20,6 +20,9 @@ using namespace std;
 // =======================================
 // DNS functions
 extern "C" LEAN_EXPORT lean_obj_res lean_uv_dns_get_info(b_obj_arg name, b_obj_arg service, uint8_t family);
+extern "C" LEAN_EXPORT lean_obj_res lean_uv_dns_get_info_batch(b_obj_arg hosts, b_obj_arg service, uint8_t family);
+extern "C" LEAN_EXPORT lean_obj_res lean_uv_dns_set_cache_ttl(uint64_t positive, uint64_t negative);
+extern "C" LEAN_EXPORT lean_obj_res lean_uv_dns_flush_cache();
 extern "C" LEAN_EXPORT lean_obj_res lean_uv_dns_get_name(b_obj_arg ip_addr);
 
 }
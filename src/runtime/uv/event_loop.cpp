@@ -63,6 +63,15 @@ void event_loop_init(event_loop_t * event_loop) {
     event_loop->n_waiters = 0;
 }
 
+// Reinitializes the event loop in a child process after `fork`, which the event loop thread and the
+// state of the mutex it may hold do not survive.
+void event_loop_after_fork(event_loop_t * event_loop) {
+    check_uv(uv_mutex_init_recursive(&event_loop->mutex), "Failed to initialize mutex");
+    check_uv(uv_cond_init(&event_loop->cond_var), "Failed to initialize condition variable");
+    check_uv(uv_loop_fork(event_loop->loop), "Failed to reinitialize event loop after fork");
+    event_loop->n_waiters = 0;
+}
+
 // Locks the event loop for the side of the requesters.
 void event_loop_lock(event_loop_t * event_loop) {
     if (uv_mutex_trylock(&event_loop->mutex) != 0) {
@@ -35,6 +35,7 @@ extern event_loop_t global_ev;
 // =======================================
 // Event loop manipulation functions.
 void event_loop_init(event_loop_t *event_loop);
+void event_loop_after_fork(event_loop_t *event_loop);
 void event_loop_cleanup(event_loop_t *event_loop);
 void event_loop_lock(event_loop_t *event_loop);
 void event_loop_unlock(event_loop_t *event_loop);
@@ -0,0 +1,579 @@
+/*
+Copyright (c) 2025 Lean FRO, LLC. All rights reserved.
+Released under Apache 2.0 license as described in the file LICENSE.
+*/
+
+#include "runtime/uv/process.h"
+#include "runtime/buffer.h"
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace lean {
+
+#ifndef LEAN_EMSCRIPTEN
+
+// The values of `IO.Process.Stdio`.
+static const uint8_t STDIO_PIPED   = 0;
+static const uint8_t STDIO_INHERIT = 1;
+
+// Stores all the things needed to send data to the stdin of a child.
+typedef struct {
+    lean_object* promise;
+    lean_object* data;
+    lean_object* child;
+    uv_buf_t* bufs;
+} process_send_data;
+
+// =======================================
+// Process object manipulation functions.
+
+static void process_handle_closed(uv_handle_t* handle) {
+    lean_uv_process_object* process = (lean_uv_process_object*)handle->data;
+    free(handle);
+    if (--process->m_pending_closes == 0) {
+        free(process);
+    }
+}
+
+void lean_uv_process_finalizer(void* ptr) {
+    lean_uv_process_object* process = (lean_uv_process_object*)ptr;
+
+    lean_always_assert(process->m_promise_shutdown == nullptr);
+    for (int i = 0; i < 3; i++) {
+        lean_always_assert(process->m_promise_read[i] == nullptr);
+        lean_always_assert(process->m_byte_array[i] == nullptr);
+    }
+
+    if (process->m_promise_exit != nullptr) {
+        lean_dec(process->m_promise_exit);
+    }
+
+    event_loop_lock(&global_ev);
+
+    /// It's changing here because the object is being freed in the finalizer, and we need the data
+    /// inside of it.
+    process->m_pending_closes = 1;
+    process->m_uv_process->data = ptr;
+    for (int i = 0; i < 3; i++) {
+        if (process->m_stdio[i] != nullptr) {
+            process->m_pending_closes++;
+            process->m_stdio[i]->data = ptr;
+        }
+    }
+
+    uv_close((uv_handle_t*)process->m_uv_process, process_handle_closed);
+    for (int i = 0; i < 3; i++) {
+        if (process->m_stdio[i] != nullptr) {
+            uv_close((uv_handle_t*)process->m_stdio[i], process_handle_closed);
+        }
+    }
+
+    event_loop_unlock(&global_ev);
+}
+
+void initialize_libuv_process() {
+    g_uv_process_external_class = lean_register_external_class(lean_uv_process_finalizer, [](void* obj, lean_object* f) {
+        lean_uv_process_object* process = (lean_uv_process_object*)obj;
+
+        if (process->m_promise_exit != nullptr) {
+            lean_inc(f);
+            lean_apply_1(f, process->m_promise_exit);
+        }
+
+        if (process->m_promise_shutdown != nullptr) {
+            lean_inc(f);
+            lean_apply_1(f, process->m_promise_shutdown);
+        }
+
+        for (int i = 0; i < 3; i++) {
+            if (process->m_promise_read[i] != nullptr) {
+                lean_inc(f);
+                lean_apply_1(f, process->m_promise_read[i]);
+            }
+
+            if (process->m_byte_array[i] != nullptr) {
+                lean_inc(f);
+                lean_apply_1(f, process->m_byte_array[i]);
+            }
+        }
+    });
+}
+
+static int process_stream_index(lean_uv_process_object* process, uv_stream_t* stream) {
+    for (int i = 0; i < 3; i++) {
+        if ((uv_stream_t*)process->m_stdio[i] == stream) return i;
+    }
+    lean_unreachable();
+}
+
+// =======================================
+// Process Operations
+
+/* Std.Internal.UV.Process.spawn (args : @& IO.Process.SpawnArgs) : IO Child */
+extern "C" LEAN_EXPORT lean_obj_res lean_uv_process_spawn(b_obj_arg args) {
+    lean_object* stdio_cfg = lean_ctor_get(args, 0);
+    lean_object* cmd = lean_ctor_get(args, 1);
+    lean_object* cmd_args = lean_ctor_get(args, 2);
+    lean_object* cwd = lean_ctor_get(args, 3);
+    lean_object* env = lean_ctor_get(args, 4);
+    bool inherit_env = lean_ctor_get_uint8(args, 5 * sizeof(lean_object*));
+    bool do_setsid = lean_ctor_get_uint8(args, 5 * sizeof(lean_object*) + 1);
+
+    buffer<char*> pargs;
+    pargs.push_back(const_cast<char*>(lean_string_cstr(cmd)));
+    for (size_t i = 0; i < lean_array_size(cmd_args); i++) {
+        pargs.push_back(const_cast<char*>(lean_string_cstr(lean_array_get_core(cmd_args, i))));
+    }
+    pargs.push_back(nullptr);
+
+    // `NULL` makes the child inherit the environment of the parent unchanged.
+    std::vector<std::string> env_entries;
+    buffer<char*> penv;
+    bool custom_env = !inherit_env || lean_array_size(env) > 0;
+    if (custom_env) {
+        if (inherit_env) {
+            uv_env_item_t* items;
+            int count;
+            int result = uv_os_environ(&items, &count);
+            if (result < 0) {
+                return lean_io_result_mk_error(lean_decode_uv_error(result, nullptr));
+            }
+            for (int i = 0; i < count; i++) {
+                env_entries.push_back(std::string(items[i].name) + "=" + items[i].value);
+            }
+            uv_os_free_environ(items, count);
+        }
+        for (size_t i = 0; i < lean_array_size(env); i++) {
+            lean_object* entry = lean_array_get_core(env, i);
+            std::string prefix = std::string(lean_string_cstr(lean_ctor_get(entry, 0))) + "=";
+            auto it = env_entries.begin();
+            while (it != env_entries.end()) {
+                if (it->compare(0, prefix.size(), prefix) == 0) {
+                    it = env_entries.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            lean_object* value = lean_ctor_get(entry, 1);
+            if (!lean_is_scalar(value)) {
+                env_entries.push_back(prefix + lean_string_cstr(lean_ctor_get(value, 0)));
+            }
+        }
+        for (auto & e : env_entries) {
+            penv.push_back(const_cast<char*>(e.c_str()));
+        }
+        penv.push_back(nullptr);
+    }
+
+    lean_uv_process_object* process = (lean_uv_process_object*)malloc(sizeof(lean_uv_process_object));
+    process->m_uv_process = (uv_process_t*)malloc(sizeof(uv_process_t));
+    process->m_promise_exit = nullptr;
+    process->m_promise_shutdown = nullptr;
+    process->m_pid = 0;
+    process->m_pending_closes = 0;
+    for (int i = 0; i < 3; i++) {
+        process->m_stdio[i] = nullptr;
+        process->m_promise_read[i] = nullptr;
+        process->m_byte_array[i] = nullptr;
+    }
+
+    lean_object* obj = lean_uv_process_new(process);
+    lean_mark_mt(obj);
+
+    // Created after marking `obj`, as the foreach of `lean_mark_mt` consumes the promises it visits.
+    process->m_promise_exit = lean_promise_new();
+    mark_mt(process->m_promise_exit);
+    process->m_uv_process->data = obj;
+
+    uv_stdio_container_t stdio[3];
+    uv_process_options_t options;
+    memset(&options, 0, sizeof(options));
+    options.file = pargs[0];
+    options.args = pargs.data();
+    options.env = custom_env ? penv.data() : nullptr;
+    options.cwd = lean_is_scalar(cwd) ? nullptr : lean_string_cstr(lean_ctor_get(cwd, 0));
+    options.flags = do_setsid ? UV_PROCESS_DETACHED : 0;
+    options.stdio_count = 3;
+    options.stdio = stdio;
+    options.exit_cb = [](uv_process_t* handle, int64_t exit_status, int term_signal) {
+        lean_object* obj = (lean_object*)handle->data;
+        lean_uv_process_object* process = lean_to_uv_process(obj);
+
+        // Same convention as `IO.Process.Child.wait`.
+        uint32_t code = term_signal != 0 ? 128 + term_signal : (uint32_t)exit_status;
+        lean_promise_resolve(lean_box_uint32(code), process->m_promise_exit);
+
+        // The loop does not need to keep the child alive anymore.
+        lean_dec(obj);
+    };
+
+    event_loop_lock(&global_ev);
+
+    for (int i = 0; i < 3; i++) {
+        uint8_t mode = lean_ctor_get_uint8(stdio_cfg, i);
+        if (mode == STDIO_PIPED) {
+            uv_pipe_t* pipe = (uv_pipe_t*)malloc(sizeof(uv_pipe_t));
+            uv_pipe_init(global_ev.loop, pipe, 0);
+            pipe->data = obj;
+            process->m_stdio[i] = pipe;
+            // The flags are from the perspective of the child.
+            stdio[i].flags = (uv_stdio_flags)(UV_CREATE_PIPE | (i == 0 ? UV_READABLE_PIPE : UV_WRITABLE_PIPE));
+            stdio[i].data.stream = (uv_stream_t*)pipe;
+        } else if (mode == STDIO_INHERIT) {
+            stdio[i].flags = UV_INHERIT_FD;
+            stdio[i].data.fd = i;
+        } else {
+            // Redirects the stream to the null device.
+            stdio[i].flags = UV_IGNORE;
+        }
+    }
+
+    int result = uv_spawn(global_ev.loop, process->m_uv_process, &options);
+
+    if (result < 0) {
+        event_loop_unlock(&global_ev);
+        // The handles are still initialized and are closed by the finalizer.
+        lean_dec(obj);
+        return lean_io_result_mk_error(lean_decode_uv_error(result, cmd));
+    }
+
+    process->m_pid = (uint32_t)process->m_uv_process->pid;
+
+    // The event loop must keep the child alive until it exits.
+    lean_inc(obj);
+
+    event_loop_unlock(&global_ev);
+
+    return lean_io_result_mk_ok(obj);
+}
+
+/* Std.Internal.UV.Process.Child.wait (child : @& Child) : IO (IO.Promise UInt32) */
+extern "C" LEAN_EXPORT lean_obj_res lean_uv_process_wait(b_obj_arg child) {
+    lean_uv_process_object* process = lean_to_uv_process(child);
+    lean_inc(process->m_promise_exit);
+    return lean_io_result_mk_ok(process->m_promise_exit);
+}
+
+/* Std.Internal.UV.Process.Child.pid (child : @& Child) : UInt32 */
+extern "C" LEAN_EXPORT uint32_t lean_uv_process_pid(b_obj_arg child) {
+    return lean_to_uv_process(child)->m_pid;
+}
+
+/* Std.Internal.UV.Process.Child.kill (child : @& Child) (signum : Int32) : IO Unit */
+extern "C" LEAN_EXPORT lean_obj_res lean_uv_process_kill(b_obj_arg child, int32_t signum) {
+    lean_uv_process_object* process = lean_to_uv_process(child);
+
+    event_loop_lock(&global_ev);
+    int result = uv_process_kill(process->m_uv_process, signum);
+    event_loop_unlock(&global_ev);
+
+    if (result < 0) {
+        return lean_io_result_mk_error(lean_decode_uv_error(result, nullptr));
+    }
+
+    return lean_io_result_mk_ok(lean_box(0));
+}
+
+/* Std.Internal.UV.Process.Child.send (child : @& Child) (data : Array ByteArray) : IO (IO.Promise (Except IO.Error Unit)) */
+extern "C" LEAN_EXPORT lean_obj_res lean_uv_process_send(b_obj_arg child, obj_arg data_array) {
+    lean_uv_process_object* process = lean_to_uv_process(child);
+
+    if (process->m_stdio[0] == nullptr) {
+        lean_dec(data_array);
+        return lean_io_result_mk_error(lean_decode_uv_error(UV_EBADF, nullptr));
+    }
+
+    size_t array_len = lean_array_size(data_array);
+
+    if (array_len == 0) {
+        lean_dec(data_array);
+
+        lean_object* promise = lean_promise_new();
+        mark_mt(promise);
+        lean_promise_resolve_with_code(0, promise);
+
+        return lean_io_result_mk_ok(promise);
+    }
+
+    uv_buf_t* bufs = (uv_buf_t*)malloc(array_len * sizeof(uv_buf_t));
+
+    for (size_t i = 0; i < array_len; i++) {
+        lean_object* byte_array = lean_array_get_core(data_array, i);
+        bufs[i] = uv_buf_init((char*)lean_sarray_cptr(byte_array), lean_sarray_size(byte_array));
+    }
+
+    lean_object* promise = lean_promise_new();
+    mark_mt(promise);
+
+    uv_write_t* write_uv = (uv_write_t*)malloc(sizeof(uv_write_t));
+    process_send_data* send_data = (process_send_data*)malloc(sizeof(process_send_data));
+    write_uv->data = send_data;
+
+    send_data->promise = promise;
+    send_data->data = data_array;
+    send_data->child = child;
+    send_data->bufs = bufs;
+
+    // These objects are going to enter the loop and be owned by it
+    lean_inc(promise);
+    lean_inc(child);
+
+    event_loop_lock(&global_ev);
+
+    int result = uv_write(write_uv, (uv_stream_t*)process->m_stdio[0], bufs, array_len, [](uv_write_t* req, int status) {
+        process_send_data* tup = (process_send_data*) req->data;
+
+        lean_promise_resolve_with_code(status, tup->promise);
+
+        lean_dec(tup->promise);
+        lean_dec(tup->data);
+        lean_dec(tup->child);
+
+        free(tup->bufs);
+        free(req->data);
+        free(req);
+    });
+
+    event_loop_unlock(&global_ev);
+
+    if (result < 0) {
+        lean_dec(promise); // The structure does not own it.
+        lean_dec(promise); // We are not going to return it.
+        lean_dec(child);
+        lean_dec(data_array);
+        free(bufs);
+
+        free(write_uv->data);
+        free(write_uv);
+
+        return lean_io_result_mk_error(lean_decode_uv_error(result, nullptr));
+    }
+
+    return lean_io_result_mk_ok(promise);
+}
+
+/* Std.Internal.UV.Process.Child.shutdownStdin (child : @& Child) : IO (IO.Promise (Except IO.Error Unit)) */
+extern "C" LEAN_EXPORT lean_obj_res lean_uv_process_shutdown_stdin(b_obj_arg child) {
+    lean_uv_process_object* process = lean_to_uv_process(child);
+
+    if (process->m_stdio[0] == nullptr) {
+        return lean_io_result_mk_error(lean_decode_uv_error(UV_EBADF, nullptr));
+    }
+
+    // Locking early prevents potential parallelism issues setting the m_promise_shutdown.
+    event_loop_lock(&global_ev);
+
+    if (process->m_promise_shutdown != nullptr) {
+        event_loop_unlock(&global_ev);
+        return lean_io_result_mk_error(lean_decode_uv_error(UV_EALREADY, mk_string("shutdown already in progress")));
+    }
+
+    lean_object* promise = lean_promise_new();
+    mark_mt(promise);
+
+    process->m_promise_shutdown = promise;
+    lean_inc(promise);
+
+    uv_shutdown_t* shutdown_req = (uv_shutdown_t*)malloc(sizeof(uv_shutdown_t));
+    shutdown_req->data = (void*)child;
+
+    lean_inc(child);
+
+    int result = uv_shutdown(shutdown_req, (uv_stream_t*)process->m_stdio[0], [](uv_shutdown_t* req, int status) {
+        lean_uv_process_object* process = lean_to_uv_process((lean_object*)req->data);
+
+        lean_promise_resolve_with_code(status, process->m_promise_shutdown);
+        lean_dec(process->m_promise_shutdown);
+        process->m_promise_shutdown = nullptr;
+
+        lean_dec((lean_object*)req->data);
+        free(req);
+    });
+
+    if (result < 0) {
+        free(shutdown_req);
+        lean_dec(process->m_promise_shutdown);
+        process->m_promise_shutdown = nullptr;
+        event_loop_unlock(&global_ev);
+
+        lean_dec(promise);
+        lean_dec(child);
+
+        return lean_io_result_mk_error(lean_decode_uv_error(result, nullptr));
+    }
+
+    event_loop_unlock(&global_ev);
+
+    return lean_io_result_mk_ok(promise);
+}
+
+/* Std.Internal.UV.Process.Child.recv? (child : @& Child) (stream : UInt8) (size : UInt64) : IO (IO.Promise (Except IO.Error (Option ByteArray))) */
+extern "C" LEAN_EXPORT lean_obj_res lean_uv_process_recv(b_obj_arg child, uint8_t stream, uint64_t buffer_size) {
+    lean_uv_process_object* process = lean_to_uv_process(child);
+
+    if (stream < 1 || stream > 2 || process->m_stdio[stream] == nullptr) {
+        return lean_io_result_mk_error(lean_decode_uv_error(UV_EBADF, nullptr));
+    }
+
+    // Locking early prevents potential parallelism issues setting the byte_array.
+    event_loop_lock(&global_ev);
+
+    if (process->m_promise_read[stream] != nullptr) {
+        event_loop_unlock(&global_ev);
+        return lean_io_result_mk_error(lean_decode_uv_error(UV_EALREADY, nullptr));
+    }
+
+    lean_object* byte_array = lean_alloc_sarray(1, 0, buffer_size);
+    process->m_byte_array[stream] = byte_array;
+
+    lean_object* promise = lean_promise_new();
+    mark_mt(promise);
+
+    process->m_promise_read[stream] = promise;
+
+    // The event loop owns the child.
+    lean_inc(child);
+    lean_inc(promise);
+
+    int result = uv_read_start((uv_stream_t*)process->m_stdio[stream], [](uv_handle_t* handle, size_t suggested_size, uv_buf_t* buf) {
+        lean_uv_process_object* process = lean_to_uv_process((lean_object*)handle->data);
+        int i = process_stream_index(process, (uv_stream_t*)handle);
+
+        buf->base = (char*)lean_sarray_cptr(process->m_byte_array[i]);
+        buf->len = lean_sarray_capacity(process->m_byte_array[i]);
+    }, [](uv_stream_t* stream, ssize_t nread, const uv_buf_t* buf) {
+        // No data was read yet, the buffer can be reused for the next attempt.
+        if (nread == 0) return;
+
+        uv_read_stop(stream);
+
+        lean_uv_process_object* process = lean_to_uv_process((lean_object*)stream->data);
+        int i = process_stream_index(process, stream);
+        lean_object* promise = process->m_promise_read[i];
+        lean_object* byte_array = process->m_byte_array[i];
+
+        process->m_promise_read[i] = nullptr;
+        process->m_byte_array[i] = nullptr;
+
+        if (nread > 0) {
+            lean_sarray_set_size(byte_array, nread);
+            lean_promise_resolve(mk_except_ok(lean::mk_option_some(byte_array)), promise);
+        } else if (nread == UV_EOF) {
+            lean_dec(byte_array);
+            lean_promise_resolve(mk_except_ok(lean::mk_option_none()), promise);
+        } else {
+            lean_dec(byte_array);
+            lean_promise_resolve(mk_except_err(lean_decode_uv_error(nread, nullptr)), promise);
+        }
+
+        lean_dec(promise);
+
+        // The event loop does not own the object anymore.
+        lean_dec((lean_object*)stream->data);
+    });
+
+    if (result < 0) {
+        process->m_byte_array[stream] = nullptr;
+        process->m_promise_read[stream] = nullptr;
+
+        event_loop_unlock(&global_ev);
+
+        lean_dec(byte_array);
+        lean_dec(promise); // The structure does not own it.
+        lean_dec(promise); // We are not going to return it.
+        lean_dec(child);
+
+        return lean_io_result_mk_error(lean_decode_uv_error(result, nullptr));
+    }
+
+    event_loop_unlock(&global_ev);
+
+    return lean_io_result_mk_ok(promise);
+}
+
+/* Std.Internal.UV.Process.Child.cancelRecv (child : @& Child) (stream : UInt8) : IO Unit */
+extern "C" LEAN_EXPORT lean_obj_res lean_uv_process_cancel_recv(b_obj_arg child, uint8_t stream) {
+    lean_uv_process_object* process = lean_to_uv_process(child);
+
+    if (stream < 1 || stream > 2 || process->m_stdio[stream] == nullptr) {
+        return lean_io_result_mk_ok(lean_box(0));
+    }
+
+    event_loop_lock(&global_ev);
+
+    if (process->m_promise_read[stream] == nullptr) {
+        event_loop_unlock(&global_ev);
+        return lean_io_result_mk_ok(lean_box(0));
+    }
+
+    uv_read_stop((uv_stream_t*)process->m_stdio[stream]);
+
+    lean_dec(process->m_promise_read[stream]);
+    process->m_promise_read[stream] = nullptr;
+
+    lean_dec(process->m_byte_array[stream]);
+    process->m_byte_array[stream] = nullptr;
+
+    event_loop_unlock(&global_ev);
+
+    // The event loop does not own the object anymore.
+    lean_dec(child);
+
+    return lean_io_result_mk_ok(lean_box(0));
+}
+
+#else
+
+void initialize_libuv_process() {}
+
+extern "C" LEAN_EXPORT lean_obj_res lean_uv_process_spawn(b_obj_arg args) {
+    lean_always_assert(
+        false && ("Please build a version of Lean4 with libuv to invoke this.")
+    );
+}
+
+extern "C" LEAN_EXPORT lean_obj_res lean_uv_process_wait(b_obj_arg child) {
+    lean_always_assert(
+        false && ("Please build a version of Lean4 with libuv to invoke this.")
+    );
+}
+
+extern "C" LEAN_EXPORT uint32_t lean_uv_process_pid(b_obj_arg child) {
+    lean_always_assert(
+        false && ("Please build a version of Lean4 with libuv to invoke this.")
+    );
+}
+
+extern "C" LEAN_EXPORT lean_obj_res lean_uv_process_kill(b_obj_arg child, int32_t signum) {
+    lean_always_assert(
+        false && ("Please build a version of Lean4 with libuv to invoke this.")
+    );
+}
+
+extern "C" LEAN_EXPORT lean_obj_res lean_uv_process_send(b_obj_arg child, obj_arg data_array) {
+    lean_always_assert(
+        false && ("Please build a version of Lean4 with libuv to invoke this.")
+    );
+}
+
+extern "C" LEAN_EXPORT lean_obj_res lean_uv_process_shutdown_stdin(b_obj_arg child) {
+    lean_always_assert(
+        false && ("Please build a version of Lean4 with libuv to invoke this.")
+    );
+}
+
+extern "C" LEAN_EXPORT lean_obj_res lean_uv_process_recv(b_obj_arg child, uint8_t stream, uint64_t buffer_size) {
+    lean_always_assert(
+        false && ("Please build a version of Lean4 with libuv to invoke this.")
+    );
+}
+
+extern "C" LEAN_EXPORT lean_obj_res lean_uv_process_cancel_recv(b_obj_arg child, uint8_t stream) {
+    lean_always_assert(
+        false && ("Please build a version of Lean4 with libuv to invoke this.")
+    );
+}
+
+#endif
+}
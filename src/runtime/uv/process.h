@@ -0,0 +1,53 @@
+/*
+Copyright (c) 2025 Lean FRO, LLC. All rights reserved.
+Released under Apache 2.0 license as described in the file LICENSE.
+*/
+#pragma once
+#include <lean/lean.h>
+#include "runtime/uv/event_loop.h"
+#include "runtime/object_ref.h"
+
+#ifndef LEAN_EMSCRIPTEN
+#include <uv.h>
+#endif
+
+namespace lean {
+
+static lean_external_class * g_uv_process_external_class = NULL;
+void initialize_libuv_process();
+
+#ifndef LEAN_EMSCRIPTEN
+using namespace std;
+
+// Structure for managing a child process spawned on the event loop, including the pipes connected to
+// its standard streams and the promises for asynchronous results.
+typedef struct {
+    uv_process_t * m_uv_process;       // LibUV process handle.
+    uv_pipe_t *    m_stdio[3];         // Pipes connected to stdin, stdout and stderr, `NULL` if not piped.
+    lean_object *  m_promise_exit;     // The promise that is resolved with the exit code of the process.
+    lean_object *  m_promise_read[3];  // The promises for asynchronous reads from stdout and stderr.
+    lean_object *  m_byte_array[3];    // Buffers for storing data received from stdout and stderr.
+    lean_object *  m_promise_shutdown; // The promise for asynchronously closing stdin.
+    uint32_t       m_pid;              // The process id of the child.
+    unsigned       m_pending_closes;   // Number of handles that still have to be closed before freeing.
+} lean_uv_process_object;
+
+// =======================================
+// Process object manipulation functions.
+static inline lean_object * lean_uv_process_new(lean_uv_process_object * s) { return lean_alloc_external(g_uv_process_external_class, s); }
+static inline lean_uv_process_object * lean_to_uv_process(lean_object * o) { return (lean_uv_process_object*)(lean_get_external_data(o)); }
+
+#endif
+
+// =======================================
+// Process manipulation functions
+extern "C" LEAN_EXPORT lean_obj_res lean_uv_process_spawn(b_obj_arg args);
+extern "C" LEAN_EXPORT lean_obj_res lean_uv_process_wait(b_obj_arg child);
+extern "C" LEAN_EXPORT uint32_t lean_uv_process_pid(b_obj_arg child);
+extern "C" LEAN_EXPORT lean_obj_res lean_uv_process_kill(b_obj_arg child, int32_t signum);
+extern "C" LEAN_EXPORT lean_obj_res lean_uv_process_send(b_obj_arg child, obj_arg data_array);
+extern "C" LEAN_EXPORT lean_obj_res lean_uv_process_shutdown_stdin(b_obj_arg child);
+extern "C" LEAN_EXPORT lean_obj_res lean_uv_process_recv(b_obj_arg child, uint8_t stream, uint64_t buffer_size);
+extern "C" LEAN_EXPORT lean_obj_res lean_uv_process_cancel_recv(b_obj_arg child, uint8_t stream);
+
+}
@@ -4,6 +4,8 @@ Released under Apache 2.0 license as described in the file LICENSE.
 
 Author: Sofia Rodrigues, Henrik Böving
 */
+#include <vector>
+#include <algorithm>
 #include "runtime/uv/timer.h"
 
 namespace lean {
@@ -11,94 +13,324 @@ namespace lean {
 
 using namespace std;
 
-// The finalizer of the `Timer`.
-void lean_uv_timer_finalizer(void* ptr) {
-    lean_uv_timer_object * timer = (lean_uv_timer_object*) ptr;
+// =======================================
+// Timer wheel
+
+// All running timers are kept in a hierarchical timing wheel that is driven by a single `uv_timer_t`.
+// Time is divided into ticks of `m_resolution` milliseconds. The root level has one slot per tick for
+// the next `TIMER_ROOT_SIZE` ticks, every further level covers `TIMER_LEVEL_SIZE` times the range of
+// the previous one. Timers on the outer levels are cascaded towards the root whenever the wheel
+// passes the start of their slot. Arming and cancelling a timer only links or unlinks it from a slot
+// and does not require the event loop lock unless the libuv timer has to be moved to an earlier time.
+#define TIMER_ROOT_BITS 8
+#define TIMER_LEVEL_BITS 6
+#define TIMER_LEVELS 3
+#define TIMER_ROOT_SIZE (1u << TIMER_ROOT_BITS)
+#define TIMER_LEVEL_SIZE (1u << TIMER_LEVEL_BITS)
+#define TIMER_ROOT_MASK (TIMER_ROOT_SIZE - 1)
+#define TIMER_LEVEL_MASK (TIMER_LEVEL_SIZE - 1)
+#define TIMER_NO_TICK UINT64_MAX
+
+struct timer_wheel {
+    uv_timer_t             m_uv_timer;    // The libuv timer that is set to the next interesting tick.
+    uv_mutex_t             m_mutex;       // Protects the wheel and the state of all timers.
+    uint64_t               m_resolution;  // Length of a tick in milliseconds.
+    uint64_t               m_tick;        // The next tick that has to be processed.
+    uint64_t               m_scheduled;   // The tick `m_uv_timer` is set to, `TIMER_NO_TICK` if stopped.
+    size_t                 m_count;       // Number of timers in the wheel.
+    lean_uv_timer_object * m_root[TIMER_ROOT_SIZE];
+    lean_uv_timer_object * m_levels[TIMER_LEVELS][TIMER_LEVEL_SIZE];
+};
+
+static timer_wheel g_timer_wheel;
+
+static inline unsigned timer_level_shift(unsigned level) {
+    return TIMER_ROOT_BITS + level * TIMER_LEVEL_BITS;
+}
 
-    /// The timer can be null in two states, it has not started and it got cancelled.
-    if (timer->m_promise != NULL) {
-        lean_dec(timer->m_promise);
+static inline uint64_t timer_now_ms() {
+    return uv_hrtime() / 1000000;
+}
+
+static inline uint64_t timer_now_tick() {
+    return timer_now_ms() / g_timer_wheel.m_resolution;
+}
+
+// The first tick at which `timeout` milliseconds from now have certainly elapsed.
+static inline uint64_t timer_deadline(uint64_t timeout) {
+    uint64_t res = g_timer_wheel.m_resolution;
+    return (timer_now_ms() + timeout + res - 1) / res;
+}
+
+static void timer_wheel_link(lean_uv_timer_object ** slot, lean_uv_timer_object * timer) {
+    timer->m_next = *slot;
+    if (*slot != NULL) (*slot)->m_pprev = &timer->m_next;
+    *slot = timer;
+    timer->m_pprev = slot;
+}
+
+// Must be called with `m_mutex` held.
+static void timer_wheel_add(lean_uv_timer_object * timer) {
+    timer_wheel & w = g_timer_wheel;
+    if (w.m_count == 0) {
+        // Nothing has to be processed while the wheel is empty, so it can skip ahead to the present.
+        w.m_tick = std::max(w.m_tick, timer_now_tick());
     }
+    w.m_count++;
 
-    event_loop_lock(&global_ev);
+    uint64_t expires = std::max(timer->m_expires, w.m_tick);
+    uint64_t idx = expires - w.m_tick;
+    if (idx < TIMER_ROOT_SIZE) {
+        timer_wheel_link(&w.m_root[expires & TIMER_ROOT_MASK], timer);
+        return;
+    }
+    for (unsigned level = 0; level < TIMER_LEVELS; level++) {
+        uint64_t range = 1ull << timer_level_shift(level + 1);
+        if (idx < range || level == TIMER_LEVELS - 1) {
+            // Timers beyond the range of the wheel are put into the farthest slot and get
+            // reinserted when it is cascaded.
+            if (idx >= range) expires = w.m_tick + range - 1;
+            uint64_t slot = (expires >> timer_level_shift(level)) & TIMER_LEVEL_MASK;
+            timer_wheel_link(&w.m_levels[level][slot], timer);
+            return;
+        }
+    }
+}
 
-    uv_close((uv_handle_t*)timer->m_uv_timer, [](uv_handle_t* handle) {
-        free(handle);
-    });
+// Must be called with `m_mutex` held.
+static void timer_wheel_remove(lean_uv_timer_object * timer) {
+    lean_assert(timer->m_pprev != NULL);
+    *timer->m_pprev = timer->m_next;
+    if (timer->m_next != NULL) timer->m_next->m_pprev = timer->m_pprev;
+    timer->m_next = NULL;
+    timer->m_pprev = NULL;
+    g_timer_wheel.m_count--;
+}
 
-    event_loop_unlock(&global_ev);
+// Detach the whole list of `slot` from the wheel.
+static lean_uv_timer_object * timer_wheel_take(lean_uv_timer_object ** slot) {
+    lean_uv_timer_object * list = *slot;
+    *slot = NULL;
+    for (lean_uv_timer_object * t = list; t != NULL; t = t->m_next) {
+        t->m_pprev = NULL;
+        g_timer_wheel.m_count--;
+    }
+    return list;
+}
 
-    free(timer);
+// Returns the first tick at or after `m_tick` at which a timer may expire or a non-empty slot has to
+// be cascaded, or `TIMER_NO_TICK` if the wheel is empty. Must be called with `m_mutex` held.
+static uint64_t timer_wheel_next_tick() {
+    timer_wheel & w = g_timer_wheel;
+    if (w.m_count == 0) return TIMER_NO_TICK;
+
+    uint64_t next = TIMER_NO_TICK;
+    for (uint64_t i = 0; i < TIMER_ROOT_SIZE; i++) {
+        if (w.m_root[(w.m_tick + i) & TIMER_ROOT_MASK] != NULL) {
+            next = w.m_tick + i;
+            break;
+        }
+    }
+    for (unsigned level = 0; level < TIMER_LEVELS; level++) {
+        unsigned shift = timer_level_shift(level);
+        // The first slot start of this level that is not before `m_tick`.
+        uint64_t first = (w.m_tick + (1ull << shift) - 1) >> shift;
+        for (uint64_t i = 0; i < TIMER_LEVEL_SIZE; i++) {
+            uint64_t start = (first + i) << shift;
+            if (start >= next) break;
+            if (w.m_levels[level][(first + i) & TIMER_LEVEL_MASK] != NULL) {
+                next = start;
+                break;
+            }
+        }
+    }
+    return next;
 }
 
-void initialize_libuv_timer() {
-    g_uv_timer_external_class = lean_register_external_class(lean_uv_timer_finalizer, [](void* obj, lean_object* f) {
-        if (((lean_uv_timer_object*)obj)->m_promise != NULL) {
-            lean_inc(f);
-            lean_apply_1(f, ((lean_uv_timer_object*)obj)->m_promise);
+static void handle_timer_wheel_event(uv_timer_t * handle);
+
+// Moves the libuv timer to the next interesting tick of the wheel. Must be called with the event
+// loop lock and `m_mutex` held.
+static void timer_wheel_schedule() {
+    timer_wheel & w = g_timer_wheel;
+    uint64_t next = timer_wheel_next_tick();
+    if (next == TIMER_NO_TICK) {
+        uv_timer_stop(&w.m_uv_timer);
+        w.m_scheduled = TIMER_NO_TICK;
+        return;
+    }
+    uint64_t now = timer_now_ms();
+    uint64_t due = next * w.m_resolution;
+    uv_timer_start(&w.m_uv_timer, handle_timer_wheel_event, due > now ? due - now : 0, 0);
+    w.m_scheduled = next;
+}
+
+// Link a timer into the wheel and make sure the libuv timer fires early enough for it.
+// Must be called with `m_mutex` held, releases it.
+static void timer_wheel_arm_and_unlock(lean_uv_timer_object * timer) {
+    timer_wheel & w = g_timer_wheel;
+    timer_wheel_add(timer);
+    bool reschedule = timer->m_expires < w.m_scheduled;
+    uv_mutex_unlock(&w.m_mutex);
+
+    if (reschedule) {
+        event_loop_lock(&global_ev);
+        uv_mutex_lock(&w.m_mutex);
+        if (w.m_count > 0 && timer_wheel_next_tick() < w.m_scheduled) {
+            timer_wheel_schedule();
         }
-    });
+        uv_mutex_unlock(&w.m_mutex);
+        event_loop_unlock(&global_ev);
+    }
 }
 
 static bool timer_promise_is_finished(lean_uv_timer_object * timer) {
     return lean_io_get_task_state_core((lean_object *)lean_to_promise(timer->m_promise)->m_result) == 2;
 }
 
-void handle_timer_event(uv_timer_t* handle) {
-    lean_object * obj = (lean_object*)handle->data;
-    lean_uv_timer_object * timer = lean_to_uv_timer(obj);
-
-    // handle_timer_event may only be called while the timer is running. The promise can be NULL
-    // if the last promise was cancelled.
+// Called when the wheel reaches the expiry tick of `timer`. Promises that have to be resolved and
+// timer objects that are no longer kept alive by the loop are collected, so that this can happen
+// after `m_mutex` has been released.
+static void handle_timer_expired(lean_uv_timer_object * timer, vector<lean_object *> & resolve, vector<lean_object *> & release) {
+    // A timer only expires while it is running. The promise can be NULL if the last promise
+    // was cancelled.
     lean_assert(timer->m_state == TIMER_STATE_RUNNING);
 
-   if (timer->m_repeating) {
+    if (timer->m_repeating) {
         // For repeating timers, only resolves if the promise exists and is not finished
         if (timer->m_promise != NULL && !timer_promise_is_finished(timer)) {
-            lean_object* res = lean_io_promise_resolve(lean_box(0), timer->m_promise);
-            lean_dec(res);
+            lean_inc(timer->m_promise);
+            resolve.push_back(timer->m_promise);
         }
+        // The wheel has already advanced past the tick the timer expired on.
+        uint64_t res = g_timer_wheel.m_resolution;
+        timer->m_expires = g_timer_wheel.m_tick - 1 + std::max<uint64_t>(1, (timer->m_timeout + res - 1) / res);
+        timer_wheel_add(timer);
     } else {
         // For non-repeating timers, resolves if the promise exists
         if (timer->m_promise != NULL) {
             lean_assert(!timer_promise_is_finished(timer));
-            lean_object* res = lean_io_promise_resolve(lean_box(0), timer->m_promise);
-            lean_dec(res);
+            lean_inc(timer->m_promise);
+            resolve.push_back(timer->m_promise);
         }
 
-        uv_timer_stop(timer->m_uv_timer);
         timer->m_state = TIMER_STATE_FINISHED;
 
         // The loop does not need to keep the timer alive anymore.
+        release.push_back(timer->m_self);
+    }
+}
+
+// Process all ticks up to and including `now`. Must be called with `m_mutex` held.
+static void timer_wheel_run(uint64_t now, vector<lean_object *> & resolve, vector<lean_object *> & release) {
+    timer_wheel & w = g_timer_wheel;
+    while (w.m_tick <= now) {
+        uint64_t next = timer_wheel_next_tick();
+        if (next > now) {
+            w.m_tick = now + 1;
+            break;
+        }
+        // Nothing happens on the ticks in between.
+        w.m_tick = next;
+
+        if ((w.m_tick & TIMER_ROOT_MASK) == 0) {
+            for (unsigned level = 0; level < TIMER_LEVELS; level++) {
+                uint64_t idx = (w.m_tick >> timer_level_shift(level)) & TIMER_LEVEL_MASK;
+                lean_uv_timer_object * t = timer_wheel_take(&w.m_levels[level][idx]);
+                while (t != NULL) {
+                    lean_uv_timer_object * n = t->m_next;
+                    timer_wheel_add(t);
+                    t = n;
+                }
+                if (idx != 0) break;
+            }
+        }
+
+        lean_uv_timer_object * t = timer_wheel_take(&w.m_root[w.m_tick & TIMER_ROOT_MASK]);
+        // Advance first so that repeating timers are rearmed for a later tick.
+        w.m_tick++;
+        while (t != NULL) {
+            lean_uv_timer_object * n = t->m_next;
+            t->m_next = NULL;
+            handle_timer_expired(t, resolve, release);
+            t = n;
+        }
+    }
+}
+
+static void handle_timer_wheel_event(uv_timer_t * handle) {
+    timer_wheel & w = g_timer_wheel;
+    vector<lean_object *> resolve;
+    vector<lean_object *> release;
+
+    uv_mutex_lock(&w.m_mutex);
+    timer_wheel_run(timer_now_tick(), resolve, release);
+    timer_wheel_schedule();
+    uv_mutex_unlock(&w.m_mutex);
+
+    for (lean_object * promise : resolve) {
+        lean_object* res = lean_io_promise_resolve(lean_box(0), promise);
+        lean_dec(res);
+        lean_dec(promise);
+    }
+    for (lean_object * obj : release) {
         lean_dec(obj);
     }
 }
 
+// =======================================
+// Timer objects
+
+// The finalizer of the `Timer`.
+void lean_uv_timer_finalizer(void* ptr) {
+    lean_uv_timer_object * timer = (lean_uv_timer_object*) ptr;
+
+    // The wheel keeps running timers alive.
+    lean_assert(timer->m_pprev == NULL);
+
+    /// The timer can be null in two states, it has not started and it got cancelled.
+    if (timer->m_promise != NULL) {
+        lean_dec(timer->m_promise);
+    }
+
+    free(timer);
+}
+
+void initialize_libuv_timer() {
+    g_uv_timer_external_class = lean_register_external_class(lean_uv_timer_finalizer, [](void* obj, lean_object* f) {
+        if (((lean_uv_timer_object*)obj)->m_promise != NULL) {
+            lean_inc(f);
+            lean_apply_1(f, ((lean_uv_timer_object*)obj)->m_promise);
+        }
+    });
+
+    timer_wheel & w = g_timer_wheel;
+    uv_mutex_init(&w.m_mutex);
+    w.m_resolution = 1;
+    w.m_tick = 0;
+    w.m_scheduled = TIMER_NO_TICK;
+    w.m_count = 0;
+    for (auto & slot : w.m_root) slot = NULL;
+    for (auto & level : w.m_levels)
+        for (auto & slot : level) slot = NULL;
+    // The event loop is initialized before the timers.
+    uv_timer_init(global_ev.loop, &w.m_uv_timer);
+}
+
 /* Std.Internal.UV.Timer.mk (timeout : UInt64) (repeating : Bool) : IO Timer */
 extern "C" LEAN_EXPORT lean_obj_res lean_uv_timer_mk(uint64_t timeout, uint8_t repeating) {
     lean_uv_timer_object * timer = (lean_uv_timer_object*)malloc(sizeof(lean_uv_timer_object));
+    timer->m_next = NULL;
+    timer->m_pprev = NULL;
+    timer->m_expires = 0;
     timer->m_timeout = timeout;
     timer->m_repeating = repeating;
     timer->m_state = TIMER_STATE_INITIAL;
     timer->m_promise = NULL;
 
-    uv_timer_t * uv_timer = (uv_timer_t*)malloc(sizeof(uv_timer_t));
-
-    event_loop_lock(&global_ev);
-    int result = uv_timer_init(global_ev.loop, uv_timer);
-    event_loop_unlock(&global_ev);
-
-    if (result != 0) {
-        free(uv_timer);
-        free(timer);
-        return lean_io_result_mk_error(lean_decode_uv_error(result, NULL));
-    }
-
-    timer->m_uv_timer = uv_timer;
-
     lean_object * obj = lean_uv_timer_new(timer);
     lean_mark_mt(obj);
-    timer->m_uv_timer->data = obj;
+    timer->m_self = obj;
 
     return lean_io_result_mk_ok(obj);
 }
@@ -120,25 +352,16 @@ extern "C" LEAN_EXPORT lean_obj_res lean_uv_timer_next(b_obj_arg obj) {
         // The event loop must keep the timer alive for the duration of the run time.
         lean_inc(obj);
 
-        int result = uv_timer_start(
-            timer->m_uv_timer,
-            handle_timer_event,
-            timer->m_repeating ? 0 : timer->m_timeout,
-            timer->m_repeating ? timer->m_timeout : 0
-        );
-
-        event_loop_unlock(&global_ev);
+        // Repeating timers resolve right away for the 0th multiple of the timeout.
+        timer->m_expires = timer_deadline(timer->m_repeating ? 0 : timer->m_timeout);
 
-        if (result != 0) {
-            lean_dec(obj);
-            return lean_io_result_mk_error(lean_decode_uv_error(result, NULL));
-        } else {
-            lean_inc(timer->m_promise);
-            return lean_io_result_mk_ok(timer->m_promise);
-        }
+        lean_object * promise = timer->m_promise;
+        lean_inc(promise);
+        timer_wheel_arm_and_unlock(timer);
+        return lean_io_result_mk_ok(promise);
     };
 
-    event_loop_lock(&global_ev);
+    uv_mutex_lock(&g_timer_wheel.m_mutex);
 
     if (timer->m_repeating) {
         switch (timer->m_state) {
@@ -156,22 +379,24 @@ extern "C" LEAN_EXPORT lean_obj_res lean_uv_timer_next(b_obj_arg obj) {
                         timer->m_promise = create_promise();
                     }
 
-                    lean_inc(timer->m_promise);
+                    lean_object* promise = timer->m_promise;
+                    lean_inc(promise);
 
-                    event_loop_unlock(&global_ev);
+                    uv_mutex_unlock(&g_timer_wheel.m_mutex);
 
-                    return lean_io_result_mk_ok(timer->m_promise);
+                    return lean_io_result_mk_ok(promise);
                 }
             case TIMER_STATE_FINISHED:
                 {
                     if (timer->m_promise != NULL) {
-                        lean_inc(timer->m_promise);
-                        event_loop_unlock(&global_ev);
-                        return lean_io_result_mk_ok(timer->m_promise);
+                        lean_object* promise = timer->m_promise;
+                        lean_inc(promise);
+                        uv_mutex_unlock(&g_timer_wheel.m_mutex);
+                        return lean_io_result_mk_ok(promise);
                     } else {
                         // Creates a resolved promise
                         lean_object* finished_promise = create_promise();
-                        event_loop_unlock(&global_ev);
+                        uv_mutex_unlock(&g_timer_wheel.m_mutex);
                         return lean_io_result_mk_ok(finished_promise);
                     }
                 }
@@ -182,10 +407,10 @@ extern "C" LEAN_EXPORT lean_obj_res lean_uv_timer_next(b_obj_arg obj) {
         } else if (timer->m_promise != NULL) {
             lean_inc(timer->m_promise);
             lean_object* promise = timer->m_promise;
-            event_loop_unlock(&global_ev);
+            uv_mutex_unlock(&g_timer_wheel.m_mutex);
             return lean_io_result_mk_ok(promise);
         } else {
-            event_loop_unlock(&global_ev);
+            uv_mutex_unlock(&g_timer_wheel.m_mutex);
             // Creates a resolved promise
             lean_object* finished_promise = create_promise();
             return lean_io_result_mk_ok(finished_promise);
@@ -198,30 +423,17 @@ extern "C" LEAN_EXPORT lean_obj_res lean_uv_timer_reset(b_obj_arg obj) {
     lean_uv_timer_object * timer = lean_to_uv_timer(obj);
 
     // Locking to access the state in order to avoid data-race
-    event_loop_lock(&global_ev);
+    uv_mutex_lock(&g_timer_wheel.m_mutex);
 
     if (timer->m_state == TIMER_STATE_RUNNING) {
-
-        uv_timer_stop(timer->m_uv_timer);
-
-        int result = uv_timer_start(
-            timer->m_uv_timer,
-            handle_timer_event,
-            timer->m_timeout,
-            timer->m_repeating ? timer->m_timeout : 0
-        );
-
-        event_loop_unlock(&global_ev);
-
-        if (result != 0) {
-            return lean_io_result_mk_error(lean_decode_uv_error(result, NULL));
-        } else {
-            return lean_io_result_mk_ok(lean_box(0));
-        }
+        timer_wheel_remove(timer);
+        timer->m_expires = timer_deadline(timer->m_timeout);
+        timer_wheel_arm_and_unlock(timer);
     } else {
-        event_loop_unlock(&global_ev);
-        return lean_io_result_mk_ok(lean_box(0));
+        uv_mutex_unlock(&g_timer_wheel.m_mutex);
     }
+
+    return lean_io_result_mk_ok(lean_box(0));
 }
 
 /* Std.Internal.UV.Timer.stop (timer : @& Timer) : IO Unit */
@@ -229,7 +441,7 @@ extern "C" LEAN_EXPORT lean_obj_res lean_uv_timer_stop(b_obj_arg obj) {
     lean_uv_timer_object * timer = lean_to_uv_timer(obj);
 
     // Locking to access the state in order to avoid data-race
-    event_loop_lock(&global_ev);
+    uv_mutex_lock(&g_timer_wheel.m_mutex);
 
     if (timer->m_promise != NULL) {
         lean_dec(timer->m_promise);
@@ -237,10 +449,10 @@ extern "C" LEAN_EXPORT lean_obj_res lean_uv_timer_stop(b_obj_arg obj) {
     }
 
     if (timer->m_state == TIMER_STATE_RUNNING) {
-        uv_timer_stop(timer->m_uv_timer);
-        event_loop_unlock(&global_ev);
-
+        // The libuv timer is left as is, firing without expired timers is harmless.
+        timer_wheel_remove(timer);
         timer->m_state = TIMER_STATE_FINISHED;
+        uv_mutex_unlock(&g_timer_wheel.m_mutex);
 
         // The loop does not need to keep the timer alive anymore.
         lean_dec(obj);
@@ -248,7 +460,7 @@ extern "C" LEAN_EXPORT lean_obj_res lean_uv_timer_stop(b_obj_arg obj) {
         return lean_io_result_mk_ok(lean_box(0));
     }
 
-    event_loop_unlock(&global_ev);
+    uv_mutex_unlock(&g_timer_wheel.m_mutex);
     return lean_io_result_mk_ok(lean_box(0));
 }
 
@@ -257,24 +469,70 @@ extern "C" LEAN_EXPORT lean_obj_res lean_uv_timer_cancel(b_obj_arg obj) {
     lean_uv_timer_object * timer = lean_to_uv_timer(obj);
 
     // It's locking here to avoid changing the state during other operations.
-    event_loop_lock(&global_ev);
+    uv_mutex_lock(&g_timer_wheel.m_mutex);
 
     if (timer->m_state == TIMER_STATE_RUNNING && timer->m_promise != NULL) {
         if (timer->m_repeating) {
             lean_dec(timer->m_promise);
             timer->m_promise = NULL;
         } else {
-            uv_timer_stop(timer->m_uv_timer);
+            timer_wheel_remove(timer);
 
             lean_dec(timer->m_promise);
             timer->m_promise = NULL;
             timer->m_state = TIMER_STATE_INITIAL;
 
+            uv_mutex_unlock(&g_timer_wheel.m_mutex);
+
             // The loop does not need to keep the timer alive anymore.
             lean_dec(obj);
+
+            return lean_io_result_mk_ok(lean_box(0));
         }
     }
 
+    uv_mutex_unlock(&g_timer_wheel.m_mutex);
+
+    return lean_io_result_mk_ok(lean_box(0));
+}
+
+/* Std.Internal.UV.Timer.setResolution (resolution : UInt64) : IO Unit */
+extern "C" LEAN_EXPORT lean_obj_res lean_uv_timer_set_resolution(uint64_t resolution) {
+    if (resolution == 0) {
+        return lean_io_result_mk_error(lean_mk_io_error_invalid_argument(EINVAL, mk_string("timer resolution must be positive")));
+    }
+
+    timer_wheel & w = g_timer_wheel;
+    event_loop_lock(&global_ev);
+    uv_mutex_lock(&w.m_mutex);
+
+    // Collect all running timers and reinsert them with their deadlines converted to the new ticks.
+    lean_uv_timer_object * all = NULL;
+    auto collect = [&](lean_uv_timer_object ** slot) {
+        lean_uv_timer_object * t = timer_wheel_take(slot);
+        while (t != NULL) {
+            lean_uv_timer_object * n = t->m_next;
+            t->m_next = all;
+            all = t;
+            t = n;
+        }
+    };
+    for (auto & slot : w.m_root) collect(&slot);
+    for (auto & level : w.m_levels)
+        for (auto & slot : level) collect(&slot);
+
+    uint64_t old_resolution = w.m_resolution;
+    w.m_resolution = resolution;
+    w.m_tick = timer_now_tick();
+    while (all != NULL) {
+        lean_uv_timer_object * n = all->m_next;
+        all->m_expires = (all->m_expires * old_resolution + resolution - 1) / resolution;
+        timer_wheel_add(all);
+        all = n;
+    }
+    timer_wheel_schedule();
+
+    uv_mutex_unlock(&w.m_mutex);
     event_loop_unlock(&global_ev);
 
     return lean_io_result_mk_ok(lean_box(0));
@@ -314,5 +572,11 @@ extern "C" LEAN_EXPORT lean_obj_res lean_uv_timer_cancel(b_obj_arg obj) {
     );
 }
 
+extern "C" LEAN_EXPORT lean_obj_res lean_uv_timer_set_resolution(uint64_t resolution) {
+    lean_always_assert(
+        false && ("Please build a version of Lean4 with libuv to invoke this.")
+    );
+}
+
 #endif
 }
@@ -26,10 +26,14 @@ enum uv_timer_state {
     TIMER_STATE_FINISHED,
 };
 
-// Structure for managing a single UV timer object, including promise handling, timeout, and
-// repeating behavior.
-typedef struct {
-    uv_timer_t *    m_uv_timer;    // LibUV timer handle.
+// Structure for managing a single timer, including promise handling, timeout, and repeating behavior.
+// Timers do not own a libuv handle, while running they are linked into the timer wheel that
+// multiplexes all of them onto a single `uv_timer_t` of the event loop.
+typedef struct lean_uv_timer_object {
+    struct lean_uv_timer_object *  m_next;    // Next timer in the same slot of the timer wheel.
+    struct lean_uv_timer_object ** m_pprev;   // Link pointing to this timer, `NULL` if it is not in the wheel.
+    lean_object *   m_self;        // The `Timer` object, the wheel holds a reference to it while linked.
+    uint64_t        m_expires;     // Tick of the timer wheel at which the timer expires.
     lean_object *   m_promise;     // The associated promise for asynchronous results.
     uint64_t        m_timeout;     // Timeout duration in milliseconds.
     bool            m_repeating;   // Flag indicating if the timer is repeating.
@@ -52,6 +56,7 @@ extern "C" LEAN_EXPORT lean_obj_res lean_uv_timer_next(b_obj_arg timer);
 extern "C" LEAN_EXPORT lean_obj_res lean_uv_timer_reset(b_obj_arg timer);
 extern "C" LEAN_EXPORT lean_obj_res lean_uv_timer_stop(b_obj_arg timer);
 extern "C" LEAN_EXPORT lean_obj_res lean_uv_timer_cancel(b_obj_arg timer);
+extern "C" LEAN_EXPORT lean_obj_res lean_uv_timer_set_resolution(uint64_t resolution);
 
 #endif
 
@@ -39,6 +39,10 @@ Author: Leonardo de Moura
 #include "library/print.h"
 #include "initialize/init.h"
 #include "library/ir_interpreter.h"
+#include "library/sampling_profiler.h"
+#include "library/chrome_trace.h"
+#include "library/alloc_profiler.h"
+#include "library/compile_server.h"
 #include "util/path.h"
 #include "stdlib_flags.h"
 #ifdef _MSC_VER
@@ -215,7 +219,11 @@ static struct option g_long_options[] = {
 #endif
     {"plugin",       required_argument, 0, 'p'},
     {"load-dynlib",  required_argument, 0, 'l'},
+    {"sample-profile", required_argument, 0, 'F'},
+    {"chrome-trace", required_argument, 0, 'Y'},
+    {"alloc-profile", required_argument, 0, 'A'},
     {"setup",        required_argument, 0, 'u'},
+    {"compile-server", required_argument, 0, 'K'},
     {"error",        required_argument, 0, 'E'},
     {"json",         no_argument,       &json_output, 1},
     {"print-prefix", no_argument,       &print_prefix, 1},
@@ -383,39 +391,34 @@ static void report_task_get_blocked_time(std::chrono::nanoseconds d) {
     }
 }
 
-extern "C" LEAN_EXPORT int lean_main(int argc, char ** argv) {
-#ifdef LEAN_EMSCRIPTEN
-    // When running in command-line mode under Node.js, we make system directories available in the virtual filesystem.
-    // This mode is used to compile 32-bit oleans.
-    EM_ASM(
-        if ((typeof process === "undefined") || (process.release.name !== "node")) {
-            throw new Error("The Lean command-line driver can only run under Node.js. For the embeddable WASM library, see lean_wasm.cpp.");
-        }
+static int run_lean(int argc, char ** argv, second_duration init_time);
 
-        var lean_path = process.env["LEAN_PATH"];
-        if (lean_path) {
-            ENV["LEAN_PATH"] = lean_path;
-        }
-
-        // We cannot mount /, see https://github.com/emscripten-core/emscripten/issues/2040
-        FS.mount(NODEFS, { root: "/home" }, "/home");
-        FS.mount(NODEFS, { root: "/tmp" }, "/tmp");
-        FS.chdir(process.cwd());
-    );
-#elif defined(LEAN_WINDOWS)
-    // "best practice" according to https://docs.microsoft.com/en-us/windows/win32/api/errhandlingapi/nf-errhandlingapi-seterrormode
-    SetErrorMode(SEM_FAILCRITICALERRORS);
-    // properly formats Unicode characters on the Windows console
-    // see https://github.com/leanprover/lean4/issues/4291
-    SetConsoleOutputCP(CP_UTF8);
+/* Run a request of the compile server, in a process forked from the server. */
+static int run_compile_server_request(std::vector<std::string> const & args) {
+    // reset the state of `getopt_long` and the flags it set when parsing the arguments of the server
+    only_src_deps = print_prefix = print_libdir = json_output = 0;
+#if defined(__GLIBC__)
+    optind = 0;
+#else
+    optreset = 1;
+    optind   = 1;
 #endif
-    auto init_start = std::chrono::steady_clock::now();
-    lean::initializer init;
-    second_duration init_time = std::chrono::steady_clock::now() - init_start;
+    std::vector<char *> argv;
+    for (std::string const & arg : args)
+        argv.push_back(const_cast<char *>(arg.c_str()));
+    argv.push_back(nullptr);
+    return run_lean(static_cast<int>(args.size()), argv.data(), second_duration(0));
+}
+
+static int run_lean(int argc, char ** argv, second_duration init_time) {
     bool run = false;
     optional<std::string> olean_fn;
     optional<std::string> ilean_fn;
     optional<std::string> setup_fn;
+    optional<std::string> sample_profile_fn;
+    optional<std::string> chrome_trace_fn;
+    optional<std::string> alloc_profile_fn;
+    optional<std::string> compile_server_path;
     bool use_stdin = false;
     unsigned trust_lvl = LEAN_BELIEVER_TRUST_LEVEL + 1;
     bool only_deps = false;
@@ -565,10 +568,26 @@ extern "C" LEAN_EXPORT int lean_main(int argc, char ** argv) {
                 lean::load_dynlib(optarg);
                 forwarded_args.push_back(string_ref("--load-dynlib=" + std::string(optarg)));
                 break;
+            case 'F':
+                check_optarg("sample-profile");
+                sample_profile_fn = optarg;
+                break;
+            case 'Y':
+                check_optarg("chrome-trace");
+                chrome_trace_fn = optarg;
+                break;
+            case 'A':
+                check_optarg("alloc-profile");
+                alloc_profile_fn = optarg;
+                break;
             case 'u':
                 check_optarg("u");
                 setup_fn = optarg;
                 break;
+            case 'K':
+                check_optarg("compile-server");
+                compile_server_path = optarg;
+                break;
             case 'E':
                 check_optarg("E");
                 error_kinds.push_back(string_to_name(std::string(optarg)));
@@ -582,11 +601,53 @@ extern "C" LEAN_EXPORT int lean_main(int argc, char ** argv) {
 
     lean::io_mark_end_initialization();
 
+    if (compile_server_path) {
+        try {
+            return run_compile_server(*compile_server_path, run_compile_server_request);
+        } catch (lean::throwable & ex) {
+            std::cerr << "error: " << ex.what() << std::endl;
+            return 1;
+        }
+    }
+
     if (get_profiler(opts)) {
         g_lean_report_task_get_blocked_time = report_task_get_blocked_time;
         report_profiling_time("initialization", init_time);
     }
 
+    // declared first so that the profile is written after all tasks have finished
+    std::unique_ptr<scoped_sampling_profiler> sampling_profiler;
+    if (sample_profile_fn) {
+        try {
+            sampling_profiler.reset(new scoped_sampling_profiler(*sample_profile_fn));
+        } catch (lean::throwable & ex) {
+            std::cerr << "error: " << ex.what() << std::endl;
+            return 1;
+        }
+    }
+    std::unique_ptr<scoped_chrome_trace> chrome_trace;
+    if (chrome_trace_fn) {
+        try {
+            chrome_trace.reset(new scoped_chrome_trace(*chrome_trace_fn));
+        } catch (lean::throwable & ex) {
+            std::cerr << "error: " << ex.what() << std::endl;
+            return 1;
+        }
+    }
+    std::unique_ptr<scoped_alloc_profiler> alloc_profiler;
+    if (alloc_profile_fn) {
+        try {
+            alloc_profiler.reset(new scoped_alloc_profiler(*alloc_profile_fn));
+        } catch (lean::throwable & ex) {
+            std::cerr << "error: " << ex.what() << std::endl;
+            return 1;
+        }
+    }
+
+    // when serving a request of the compile server, the task manager may only be started after `import`
+    num_threads = compile_server_task_workers(num_threads, run_server == 0 && !only_deps && !print_prefix &&
+                                              !print_libdir && !sample_profile_fn && !chrome_trace_fn &&
+                                              !alloc_profile_fn);
     scoped_task_manager scope_task_man(num_threads);
 
     try {
@@ -605,3 +666,40 @@ extern "C" LEAN_EXPORT int lean_main(int argc, char ** argv) {
     }
     return 1;
 }
+
+extern "C" LEAN_EXPORT int lean_main(int argc, char ** argv) {
+#ifdef LEAN_EMSCRIPTEN
+    // When running in command-line mode under Node.js, we make system directories available in the virtual filesystem.
+    // This mode is used to compile 32-bit oleans.
+    EM_ASM(
+        if ((typeof process === "undefined") || (process.release.name !== "node")) {
+            throw new Error("The Lean command-line driver can only run under Node.js. For the embeddable WASM library, see lean_wasm.cpp.");
+        }
+
+        var lean_path = process.env["LEAN_PATH"];
+        if (lean_path) {
+            ENV["LEAN_PATH"] = lean_path;
+        }
+
+        // We cannot mount /, see https://github.com/emscripten-core/emscripten/issues/2040
+        FS.mount(NODEFS, { root: "/home" }, "/home");
+        FS.mount(NODEFS, { root: "/tmp" }, "/tmp");
+        FS.chdir(process.cwd());
+    );
+#elif defined(LEAN_WINDOWS)
+    // "best practice" according to https://docs.microsoft.com/en-us/windows/win32/api/errhandlingapi/nf-errhandlingapi-seterrormode
+    SetErrorMode(SEM_FAILCRITICALERRORS);
+    // properly formats Unicode characters on the Windows console
+    // see https://github.com/leanprover/lean4/issues/4291
+    SetConsoleOutputCP(CP_UTF8);
+#endif
+    // forward the command line to a compile server, if any, before spending time on initialization
+    if (char const * compile_server = getenv("LEAN_COMPILE_SERVER")) {
+        if (optional<int> code = run_compile_server_client(compile_server, argc, argv))
+            return *code;
+    }
+    auto init_start = std::chrono::steady_clock::now();
+    lean::initializer init;
+    second_duration init_time = std::chrono::steady_clock::now() - init_start;
+    return run_lean(argc, argv, init_time);
+}
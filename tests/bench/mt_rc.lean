@@ -0,0 +1,44 @@
+/-
+Measures the cost of reference counting a value that is shared between threads. Every worker
+repeatedly packs the shared array into a fresh pair and drops it again, which increments and
+decrements the reference count of the multi-threaded array. With `Runtime.setDeferredMTDecrements`
+the decrements are combined per thread, halving the atomic operations on the contended counter.
+
+All times reported are in seconds.
+-/
+
+def ITERS : Nat := 5_000_000
+def THREADS : Nat := 4
+
+@[noinline] def pack (xs : Array Nat) (i : Nat) : Array Nat × Nat := (xs, i)
+
+def work (xs : Array Nat) : Nat := Id.run do
+  let mut acc := 0
+  for i in *...ITERS do
+    let p := pack xs i
+    acc := acc + p.1.size + p.2 % 2
+  return acc
+
+def runWorkers (xs : Array Nat) (threads : Nat) : IO Unit := do
+  let mut workers := Array.emptyWithCapacity threads
+  for _ in *...threads do
+    workers := workers.push (Task.spawn (prio := .dedicated) fun _ => work xs)
+  for w in workers do
+    if w.get != ITERS * xs.size + ITERS / 2 then
+      throw <| .userError "Fail"
+
+def run (name : String) (threads : Nat) (deferred : Bool) : IO Unit := do
+  let xs ← Runtime.markMultiThreaded (Array.range 16)
+  Runtime.setDeferredMTDecrements deferred
+  let t1 ← IO.monoMsNow
+  runWorkers xs threads
+  let t2 ← IO.monoMsNow
+  Runtime.setDeferredMTDecrements false
+  let time : Float := (t2 - t1).toFloat / 1000.0
+  IO.println s!"{name}: {time}"
+
+def main : IO Unit := do
+  run "mt_rc_1_direct" 1 false
+  run "mt_rc_1_deferred" 1 true
+  run s!"mt_rc_{THREADS}_direct" THREADS false
+  run s!"mt_rc_{THREADS}_deferred" THREADS true
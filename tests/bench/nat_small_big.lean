@@ -0,0 +1,60 @@
+/-
+Measures arithmetic on natural numbers that are slightly too large to be scalars, between 64 and
+256 bits. This is the common case for e.g. `UInt64` overflow checks, fixed-width bit-vectors and
+hash computations. Values are kept in range with `%`, so every iteration performs a few big number
+operations and allocations.
+
+The numbers reported are millions of iterations per second.
+-/
+
+def m128 : Nat := 2^128 - 159
+def m256 : Nat := 2^256 - 189
+
+def loopAdd (n : Nat) (x : Nat) : Nat := Id.run do
+  let mut acc := x
+  for i in *...n do
+    acc := acc + x + i
+    if acc ≥ m128 then acc := acc - m128
+  return acc
+
+def loopMul (n : Nat) (x : Nat) : Nat := Id.run do
+  let mut acc := x
+  for i in *...n do
+    acc := (acc * (x + i)) % m128
+  return acc
+
+def loopDiv (n : Nat) (x : Nat) : Nat := Id.run do
+  let mut acc := 0
+  for i in *...n do
+    acc := (acc + x / (i + 1) + x % (i + 3)) % m128
+  return acc
+
+def loopShift (n : Nat) (x : Nat) : Nat := Id.run do
+  let mut acc := x
+  for i in *...n do
+    acc := ((acc <<< 7) ^^^ (acc >>> 13) ^^^ i) &&& (2^120 - 1)
+  return acc
+
+def loopMul256 (n : Nat) (x : Nat) : Nat := Id.run do
+  let mut acc := x
+  for i in *...n do
+    acc := (acc * (x + i)) % m256
+  return acc
+
+def bench (name : String) (n : Nat) (loop : Nat → Nat) : IO Unit := do
+  let t1 ← IO.monoNanosNow
+  let r := loop n
+  if r == 1 then
+    throw <| .userError "Fail"
+  let t2 ← IO.monoNanosNow
+  let rate : Float := n.toFloat / ((t2 - t1).toFloat / 1000.0)
+  IO.println s!"{name}: {rate}"
+
+def main (args : List String) : IO Unit := do
+  let n := (args.head? >>= String.toNat?).getD 10_000_000
+  let x := 2^64 + n
+  bench "nat_small_big_add" n (loopAdd · x)
+  bench "nat_small_big_mul" n (loopMul · x)
+  bench "nat_small_big_div" n (loopDiv · (x * x))
+  bench "nat_small_big_shift" n (loopShift · x)
+  bench "nat_small_big_mul256" n (loopMul256 · (x * x))
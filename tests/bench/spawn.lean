@@ -0,0 +1,36 @@
+/-
+Measures the latency of spawning a trivial child process while the parent process keeps a heap of
+growing size alive. With a `fork`-based implementation, the latency grows with the size of the heap
+as the page tables of the parent have to be copied; with `posix_spawn` it should stay flat.
+
+All times reported are average times per spawn in microseconds.
+-/
+
+def SPAWNS : Nat := 200
+
+/-- Allocates and touches `mb` megabytes spread over many small objects. -/
+def mkHeap (mb : Nat) : Array ByteArray := Id.run do
+  let chunk := 64 * 1024
+  let mut heap := Array.emptyWithCapacity (mb * 16)
+  for i in *...(mb * 16) do
+    heap := heap.push (ByteArray.mk (Array.replicate chunk i.toUInt8))
+  return heap
+
+def benchSpawn (mb : Nat) : IO Float := do
+  let heap := mkHeap mb
+  let t1 ← IO.monoNanosNow
+  for _ in *...SPAWNS do
+    let child ← IO.Process.spawn { cmd := "true", stdin := .null, stdout := .null, stderr := .null }
+    let rc ← child.wait
+    if rc != 0 then
+      throw <| .userError s!"unexpected exit code {rc}"
+  let t2 ← IO.monoNanosNow
+  -- keep the heap alive until after the measurement
+  if heap.size != mb * 16 then
+    throw <| .userError "Fail"
+  return (t2 - t1).toFloat / SPAWNS.toFloat / 1000.0
+
+def main : IO Unit := do
+  for mb in [0, 64, 256, 1024] do
+    let time ← benchSpawn mb
+    IO.println s!"spawn_{mb}mb: {time}"
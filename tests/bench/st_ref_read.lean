@@ -0,0 +1,47 @@
+/-
+Measures concurrent reads of a multi-threaded `IO.Ref`, as used by global caches that many tasks
+consult. Every reader repeatedly calls `ST.Ref.get` on the same ref, optionally while one writer
+keeps replacing its value. Readers of a multi-threaded ref should not block each other, so the time
+per configuration should only grow slowly with the number of readers.
+
+All times reported are in seconds.
+-/
+
+def ITERS : Nat := 2_000_000
+
+def reader (r : IO.Ref (Array Nat)) : IO Nat := do
+  let mut acc := 0
+  for _ in *...ITERS do
+    acc := acc + (← r.get).size
+  return acc
+
+def writer (r : IO.Ref (Array Nat)) (stop : IO.Ref Bool) : IO Nat := do
+  let mut n := 0
+  while !(← stop.get) do
+    r.set (Array.replicate 16 n)
+    n := n + 1
+  return n
+
+def run (readers : Nat) (writers : Nat) : IO Unit := do
+  let r ← IO.mkRef (Array.range 16)
+  let stop ← IO.mkRef false
+  let ws ← (List.range writers).mapM fun _ => IO.asTask (prio := .dedicated) (writer r stop)
+  let t1 ← IO.monoMsNow
+  let rs ← (List.range readers).mapM fun _ => IO.asTask (prio := .dedicated) (reader r)
+  for t in rs do
+    if (← IO.ofExcept t.get) != ITERS * 16 then
+      throw <| .userError "Fail"
+  let t2 ← IO.monoMsNow
+  stop.set true
+  for t in ws do
+    discard <| IO.ofExcept t.get
+  let time : Float := (t2 - t1).toFloat / 1000.0
+  IO.println s!"st_ref_read_{readers}r_{writers}w: {time}"
+
+def main (args : List String) : IO Unit := do
+  let maxReaders := (args.head? >>= String.toNat?).getD 8
+  let mut readers := 1
+  while readers ≤ maxReaders do
+    run readers 0
+    run readers 1
+    readers := readers * 2
@@ -0,0 +1,63 @@
+/-
+Compares `String.hash` (MurmurHash64A, used by `Hashable String` and persisted in `.olean` files)
+with the seeded `String.hashV2` on a corpus of real identifiers and (dotted) names, namely all distinct
+identifier tokens occurring in the Lean files of the core library.
+
+* `string_hash_{v1,v2}_{bucket}`: megabytes hashed per second for keys of the given length range
+* `string_hash_{v1,v2}_collisions`: number of colliding keys when truncating the hash to 32 bits
+-/
+
+def isIdChar (c : Char) : Bool :=
+  c.isAlphanum || c == '_' || c == '.' || c == '\'' || c.val ≥ 0x80
+
+def readIdentifiers (dir : System.FilePath) : IO (Array String) := do
+  let files ← dir.walkDir
+  let mut seen : Std.HashSet String := {}
+  let mut r := #[]
+  for f in files.qsort (·.toString < ·.toString) do
+    if f.extension == some "lean" then
+      let mut tk := ""
+      for c in (← IO.FS.readFile f).toList ++ [' '] do
+        if isIdChar c then
+          tk := tk.push c
+        else if !tk.isEmpty then
+          if !seen.contains tk then
+            seen := seen.insert tk
+            r := r.push tk
+          tk := ""
+  return r
+
+def buckets : List (String × Nat × Nat) :=
+  [("1_8", 1, 8), ("9_16", 9, 16), ("17_32", 17, 32), ("33_64", 33, 64), ("65_inf", 65, 1000000)]
+
+def bench (name : String) (keys : Array String) (iters : Nat) (h : String → UInt64) : IO Unit := do
+  let bytes := keys.foldl (· + ·.utf8ByteSize) 0
+  let t1 ← IO.monoNanosNow
+  let mut acc : UInt64 := 0
+  for _ in [0:iters] do
+    for k in keys do
+      acc := acc ^^^ h k
+  let t2 ← IO.monoNanosNow
+  if acc == 42 then
+    IO.println "unlikely"
+  let rate : Float := (bytes * iters).toFloat / ((t2 - t1).toFloat / 1000.0)
+  IO.println s!"string_hash_{name}: {rate}"
+
+def collisions (keys : Array String) (h : String → UInt64) : Nat := Id.run do
+  let mut seen : Std.HashSet UInt32 := {}
+  for k in keys do
+    seen := seen.insert (h k).toUInt32
+  return keys.size - seen.size
+
+def main (args : List String) : IO Unit := do
+  let dir := args.head?.getD "../../src/Init"
+  let iters := (args[1]? >>= String.toNat?).getD 200
+  let keys ← readIdentifiers dir
+  IO.println s!"string_hash_keys: {keys.size}"
+  for (b, lo, hi) in buckets do
+    let ks := keys.filter fun k => lo ≤ k.utf8ByteSize && k.utf8ByteSize ≤ hi
+    unless ks.isEmpty do
+      bench s!"v1_{b}" ks iters (·.hash)
+      bench s!"v2_{b}" ks iters (·.hashV2)
+  IO.println s!"string_hash_v1_collisions: {collisions keys (·.hash)}"
+  IO.println s!"string_hash_v2_collisions: {collisions keys (·.hashV2)}"
@@ -0,0 +1,38 @@
+/-
+Measures UTF-8 validation and character counting on real source files, i.e., mostly ASCII text with
+some Unicode symbols. By default, all Lean files of the core library are used.
+
+* `validate`: `ByteArray.validateUTF8`
+* `from_utf8`: `String.fromUTF8?`, which validates, counts and copies
+* `extract`: `String.Pos.Raw.extract`, which counts the characters of the copied region
+
+The numbers reported are megabytes per second.
+-/
+
+def readSources (dir : System.FilePath) : IO ByteArray := do
+  let files ← dir.walkDir
+  let mut r := ByteArray.empty
+  for f in files.qsort (·.toString < ·.toString) do
+    if f.extension == some "lean" then
+      r := r ++ (← IO.FS.readBinFile f)
+  return r
+
+def bench (name : String) (bytes : Nat) (iters : Nat) (f : Unit → IO Nat) : IO Unit := do
+  let t1 ← IO.monoNanosNow
+  let mut acc := 0
+  for _ in [0:iters] do
+    acc := acc + (← f ())
+  if acc == 0 then
+    throw <| .userError "Fail"
+  let t2 ← IO.monoNanosNow
+  let rate : Float := (bytes * iters).toFloat / ((t2 - t1).toFloat / 1000.0)
+  IO.println s!"utf8_scan_{name}: {rate}"
+
+def main (args : List String) : IO Unit := do
+  let dir := args.head?.getD "../../src/Init"
+  let iters := (args[1]? >>= String.toNat?).getD 20
+  let data ← readSources dir
+  let some s := String.fromUTF8? data | throw <| .userError "invalid UTF-8"
+  bench "validate" data.size iters fun _ => return if data.validateUTF8 then 1 else 0
+  bench "from_utf8" data.size iters fun _ => return (String.fromUTF8? data).map (·.length) |>.getD 0
+  bench "extract" data.size iters fun _ => return (String.Pos.Raw.extract s ⟨0⟩ ⟨s.utf8ByteSize⟩).length
@@ -0,0 +1,53 @@
+import Std.Internal.Async
+import Std.Net.Addr
+
+open Std.Internal.IO Async
+open Std.Net
+
+-- `localhost` is resolved from `/etc/hosts`, so these tests don't depend on the network.
+
+def isLoopback : IPAddr → Bool
+  | .v4 addr => addr.octets[0] == 127
+  | .v6 addr => addr == .ofParts 0 0 0 0 0 0 0 1
+
+def cachedLookup : Async Unit := do
+  DNS.flushCache
+  let first ← DNS.getAddrInfo "localhost" "http"
+  let second ← DNS.getAddrInfo "localhost" "http"
+  unless first.size > 0 && first.all isLoopback do
+    throw <| IO.userError "unexpected addresses for localhost"
+  unless first.size == second.size do
+    throw <| IO.userError "cached lookup differs"
+
+def batchLookup : Async Unit := do
+  let results ← DNS.getAddrInfoBatch #["localhost", "localhost▸", "localhost"] "http"
+  unless results.size == 3 do
+    throw <| IO.userError "wrong number of results"
+  for i in [0, 2] do
+    match results[i]! with
+    | .ok addrs =>
+      unless addrs.size > 0 && addrs.all isLoopback do
+        throw <| IO.userError "unexpected addresses for localhost"
+    | .error e => throw e
+  match results[1]! with
+  | .error (.invalidArgument ..) => pure ()
+  | _ => throw <| IO.userError "expected an invalid argument error"
+
+def emptyBatch : Async Unit := do
+  let results ← DNS.getAddrInfoBatch #[] "http"
+  unless results.isEmpty do
+    throw <| IO.userError "expected no results"
+
+def uncachedLookup : Async Unit := do
+  DNS.setCacheTTL 0 0
+  try
+    let addrs ← DNS.getAddrInfo "localhost" "http"
+    unless addrs.size > 0 do
+      throw <| IO.userError "no addresses for localhost"
+  finally
+    DNS.setCacheTTL 30000 10000
+
+#eval cachedLookup.block
+#eval batchLookup.block
+#eval emptyBatch.block
+#eval uncachedLookup.block
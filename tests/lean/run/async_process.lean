@@ -0,0 +1,53 @@
+import Std.Internal.Async
+
+open Std.Internal.IO Async
+
+def assertBEq [BEq α] [ToString α] (actual expected : α) : IO Unit := do
+  unless actual == expected do
+    throw <| IO.userError <|
+      s!"expected '{expected}', got '{actual}'"
+
+partial def readAll (child : Process.Child) (acc : ByteArray := .empty) : Async ByteArray := do
+  match ← child.recvStdout? 1024 with
+  | some data => readAll child (acc ++ data)
+  | none => return acc
+
+def catRoundtrip : Async Unit := do
+  let child ← Process.spawn { cmd := "cat", stdin := .piped, stdout := .piped, stderr := .null }
+  child.send "hello ".toUTF8
+  child.send "world".toUTF8
+  child.closeStdin
+  let out ← readAll child
+  assertBEq (String.fromUTF8? out) (some "hello world")
+  assertBEq (← child.wait) 0
+
+def exitCode : Async Unit := do
+  let child ← Process.spawn { cmd := "sh", args := #["-c", "exit 3"], stdin := .null, stdout := .null, stderr := .null }
+  assertBEq (← child.wait) 3
+  -- waiting again returns the same result
+  assertBEq (← child.wait) 3
+
+def killed : Async Unit := do
+  let child ← Process.spawn { cmd := "sleep", args := #["10"], stdin := .null, stdout := .null, stderr := .null }
+  child.kill 9
+  assertBEq (← child.wait) (128 + 9)
+
+def manyChildren : Async Unit := do
+  let children ← (List.range 50).mapM fun i =>
+    Process.spawn { cmd := "sh", args := #["-c", s!"exit {i % 7}"], stdin := .null, stdout := .null, stderr := .null }
+  for i in [0:50], child in children do
+    assertBEq (← child.wait) (i % 7).toUInt32
+
+def spawnError : IO Unit := do
+  try
+    discard <| Process.spawn { cmd := "this-command-does-not-exist-hopefully" }
+    throw <| IO.userError "spawn should have failed"
+  catch
+    | .noFileOrDirectory .. => pure ()
+    | e => throw e
+
+#eval catRoundtrip.block
+#eval exitCode.block
+#eval killed.block
+#eval manyChildren.block
+#eval spawnError
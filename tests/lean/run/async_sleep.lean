@@ -392,3 +392,41 @@ def cancelRepeat : IO Unit := do
 #eval sequentialSleep
 
 end IntervalTest
+
+namespace WheelTest
+
+def manyTimers : IO Unit := do
+  assertDuration BASE_DURATION EPS do
+    let timers ← (List.range 10000).mapM fun i =>
+      Timer.mk (BASE_DURATION / 2 + i % (BASE_DURATION / 2)).toUInt64 false
+    let proms ← timers.mapM (·.next)
+    -- cancel every other timer, the rest still has to fire on time
+    for timer in timers, i in [0:timers.length] do
+      if i % 2 == 0 then timer.cancel
+    for prom in proms, i in [0:proms.length] do
+      let r ← await prom.result?
+      assert! (i % 2 == 0) == r.isNone
+
+def coarseResolution : IO Unit := do
+  Timer.setResolution 10
+  try
+    assertDuration BASE_DURATION EPS do
+      let timer ← Timer.mk BASE_DURATION.toUInt64 false
+      let p ← timer.next
+      await p.result!
+  finally
+    Timer.setResolution 1
+
+def zeroResolution : IO Unit := do
+  try
+    Timer.setResolution 0
+    throw <| .userError "setResolution 0 should have failed"
+  catch
+    | .invalidArgument .. => pure ()
+    | e => throw e
+
+#eval manyTimers
+#eval coarseResolution
+#eval zeroResolution
+
+end WheelTest
@@ -0,0 +1,33 @@
+/-!
+Applications of closures to more than 16 arguments go through `lean_apply_m`,
+including the case where the closure expects fewer arguments and returns a new closure.
+-/
+
+@[noinline] def hide (f : α) : α := f
+
+def sum16 (a1 a2 a3 a4 a5 a6 a7 a8 a9 a10 a11 a12 a13 a14 a15 a16 : Nat) : Nat :=
+  a1 + a2 + a3 + a4 + a5 + a6 + a7 + a8 + a9 + a10 + a11 + a12 + a13 + a14 + a15 + a16
+
+@[noinline] def pick (k : Nat) : Nat → Nat → Nat → Nat → Nat → Nat → Nat → Nat → Nat → Nat → Nat → Nat → Nat → Nat → Nat → Nat → Nat :=
+  if k == 0 then sum16 else fun _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ => k
+
+def sum17 (a1 a2 a3 a4 a5 a6 a7 a8 a9 a10 a11 a12 a13 a14 a15 a16 a17 : Nat) : Nat :=
+  sum16 a1 a2 a3 a4 a5 a6 a7 a8 a9 a10 a11 a12 a13 a14 a15 a16 + a17
+
+def tst : IO Unit := do
+  let f := hide pick
+  IO.println (f 0 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16)
+  IO.println (f 7 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16)
+  let g := hide sum17
+  IO.println (g 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16 17)
+  let h := hide (sum17 100)
+  IO.println (h 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16)
+
+/--
+info: 136
+7
+153
+236
+-/
+#guard_msgs in
+#eval tst
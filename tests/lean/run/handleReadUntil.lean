@@ -0,0 +1,45 @@
+def tstReadUntil : IO Unit := do
+  let path := "tmp_file_read_until"
+  IO.FS.withFile path IO.FS.Mode.write fun h => do
+    h.putStr "ab,cd,,ααα,"
+    h.putStr "tail"
+  IO.FS.withFile path IO.FS.Mode.read fun h => do
+    for _ in [0:7] do
+      let chunk ← h.readUntil ','.toNat.toUInt8
+      IO.println (repr (String.fromUTF8! chunk))
+  IO.FS.removeFile path
+
+/--
+info: "ab,"
+"cd,"
+","
+"ααα,"
+"tail"
+""
+""
+-/
+#guard_msgs in
+#eval tstReadUntil
+
+def tstGetLineLong : IO Unit := do
+  let path := "tmp_file_read_until_long"
+  let line := "".pushn 'α' 100000
+  IO.FS.withFile path IO.FS.Mode.write fun h => do
+    h.putStrLn line
+    h.putStrLn "short"
+  IO.FS.withFile path IO.FS.Mode.read fun h => do
+    let l1 ← h.getLine
+    let l2 ← h.getLine
+    let l3 ← h.getLine
+    unless l1 == line ++ "\n" && l1.length == 100001 do
+      throw <| IO.userError "unexpected first line"
+    IO.println (repr l2)
+    IO.println (repr l3)
+  IO.FS.removeFile path
+
+/--
+info: "short\n"
+""
+-/
+#guard_msgs in
+#eval tstGetLineLong
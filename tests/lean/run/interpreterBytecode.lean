@@ -0,0 +1,55 @@
+-- The bytecode and the IR walking interpreter must agree on code exercising tail calls, join points, `case`
+-- on constructors and scalars, destructive updates, closures and unboxed values.
+
+def sumTo (n acc : Nat) : Nat :=
+  if n == 0 then acc else sumTo (n - 1) (acc + n)
+
+def fib : Nat → Nat
+  | 0 => 0
+  | 1 => 1
+  | n + 2 => fib n + fib (n + 1)
+
+def incAll (k : Nat) : List Nat → List Nat
+  | [] => []
+  | x :: xs => (x + k) :: incAll k xs
+
+def classify (x : Nat) : String :=
+  let s := if x % 3 == 0 then "fizz" else if x % 5 == 0 then "buzz" else toString x
+  s ++ "!"
+
+def swapLoop (a b : Nat) : Nat → Nat
+  | 0 => a
+  | k + 1 => swapLoop b a k
+
+def floats (n : Nat) : Float := Id.run do
+  let mut r := 0.5
+  for i in [0:n] do
+    r := r * 1.5 + i.toFloat
+  return r
+
+def mix (x : UInt64) (y : UInt8) : UInt64 × UInt8 :=
+  (x * 31 + y.toUInt64, y + 1)
+
+def closures (n : Nat) : Nat :=
+  let f := fun a b c => a * b + c + n
+  let g := f 2
+  [1, 2, 3].foldl (fun acc x => acc + g x x) 0
+
+def run : String :=
+  ", ".intercalate [toString (sumTo 100000 0), toString (fib 20), toString (incAll 5 [1, 2, 3]),
+    toString ((List.range 7).map classify), toString (swapLoop 1 2 5), toString (floats 10),
+    toString (mix 12345 255), toString (closures 10), toString ((Array.range 10).map (· * 2) |>.reverse)]
+
+/--
+info: "5000050000, 6765, [6, 7, 8], [fizz!, 1!, 2!, fizz!, 4!, buzz!, fizz!], 2, 235.492676, (382950, 0), 48, #[18, 16, 14, 12, 10, 8, 6, 4, 2, 0]"
+-/
+#guard_msgs in
+set_option interpreter.bytecode true in
+#eval run
+
+/--
+info: "5000050000, 6765, [6, 7, 8], [fizz!, 1!, 2!, fizz!, 4!, buzz!, fizz!], 2, 235.492676, (382950, 0), 48, #[18, 16, 14, 12, 10, 8, 6, 4, 2, 0]"
+-/
+#guard_msgs in
+set_option interpreter.bytecode false in
+#eval run
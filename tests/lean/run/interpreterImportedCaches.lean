@@ -0,0 +1,24 @@
+import Lean
+
+open Lean
+
+/-!
+The interpreter's caches for imported declarations are shared by all environments with the same imports, and freed
+together with the imports by `Environment.freeRegions`.
+-/
+
+unsafe def evalSize (env : Environment) : IO Nat :=
+  IO.ofExcept <| env.evalConst Nat {} ``UInt8.size (checkMeta := false)
+
+/-- info: (256, 256, 1, 1, 0) -/
+#guard_msgs in
+#eval show IO _ from unsafe do
+  let numCaches ← getNumInterpreterCaches
+  let (r₁, r₂, n₁, n₂) ← withImportModules #[{ module := `Init }] {} fun env => do
+    let r₁ ← evalSize env
+    let n₁ ← getNumInterpreterCaches
+    -- a different environment with the same imports
+    let r₂ ← evalSize (env.setMainModule `Other)
+    let n₂ ← getNumInterpreterCaches
+    return (r₁, r₂, n₁, n₂)
+  return (r₁, r₂, n₁ - numCaches, n₂ - numCaches, (← getNumInterpreterCaches) - numCaches)
@@ -0,0 +1,48 @@
+import Lean.Compiler.IR.EmitLLVM
+
+-- Hot functions may be compiled by the JIT tier when Lean is built with LLVM support; results must not change,
+-- including for functions passed as closures, mutual recursion and calls back into interpreted code.
+
+-- only the evaluations below may compile functions
+set_option interpreter.jit_threshold 0
+
+partial def collatz (n : Nat) (steps : Nat := 0) : Nat :=
+  if n ≤ 1 then steps else collatz (if n % 2 == 0 then n / 2 else 3 * n + 1) (steps + 1)
+
+mutual
+def isEven : Nat → Bool
+  | 0 => true
+  | n + 1 => isOdd n
+def isOdd : Nat → Bool
+  | 0 => false
+  | n + 1 => isEven n
+end
+
+def applyAll (fs : List (Nat → Nat)) (x : Nat) : Nat :=
+  fs.foldl (fun acc f => f acc) x
+
+def run : String :=
+  let cs := (List.range 30).map (collatz ·)
+  let ps := (List.range 10).map isEven
+  let as := (List.range 20).map (applyAll [(· + 1), (· * 3), collatz])
+  s!"{cs.foldl (· + ·) 0}, {ps}, {as.foldl (· + ·) 0}"
+
+/--
+info: "423, [true, false, true, false, true, false, true, false, true, false], 529"
+-/
+#guard_msgs in
+set_option interpreter.jit_threshold 2 in
+#eval run
+
+/--
+info: "423, [true, false, true, false, true, false, true, false, true, false], 529"
+-/
+#guard_msgs in
+set_option interpreter.jit_threshold 0 in
+#eval run
+
+-- with LLVM support, the functions above must actually have been compiled
+/-- info: true -/
+#guard_msgs in
+#eval show IO Bool from do
+  return !Lean.IR.jitAvailable () || (← Lean.IR.getNumJitCompiled) > 0
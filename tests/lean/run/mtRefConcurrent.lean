@@ -0,0 +1,31 @@
+/-!
+Concurrent reads and writes of an `IO.Ref` shared between threads. Readers must never observe a value
+that a concurrent writer has already released.
+-/
+
+def write (ref : IO.Ref (Array Nat)) : IO Unit := do
+  for _ in *...(20000 : Nat) do
+    -- each write allocates a new array and releases the previous one
+    ref.modify fun a => #[a[0]! + 1, a[0]! + 1]
+
+def read (ref : IO.Ref (Array Nat)) (done : IO.Ref Bool) : IO Unit := do
+  while !(← done.get) do
+    let a ← ref.get
+    unless a.size == 2 && a[0]! == a[1]! do
+      throw <| .userError s!"inconsistent value {a}"
+
+def readWrite : IO Unit := do
+  let ref ← IO.mkRef #[0, 0]
+  let done ← IO.mkRef false
+  let readers ← (List.range 4).mapM fun _ => IO.asTask (prio := .dedicated) (read ref done)
+  let writers ← (List.range 4).mapM fun _ => IO.asTask (prio := .dedicated) (write ref)
+  for w in writers do
+    IO.ofExcept w.get
+  done.set true
+  for r in readers do
+    IO.ofExcept r.get
+  let a ← ref.get
+  if a != #[80000, 80000] then
+    throw <| .userError s!"Should be #[80000, 80000] but was {a}"
+
+#eval readWrite
@@ -0,0 +1,21 @@
+-- Runtime fast paths for natural numbers smaller than 2^128, and their boundaries.
+
+@[noinline] def big (n : Nat) : Nat := n
+
+def results : List Nat :=
+  let a := big (2^64 + 3)
+  let b := big (2^127 + 1)
+  let c := big (2^128 - 1)
+  [ a + a, b + b, c + 1, c + c,
+    c - c, a - c, c - a, c - (2^64 - 1),
+    a * a, a * b, c * c, big (2^63) * 2,
+    c / a, a / c, c % a, a % big 0, a / big 0,
+    a <<< 63, a <<< 64, b <<< 1, c <<< 0, big 1 <<< 127,
+    c >>> 1, c >>> 127, c >>> 128, b >>> 200,
+    c &&& a, b ||| a, c ^^^ b ]
+
+/--
+info: [36893488147419103238, 340282366920938463463374607431768211458, 340282366920938463463374607431768211456, 680564733841876926926749214863536422910, 0, 0, 340282366920938463444927863358058659836, 340282366920938463444927863358058659840, 340282366920938463574055071874025521161, 3138550867693340382428318261985240903264686377453379125251, 115792089237316195423570985008687907852589419931798687112530834793049593217025, 18446744073709551616, 18446744073709551613, 0, 8, 18446744073709551619, 0, 170141183460469231759357419826448433152, 340282366920938463518714839652896866304, 340282366920938463463374607431768211458, 340282366920938463463374607431768211455, 170141183460469231731687303715884105728, 170141183460469231731687303715884105727, 1, 0, 0, 18446744073709551619, 170141183460469231750134047789593657347, 170141183460469231731687303715884105726]
+-/
+#guard_msgs in
+#eval results
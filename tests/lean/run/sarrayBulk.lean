@@ -0,0 +1,69 @@
+-- Native bulk primitives on `ByteArray` and `FloatArray`, using sizes that exercise both the vectorized
+-- loops and their scalar tails.
+
+def bytes (n : Nat) (f : Nat → Nat) : ByteArray := Id.run do
+  let mut r := ByteArray.empty
+  for i in [0:n] do
+    r := r.push (f i).toUInt8
+  return r
+
+def a := bytes 37 (· * 7)
+def b := bytes 35 (· + 100)
+
+/--
+info: (#[1, 1, 1, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1], true)
+-/
+#guard_msgs in
+#eval
+  let f := (bytes 40 fun _ => 1).fill 7 3 30
+  (f.data, f.fill 0 100 0 == f)
+
+/--
+info: (some 3, some 34, none, some 36, none)
+-/
+#guard_msgs in
+#eval (a.idxOf? 21, a.idxOf? (34 * 7).toUInt8, a.idxOf? 21 4, a.idxOf? (36 * 7).toUInt8 36, a.idxOf? 0 100)
+
+/--
+info: [Ordering.eq, Ordering.gt, Ordering.lt, Ordering.lt, Ordering.gt, Ordering.eq]
+-/
+#guard_msgs in
+#eval [compare a a, compare a (a.extract 0 36), compare (a.extract 0 36) a, compare a b,
+  compare (bytes 20 fun i => if i == 19 then 5 else 0) (bytes 20 fun i => if i == 19 then 4 else 0),
+  compare ByteArray.empty ByteArray.empty]
+
+/--
+info: true
+-/
+#guard_msgs in
+#eval
+  let ref (f : UInt8 → UInt8 → UInt8) := bytes 35 fun i => (f (i * 7).toUInt8 (i + 100).toUInt8).toNat
+  a.xor b == ref (· ^^^ ·) && a.and b == ref (· &&& ·) && a.or b == ref (· ||| ·) &&
+    -- the first argument is updated in place when it is not shared
+    (a.copySlice 0 .empty 0 37).xor b == ref (· ^^^ ·) && (a.xor b).size == 35 && a.size == 37
+
+def floats (n : Nat) (f : Nat → Float) : FloatArray := Id.run do
+  let mut r := FloatArray.empty
+  for i in [0:n] do
+    r := r.push (f i)
+  return r
+
+def x := floats 11 (·.toFloat)
+def y := floats 9 fun i => (2 * i + 1).toFloat
+
+/--
+info: 55.000000
+444.000000
+[1.000000, 5.000000, 9.000000, 13.000000, 17.000000, 21.000000, 25.000000, 29.000000, 33.000000]
+[0.000000, 0.500000, 1.000000, 1.500000, 2.000000, 2.500000, 3.000000, 3.500000, 4.000000, 4.500000, 5.000000]
+[0.000000, 1.000000, 9.000000, 9.000000, 4.000000, 5.000000, 6.000000, 7.000000, 8.000000, 9.000000, 10.000000]
+0.000000
+-/
+#guard_msgs in
+#eval do
+  IO.println x.sum
+  IO.println (x.dot y)
+  IO.println (FloatArray.axpy 2 x y)
+  IO.println (x.scale 0.5)
+  IO.println (x.fill 9 2 4)
+  IO.println FloatArray.empty.sum
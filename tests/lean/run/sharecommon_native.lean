@@ -0,0 +1,62 @@
+open ShareCommon
+
+def check (b : Bool) : IO Unit := do
+  unless b do throw $ IO.userError "check failed"
+
+@[noinline] def mkList (n : Nat) : List Nat := List.range n |>.map (· + 1)
+
+unsafe def tst1 : IO Unit := do
+  let x := mkList 3
+  let y := [1, 2, 3]
+  check $ ptrAddrUnsafe x != ptrAddrUnsafe y
+  let s := NativeState.mk
+  let (x, s) := s.shareCommon x
+  let (y, s) := s.shareCommon y
+  check $ ptrAddrUnsafe x == ptrAddrUnsafe y
+  -- The table is kept across calls, so a list that extends `x` reuses it as its tail.
+  let (z, s) := s.shareCommon (0 :: mkList 3)
+  check $ ptrAddrUnsafe z.tail == ptrAddrUnsafe x
+  IO.println s.size
+  IO.println z
+
+/--
+info: 4
+[0, 1, 2, 3]
+-/
+#guard_msgs in
+#eval tst1
+
+unsafe def tst2 : IO Unit := do
+  let s := NativeState.mk
+  let (x, s) := s.shareCommon (#[mkList 2, mkList 2], "hello", "hel" ++ "lo")
+  check $ ptrAddrUnsafe x.1[0]! == ptrAddrUnsafe x.1[1]!
+  check $ ptrAddrUnsafe x.2.1 == ptrAddrUnsafe x.2.2
+  -- A shared state is copied, and both copies keep working.
+  let (y, s₁) := s.shareCommon (mkList 2)
+  let (z, s₂) := s.shareCommon (mkList 2)
+  check $ ptrAddrUnsafe y == ptrAddrUnsafe x.1[0]!
+  check $ ptrAddrUnsafe z == ptrAddrUnsafe x.1[0]!
+  IO.println (s₁.size, s₂.size)
+
+/-- info: (6, 6) -/
+#guard_msgs in
+#eval tst2
+
+-- Deep objects do not overflow the stack.
+unsafe def tst3 : IO Unit := do
+  let s := NativeState.mk
+  let (x, s) := s.shareCommon (mkList 1000000)
+  let (y, _) := s.shareCommon (mkList 1000000)
+  check $ ptrAddrUnsafe x == ptrAddrUnsafe y
+  IO.println x.length
+
+/-- info: 1000000 -/
+#guard_msgs in
+#eval tst3
+
+unsafe def tst4 : NativeShareCommonT IO Unit := do
+  let x ← shareCommonM (mkList 5)
+  let y ← shareCommonM (mkList 5)
+  check $ ptrAddrUnsafe x == ptrAddrUnsafe y
+
+#eval tst4.run
@@ -0,0 +1,35 @@
+def check (b : Bool) : IO Unit := do
+  unless b do throw $ IO.userError "check failed"
+
+@[noinline] def mkPairs (n : Nat) : Array (List Nat × Nat) :=
+  Array.ofFn (n := n) fun i => ((List.range (i.val % 7)).map (· % 3), i.val % 5)
+
+unsafe def numDistinctTails (xs : Array (List Nat × Nat)) : Nat := Id.run do
+  let mut ptrs : Std.HashSet USize := {}
+  for (l, _) in xs do
+    let mut l := l
+    while !l.isEmpty do
+      ptrs := ptrs.insert (ptrAddrUnsafe l)
+      l := l.tail
+  return ptrs.size
+
+unsafe def tst (numThreads : Nat) : IO Unit := do
+  let xs := mkPairs 20000
+  let ys := ShareCommon.shareCommon' xs
+  let zs := ShareCommon.shareCommonPar' xs numThreads
+  check $ ys == zs && zs == xs
+  check $ numDistinctTails ys == numDistinctTails zs
+  check $ ptrAddrUnsafe zs[7]! == ptrAddrUnsafe zs[42]!
+  IO.println (numDistinctTails zs)
+
+/-- info: 15 -/
+#guard_msgs in
+#eval tst 4
+
+/-- info: 15 -/
+#guard_msgs in
+#eval tst 1
+
+/-- info: 15 -/
+#guard_msgs in
+#eval tst 0
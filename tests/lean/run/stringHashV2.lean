@@ -0,0 +1,19 @@
+-- Version 2 of the runtime's string hash agrees between strings, slices and their UTF-8 bytes, and
+-- depends on the seed. The lengths cover each of the short-key cases and the 48-byte block loop.
+
+def keys : List String :=
+  [0, 1, 3, 4, 8, 15, 16, 17, 47, 48, 49, 100].map fun n => String.ofList (List.replicate n 'x') ++ "∀"
+
+/--
+info: true
+-/
+#guard_msgs in
+#eval keys.all fun s =>
+  s.hashV2 == s.toSlice.hashV2 && s.hashV2 7 == s.toUTF8.hashV2 7 &&
+    s.hashV2 != s.hashV2 1 && ((("(" ++ s ++ ")").drop 1).dropEnd 1).hashV2 == s.hashV2
+
+/--
+info: true
+-/
+#guard_msgs in
+#eval (keys.map (·.hashV2)).eraseDups.length == keys.length
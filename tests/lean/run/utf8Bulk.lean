@@ -0,0 +1,27 @@
+-- UTF-8 validation and character counting on inputs that cross the 8 and 16 byte blocks used by the
+-- runtime.
+
+def mixed (n : Nat) : String := Id.run do
+  let mut s := ""
+  for i in [0:n] do
+    s := s.push (if i % 13 == 5 then '∀' else if i % 29 == 7 then '𝔸' else 'a')
+  return s
+
+/--
+info: [true, true, true, true, true, true]
+-/
+#guard_msgs in
+#eval [0, 15, 16, 17, 40, 100].map fun n =>
+  let s := mixed n
+  (String.fromUTF8? s.toUTF8).map (·.length) == some n &&
+    (String.Pos.Raw.extract s ⟨0⟩ ⟨s.utf8ByteSize⟩).length == n
+
+/--
+info: [false, false, false, true]
+-/
+#guard_msgs in
+#eval
+  let b := (mixed 40).toUTF8
+  -- a stray continuation byte, a truncated character and an invalid byte, at different offsets
+  [(b.set! 3 0x80).validateUTF8, (b.copySlice 0 .empty 0 6).validateUTF8, (b.set! 33 0xff).validateUTF8,
+   b.validateUTF8]
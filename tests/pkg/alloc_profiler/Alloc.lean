@@ -0,0 +1,10 @@
+import Lean.Util.Profile
+
+#eval show IO Unit from do
+  let some path ← IO.getEnv "ALLOC_PROFILE" | throw <| .userError "ALLOC_PROFILE not set"
+  let xs := List.range 1000000
+  IO.println s!"length: {xs.length}"
+  Lean.writeAllocProfile
+  IO.print (← IO.FS.readFile path)
+  -- keep `xs` alive across the report
+  IO.println s!"sum: {xs.foldl (· + ·) 0}"
@@ -0,0 +1,23 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+PROFILE=$(mktemp)
+trap 'rm -f "$PROFILE"' EXIT
+
+if ! OUT=$(ALLOC_PROFILE="$PROFILE" lean --alloc-profile="$PROFILE" Alloc.lean 2>&1); then
+  echo "$OUT"
+  # the profiler is not supported by builds without the small allocator
+  echo "$OUT" | grep -q "requires Lean to be built with the small allocator" && exit 0
+  exit 1
+fi
+echo "$OUT"
+
+# the report written by `Lean.writeAllocProfile` counts the list as retained
+echo "$OUT" | grep -q "^allocation profile: "
+echo "$OUT" | grep -qE "^.{12} *[0-9.]+ MiB  "
+echo "$OUT" | grep -q "sum: 499999500000"
+
+# the final report is written on exit
+grep -q "^allocation profile: " "$PROFILE"
+grep -q "allocated    retained  declaration" "$PROFILE"
+grep -q "allocated    retained  profiled step: object kind" "$PROFILE"
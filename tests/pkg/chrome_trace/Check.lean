@@ -0,0 +1,10 @@
+import Lean.Data.Json
+
+open Lean
+
+/-- Parses the trace given as argument and prints the phase and name of each of its events. -/
+def main (args : List String) : IO Unit := do
+  let json ← IO.ofExcept <| Json.parse (← IO.FS.readFile args[0]!)
+  for e in ← IO.ofExcept json.getArr? do
+    let ph ← IO.ofExcept <| e.getObjValAs? String "ph"
+    IO.println s!"{ph} {(e.getObjValAs? String "name").toOption.getD ""}"
@@ -0,0 +1,7 @@
+/-! Spawns a task that the main thread then blocks on, see `test.sh`. -/
+
+def slow (n : Nat) : Nat := dbgSleep 500 fun _ => n + 1
+
+/-- info: 2 -/
+#guard_msgs in
+#eval (Task.spawn fun _ => slow 1).get
@@ -0,0 +1,19 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+TRACE=$(mktemp)
+EVENTS=$(mktemp)
+trap 'rm -f "$TRACE" "$EVENTS"' EXIT
+
+lean --chrome-trace="$TRACE" Tasks.lean
+# fails unless the trace is a valid JSON array of events
+lean --run Check.lean "$TRACE" > "$EVENTS"
+
+# slices, including the blocking `Task.get`
+grep -q '^B Task.get$' "$EVENTS"
+grep -q '^E $' "$EVENTS"
+# flows from spawning the task to its execution, and from resolving it to the `Task.get`
+grep -q '^s spawn$' "$EVENTS"
+grep -q '^f spawn$' "$EVENTS"
+grep -q '^s resolve$' "$EVENTS"
+grep -q '^f resolve$' "$EVENTS"
@@ -0,0 +1,3 @@
+import Lean
+
+#eval (throw (IO.userError "fail") : IO Unit)
@@ -0,0 +1,3 @@
+import Lean
+
+#eval do IO.println s!"ok {(← IO.getEnv "COMPILE_SERVER_TEST").getD ""}"
@@ -0,0 +1 @@
+#eval IO.println "other"
@@ -0,0 +1,3 @@
+import Dep
+
+#eval IO.println dep
@@ -0,0 +1,63 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+# The compile server is not supported on Windows.
+if [ "${OS:-}" = Windows_NT ]; then
+  exit 0
+fi
+
+TMP_DIR=$(mktemp -d)
+SOCK=$TMP_DIR/sock
+# started in another directory, as requests should run in the directory of the client
+(cd "$TMP_DIR" && exec lean --compile-server="$SOCK") &
+SERVER=$!
+trap 'kill $SERVER 2>/dev/null || true; rm -rf "$TMP_DIR"' EXIT
+for _ in $(seq 100); do
+  [ -S "$SOCK" ] && break
+  sleep 0.1
+done
+export LEAN_COMPILE_SERVER=$SOCK
+
+# Waits for the server to have the given number of children, i.e. processes keeping imports loaded
+# once no request is running.
+expect_zygotes () {
+  for _ in $(seq 50); do
+    [ "$(pgrep -P $SERVER | wc -l)" -eq "$1" ] && return 0
+    sleep 0.1
+  done
+  echo "expected $1 processes keeping imports loaded, found:"
+  pgrep -l -P $SERVER || true
+  exit 1
+}
+
+echo "Testing requests through the server ..."
+COMPILE_SERVER_TEST=value lean Ok.lean | diff <(echo "ok value") -
+code=0
+lean Fail.lean > /dev/null || code=$?
+test $code = 1
+expect_zygotes 1
+
+echo "Testing requests with the same imports forwarded to the same process ..."
+lean Ok.lean | diff <(echo "ok ") -
+expect_zygotes 1
+lean Other.lean | diff <(echo "other") -
+expect_zygotes 2
+
+echo "Testing modules rebuilt while imported ..."
+mkdir -p "$TMP_DIR/build"
+export LEAN_PATH=$TMP_DIR/build
+echo 'def dep := "one"' > "$TMP_DIR/Dep.lean"
+(cd "$TMP_DIR" && lean Dep.lean -o build/Dep.olean)
+lean UseDep.lean | diff <(echo "one") -
+echo 'def dep := "three"' > "$TMP_DIR/Dep.lean"
+(cd "$TMP_DIR" && lean Dep.lean -o build/Dep.olean)
+lean UseDep.lean | diff <(echo "three") -
+unset LEAN_PATH
+
+echo "Testing fallback without a server ..."
+kill $SERVER
+wait $SERVER || true
+lean Ok.lean | diff <(echo "ok ") -
+LEAN_COMPILE_SERVER=$TMP_DIR/none lean Ok.lean | diff <(echo "ok ") -
+
+echo "Tests completed successfully."
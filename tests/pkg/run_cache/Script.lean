@@ -0,0 +1,6 @@
+def fib : Nat → Nat
+  | 0 => 0
+  | 1 => 1
+  | n + 2 => fib n + fib (n + 1)
+
+def main : IO Unit := IO.println (fib 25)
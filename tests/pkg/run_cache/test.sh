@@ -0,0 +1,38 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+# the cache is not used on Windows
+if [ "${OS:-}" = Windows_NT ]; then
+  exit 0
+fi
+
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+ERR="$TMP/stderr"
+
+# miss: the library is built into the cache, leaving no intermediate files behind
+CACHE="$TMP/cache"
+test "$(LEAN_RUN_CACHE_DIR="$CACHE" lean --run Script.lean 2>"$ERR")" = 75025
+cat "$ERR"
+test ! -s "$ERR"
+test "$(ls "$CACHE" | wc -l)" -eq 1
+LIB=$(ls "$CACHE")
+case "$LIB" in
+  *.so|*.dylib) ;;
+  *) echo "unexpected file in cache: $LIB"; exit 1 ;;
+esac
+INODE=$(ls -i "$CACHE/$LIB" | awk '{print $1}')
+
+# hit: the library is reused rather than rebuilt and renamed into place again
+test "$(LEAN_RUN_CACHE_DIR="$CACHE" LEAN_CC=false lean --run Script.lean 2>"$ERR")" = 75025
+test ! -s "$ERR"
+test "$(ls "$CACHE")" = "$LIB"
+test "$(ls -i "$CACHE/$LIB" | awk '{print $1}')" = "$INODE"
+
+# fallback: without a working compiler, the script is interpreted and the cache is left empty
+for CC in false "$TMP/missing-cc"; do
+  CACHE="$TMP/cache-$(basename "$CC")"
+  test "$(LEAN_RUN_CACHE_DIR="$CACHE" LEAN_CC="$CC" lean --run Script.lean 2>"$ERR")" = 75025
+  grep -q "warning: not using native code cache" "$ERR"
+  test -z "$(ls -A "$CACHE")"
+done
@@ -0,0 +1,14 @@
+@[extern "lean_sampling_profiler_test_missing"]
+opaque missing : Nat → Nat
+
+/-- Fails with an exception thrown through its interpreted frames. -/
+def throwing : Nat → Nat
+  | 0 => missing 0
+  | n + 1 => throwing n + 1
+
+def spin : Nat → UInt64 → UInt64
+  | 0, acc => acc
+  | n + 1, acc => spin n (acc * 31 + 7)
+
+#eval throwing 10
+#eval spin 5000000 0
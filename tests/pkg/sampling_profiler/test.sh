@@ -0,0 +1,25 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+# the sampling profiler is not supported on Windows
+if [ "${OS:-}" = Windows_NT ]; then
+  exit 0
+fi
+
+PROFILE=$(mktemp)
+trap 'rm -f "$PROFILE"' EXIT
+
+OUT=$(lean --sample-profile="$PROFILE" Prof.lean 2>&1 || true)
+echo "$OUT" | grep -q "Could not find native implementation of external declaration 'missing'"
+
+# every line is a stack in the collapsed stack format
+if grep -vE '^.+ [0-9]+$' "$PROFILE"; then
+  echo "unexpected line in profile"
+  exit 1
+fi
+grep -qw spin "$PROFILE"
+# the frames of `throwing` must have been removed from the interpreted stack by the exception
+if grep -w spin "$PROFILE" | grep -w throwing; then
+  echo "stale interpreted frames in profile"
+  exit 1
+fi
@@ -0,0 +1,27 @@
+#include <stdio.h>
+#include <lean/lean.h>
+
+void lean_initialize_runtime_module();
+lean_object * initialize_Registry(uint8_t builtin);
+lean_object * registry_size(void);
+
+/* Initializes `Registry` like `lean_initialize` does the core libraries, with the startup snapshot `argv[1]`. */
+int main(int argc, char ** argv) {
+    lean_object * res;
+    if (argc != 2)
+        return 2;
+    lean_initialize_runtime_module();
+    lean_startup_snapshot_start(argv[1]);
+    res = initialize_Registry(1 /* builtin */);
+    lean_startup_snapshot_finish();
+    lean_io_mark_end_initialization();
+    if (!lean_io_result_is_ok(res)) {
+        lean_io_result_show_error(res);
+        return 1;
+    }
+    lean_dec_ref(res);
+    res = registry_size();
+    printf("%u\n", (unsigned)lean_unbox(lean_io_result_get_value(res)));
+    lean_dec_ref(res);
+    return 0;
+}
@@ -0,0 +1,31 @@
+import Lean
+
+open Lean
+
+/-!
+Checks that the builtin `IO.Ref`s restored from a startup snapshot are still distinct objects. Refs holding equal
+values, such as the scalars below, must not be merged when the snapshot is taken.
+-/
+
+unsafe def refAddrs : IO (Array USize) := do
+  return #[ptrAddrUnsafe searchPathRef, ptrAddrUnsafe interpretedModInits, ptrAddrUnsafe Elab.builtinIncrementalElabs,
+    ptrAddrUnsafe builtinDeclRanges, ptrAddrUnsafe Elab.Command.lintersRef]
+
+#eval show IO Unit from do
+  let addrs ← unsafe refAddrs
+  for i in [0:addrs.size] do
+    for j in [i+1:addrs.size] do
+      if addrs[i]! == addrs[j]! then
+        throw <| IO.userError s!"builtin refs {i} and {j} are the same object"
+
+def NameSet.count (s : NameSet) : Nat := Id.run do
+  let mut n := 0
+  for _ in s do
+    n := n + 1
+  return n
+
+#eval show IO Unit from do
+  let numInits := (← interpretedModInits.get).count
+  searchPathRef.modify ("startup_snapshot" :: ·)
+  unless (← interpretedModInits.get).count == numInits do
+    throw <| IO.userError "modifying `searchPathRef` modified `interpretedModInits`"
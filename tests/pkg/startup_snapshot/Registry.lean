@@ -0,0 +1,13 @@
+import Std.Sync.Mutex
+
+/-!
+A module that cannot be part of a startup snapshot, initialized by `Driver.c` while a snapshot is taken or restored:
+`registry` contains a mutex and is modified by another initializer of the module.
+-/
+
+builtin_initialize registry : Std.Mutex (Array String) ← Std.Mutex.new #[]
+
+builtin_initialize registry.atomically (modify (·.push "registered"))
+
+@[export registry_size]
+def registrySize : IO Nat := registry.atomically do return (← get).size
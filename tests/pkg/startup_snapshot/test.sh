@@ -0,0 +1,37 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+# Startup snapshots are not supported on Windows.
+if [ "${OS:-}" = Windows_NT ]; then
+  exit 0
+fi
+
+# Run `lean` twice with the same startup snapshot: the first run takes it, the second one restores it.
+SNAPSHOT=$(mktemp -u)
+trap 'rm -f "$SNAPSHOT"' EXIT
+
+LEAN_STARTUP_SNAPSHOT="$SNAPSHOT" lean Refs.lean
+test -f "$SNAPSHOT"
+INODE=$(ls -i "$SNAPSHOT" | awk '{print $1}')
+
+LEAN_STARTUP_SNAPSHOT="$SNAPSHOT" lean Refs.lean
+# the snapshot is replaced by a new file only when it is taken again
+test "$(ls -i "$SNAPSHOT" | awk '{print $1}')" = "$INODE"
+
+# a snapshot taken by a different binary is not restored but taken again; the binary identity follows the 48 bytes of
+# the marker and githash in the header
+printf 'x' | dd of="$SNAPSHOT" bs=1 seek=48 conv=notrunc 2>/dev/null
+LEAN_STARTUP_SNAPSHOT="$SNAPSHOT" lean Refs.lean
+test "$(ls -i "$SNAPSHOT" | awk '{print $1}')" != "$INODE"
+
+# a module whose globals cannot be compacted is initialized as usual, and no snapshot of it is written as restoring
+# its other globals would skip its initializers
+TMP_DIR=$(mktemp -d)
+trap 'rm -rf "$SNAPSHOT" "$TMP_DIR"' EXIT
+lean --c="$TMP_DIR/Registry.c" Registry.lean
+leanc -o "$TMP_DIR/driver" "$TMP_DIR/Registry.c" Driver.c
+rm -f "$SNAPSHOT"
+"$TMP_DIR/driver" "$SNAPSHOT" 2> "$TMP_DIR/err" | diff <(echo 1) -
+grep -q "warning: failed to write startup snapshot .*cannot be compacted" "$TMP_DIR/err"
+test ! -e "$SNAPSHOT"
+"$TMP_DIR/driver" "$SNAPSHOT" 2> /dev/null | diff <(echo 1) -